@@ -0,0 +1,69 @@
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <Tools/Bootstrap.hpp>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setApplicationName("xsn-bootstrap");
+    QCoreApplication::setOrganizationName("Stakenet");
+    QCoreApplication::setOrganizationDomain("stakenet.io");
+    QCoreApplication::setApplicationVersion("1.0.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Builds chain bootstrap snapshot from chain index database");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption dataDirOpt(
+        "datadir", "Path to chain index database, usually <wallet data>/chain/index", "datadir");
+    QCommandLineOption assetsOpt("assets", "Comma separated asset ids", "assets", "384,0,2");
+    parser.addOption(dataDirOpt);
+    parser.addOption(assetsOpt);
+    parser.addPositionalArgument("output", "path to bootstrap file");
+    parser.process(a);
+
+    if (parser.positionalArguments().isEmpty() || !parser.isSet(dataDirOpt)
+        || !QDir(parser.value(dataDirOpt)).exists()) {
+        parser.showHelp(-1);
+    }
+
+    std::vector<AssetID> assets;
+    for (auto&& id : parser.value(assetsOpt).split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        auto assetID = id.trimmed().toUInt(&ok);
+        if (!ok) {
+            std::cerr << "Invalid asset id: " << id.toStdString() << std::endl;
+            return -1;
+        }
+        assets.push_back(assetID);
+    }
+
+    if (assets.empty()) {
+        parser.showHelp(-1);
+    }
+
+    try {
+        QElapsedTimer timer;
+        timer.start();
+
+        BootstrapWriter writer(parser.value(dataDirOpt));
+        auto builder = writer.createBuilder(parser.positionalArguments().first(), assets);
+        while (builder->canBuildNext()) {
+            std::cout << "Building asset " << builder->currentAssetID() << std::endl;
+            builder->build();
+        }
+        builder->finalize();
+
+        std::cout << "Bootstrap built in " << timer.elapsed() << " ms" << std::endl;
+    } catch (std::exception& ex) {
+        std::cerr << "Failed to build bootstrap: " << ex.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
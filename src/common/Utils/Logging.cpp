@@ -10,5 +10,7 @@ Q_LOGGING_CATEGORY(General, "stakenet.general")
 Q_LOGGING_CATEGORY(WalletBackend, "stakenet.wallet")
 Q_LOGGING_CATEGORY(Swaps, "stakenet.swaps")
 Q_LOGGING_CATEGORY(Orderbook, "stakenet.orderbook")
+// full protobuf dumps, opt in with "stakenet.orderbook.payload.debug=true"
+Q_LOGGING_CATEGORY(OrderbookPayload, "stakenet.orderbook.payload", QtInfoMsg)
 Q_LOGGING_CATEGORY(Web3, "stakenet.web3")
 Q_LOGGING_CATEGORY(TradingBot, "stakenet.tradingbot")
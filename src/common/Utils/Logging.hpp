@@ -14,6 +14,7 @@ Q_DECLARE_LOGGING_CATEGORY(General)
 Q_DECLARE_LOGGING_CATEGORY(WalletBackend)
 Q_DECLARE_LOGGING_CATEGORY(Swaps)
 Q_DECLARE_LOGGING_CATEGORY(Orderbook)
+Q_DECLARE_LOGGING_CATEGORY(OrderbookPayload)
 Q_DECLARE_LOGGING_CATEGORY(Web3)
 Q_DECLARE_LOGGING_CATEGORY(TradingBot)
 
@@ -62,6 +62,29 @@ void WorkerThread::run()
 
 //==============================================================================
 
+KeyedWorkerThreads::KeyedWorkerThreads(QString namePrefix)
+    : _namePrefix(namePrefix)
+{
+}
+
+//==============================================================================
+
+WorkerThread& KeyedWorkerThreads::threadFor(uint32_t key)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _threads.find(key);
+    if (it == std::end(_threads)) {
+        std::unique_ptr<WorkerThread> thread(new WorkerThread);
+        thread->rename(QString("%1-%2").arg(_namePrefix).arg(key));
+        thread->start();
+        it = _threads.emplace(key, std::move(thread)).first;
+    }
+
+    return *it->second;
+}
+
+//==============================================================================
+
 void ScheduleJob(WorkerThread& thread, std::function<void()> job, std::function<void()> onSuccess,
     std::function<void(QString)> onFailure)
 {
@@ -11,6 +11,9 @@
 #include <QtPromise>
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace Utils {
 
@@ -30,6 +33,19 @@ protected:
     void run() override;
 };
 
+// lazily starts one worker thread per key(e.g. asset id), so jobs for different keys run in
+// parallel while jobs for same key stay ordered.
+class KeyedWorkerThreads {
+public:
+    explicit KeyedWorkerThreads(QString namePrefix);
+    WorkerThread& threadFor(uint32_t key);
+
+private:
+    QString _namePrefix;
+    std::mutex _lock;
+    std::map<uint32_t, std::unique_ptr<WorkerThread>> _threads;
+};
+
 // schedule job on object's own thread, similiar to invoke method
 template <class T, class Func> void ScheduleJob(T* obj, Func job)
 {
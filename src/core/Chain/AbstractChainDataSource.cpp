@@ -12,3 +12,14 @@ AbstractChainDataSource::AbstractChainDataSource(QObject* parent)
 AbstractChainDataSource::~AbstractChainDataSource() {}
 
 //==============================================================================
+
+void AbstractChainDataSource::subscribeTips(AssetID) {}
+
+//==============================================================================
+
+Promise<HeadersCacheStats> AbstractChainDataSource::headersCacheStats(AssetID) const
+{
+    return Promise<HeadersCacheStats>::resolve(HeadersCacheStats{});
+}
+
+//==============================================================================
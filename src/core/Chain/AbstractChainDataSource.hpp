@@ -2,6 +2,7 @@
 #define ABSTRACTCHAINDATASOURCE_HPP
 
 #include <Chain/BlockHeader.hpp>
+#include <Chain/HeadersCache.hpp>
 #include <QObject>
 #include <Utils/Utils.hpp>
 
@@ -39,6 +40,16 @@ public:
     virtual Promise<int64_t> estimateNetworkFee(AssetID assetID, uint64_t blocks) const = 0;
     virtual Promise<Wire::TxConfrimation> getSpendingDetails(
         AssetID assetID, Wire::OutPoint outpoint) const = 0;
+
+    // Asks data source to push new tips for assetID through tipNotified, can be called from any
+    // thread. Data sources which can't push tips never emit tipNotified.
+    virtual void subscribeTips(AssetID assetID);
+    // Counters of headers cache for assetID, data sources without cache report zeros.
+    virtual Promise<HeadersCacheStats> headersCacheStats(AssetID assetID) const;
+
+signals:
+    void tipNotified(AssetID assetID, BlockHash hash, BlockHeight height);
+    void tipStreamStateChanged(AssetID assetID, bool connected);
 };
 
 #endif // ABSTRACTCHAINDATASOURCE_HPP
@@ -30,6 +30,10 @@ signals:
     void finished();
     void syncError(QString error);
     void bestBlockHeightChanged(unsigned bestBlockHeight);
+    // managers which get tips pushed by their backend notify about them, sync service doesn't
+    // need to poll such chains often.
+    void tipNotified();
+    void tipStreamStateChanged(bool connected);
 
 protected:
     Chain& chain() const;
@@ -10,6 +10,17 @@ AbstractTransactionsCache::AbstractTransactionsCache(QObject* parent)
 
 //==============================================================================
 
+Promise<TransactionsPage> AbstractTransactionsCache::transactionsPage(
+    size_t offset, size_t count) const
+{
+    return transactionsList().then([offset, count](TransactionsList transactions) {
+        TransactionUtils::SortNewestFirst(transactions);
+        return TransactionUtils::MakePage(transactions, offset, count);
+    });
+}
+
+//==============================================================================
+
 AssetsTransactionsCache::AssetsTransactionsCache(QObject* parent)
     : QObject(parent)
     , _executionContext(new QObject(this))
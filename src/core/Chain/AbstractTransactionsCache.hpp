@@ -20,6 +20,8 @@ public:
     /** all transactions **/
     virtual Promise<TransactionsList> transactionsList() const = 0;
     virtual Promise<void> addTransactions(std::vector<Transaction> transaction) = 0;
+    /** all transactions ordered from newest to oldest, [offset, offset + count) **/
+    virtual Promise<TransactionsPage> transactionsPage(size_t offset, size_t count) const;
 
     /** all transactions, sync interface **/
     virtual void addTransactionsSync(std::vector<Transaction> transaction) = 0;
@@ -77,6 +79,8 @@ public:
 
     virtual AbstractTransactionsCache& cacheByIdSync(AssetID assetId) = 0;
     virtual std::vector<AssetID> availableCaches() const = 0;
+    /** blocks until every saved transaction is durably stored **/
+    virtual void checkpointSync() = 0;
 
 signals:
     void cacheAdded(AssetID assetID);
@@ -29,6 +29,16 @@ AccountSyncManager::AccountSyncManager(Chain& chain, AssetsTransactionsCache& tr
     , _activeTokens(activeTokens)
 {
     _activeTokens.emplace_back(coinAsset());
+
+    if (!coinAsset().token()) {
+        connect(_web3Client.get(), &AbstractWeb3Client::newBlockHeader, this,
+            &AccountSyncManager::onNewBlockHeader);
+        connect(_web3Client.get(), &AbstractWeb3Client::disconnected, this,
+            &AccountSyncManager::onWeb3Disconnected);
+        _web3Client->subscribe("newHeads").tapFail([](std::exception& ex) {
+            LogCCritical(Sync) << "Failed to subscribe for new heads:" << ex.what();
+        });
+    }
 }
 
 //==============================================================================
@@ -92,6 +102,36 @@ void AccountSyncManager::onTransactionsSynced(QString address, EthOnChainTxList
 
 //==============================================================================
 
+void AccountSyncManager::onNewBlockHeader(QVariantMap header)
+{
+    auto hash = header.value("hash").toString();
+    auto number = header.value("number").toString();
+    if (hash.isEmpty() || number.isEmpty()) {
+        LogCDebug(Sync) << "Skipping malformed block header" << header;
+        return;
+    }
+
+    chain().setEthChain(hash, eth::u64{ number.toStdString() }.convert_to<int64_t>());
+    if (!_hasSubscribedTip) {
+        _hasSubscribedTip = true;
+        tipStreamStateChanged(true);
+    }
+
+    tipNotified();
+}
+
+//==============================================================================
+
+void AccountSyncManager::onWeb3Disconnected()
+{
+    if (_hasSubscribedTip) {
+        _hasSubscribedTip = false;
+        tipStreamStateChanged(false);
+    }
+}
+
+//==============================================================================
+
 void AccountSyncManager::trySync()
 {
     sync(false);
@@ -127,8 +167,7 @@ Promise<void> AccountSyncManager::scheduleLastTransactions(QString address, bool
     return _accountSyncHelper->getTransactions(address, lastTxHash)
         .then([this, address](
                   EthOnChainTxList transactions) { onTransactionsSynced(address, transactions); })
-        .then([this, address] { return scheduleFailedTransactions(address); })
-        .then([this, address] { return schedulePendingTransactions(address); })
+        .then([this, address] { return scheduleUnconfirmedTransactions(address); })
         .tapFail([this](const NetworkUtils::ApiErrorException& error) {
             onAPISyncError(error.errorResponse);
         });
@@ -136,50 +175,13 @@ Promise<void> AccountSyncManager::scheduleLastTransactions(QString address, bool
 
 //==============================================================================
 
-Promise<void> AccountSyncManager::schedulePendingTransactions(QString address)
+Promise<void> AccountSyncManager::scheduleUnconfirmedTransactions(QString address)
 {
     // TODO: Yurii - need to handle missing timestamp in web3 api where placing pending tx
     if (coinAsset().token()) {
         return Promise<void>::resolve();
     }
 
-    const auto& txns = txCache().ethOnChainTransactionsListSync();
-    std::vector<EthOnChainTxRef> pendingTxns;
-    for (auto it = txns.rbegin(); it != txns.rend(); ++it) {
-        auto tx = *it;
-        if (tx->blockHash() == EthOnChainTx::UNKNOWN_BLOCK_HASH
-            || tx->blockHeight() == EthOnChainTx::UNKNOWN_BLOCK_HEIGHT) {
-            pendingTxns.emplace_back(tx);
-        }
-    }
-
-    return QtPromise::map(pendingTxns,
-        [this, address](const EthOnChainTxRef& tx, ...) {
-            return _web3Client->getTransactionByHash(tx->txId()).then([tx](QVariantMap obj) {
-                return std::make_tuple(tx, obj);
-            });
-        })
-        .filter([](std::tuple<EthOnChainTxRef, QVariantMap> t, ...) {
-            return AccountSyncHelper::IsRemoteTxConfirmed(std::get<1>(t));
-        })
-        .map([address](std::tuple<EthOnChainTxRef, QVariantMap> t, ...) {
-            auto [tx, obj] = t;
-            auto mergedTx = AccountSyncHelper::MergeTransactions(tx, obj);
-            return TransactionUtils::UpdateEthTransactionStatus(mergedTx);
-        })
-        .then([this](QVector<EthOnChainTxRef> txns) {
-            txCache().addTransactionsSync({ txns.begin(), txns.end() });
-        });
-}
-
-//==============================================================================
-
-Promise<void> AccountSyncManager::scheduleFailedTransactions(QString address)
-{
-    if (coinAsset().token()) {
-        return Promise<void>::resolve();
-    }
-
     const auto& txns = txCache().ethOnChainTransactionsListSync();
     std::vector<EthOnChainTxRef> notConfirmedTxns;
     for (auto it = txns.rbegin(); it != txns.rend(); ++it) {
@@ -190,25 +192,31 @@ Promise<void> AccountSyncManager::scheduleFailedTransactions(QString address)
         }
     }
 
+    using RemoteTx = std::tuple<EthOnChainTxRef, QVariantMap>;
     return QtPromise::map(notConfirmedTxns,
         [this, address](const EthOnChainTxRef& tx, ...) {
             return _web3Client->getTransactionByHash(tx->txId()).then([tx](QVariantMap obj) {
                 return std::make_tuple(tx, obj);
             });
         })
-        .filter([](std::tuple<EthOnChainTxRef, QVariantMap> t, ...) {
-            const auto& [_, obj] = t;
-            return !obj.empty()
-                && obj.value("status")
-                == "0x0"; // status = "0x0" - tx failed, status = "0x1" - tx success
-        })
-        .map([address](std::tuple<EthOnChainTxRef, QVariantMap> t, ...) {
-            auto [tx, obj] = t;
-            auto mergedTx = AccountSyncHelper::MergeTransactions(tx, obj);
-            return TransactionUtils::UpdateEthTransactionStatus(mergedTx, "0x0");
-        })
-        .then([this](QVector<EthOnChainTxRef> txns) {
-            txCache().addTransactionsSync({ txns.begin(), txns.end() });
+        .then([this](QVector<RemoteTx> remoteTxns) {
+            std::vector<Transaction> updated;
+            for (auto&& [tx, obj] : remoteTxns) {
+                if (obj.empty()) {
+                    continue;
+                }
+
+                // status = "0x0" - tx failed, status = "0x1" - tx success
+                if (obj.value("status") == "0x0") {
+                    updated.emplace_back(TransactionUtils::UpdateEthTransactionStatus(
+                        AccountSyncHelper::MergeTransactions(tx, obj), "0x0"));
+                } else if (AccountSyncHelper::IsRemoteTxConfirmed(obj)) {
+                    updated.emplace_back(TransactionUtils::UpdateEthTransactionStatus(
+                        AccountSyncHelper::MergeTransactions(tx, obj)));
+                }
+            }
+
+            txCache().addTransactionsSync(updated);
         });
 }
 
@@ -242,31 +250,20 @@ Promise<Balance> AccountSyncManager::syncAccountBalance(QString address, CoinAss
 
 Promise<void> AccountSyncManager::getBestBlockHeight(CoinAsset asset)
 {
-    if (coinAsset().token()) {
+    // tip is kept up to date by newHeads subscription while it's alive
+    if (asset.token() || _hasSubscribedTip) {
         return Promise<void>::resolve();
     }
 
-    return Promise<void>([=](const auto& resolve, const auto& reject) {
-        _web3Client->getBlockNumber()
-            .then([this, asset, resolve, reject](eth::u64 bestBlockHeight) {
-                auto blockNumber
-                    = QString::fromStdString(eth::ConvertFromDecimalToHex(bestBlockHeight));
-                _web3Client->getBlockByNumber(blockNumber)
-                    .then([this, resolve, bestBlockHeight](QVariantMap blockInfo) {
-                        chain().setEthChain(blockInfo.value("hash").toString(),
-                            bestBlockHeight.convert_to<int64_t>());
-                        resolve();
-                    })
-                    .tapFail([reject](std::exception& ex) {
-                        qDebug() << "Failed to fetch block hash:" << ex.what();
-                        reject(std::current_exception());
-                    });
-            })
-            .tapFail([reject](std::exception& ex) {
-                qDebug() << "Failed to fetch block number:" << ex.what();
-                reject(std::current_exception());
-            });
-    });
+    // latest block carries both height and hash, no need to ask for block number first
+    return _web3Client->getBlockByNumber("latest")
+        .then([this](QVariantMap blockInfo) {
+            auto height = eth::u64{ blockInfo.value("number").toString().toStdString() };
+            chain().setEthChain(blockInfo.value("hash").toString(), height.convert_to<int64_t>());
+        })
+        .tapFail([](std::exception& ex) {
+            LogCCritical(Sync) << "Failed to fetch best block:" << ex.what();
+        });
 }
 
 //==============================================================================
@@ -274,31 +271,27 @@ Promise<void> AccountSyncManager::getBestBlockHeight(CoinAsset asset)
 void AccountSyncManager::sync(bool isRescan)
 {
     setIsSyncing(true);
-    // TODO(yuraolex): add check if it's connected or not, remove this later.
-    QTimer::singleShot(5000, this, [this, isRescan] {
-        _accountDataSource.getAccountAddress(coinAsset().coinID())
-            .then([this, isRescan](QString address) {
-                // address = "0xfe47fc0d8dcC526968511084E9Df04F7dC4952be";
-                // address = "0xba8e7E613346d52f8121c7cdbf35b9Fb12E77d16";
-                // address = "0x81B4E2dC68F0201291e2904a751b46e3B3561017"; // shahab
-                getBestBlockHeight(coinAsset()).then([this, address, isRescan]() {
-                    auto tokensSyncPromise = QtPromise::map(_activeTokens,
-                        [this, address](const CoinAsset& asset, ...) {
-                            return syncAccountBalance(address, asset)
-                                .then([this, assetId = asset.coinID()](Balance newBalance) {
-                                    _accountsCache.mutableCacheByIdSync(assetId).setAccountBalance(
-                                        newBalance);
-                                    return true;
-                                });
-                        })
-                                                 .then([](const QVector<bool>&) {});
-
-                    auto txSyncPromise = scheduleLastTransactions(address, isRescan);
-                    QtPromise::all(std::vector<Promise<void>>{ tokensSyncPromise, txSyncPromise })
-                        .finally([this] { this->setIsSyncing(false); });
-                });
-            });
-    });
+    // web3 calls wait in client until it's connected, calls issued together below leave as one
+    // batch instead of separate round trips.
+    _accountDataSource.getAccountAddress(coinAsset().coinID())
+        .then([this, isRescan](QString address) {
+            auto tipSyncPromise = getBestBlockHeight(coinAsset());
+            auto tokensSyncPromise = QtPromise::map(_activeTokens,
+                [this, address](const CoinAsset& asset, ...) {
+                    return syncAccountBalance(address, asset)
+                        .then([this, assetId = asset.coinID()](Balance newBalance) {
+                            _accountsCache.mutableCacheByIdSync(assetId).setAccountBalance(
+                                newBalance);
+                            return true;
+                        });
+                })
+                                         .then([](const QVector<bool>&) {});
+
+            auto txSyncPromise = scheduleLastTransactions(address, isRescan);
+            return QtPromise::all(
+                std::vector<Promise<void>>{ tipSyncPromise, tokensSyncPromise, txSyncPromise });
+        })
+        .finally([this] { this->setIsSyncing(false); });
 }
 
 //==============================================================================
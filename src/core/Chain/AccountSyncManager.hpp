@@ -30,6 +30,8 @@ public:
 private slots:
     void onAPISyncError(QString error);
     void onTransactionsSynced(QString address, EthOnChainTxList transactions);
+    void onNewBlockHeader(QVariantMap header);
+    void onWeb3Disconnected();
 
     // AbstractChainSyncManager interface
 public:
@@ -39,8 +41,8 @@ public:
 
 protected:
     Promise<void> scheduleLastTransactions(QString address, bool isRescan = false);
-    Promise<void> schedulePendingTransactions(QString address);
-    Promise<void> scheduleFailedTransactions(QString address);
+    // pending and failed transactions are resolved with one lookup per unconfirmed tx
+    Promise<void> scheduleUnconfirmedTransactions(QString address);
     Promise<Balance> syncAccountBalance(QString address, CoinAsset asset);
     Promise<void> getBestBlockHeight(CoinAsset asset);
     void sync(bool isRescan);
@@ -52,6 +54,8 @@ protected:
     qobject_delete_later_unique_ptr<AbstractAccountExplorerHttpClient> _accountExplorerHttpClient;
     qobject_delete_later_unique_ptr<AccountSyncHelper> _accountSyncHelper;
     std::vector<CoinAsset> _activeTokens;
+    // set while newHeads subscription keeps chain tip up to date
+    bool _hasSubscribedTip{ false };
 };
 
 class RescanAccountSyncManager : public AccountSyncManager {
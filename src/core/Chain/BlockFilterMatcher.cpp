@@ -1,4 +1,5 @@
 #include "BlockFilterMatcher.hpp"
+#include <Chain/BlockIndex.hpp>
 
 //==============================================================================
 
@@ -13,6 +14,34 @@ BlockFilterMatcher::~BlockFilterMatcher() {}
 
 //==============================================================================
 
+std::vector<size_t> BlockFilterMatcher::matchBatch(const std::vector<BlockIndex>& indexes) const
+{
+    std::vector<size_t> result;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (match(indexes[i])) {
+            result.push_back(i);
+        }
+    }
+
+    return result;
+}
+
+//==============================================================================
+
+BlockFilterMatcher::RefreshResult BlockFilterMatcher::refresh()
+{
+    return RefreshResult::Unsupported;
+}
+
+//==============================================================================
+
+std::unique_ptr<BlockFilterMatcher> BlockFilterMatcher::clone() const
+{
+    return nullptr;
+}
+
+//==============================================================================
+
 BlockFilterMatchable::~BlockFilterMatchable() {}
 
 //==============================================================================
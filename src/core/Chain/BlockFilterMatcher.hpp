@@ -3,6 +3,7 @@
 
 #include <Tools/Common.hpp>
 #include <memory>
+#include <vector>
 
 struct BlockIndex;
 
@@ -10,9 +11,19 @@ struct BlockIndex;
 
 struct BlockFilterMatcher {
 public:
+    enum class RefreshResult { Unchanged, Updated, Unsupported };
+
     BlockFilterMatcher(AssetID assetID);
     virtual ~BlockFilterMatcher();
     virtual bool match(const BlockIndex& blockIndex) const = 0;
+    // returns positions of matched indexes
+    virtual std::vector<size_t> matchBatch(const std::vector<BlockIndex>& indexes) const;
+    // picks up scripts that were added to wallet after matcher was created,
+    // Unsupported means that matcher has to be recreated.
+    virtual RefreshResult refresh();
+    // independent copy which can be used for matching from another thread while this matcher
+    // keeps being refreshed, nullptr if matcher can't be copied.
+    virtual std::unique_ptr<BlockFilterMatcher> clone() const;
 
 protected:
     AssetID _assetID;
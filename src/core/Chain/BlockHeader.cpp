@@ -25,7 +25,7 @@ Wire::EncodedBlockFilter::EncodedBlockFilter(
     : n(nIn)
     , m(mIn)
     , p(pIn)
-    , bytes(encodedFilter)
+    , _bytes(std::make_shared<const std::vector<uint8_t>>(std::move(encodedFilter)))
 {
 }
 
@@ -33,7 +33,15 @@ Wire::EncodedBlockFilter::EncodedBlockFilter(
 
 bool Wire::EncodedBlockFilter::isValid() const
 {
-    return !bytes.empty();
+    return _bytes && !_bytes->empty();
+}
+
+//==============================================================================
+
+const std::vector<uint8_t>& Wire::EncodedBlockFilter::bytes() const
+{
+    static const std::vector<uint8_t> empty;
+    return _bytes ? *_bytes : empty;
 }
 
 //==============================================================================
@@ -63,6 +71,38 @@ Wire::VerboseBlockHeader Wire::VerboseBlockHeader::FromJson(const QJsonObject& o
 
 //==============================================================================
 
+Wire::PackedBlockHeader::PackedBlockHeader(const VerboseBlockHeader& verboseHeader)
+    : hash(bitcoin::uint256S(verboseHeader.hash))
+    , prevBlock(bitcoin::uint256S(verboseHeader.header.prevBlock))
+    , merkleRoot(bitcoin::uint256S(verboseHeader.header.merkleRoot))
+    , version(verboseHeader.header.version)
+    , timestamp(verboseHeader.header.timestamp)
+    , bits(verboseHeader.header.bits)
+    , nonce(verboseHeader.header.nonce)
+    , height(verboseHeader.height)
+    , filter(verboseHeader.filter)
+{
+}
+
+//==============================================================================
+
+Wire::VerboseBlockHeader Wire::PackedBlockHeader::unpack() const
+{
+    VerboseBlockHeader result;
+    result.header.version = version;
+    result.header.prevBlock = prevBlock.ToString();
+    result.header.merkleRoot = merkleRoot.ToString();
+    result.header.timestamp = timestamp;
+    result.header.bits = bits;
+    result.header.nonce = nonce;
+    result.height = height;
+    result.hash = hash.ToString();
+    result.filter = filter;
+    return result;
+}
+
+//==============================================================================
+
 Wire::TxConfrimation Wire::TxConfrimation::FromJson(const QJsonObject& obj)
 {
     TxConfrimation result;
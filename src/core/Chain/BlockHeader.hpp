@@ -4,6 +4,7 @@
 #include <Data/TransactionEntry.hpp>
 #include <QString>
 #include <limits>
+#include <memory>
 #include <uint256.h>
 #include <vector>
 
@@ -18,13 +19,17 @@ struct EncodedBlockFilter {
         uint32_t nIn, uint64_t mIn, uint16_t pIn, std::vector<uint8_t> encodedFilter);
 
     bool isValid() const;
+    const std::vector<uint8_t>& bytes() const;
 
     static EncodedBlockFilter FromJson(const QJsonObject& object);
 
-    uint32_t n;
-    uint64_t m;
-    uint16_t p;
-    std::vector<uint8_t> bytes;
+    uint32_t n{ 0 };
+    uint64_t m{ 0 };
+    uint16_t p{ 0 };
+
+private:
+    // filter never changes once received, copies of header share one blob.
+    std::shared_ptr<const std::vector<uint8_t>> _bytes;
 };
 
 struct VerboseBlockHeader {
@@ -45,6 +50,34 @@ struct VerboseBlockHeader {
     EncodedBlockFilter filter;
 };
 
+/*!
+ * \brief The PackedBlockHeader struct is compact form of VerboseBlockHeader for in-memory caches.
+ * Hashes are raw uint256 instead of hex strings, hex exists only at json/api edge.
+ */
+struct PackedBlockHeader {
+    PackedBlockHeader() = default;
+    explicit PackedBlockHeader(const VerboseBlockHeader& verboseHeader);
+
+    VerboseBlockHeader unpack() const;
+
+    bitcoin::uint256 hash;
+    bitcoin::uint256 prevBlock;
+    bitcoin::uint256 merkleRoot;
+    int32_t version{ 0 };
+    uint32_t timestamp{ 0 };
+    uint32_t bits{ 0 };
+    uint32_t nonce{ 0 };
+    uint32_t height{ 0 };
+    EncodedBlockFilter filter;
+};
+
+struct Uint256Hasher {
+    size_t operator()(const bitcoin::uint256& hash) const
+    {
+        return static_cast<size_t>(hash.GetCheapHash());
+    }
+};
+
 struct OutPoint {
     bitcoin::uint256 hash;
     uint32_t index = (std::numeric_limits<uint32_t>::max)();
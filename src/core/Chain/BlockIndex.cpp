@@ -48,3 +48,10 @@ BlockHash BlockIndex::hash() const
 }
 
 //==============================================================================
+
+bitcoin::uint256 BlockIndex::rawHash() const
+{
+    return bitcoin::uint256S(_header.hash);
+}
+
+//==============================================================================
@@ -23,6 +23,7 @@ public:
 
     size_t height() const;
     BlockHash hash() const;
+    bitcoin::uint256 rawHash() const;
 
 private:
     Wire::VerboseBlockHeader _header;
@@ -5,34 +5,74 @@
 #include <Data/WalletAssetsModel.hpp>
 #include <Factories/AbstractNetworkingFactory.hpp>
 #include <Networking/NetworkingUtils.hpp>
+#include <Tools/DBUtils.hpp>
 #include <Utils/Logging.hpp>
 #include <streams.h>
 #include <transaction.h>
+#include <txdb.h>
 #include <utilstrencodings.h>
 
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <boost/range/algorithm.hpp>
+#include <numeric>
+
+//==============================================================================
+
+static const size_t HEADERS_CACHE_MAX_BYTES = 32 * 1024 * 1024;
+// fewer wallet transactions in block are fetched one by one instead of downloading whole block
+static const size_t BULK_RAW_TRANSACTIONS_MIN_MATCHES = 5;
+
+//==============================================================================
+
+// fetches raw transactions at given indexes one by one and stores them into txns
+static Promise<std::vector<std::string>> FetchRawTransactions(
+    AbstractBlockExplorerHttpClient* client, std::vector<QString> transactions,
+    std::vector<size_t> indexes, std::shared_ptr<std::vector<std::string>> txns)
+{
+    QVector<Promise<void>> fetches;
+    for (auto index : indexes) {
+        fetches.push_back(
+            client->getRawTransaction(transactions[index]).then([txns, index](QByteArray rawTx) {
+                txns->at(index)
+                    = Wire::TxConfrimation::FromJson(QJsonDocument::fromJson(rawTx).object()).hexTx;
+            }));
+    }
+
+    return QtPromise::all(fetches).then([txns] { return *txns; });
+}
+
+//==============================================================================
+
+static bitcoin::uint256 HeaderCacheKey(const BlockHash& hash)
+{
+    return bitcoin::uint256S(hash.toStdString());
+}
 
 //==============================================================================
 
 CachedChainDataSource::CachedChainDataSource(AbstractNetworkingFactory& networkingFactory,
     const WalletAssetsModel& assetsModel, AssetsTransactionsCache& transactionsCache,
-    const AbstractMutableChainManager& chainManager, QObject* parent)
+    const AbstractMutableChainManager& chainManager, QString demotedHeadersDir, QObject* parent)
     : AbstractChainDataSource(parent)
     , _executionContext(new QObject(this))
     , _networkingFactory(networkingFactory)
     , _assetsModel(assetsModel)
     , _transactionsCache(transactionsCache)
     , _chainManager(chainManager)
-    , _blockHeadersCache(10000)
     , _rawTranscationsCache(1000)
+    , _blockRawTransactionsCache(16)
+    , _demotedHeadersDir(demotedHeadersDir)
 {
 }
 
 //==============================================================================
 
+CachedChainDataSource::~CachedChainDataSource() {}
+
+//==============================================================================
+
 Promise<std::vector<Wire::VerboseBlockHeader>> CachedChainDataSource::getBlockHeaders(
     AssetID assetID, BlockHash startingBlockHash) const
 {
@@ -43,9 +83,7 @@ Promise<std::vector<Wire::VerboseBlockHeader>> CachedChainDataSource::getBlockHe
                 syncHelper->getLastHeaders(startingBlockHash)
                     .then([this, resolve, assetID](std::vector<Wire::VerboseBlockHeader> headers) {
                         boost::for_each(headers, [this, assetID](const auto& header) {
-                            _blockHeadersCache.insert(BlockHeadersCache::key_type{ assetID,
-                                                          QString::fromStdString(header.hash) },
-                                header);
+                            this->headersCache(assetID).insert(Wire::PackedBlockHeader(header));
                         });
 
                         resolve(headers);
@@ -63,18 +101,17 @@ Promise<Wire::VerboseBlockHeader> CachedChainDataSource::getBlockHeader(
     return Promise<Wire::VerboseBlockHeader>([=](const auto& resolve, const auto& reject) {
         QMetaObject::invokeMethod(_executionContext, [=] {
             try {
-                auto cacheKey = BlockHeadersCache::key_type{ assetID, hash };
                 if (auto opt = this->lookupHeaderFromCache(assetID, hash)) {
-                    resolve(*opt);
+                    resolve(opt->unpack());
                     return;
                 }
 
                 auto client = this->apiClient(assetID);
                 client->getBlockHeader(hash)
-                    .then([resolve, cacheKey, this](QByteArray result) {
+                    .then([resolve, assetID, this](QByteArray result) {
                         QJsonObject obj = QJsonDocument::fromJson(result).object();
                         auto header = Wire::VerboseBlockHeader::FromJson(obj);
-                        _blockHeadersCache.insert(cacheKey, header);
+                        this->headersCache(assetID).insert(Wire::PackedBlockHeader(header));
                         resolve(header);
                     })
                     .fail([reject]() { reject(std::current_exception()); });
@@ -95,26 +132,27 @@ Promise<BlockHash> CachedChainDataSource::getBlockHash(AssetID assetID, size_t b
                 auto client = this->apiClient(assetID);
 
                 if (auto header = _chainManager.chainById(assetID).headerAt(blockHeight)) {
-                    auto hash = QString::fromStdString(header->hash);
-                    _blockHeadersCache.insert(
-                        BlockHeadersCache::key_type{ assetID, hash }, header.get());
-                    resolve(hash);
+                    this->headersCache(assetID).insert(Wire::PackedBlockHeader(header.get()));
+                    resolve(QString::fromStdString(header->hash));
                     return;
                 }
 
-                if (_secondLayerBlockHashIndex.count(assetID) > 0
-                    && _secondLayerBlockHashIndex.at(assetID).count(blockHeight) > 0) {
-                    resolve(_secondLayerBlockHashIndex.at(assetID).at(blockHeight));
-                    return;
+                auto rangeIt = _secondLayerHashes.find(assetID);
+                if (rangeIt != _secondLayerHashes.end()) {
+                    const auto& range = rangeIt->second;
+                    if (blockHeight >= range.firstHeight
+                        && blockHeight - range.firstHeight < range.hashes.size()) {
+                        auto hash = range.hashes.at(blockHeight - range.firstHeight);
+                        resolve(QString::fromStdString(hash.ToString()));
+                        return;
+                    }
                 }
 
                 client->getBlockHashByHeight(blockHeight)
                     .then([=](QByteArray bytes) {
                         QJsonObject obj = QJsonDocument::fromJson(bytes).object();
                         auto result = Wire::VerboseBlockHeader::FromJson(obj);
-                        _blockHeadersCache.insert(BlockHeadersCache::key_type{ assetID,
-                                                      QString::fromStdString(result.hash) },
-                            result);
+                        this->headersCache(assetID).insert(Wire::PackedBlockHeader(result));
                         resolve(QString::fromStdString(result.hash));
                     })
                     .fail([reject]() { reject(std::current_exception()); });
@@ -200,24 +238,55 @@ Promise<std::vector<std::string>> CachedChainDataSource::getFilteredBlock(
         QMetaObject::invokeMethod(_executionContext, [=] {
             try {
                 auto client = this->apiClient(assetID);
+                using Transactions = std::vector<QString>;
+                using RawTransactions = std::vector<std::string>;
 
                 _transactionsCache.cacheByIdSync(assetID)
                     .transactionsInBlock(hash)
-                    .then([client, this](const std::vector<QString>& transactions) {
-                        return QtPromise::map(transactions, [client, this](const QString& id, ...) {
-                            return client->getRawTransaction(id);
-                        });
-                    })
-                    .then([resolve](const QVector<QByteArray>& rawTransactions) mutable {
-                        std::vector<std::string> txns;
-                        for (auto&& rawTxBytes : rawTransactions) {
-                            auto rawTx = Wire::TxConfrimation::FromJson(
-                                QJsonDocument::fromJson(rawTxBytes).object());
-                            txns.emplace_back(rawTx.hexTx);
+                    .then([=](const Transactions& transactions) {
+                        auto txns = std::make_shared<RawTransactions>(transactions.size());
+                        std::vector<size_t> all(transactions.size());
+                        std::iota(all.begin(), all.end(), 0);
+
+                        // whole block is requested only when it saves enough requests and
+                        // explorer serves it.
+                        if (transactions.size() < BULK_RAW_TRANSACTIONS_MIN_MATCHES
+                            || _bulkRawTransactionsUnsupported.count(assetID) > 0) {
+                            return FetchRawTransactions(client, transactions, all, txns);
                         }
 
-                        resolve(txns);
+                        // txs which block doesn't list anymore (e.g. wallet cache is behind
+                        // reorg) are fetched one by one.
+                        return this->blockRawTransactions(assetID, hash)
+                            .then([client, transactions, txns](BlockRawTransactionsRef block) {
+                                std::vector<size_t> missing;
+                                for (size_t i = 0; i < transactions.size(); ++i) {
+                                    auto it = block->find(transactions[i]);
+                                    if (it != block->end()) {
+                                        txns->at(i) = it->second;
+                                    } else {
+                                        missing.emplace_back(i);
+                                    }
+                                }
+
+                                return FetchRawTransactions(client, transactions, missing, txns);
+                            })
+                            .fail([=] {
+                                try {
+                                    throw;
+                                } catch (const NetworkUtils::ApiErrorException& ex) {
+                                    if (ex.errorCode == 404) {
+                                        _bulkRawTransactionsUnsupported.emplace(assetID);
+                                    }
+                                } catch (...) {
+                                }
+
+                                LogCDebug(Api) << "Failed to fetch raw transactions of block"
+                                               << hash << "fetching them one by one";
+                                return FetchRawTransactions(client, transactions, all, txns);
+                            });
                     })
+                    .then([resolve](const RawTransactions& txns) { resolve(txns); })
                     .fail([reject]() { reject(std::current_exception()); });
             } catch (...) {
                 reject(std::current_exception());
@@ -235,7 +304,7 @@ Promise<Wire::EncodedBlockFilter> CachedChainDataSource::getBlockFilter(
         QMetaObject::invokeMethod(_executionContext, [=] {
             try {
                 if (auto opt = this->lookupHeaderFromCache(assetID, hash)) {
-                    resolve(opt.get().filter);
+                    resolve(opt->filter);
                     return;
                 }
 
@@ -383,8 +452,6 @@ Promise<void> CachedChainDataSource::loadSecondLayerCache(
     }
     return Promise<void>([=](const auto& resolve, const auto& reject) {
         QMetaObject::invokeMethod(_executionContext, [=] {
-            auto syncHelper = &this->chainSyncHelper(assetID);
-
             if (*interrupt) {
                 reject(QtPromise::QPromiseCanceledException{});
                 return;
@@ -392,10 +459,11 @@ Promise<void> CachedChainDataSource::loadSecondLayerCache(
 
             this->getBlockHash(assetID, startBlock)
                 .then([=](QString startingBlockHash) {
-                    auto headersCache = &_secondLayerBlockHeadersCache[assetID];
-                    auto hashIndex = &_secondLayerBlockHashIndex[assetID];
-                    OnGetBlockHeaderRecursive(resolve, reject, headersCache, hashIndex,
-                        startingBlockHash, syncHelper, interrupt.get());
+                    auto& range = _secondLayerHashes[assetID];
+                    range.firstHeight = startBlock + 1;
+                    range.hashes.clear();
+                    this->prefetchHeaders(
+                        assetID, startBlock + 1, startingBlockHash, interrupt, resolve, reject);
                 })
                 .fail([reject]() { reject(std::current_exception()); });
         });
@@ -408,8 +476,11 @@ Promise<void> CachedChainDataSource::freeSecondLayerCache(AssetID assetID) const
 {
     return Promise<void>([=](const auto& resolve, const auto&) {
         QMetaObject::invokeMethod(_executionContext, [=] {
-            _secondLayerBlockHeadersCache.erase(assetID);
-            _secondLayerBlockHashIndex.erase(assetID);
+            this->headersCache(assetID).clearDemoted();
+            _secondLayerHashes.erase(assetID);
+            if (auto db = this->demotedHeadersDb()) {
+                db->EraseByAsset(assetID);
+            }
             resolve();
         });
     });
@@ -474,35 +545,22 @@ Promise<Wire::TxConfrimation> CachedChainDataSource::getSpendingDetails(
 
 //==============================================================================
 
-static void OnGetBlockHeaderRecursive(const QtPromise::QPromiseResolve<void>& resolve,
-    const QtPromise::QPromiseReject<void>& reject,
-    std::unordered_map<BlockHash, Wire::VerboseBlockHeader>* headersCache,
-    std::unordered_map<size_t, BlockHash>* hashIndex, QString startHash,
-    ChainSyncHelper* syncHelper, bool* interruptFlag)
+void CachedChainDataSource::subscribeTips(AssetID assetID)
 {
-
-    if (*interruptFlag) {
-        reject(QtPromise::QPromiseCanceledException{});
-        return;
-    }
-
-    syncHelper->getLastHeaders(startHash)
-        .then([=](std::vector<Wire::VerboseBlockHeader> headers) {
-            if (!headers.empty()) {
-                // copy headers  into headersCache
-                for (auto&& header : std::move(headers)) {
-                    headersCache->emplace(QString::fromStdString(header.hash), header);
-                    hashIndex->emplace(header.height, QString::fromStdString(header.hash));
-                }
-
-                // recursively call this function until we cache all needed headers
-                OnGetBlockHeaderRecursive(resolve, reject, headersCache, hashIndex,
-                    QString::fromStdString(headers.back().hash), syncHelper, interruptFlag);
-            } else {
-                resolve();
-            }
-        })
-        .fail(reject);
+    QMetaObject::invokeMethod(_executionContext, [=] {
+        if (!_tipSubscriptions.insert(assetID).second) {
+            return;
+        }
+
+        auto client = this->apiClient(assetID);
+        connect(client, &AbstractBlockExplorerHttpClient::tipReceived, this,
+            [this, assetID](QString hash, unsigned height) {
+                tipNotified(assetID, hash, height);
+            });
+        connect(client, &AbstractBlockExplorerHttpClient::tipStreamStateChanged, this,
+            [this, assetID](bool connected) { tipStreamStateChanged(assetID, connected); });
+        QMetaObject::invokeMethod(client, [client] { client->subscribeTips(); });
+    });
 }
 
 //==============================================================================
@@ -530,28 +588,196 @@ AbstractBlockExplorerHttpClient* CachedChainDataSource::apiClient(AssetID assetI
 
 //==============================================================================
 
-boost::optional<Wire::VerboseBlockHeader> CachedChainDataSource::fetchFromSecondLayerCache(
+Promise<HeadersCacheStats> CachedChainDataSource::headersCacheStats(AssetID assetID) const
+{
+    return Promise<HeadersCacheStats>([=](const auto& resolve, const auto&) {
+        QMetaObject::invokeMethod(_executionContext, [=] {
+            auto stats = this->headersCache(assetID).stats();
+            auto it = _secondLayerHashes.find(assetID);
+            if (it != _secondLayerHashes.end()) {
+                stats.bytes += it->second.hashes.capacity() * sizeof(bitcoin::uint256);
+            }
+            resolve(stats);
+        });
+    });
+}
+
+//==============================================================================
+
+HeadersCache& CachedChainDataSource::headersCache(AssetID assetID) const
+{
+    auto it = _headersCaches.find(assetID);
+    if (it == _headersCaches.end()) {
+        auto onDemoted = [this, assetID](const HeadersCache::Header& header) {
+            persistDemotedHeader(assetID, header);
+        };
+        it = _headersCaches.emplace(assetID, HeadersCache(HEADERS_CACHE_MAX_BYTES, onDemoted))
+                 .first;
+    }
+
+    return it->second;
+}
+
+//==============================================================================
+
+boost::optional<Wire::PackedBlockHeader> CachedChainDataSource::lookupHeaderFromCache(
     AssetID assetID, BlockHash hash) const
 {
-    if (_secondLayerBlockHeadersCache.count(assetID) > 0
-        && _secondLayerBlockHeadersCache.at(assetID).count(hash) > 0) {
-        return _secondLayerBlockHeadersCache.at(assetID).at(hash);
+    auto& cache = headersCache(assetID);
+    auto key = HeaderCacheKey(hash);
+    if (auto header = cache.get(key)) {
+        return header;
     }
 
+    // evicted headers are read back by height from disk, hash confirms it is the same block.
+    if (auto height = cache.demotedHeight(key)) {
+        if (auto packed = readDemotedHeader(assetID, *height)) {
+            if (packed->hash == key) {
+                cache.countDiskHit();
+                cache.insert(*packed);
+                return packed;
+            }
+        }
+    }
+
+    cache.countMiss();
     return boost::none;
 }
 
 //==============================================================================
 
-boost::optional<Wire::VerboseBlockHeader> CachedChainDataSource::lookupHeaderFromCache(
-    AssetID assetID, BlockHash hash) const
+boost::optional<Wire::PackedBlockHeader> CachedChainDataSource::readDemotedHeader(
+    AssetID assetID, uint32_t height) const
+{
+    if (_chainManager.hasChain(assetID)) {
+        if (auto header = _chainManager.chainById(assetID).headerAt(height)) {
+            return Wire::PackedBlockHeader(header.get());
+        }
+    }
+
+    // chain index keeps only recent blocks, older ones are found where they were demoted to.
+    if (auto db = demotedHeadersDb()) {
+        bitcoin::CDiskBlockIndex diskIndex;
+        if (db->ReadBlockIndex(assetID, height, diskIndex)) {
+            return DBUtils::DiskIndexToPackedHeader(diskIndex);
+        }
+    }
+
+    return boost::none;
+}
+
+//==============================================================================
+
+void CachedChainDataSource::persistDemotedHeader(
+    AssetID assetID, const Wire::PackedBlockHeader& header) const
+{
+    if (auto db = demotedHeadersDb()) {
+        bitcoin::CDBBatch batch(*db);
+        db->WriteBlockIndex(batch, assetID, DBUtils::BlockIndexToDisk(header));
+        db->WriteBatch(batch, false);
+    }
+}
+
+//==============================================================================
+
+bitcoin::CBlockTreeDB* CachedChainDataSource::demotedHeadersDb() const
+{
+    if (!_demotedHeadersDb && !_demotedHeadersDir.isEmpty()) {
+        // demoted headers are valid only for this run, database is wiped when opened.
+        _demotedHeadersDb.reset(
+            new bitcoin::CBlockTreeDB(_demotedHeadersDir.toStdString(), 1000, false, true));
+    }
+
+    return _demotedHeadersDb.get();
+}
+
+//==============================================================================
+
+void CachedChainDataSource::prefetchHeaders(AssetID assetID, uint32_t height, BlockHash lastHash,
+    std::shared_ptr<bool> interrupt, QtPromise::QPromiseResolve<void> resolve,
+    QtPromise::QPromiseReject<void> reject) const
+{
+    if (*interrupt) {
+        reject(QtPromise::QPromiseCanceledException{});
+        return;
+    }
+
+    // headers which chain manager already stored don't need to be downloaded, only indexed.
+    if (_chainManager.hasChain(assetID)) {
+        auto& cache = headersCache(assetID);
+        auto& range = _secondLayerHashes[assetID];
+        const auto& chain = _chainManager.chainById(assetID);
+        auto last = std::min<size_t>(
+            chain.getHeight(), height + ChainSyncHelper::CHAIN_HEADERS_SYNC_LIMIT - 1);
+        size_t read = 0;
+        for (; height <= last; ++height, ++read) {
+            auto header = chain.headerAt(height);
+            if (!header) {
+                break;
+            }
+            auto hash = bitcoin::uint256S(header->hash);
+            cache.remember(hash, height);
+            range.hashes.emplace_back(hash);
+            lastHash = QString::fromStdString(header->hash);
+        }
+
+        if (read > 0) {
+            // let other requests through between batches
+            QMetaObject::invokeMethod(
+                _executionContext,
+                [=] { prefetchHeaders(assetID, height, lastHash, interrupt, resolve, reject); },
+                Qt::QueuedConnection);
+            return;
+        }
+    }
+
+    chainSyncHelper(assetID)
+        .getLastHeaders(lastHash)
+        .then([=](const std::vector<Wire::VerboseBlockHeader>& headers) {
+            if (headers.empty()) {
+                resolve();
+                return;
+            }
+
+            auto& cache = headersCache(assetID);
+            auto& range = _secondLayerHashes[assetID];
+            for (const auto& header : headers) {
+                Wire::PackedBlockHeader packed(header);
+                range.hashes.emplace_back(packed.hash);
+                cache.insert(std::move(packed));
+            }
+
+            prefetchHeaders(assetID, headers.back().height + 1,
+                QString::fromStdString(headers.back().hash), interrupt, resolve, reject);
+        })
+        .fail([reject]() { reject(std::current_exception()); });
+}
+
+//==============================================================================
+
+auto CachedChainDataSource::blockRawTransactions(AssetID assetID, BlockHash hash) const
+    -> Promise<BlockRawTransactionsRef>
 {
-    auto cacheKey = BlockHeadersCache::key_type{ assetID, hash };
-    if (auto opt = _blockHeadersCache.get(cacheKey)) {
-        return opt;
+    auto cacheKey = BlockRawTransactionsCache::key_type{ assetID, hash };
+    if (auto opt = _blockRawTransactionsCache.get(cacheKey)) {
+        return Promise<BlockRawTransactionsRef>::resolve(*opt);
     }
 
-    return fetchFromSecondLayerCache(assetID, hash);
+    return apiClient(assetID)->getBlockRawTransactions(hash).then(
+        [this, cacheKey](QByteArray response) {
+            auto data = QJsonDocument::fromJson(response).object().value("data").toArray();
+            auto block = std::make_shared<BlockRawTransactions>();
+            block->reserve(static_cast<size_t>(data.size()));
+            for (const auto& value : data) {
+                auto obj = value.toObject();
+                block->emplace(
+                    obj.value("id").toString(), obj.value("hex").toString().toStdString());
+            }
+
+            BlockRawTransactionsRef result = block;
+            _blockRawTransactionsCache.insert(cacheKey, result);
+            return result;
+        });
 }
 
 //==============================================================================
@@ -3,9 +3,11 @@
 
 #include <Chain/AbstractChainDataSource.hpp>
 #include <Chain/ChainSyncHelper.hpp>
+#include <Chain/HeadersCache.hpp>
 #include <QObject>
 #include <Utils/Utils.hpp>
 #include <boost/compute/detail/lru_cache.hpp>
+#include <set>
 #include <unordered_map>
 
 class ChainSyncHelper;
@@ -14,6 +16,10 @@ class AbstractNetworkingFactory;
 class AssetsTransactionsCache;
 class AbstractMutableChainManager;
 
+namespace bitcoin {
+class CBlockTreeDB;
+}
+
 //==============================================================================
 
 class CachedChainDataSource : public AbstractChainDataSource {
@@ -21,7 +27,9 @@ class CachedChainDataSource : public AbstractChainDataSource {
 public:
     explicit CachedChainDataSource(AbstractNetworkingFactory& networkingFactory,
         const WalletAssetsModel& assetsModel, AssetsTransactionsCache& transactionsCache,
-        const AbstractMutableChainManager& chainManager, QObject* parent = nullptr);
+        const AbstractMutableChainManager& chainManager, QString demotedHeadersDir = QString(),
+        QObject* parent = nullptr);
+    ~CachedChainDataSource() override;
 
     Promise<std::vector<Wire::VerboseBlockHeader>> getBlockHeaders(
         AssetID assetID, BlockHash startingBlockHash) const override;
@@ -48,14 +56,27 @@ public:
     Promise<int64_t> estimateNetworkFee(AssetID assetID, uint64_t blocks) const override;
     Promise<Wire::TxConfrimation> getSpendingDetails(
         AssetID assetID, Wire::OutPoint outpoint) const override;
+    void subscribeTips(AssetID assetID) override;
+    Promise<HeadersCacheStats> headersCacheStats(AssetID assetID) const override;
 
 private:
     ChainSyncHelper& chainSyncHelper(AssetID assetID) const;
     AbstractBlockExplorerHttpClient* apiClient(AssetID assetID) const;
-    boost::optional<Wire::VerboseBlockHeader> fetchFromSecondLayerCache(
-        AssetID assetID, BlockHash hash) const;
-    boost::optional<Wire::VerboseBlockHeader> lookupHeaderFromCache(
+    HeadersCache& headersCache(AssetID assetID) const;
+    boost::optional<Wire::PackedBlockHeader> lookupHeaderFromCache(
         AssetID assetID, BlockHash hash) const;
+    boost::optional<Wire::PackedBlockHeader> readDemotedHeader(
+        AssetID assetID, uint32_t height) const;
+    void persistDemotedHeader(AssetID assetID, const Wire::PackedBlockHeader& header) const;
+    bitcoin::CBlockTreeDB* demotedHeadersDb() const;
+    void prefetchHeaders(AssetID assetID, uint32_t height, BlockHash lastHash,
+        std::shared_ptr<bool> interrupt, QtPromise::QPromiseResolve<void> resolve,
+        QtPromise::QPromiseReject<void> reject) const;
+
+    // raw transactions of one block indexed by txid, hex encoded.
+    using BlockRawTransactions = std::unordered_map<QString, std::string>;
+    using BlockRawTransactionsRef = std::shared_ptr<const BlockRawTransactions>;
+    Promise<BlockRawTransactionsRef> blockRawTransactions(AssetID assetID, BlockHash hash) const;
 
 private:
     QObject* _executionContext{ nullptr };
@@ -64,21 +85,30 @@ private:
     AssetsTransactionsCache& _transactionsCache;
     const AbstractMutableChainManager& _chainManager;
 
-    using BlockHeadersCache = boost::compute::detail::lru_cache<std::pair<AssetID, BlockHash>,
-        Wire::VerboseBlockHeader>;
-    using SecondLayerBlockCache = std::unordered_map<BlockHash, Wire::VerboseBlockHeader>;
-    using SecondLayerCache = std::map<AssetID, SecondLayerBlockCache>;
     using RawTransactionsCache
         = boost::compute::detail::lru_cache<std::pair<AssetID, TxID>, Wire::TxConfrimation>;
+    using BlockRawTransactionsCache = boost::compute::detail::lru_cache<
+        std::pair<AssetID, BlockHash>, BlockRawTransactionsRef>;
     using ChainSyncHelperPtr = qobject_delete_later_unique_ptr<ChainSyncHelper>;
     using BlockExplorerClientPtr = qobject_delete_later_unique_ptr<AbstractBlockExplorerHttpClient>;
     mutable std::map<AssetID, ChainSyncHelperPtr> _chainSyncHelpers;
     mutable std::map<AssetID, BlockExplorerClientPtr> _clients;
-    mutable BlockHeadersCache _blockHeadersCache;
+    std::set<AssetID> _tipSubscriptions;
     mutable RawTransactionsCache _rawTranscationsCache;
-    mutable SecondLayerCache
-        _secondLayerBlockHeadersCache; // temporary loaded cache to sync lnd quickly
-    mutable std::map<AssetID, std::unordered_map<size_t, BlockHash>> _secondLayerBlockHashIndex;
+    mutable BlockRawTransactionsCache _blockRawTransactionsCache;
+    // assets which explorer doesn't serve raw transactions of whole block
+    mutable std::set<AssetID> _bulkRawTransactionsUnsupported;
+    // headers are cached packed, hex strings are produced only when header leaves the cache.
+    mutable std::map<AssetID, HeadersCache> _headersCaches;
+    // bodies of headers evicted from memory which chain index doesn't have, e.g. prefetched ones.
+    QString _demotedHeadersDir;
+    mutable std::unique_ptr<bitcoin::CBlockTreeDB> _demotedHeadersDb;
+    // hashes of range prefetched for lnd by loadSecondLayerCache, indexed by height.
+    struct HashRange {
+        uint32_t firstHeight{ 0 };
+        std::vector<bitcoin::uint256> hashes;
+    };
+    mutable std::map<AssetID, HashRange> _secondLayerHashes;
 };
 
 #endif // CACHEDCHAINDATASOURCE_HPP
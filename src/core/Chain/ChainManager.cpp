@@ -10,14 +10,22 @@
 
 //==============================================================================
 
-static constexpr size_t FLUSH_DISK_TIMER_INTERVAL = 100;
+// dirty headers are flushed once any threshold is reached, timer flushes whatever is left when
+// chain goes idle.
+static constexpr size_t FLUSH_DISK_TIMER_INTERVAL = 1000;
+static constexpr size_t FLUSH_DIRTY_HEADERS_COUNT = 2000;
+static constexpr size_t FLUSH_DIRTY_HEADERS_BYTES = 8 << 20;
 static constexpr size_t BLOCKS_STORED_LOCALLY = 10000;
+// bootstrap writes are flushed without fsync once batch grows above it, last write is synced.
+static constexpr size_t BOOTSTRAP_BATCH_SIZE = 16 << 20;
 
 //==============================================================================
 
-ChainManager::ChainManager(const WalletAssetsModel& assetsModel, QString dataDir, QObject* parent)
+ChainManager::ChainManager(const WalletAssetsModel& assetsModel, QString dataDir,
+    FlushCheckpoint checkpoint, QObject* parent)
     : AbstractMutableChainManager(assetsModel, parent)
     , _dataDir(dataDir.toStdString())
+    , _flushCheckpoint(checkpoint)
 {
     _diskFlushTimer = new QTimer(this);
     _diskFlushTimer->setSingleShot(true);
@@ -31,7 +39,7 @@ Promise<void> ChainManager::loadChains(std::vector<AssetID> chains)
     return Promise<void>([=](const auto& resolver, const auto& reject) {
         QMetaObject::invokeMethod(this, [=] {
             try {
-                _chainDB.reset(new bitcoin::CBlockTreeDB(_dataDir, 1000, false, false));
+                this->openChainDB();
                 this->executeLoadChains(chains);
                 this->chainsLoaded(chains);
                 resolver();
@@ -47,10 +55,16 @@ Promise<void> ChainManager::loadChains(std::vector<AssetID> chains)
 
 Promise<void> ChainManager::loadFromBootstrap(QString bootstrapFile)
 {
-    return Promise<void>([=](const auto& resolver, const auto&) {
+    return Promise<void>([=](const auto& resolver, const auto& reject) {
         QMetaObject::invokeMethod(this, [=] {
-            this->executeLoadBootstrap(bootstrapFile);
-            resolver();
+            try {
+                this->openChainDB();
+                this->executeLoadBootstrap(bootstrapFile);
+                resolver();
+            } catch (std::exception& ex) {
+                LogCCritical(Chains) << "Failed to load bootstrap:" << ex.what();
+                reject(std::current_exception());
+            }
         });
     });
 }
@@ -70,8 +84,14 @@ void ChainManager::executeLoadChains(std::vector<AssetID> chains)
     }
 
     auto setNewTip = [this](AssetID assetID, Wire::VerboseBlockHeader newTip) {
-        _dirtyIndex[assetID].emplace_back(newTip);
-        startFlushTimer();
+        auto& headers = _dirtyIndex[assetID];
+        if (!headers.empty() && newTip.height > headers.tipHeight() + 1) {
+            // buffer restarts at new tip, headers buffered so far must reach disk first
+            flushStateToDisk();
+        }
+        headers.push(Wire::PackedBlockHeader(newTip));
+        _tips[assetID] = std::move(newTip);
+        scheduleFlush();
     };
 
     auto getHeader
@@ -83,14 +103,16 @@ void ChainManager::executeLoadChains(std::vector<AssetID> chains)
 
         bitcoin::CDiskBlockIndex index;
 
+        // most lookups are done at tip, it's kept unpacked
+        auto tipIt = _tips.find(assetID);
+        if (tipIt != std::end(_tips) && tipIt->second.height == height) {
+            return tipIt->second;
+        }
+
         auto it = _dirtyIndex.find(assetID);
         if (it != std::end(_dirtyIndex)) {
-            const auto& list = it->second;
-            auto lIt = std::find_if(std::begin(list), std::end(list),
-                [height](const auto& item) { return item.height == height; });
-
-            if (lIt != std::end(list)) {
-                return *lIt;
+            if (auto header = it->second.headerAt(height)) {
+                return header->unpack();
             }
         }
 
@@ -146,40 +168,64 @@ void ChainManager::onFlushError(QString error)
 
 void ChainManager::flushStateToDisk()
 {
+    _diskFlushTimer->stop();
+
+    auto isDirty = std::any_of(std::begin(_dirtyIndex), std::end(_dirtyIndex),
+        [](const auto& it) { return !it.second.empty(); });
+    if (!isDirty) {
+        return;
+    }
+
+    if (_flushCheckpoint) {
+        _flushCheckpoint();
+    }
+
     for (auto&& it : _dirtyIndex) {
-        auto& items = it.second;
-        bitcoin::CDBBatch batch(*_chainDB);
-        uint32_t bestBlockHeight = 0;
-        for (auto&& item : items) {
-            _chainDB->WriteBlockIndex(batch, it.first, DBUtils::BlockIndexToDisk(item));
-            bestBlockHeight = std::max(item.height, bestBlockHeight);
+        auto& headers = it.second;
+        if (headers.empty()) {
+            continue;
         }
 
-        uint32_t storedBBHeight = 0;
-        if (_chainDB->ReadBestBlock(it.first, storedBBHeight)) {
-            bestBlockHeight = std::max(storedBBHeight, bestBlockHeight);
+        bitcoin::CDBBatch batch(*_chainDB);
+        headers.forEach([this, &batch, assetID = it.first](const auto& header) {
+            _chainDB->WriteBlockIndex(batch, assetID, DBUtils::BlockIndexToDisk(header));
+        });
+
+        // buffered tip is lower than stored one after reorg to shorter chain, best block
+        // never goes down.
+        auto bestBlockHeight = static_cast<uint32_t>(headers.tipHeight());
+        uint32_t storedBestBlockHeight = 0;
+        if (_chainDB->ReadBestBlock(it.first, storedBestBlockHeight)) {
+            bestBlockHeight = std::max(storedBestBlockHeight, bestBlockHeight);
         }
 
         _chainDB->WriteBestBlock(batch, it.first, bestBlockHeight);
         _chainDB->WriteBatch(batch, true);
 
-        const auto staleHeight = bestBlockHeight - BLOCKS_STORED_LOCALLY - items.size();
-        for (size_t i = 0; i < items.size(); ++i) {
+        const auto staleHeight = bestBlockHeight - BLOCKS_STORED_LOCALLY - headers.size();
+        for (size_t i = 0; i < headers.size(); ++i) {
             _chainDB->EraseBlockIndex(batch, it.first, staleHeight + i);
         }
 
         _chainDB->WriteBatch(batch, true);
-        items.clear();
+        headers.clear();
     }
-
-    _dirtyIndex.clear();
 }
 
 //==============================================================================
 
-void ChainManager::startFlushTimer()
+void ChainManager::scheduleFlush()
 {
-    if (!_diskFlushTimer->isActive()) {
+    size_t count = 0;
+    size_t bytes = 0;
+    for (auto&& it : _dirtyIndex) {
+        count += it.second.size();
+        bytes += it.second.bytes();
+    }
+
+    if (count >= FLUSH_DIRTY_HEADERS_COUNT || bytes >= FLUSH_DIRTY_HEADERS_BYTES) {
+        flushStateToDisk();
+    } else if (!_diskFlushTimer->isActive()) {
         _diskFlushTimer->start(FLUSH_DISK_TIMER_INTERVAL);
     }
 }
@@ -188,52 +234,73 @@ void ChainManager::startFlushTimer()
 
 void ChainManager::executeLoadBootstrap(QString path)
 {
-#if 0
+    verifyBootstrap(path);
+
     BootstrapReader bootstrapReader(path);
-    std::vector<std::pair<AssetID, bitcoin::CDiskBlockIndex>> diskIndexes;
-    diskIndexes.reserve(10000);
 
-    while(bootstrapReader.canReadMore())
-    {
+    while (bootstrapReader.canReadMore()) {
         auto assetReader = bootstrapReader.readNextAsset();
-        bitcoin::uint256 bestBlockHash;
+        auto assetID = assetReader->assetID;
 
-        if(_chainDB->Exists(assetReader->assetID))
-        {
-            _chainDB->EraseByAsset(assetReader->assetID);
-        }
+        LogCDebug(Chains) << "Loading bootstrap for asset" << assetID
+                          << "best height:" << assetReader->bestHeight;
 
-        while(assetReader->canReadMore())
-        {
-            diskIndexes.push_back({assetReader->assetID, assetReader->readNext()});
+        _chainDB->EraseByAsset(assetID);
 
-            if(assetReader->remainingBlocks() == 0)
-            {
-                bestBlockHash = diskIndexes.back().second.hashBlock;
+        bitcoin::CDBBatch batch(*_chainDB);
+        while (assetReader->canReadMore()) {
+            for (auto&& diskIndex : assetReader->readNextChunk()) {
+                _chainDB->WriteBlockIndex(batch, assetID, diskIndex);
             }
 
-            if(diskIndexes.size() >= 10000)
-            {
-                _chainDB->WriteBatchSync(diskIndexes);
-                diskIndexes.clear();
+            if (batch.SizeEstimate() >= BOOTSTRAP_BATCH_SIZE) {
+                _chainDB->WriteBatch(batch, false);
+                batch.Clear();
             }
         }
 
-        if(!diskIndexes.empty())
-        {
-            _chainDB->WriteBatchSync(diskIndexes);
-            diskIndexes.clear();
-        }
-
-        bitcoin::CDBBatch batch(*_chainDB);
-        _chainDB->WriteBestBlockBatch(batch, assetReader->assetID, bestBlockHash);
+        // best block goes last, interrupted import looks like empty chain on next start.
+        _chainDB->WriteBestBlock(batch, assetID, assetReader->bestHeight);
         _chainDB->WriteBatch(batch, true);
     }
 
     bootstrapReader.finalize();
 
     LogCDebug(Chains) << "Bootstrap loaded";
-#endif
+}
+
+//==============================================================================
+
+void ChainManager::verifyBootstrap(QString path) const
+{
+    // whole file is read and verified before existing index gets erased, broken chunk at the end
+    // of file must not leave chain wiped and partially imported.
+    BootstrapReader bootstrapReader(path);
+
+    while (bootstrapReader.canReadMore()) {
+        auto assetReader = bootstrapReader.readNextAsset();
+        auto assetID = assetReader->assetID;
+
+        if (_chains.count(assetID) > 0) {
+            throw std::runtime_error(
+                QString("Chain %1 is already loaded, bootstrap has to be loaded before chains")
+                    .arg(assetID)
+                    .toStdString());
+        }
+
+        while (assetReader->canReadMore()) {
+            assetReader->readNextChunk();
+        }
+    }
+}
+
+//==============================================================================
+
+void ChainManager::openChainDB()
+{
+    if (!_chainDB) {
+        _chainDB.reset(new bitcoin::CBlockTreeDB(_dataDir, 1000, false, false));
+    }
 }
 
 //==============================================================================
@@ -3,8 +3,10 @@
 
 #include <Chain/AbstractChainManager.hpp>
 #include <Chain/BlockIndex.hpp>
+#include <Chain/DirtyHeadersBuffer.hpp>
 
 #include <boost/compute/detail/lru_cache.hpp>
+#include <functional>
 #include <set>
 
 namespace bitcoin {
@@ -15,7 +17,11 @@ class QTimer;
 
 class ChainManager : public AbstractMutableChainManager {
 public:
-    ChainManager(const WalletAssetsModel& assetsModel, QString dataDir, QObject* parent = nullptr);
+    // called before new best blocks are written, everything that was derived from these blocks has
+    // to be durable once it returns, chain sync resumes from stored best block after a crash.
+    using FlushCheckpoint = std::function<void()>;
+    ChainManager(const WalletAssetsModel& assetsModel, QString dataDir,
+        FlushCheckpoint checkpoint = {}, QObject* parent = nullptr);
 
     Promise<void> loadChains(std::vector<AssetID> chains) override;
     Promise<void> loadFromBootstrap(QString bootstrapFile) override;
@@ -31,15 +37,19 @@ private slots:
 
 private:
     void flushStateToDisk();
-    void startFlushTimer();
+    void scheduleFlush();
     void executeLoadChains(std::vector<AssetID> chains);
     void executeLoadBootstrap(QString path);
+    void verifyBootstrap(QString path) const;
+    void openChainDB();
 
 private:
     std::unique_ptr<bitcoin::CBlockTreeDB> _chainDB;
-    std::map<AssetID, std::vector<Wire::VerboseBlockHeader>> _dirtyIndex;
+    std::map<AssetID, DirtyHeadersBuffer> _dirtyIndex;
+    std::map<AssetID, Wire::VerboseBlockHeader> _tips;
     QTimer* _diskFlushTimer{ nullptr };
     std::string _dataDir;
+    FlushCheckpoint _flushCheckpoint;
 };
 
 #endif // CHAINMANAGER_HPP
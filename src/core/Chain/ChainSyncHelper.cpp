@@ -11,7 +11,6 @@
 #include <QUrl>
 
 static const QString ORDER = "asc";
-static constexpr const size_t CHAIN_HEADERS_SYNC_LIMIT = 1000;
 static constexpr const size_t BLOCK_TRANSACTIONS_SYNC_LIMIT = 100;
 
 //==============================================================================
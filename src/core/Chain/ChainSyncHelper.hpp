@@ -14,6 +14,9 @@ class AbstractBlockExplorerHttpClient;
 class ChainSyncHelper : public QObject {
     Q_OBJECT
 public:
+    // max headers returned by one getLastHeaders call
+    static constexpr size_t CHAIN_HEADERS_SYNC_LIMIT = 1000;
+
     explicit ChainSyncHelper(QPointer<AbstractBlockExplorerHttpClient> blockExplorerHttpClient,
         CoinAsset asset, QObject* parent = nullptr);
     ~ChainSyncHelper() override;
@@ -10,6 +10,14 @@
 
 //==============================================================================
 
+// how many headers are matched by single job on matching context
+static constexpr size_t BACKGROUND_MATCH_BATCH_SIZE = 500;
+// delivered blocks wait until every block below them is applied, this bounds how many of them
+// (together with requests in flight) are kept in memory, relative to max blocks in flight.
+static constexpr size_t MAX_PENDING_BLOCKS_PER_BLOCK_IN_FLIGHT = 4;
+
+//==============================================================================
+
 static bool IsReorg(std::vector<NetworkUtils::ApiErrorException::ApiError> errors)
 {
     for (auto&& error : errors) {
@@ -56,8 +64,10 @@ void ChainSyncManager::trySync()
 
 void ChainSyncManager::interruptAsync()
 {
-    Utils::ScheduleJob(
-        this, std::bind(&ChainSyncManager::setIsSyncing, std::placeholders::_1, false));
+    Utils::ScheduleJob(this, [](ChainSyncManager* self) {
+        self->resetSyncState();
+        self->setIsSyncing(false);
+    });
     LogCDebug(Sync) << "ChainSyncManager task interrupted";
 }
 
@@ -68,6 +78,28 @@ void ChainSyncManager::interrupt()
     interruptAsync();
 }
 
+//==============================================================================
+
+void ChainSyncManager::setMaxBlocksInFlight(size_t maxBlocksInFlight)
+{
+    _maxBlocksInFlight = std::max<size_t>(1, maxBlocksInFlight);
+}
+
+//==============================================================================
+
+size_t ChainSyncManager::maxBlocksInFlight() const
+{
+    return _maxBlocksInFlight;
+}
+
+//==============================================================================
+
+void ChainSyncManager::setMatchingContext(QObject* context)
+{
+    _matchingContext = context;
+}
+
+
 //==============================================================================
 
 void ChainSyncManager::onHeadersSynced(std::vector<Wire::VerboseBlockHeader> headers)
@@ -78,16 +110,21 @@ void ChainSyncManager::onHeadersSynced(std::vector<Wire::VerboseBlockHeader> hea
     }
 
     if (!headers.empty()) {
+        syncProgress(static_cast<unsigned>(headers.back().height));
         for (auto&& header : headers) {
-            _headersProcessingQueue.push(header);
+            _headersProcessingQueue.emplace_back(std::move(header));
+        }
+
+        if (!_throughputTimer.isValid()) {
+            _throughputTimer.start();
         }
 
-        syncProgress(static_cast<unsigned>(headers.back().height));
         processHeaders();
     } else {
         LogCDebug(Sync) << "Got sequence of headers with unknown prevBlockHash";
         Q_ASSERT(_headersProcessingQueue
                      .empty()); // we should get here only if we don't have any work left
+        updateSyncThroughput(true);
         setIsSyncing(false);
     }
 }
@@ -97,10 +134,7 @@ void ChainSyncManager::onHeadersSynced(std::vector<Wire::VerboseBlockHeader> hea
 void ChainSyncManager::onAPISyncError(QString error)
 {
     LogCCritical(Sync) << "API Sync error" << error;
-    while (!_headersProcessingQueue.empty()) {
-        _headersProcessingQueue.pop();
-    }
-    _pendingBlocks.clear();
+    resetSyncState();
     setIsSyncing(false);
     syncError(error);
 }
@@ -112,8 +146,9 @@ void ChainSyncManager::onStrippedBlockSynced(Wire::StrippedBlock block)
     //    LogCDebug(Sync) << "onStrippedBlockSynced" << block.hash;
 
     auto it = _pendingBlocks.find(block.hash);
-    if (it != std::end(_pendingBlocks)) {
-        it->second = block;
+    if (it != std::end(_pendingBlocks) && !it->second) {
+        --_blocksInFlight;
+        it->second = std::move(block);
         processHeaders();
     }
 }
@@ -137,14 +172,32 @@ void ChainSyncManager::syncBestBlockHash()
 
 //==============================================================================
 
+void ChainSyncManager::resetSyncState()
+{
+    _headersProcessingQueue.clear();
+    _pendingBlocks.clear();
+    _lookaheadIndex = 0;
+    _blocksInFlight = 0;
+    ++_syncSession;
+}
+
+//==============================================================================
+
 void ChainSyncManager::scheduleLastHeaders(QString bestBlockHash)
 {
     setIsSyncing(true);
     _chainDataSource.getBlockHeaders(chain().assetID(), bestBlockHash)
-        .then([this](std::vector<Wire::VerboseBlockHeader> blockHeaders) {
-            onHeadersSynced(blockHeaders);
+        .then([this, session = _syncSession](std::vector<Wire::VerboseBlockHeader> blockHeaders) {
+            if (session == _syncSession) {
+                onHeadersSynced(blockHeaders);
+            }
         })
-        .fail([this, bestBlockHash](NetworkUtils::ApiErrorException& error) {
+        .fail([this, bestBlockHash, session = _syncSession](
+                  NetworkUtils::ApiErrorException& error) {
+            if (session != _syncSession) {
+                return;
+            }
+
             if (IsReorg(error.errors)) {
                 reorg(bestBlockHash);
             } else {
@@ -186,48 +239,35 @@ size_t ChainSyncManager::bestBlockHeight() const
 void ChainSyncManager::processHeaders()
 {
     boost::optional<Wire::VerboseBlockHeader> lastAddedHeader;
+    prefetchMatchedBlocks();
+
     // TODO: Check this code when reorg happens.
     while (!_headersProcessingQueue.empty()) {
-        lastAddedHeader = _headersProcessingQueue.front();
-        QString blockHash = QString::fromStdString(lastAddedHeader->hash);
-        // means we are waiting for stripped block
-        auto index = BlockIndex(lastAddedHeader.get());
-        if (_pendingBlocks.count(blockHash) > 0) {
-            if (auto strippedBlock = _pendingBlocks.at(blockHash)) {
-                std::vector<Transaction> appliedTxns;
-                auto lookupTx = [&appliedTxns](QString txId) {
-                    auto it = std::find_if(
-                        std::begin(appliedTxns), std::end(appliedTxns), [txId](const auto& it) {
-                            return boost::variant2::get<OnChainTxRef>(it)->txId() == txId;
-                        });
-
-                    return it != std::end(appliedTxns) ? boost::variant2::get<OnChainTxRef>(*it)
-                                                       : OnChainTxRef{};
-                };
-
-                for (auto&& ref : strippedBlock->transactions) {
-                    if (auto appliedTransaction
-                        = _walletDataSource.applyTransaction(ref, lookupTx)) {
-                        if (!appliedTransaction->outputs().empty()) {
-                            _cachedMatcher.reset();
-                        }
+        auto& entry = _headersProcessingQueue.front();
+        if (!isChecked(entry) && _matchingInFlight) {
+            // we will get back here once background matching is done
+            break;
+        }
 
-                        appliedTxns.emplace_back(appliedTransaction);
-                    }
-                }
-                txCache().addTransactionsSync(appliedTxns);
-            } else {
-                // means it wasn't delivered, since we do everything in order. We need to come here
-                // later.
-                return;
+        if (checkMatched(entry)) {
+            auto it = _pendingBlocks.find(QString::fromStdString(entry.header.hash));
+            if (it == std::end(_pendingBlocks) || !it->second) {
+                // means it wasn't delivered yet, transactions have to be applied strictly in
+                // height order, we will come here later.
+                break;
             }
-        } else if (filterMatcher().match(index)) {
-            // if we found a matched block, we wait for processing and return here later
-            scheduleStrippedBlock(index.hash(), index.height());
-            return;
+
+            applyStrippedBlock(*it->second);
+            _pendingBlocks.erase(it);
         }
 
-        _headersProcessingQueue.pop();
+        lastAddedHeader = std::move(entry.header);
+        _headersProcessingQueue.pop_front();
+        if (_lookaheadIndex > 0) {
+            --_lookaheadIndex;
+        }
+
+        ++_processedSinceReport;
         auto lastHeadersHeight = lastAddedHeader->height;
         if (chain().getHeight() < lastHeadersHeight) {
             chain().connectTip(*lastAddedHeader);
@@ -236,8 +276,12 @@ void ChainSyncManager::processHeaders()
                 setBestBlockHeight(lastHeadersHeight);
             }
         }
+
+        prefetchMatchedBlocks();
     }
 
+    updateSyncThroughput(false);
+
     if (_headersProcessingQueue.empty() && lastAddedHeader) {
         scheduleLastHeaders(QString::fromStdString(lastAddedHeader->hash));
     }
@@ -245,6 +289,248 @@ void ChainSyncManager::processHeaders()
 
 //==============================================================================
 
+void ChainSyncManager::prefetchMatchedBlocks()
+{
+    scheduleBackgroundMatching();
+
+    const auto maxPendingBlocks = _maxBlocksInFlight * MAX_PENDING_BLOCKS_PER_BLOCK_IN_FLIGHT;
+    while (_lookaheadIndex < _headersProcessingQueue.size()
+        && _blocksInFlight < _maxBlocksInFlight && _pendingBlocks.size() < maxPendingBlocks) {
+        auto& entry = _headersProcessingQueue[_lookaheadIndex];
+        if (!isChecked(entry) && _matchingInFlight) {
+            break;
+        }
+
+        checkMatched(entry);
+        ++_lookaheadIndex;
+    }
+}
+
+//==============================================================================
+
+void ChainSyncManager::scheduleBackgroundMatching()
+{
+    if (!_matchingContext || _matchingInFlight) {
+        return;
+    }
+
+    std::vector<BlockHash> hashes;
+    std::vector<BlockIndex> indexes;
+    for (auto&& entry : _headersProcessingQueue) {
+        if (!isChecked(entry)) {
+            hashes.emplace_back(QString::fromStdString(entry.header.hash));
+            indexes.emplace_back(entry.header);
+            if (indexes.size() == BACKGROUND_MATCH_BATCH_SIZE) {
+                break;
+            }
+        }
+    }
+
+    if (indexes.empty()) {
+        return;
+    }
+
+    auto matcher = matcherSnapshot();
+    if (!matcher) {
+        // matcher can't be used from other thread, headers will be matched inline
+        return;
+    }
+
+    _matchingInFlight = true;
+    QPointer<ChainSyncManager> self(this);
+    Promise<std::vector<size_t>>(
+        [context = _matchingContext, matcher, indexes](const auto& resolve, const auto& reject) {
+            QMetaObject::invokeMethod(context, [=] {
+                try {
+                    resolve(matcher->matchBatch(indexes));
+                } catch (std::exception& ex) {
+                    LogCWarning(Sync) << "Background matching failed:" << ex.what();
+                    reject(std::current_exception());
+                }
+            });
+        })
+        .then([self, generation = _matcherGeneration, hashes](std::vector<size_t> matched) {
+            if (self) {
+                self->onBackgroundMatched(generation, hashes, matched);
+            }
+        })
+        .fail([self] {
+            if (self) {
+                self->onBackgroundMatchingFailed();
+            }
+        });
+}
+
+//==============================================================================
+
+void ChainSyncManager::onBackgroundMatchingFailed()
+{
+    _matchingInFlight = false;
+    // matching context is not used anymore, rest of headers will be matched inline
+    _matchingContext = nullptr;
+
+    if (isSyncing()) {
+        processHeaders();
+    }
+}
+
+//==============================================================================
+
+void ChainSyncManager::onBackgroundMatched(
+    size_t generation, std::vector<BlockHash> hashes, std::vector<size_t> matched)
+{
+    _matchingInFlight = false;
+
+    // sync was stopped or failed while batch was matched, queue is already gone
+    if (!isSyncing()) {
+        return;
+    }
+
+    // results of outdated matcher are dropped, headers will be scheduled again
+    if (generation == _matcherGeneration) {
+        std::map<BlockHash, bool> results;
+        for (auto&& hash : hashes) {
+            results.emplace(hash, false);
+        }
+
+        for (auto position : matched) {
+            results[hashes.at(position)] = true;
+        }
+
+        for (auto&& entry : _headersProcessingQueue) {
+            if (isChecked(entry)) {
+                continue;
+            }
+
+            auto it = results.find(QString::fromStdString(entry.header.hash));
+            if (it != std::end(results)) {
+                entry.matcherGeneration = generation;
+                entry.matched = it->second;
+            }
+        }
+    }
+
+    processHeaders();
+}
+
+//==============================================================================
+
+std::shared_ptr<const BlockFilterMatcher> ChainSyncManager::matcherSnapshot()
+{
+    if (_matcherSnapshotGeneration != _matcherGeneration) {
+        _matcherSnapshot = filterMatcher().clone();
+        _matcherSnapshotGeneration = _matcherGeneration;
+    }
+
+    return _matcherSnapshot;
+}
+
+//==============================================================================
+
+bool ChainSyncManager::isChecked(const QueuedHeader& entry) const
+{
+    // once matched block stays matched, matcher can only grow when new addresses are generated,
+    // headers which didn't match with previous matcher need to be rechecked.
+    return entry.matched || entry.matcherGeneration == _matcherGeneration;
+}
+
+//==============================================================================
+
+bool ChainSyncManager::checkMatched(QueuedHeader& entry)
+{
+    if (!isChecked(entry)) {
+        entry.matcherGeneration = _matcherGeneration;
+        entry.matched = filterMatcher().match(BlockIndex(entry.header));
+    }
+
+    if (entry.matched && !entry.requested) {
+        entry.requested = true;
+        ++_matchedSinceReport;
+        scheduleStrippedBlock(QString::fromStdString(entry.header.hash), entry.header.height);
+    }
+
+    return entry.matched;
+}
+
+//==============================================================================
+
+void ChainSyncManager::applyStrippedBlock(const Wire::StrippedBlock& strippedBlock)
+{
+    std::vector<Transaction> appliedTxns;
+    auto lookupTx = [&appliedTxns](QString txId) {
+        auto it = std::find_if(
+            std::begin(appliedTxns), std::end(appliedTxns), [txId](const auto& it) {
+                return boost::variant2::get<OnChainTxRef>(it)->txId() == txId;
+            });
+
+        return it != std::end(appliedTxns) ? boost::variant2::get<OnChainTxRef>(*it)
+                                           : OnChainTxRef{};
+    };
+
+    for (auto&& ref : strippedBlock.transactions) {
+        if (auto appliedTransaction = _walletDataSource.applyTransaction(ref, lookupTx)) {
+            if (!appliedTransaction->outputs().empty()) {
+                invalidateMatcher();
+            }
+
+            appliedTxns.emplace_back(appliedTransaction);
+        }
+    }
+    txCache().addTransactionsSync(appliedTxns);
+}
+
+//==============================================================================
+
+void ChainSyncManager::invalidateMatcher()
+{
+    if (!_cachedMatcher) {
+        return;
+    }
+
+    switch (_cachedMatcher->refresh()) {
+    case BlockFilterMatcher::RefreshResult::Unchanged:
+        return;
+    case BlockFilterMatcher::RefreshResult::Updated:
+        break;
+    case BlockFilterMatcher::RefreshResult::Unsupported:
+        _cachedMatcher.reset();
+        break;
+    }
+
+    ++_matcherGeneration;
+    // headers that were looked ahead have to be checked with new matcher
+    _lookaheadIndex = 0;
+}
+
+//==============================================================================
+
+void ChainSyncManager::updateSyncThroughput(bool force)
+{
+    static const qint64 REPORT_INTERVAL_MS = 5000;
+
+    if (!_throughputTimer.isValid()) {
+        return;
+    }
+
+    auto elapsed = _throughputTimer.elapsed();
+    if (elapsed == 0 || (!force && elapsed < REPORT_INTERVAL_MS)) {
+        return;
+    }
+
+    auto seconds = static_cast<double>(elapsed) / 1000.0;
+    LogCDebug(Sync) << "Sync throughput" << coinAsset().name()
+                    << "blocks/s:" << _processedSinceReport / seconds
+                    << "matched blocks/s:" << _matchedSinceReport / seconds
+                    << "in flight:" << _blocksInFlight << "/" << _maxBlocksInFlight
+                    << "pending:" << _pendingBlocks.size();
+
+    _processedSinceReport = 0;
+    _matchedSinceReport = 0;
+    _throughputTimer.restart();
+}
+
+//==============================================================================
+
 void ChainSyncManager::reorg(BlockHash reorgHash)
 {
     LogCCInfo(Sync) << "Reorg detected at block:" << reorgHash << chain().getHeight();
@@ -352,11 +638,24 @@ auto ChainSyncManager::findForkBlock(BlockHash startSearchHash, size_t reorgHeig
 
 void ChainSyncManager::scheduleStrippedBlock(BlockHash blockHash, int64_t blockHeight)
 {
-    _pendingBlocks.emplace(blockHash, boost::none);
+    if (!_pendingBlocks.emplace(blockHash, boost::none).second) {
+        return;
+    }
+
+    ++_blocksInFlight;
     _chainDataSource.getLightWalletBlock(coinAsset().coinID(), blockHash, blockHeight)
-        .then([=](Wire::StrippedBlock block) { onStrippedBlockSynced(block); })
-        .fail([this](
-                  NetworkUtils::ApiErrorException& error) { onAPISyncError(error.errorResponse); });
+        .then([this, session = _syncSession](Wire::StrippedBlock block) {
+            if (session == _syncSession) {
+                onStrippedBlockSynced(block);
+            }
+        })
+        .fail([this, blockHash, session = _syncSession](
+                  NetworkUtils::ApiErrorException& error) {
+            // several requests can be in flight, report only the first failure
+            if (session == _syncSession && _pendingBlocks.count(blockHash) > 0) {
+                onAPISyncError(error.errorResponse);
+            }
+        });
 }
 
 //==============================================================================
@@ -389,7 +688,10 @@ void RescanSyncManager::trySync()
 
 void RescanSyncManager::interruptAsync()
 {
-    setIsSyncing(false);
+    Utils::ScheduleJob(this, [](RescanSyncManager* self) {
+        self->resetSyncState();
+        self->setIsSyncing(false);
+    });
     LogCDebug(Sync) << "RescanSyncManager task interrupted";
 }
 
@@ -1,9 +1,11 @@
 #ifndef CHAINSYNCMANAGER_HPP
 #define CHAINSYNCMANAGER_HPP
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QPointer>
 #include <QQueue>
+#include <deque>
 #include <memory>
 #include <queue>
 #include <stack>
@@ -24,6 +26,8 @@ struct BlockIndex;
 class ChainSyncManager : public AbstractChainSyncManager {
     Q_OBJECT
 public:
+    static constexpr size_t DEFAULT_MAX_BLOCKS_IN_FLIGHT = 8;
+
     explicit ChainSyncManager(Chain& chain, AssetsTransactionsCache& transactionsCache,
         WalletDataSource& walletDataSource, const BlockFilterMatchable& blockFilterMatcher,
         CoinAsset asset, AbstractChainDataSource& chainDataSource, QObject* parent = nullptr);
@@ -34,6 +38,11 @@ public:
     void interruptAsync() override;
     void interrupt() override;
 
+    void setMaxBlocksInFlight(size_t maxBlocksInFlight);
+    size_t maxBlocksInFlight() const;
+    // filter matching is posted to context(usually per asset worker), inline if nullptr
+    void setMatchingContext(QObject* context);
+
 protected:
     void scheduleStrippedBlock(BlockHash blockHash, int64_t blockHeight);
     void scheduleLastHeaders(QString bestBlockHash);
@@ -41,6 +50,8 @@ protected:
 
     void setBestBlockHeight(size_t bestBlockHeight);
     size_t bestBlockHeight() const;
+    // drops queued headers and blocks, replies to requests that are in flight are ignored
+    void resetSyncState();
 
 private slots:
     void onHeadersSynced(std::vector<Wire::VerboseBlockHeader> headers);
@@ -50,6 +61,15 @@ private slots:
 private:
     void syncBestBlockHash();
     void processHeaders();
+    void prefetchMatchedBlocks();
+    void scheduleBackgroundMatching();
+    void onBackgroundMatched(
+        size_t generation, std::vector<BlockHash> hashes, std::vector<size_t> matched);
+    void onBackgroundMatchingFailed();
+    std::shared_ptr<const BlockFilterMatcher> matcherSnapshot();
+    void applyStrippedBlock(const Wire::StrippedBlock& block);
+    void invalidateMatcher();
+    void updateSyncThroughput(bool force);
     void reorg(BlockHash reorgHash);
     using ForkBlock = std::tuple<BlockHash, size_t, std::vector<Wire::VerboseBlockHeader>>;
     Promise<ForkBlock> findForkBlock(BlockHash localBestBlock, size_t reorgHeight,
@@ -64,7 +84,40 @@ protected:
     size_t _bestBlockHeight{ 0 };
 
 private:
-    std::queue<Wire::VerboseBlockHeader> _headersProcessingQueue;
+    struct QueuedHeader {
+        explicit QueuedHeader(Wire::VerboseBlockHeader headerIn)
+            : header(std::move(headerIn))
+        {
+        }
+
+        Wire::VerboseBlockHeader header;
+        // generation of matcher which was used to check this header, 0 if not checked yet
+        size_t matcherGeneration{ 0 };
+        bool matched{ false };
+        bool requested{ false };
+    };
+
+    bool isChecked(const QueuedHeader& entry) const;
+    bool checkMatched(QueuedHeader& entry);
+
+    std::deque<QueuedHeader> _headersProcessingQueue;
+    // every header before this index was already checked against current matcher
+    size_t _lookaheadIndex{ 0 };
+    size_t _matcherGeneration{ 1 };
+    size_t _blocksInFlight{ 0 };
+    size_t _maxBlocksInFlight{ DEFAULT_MAX_BLOCKS_IN_FLIGHT };
+    // bumped when sync state is dropped, replies of requests from older session are ignored
+    size_t _syncSession{ 0 };
+
+    QObject* _matchingContext{ nullptr };
+    // copy of current matcher, shared with matching jobs that are in flight
+    std::shared_ptr<const BlockFilterMatcher> _matcherSnapshot;
+    size_t _matcherSnapshotGeneration{ 0 };
+    bool _matchingInFlight{ false };
+
+    QElapsedTimer _throughputTimer;
+    size_t _processedSinceReport{ 0 };
+    size_t _matchedSinceReport{ 0 };
     //    WalletDataSource &_walletDataSource;
     //    BFMatcherUniqueRef _cachedMatcher;
 };
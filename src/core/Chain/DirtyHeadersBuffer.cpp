@@ -0,0 +1,157 @@
+#include "DirtyHeadersBuffer.hpp"
+
+#include <algorithm>
+
+//==============================================================================
+
+static size_t HeaderBytes(const Wire::PackedBlockHeader& header)
+{
+    return sizeof(header) + header.filter.bytes().size();
+}
+
+//==============================================================================
+
+static size_t NextPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+//==============================================================================
+
+DirtyHeadersBuffer::DirtyHeadersBuffer(size_t capacity)
+    : _slots(NextPowerOfTwo(std::max<size_t>(capacity, 1)))
+{
+}
+
+//==============================================================================
+
+void DirtyHeadersBuffer::push(Header header)
+{
+    const size_t height = header.height;
+    if (_size > 0 && (height < _firstHeight || height > tipHeight() + 1)) {
+        // doesn't connect to buffered headers, owner has flushed them or they are stale.
+        clear();
+    }
+
+    if (_size == 0) {
+        _firstHeight = height;
+    } else if (height <= tipHeight()) {
+        truncate(height);
+    }
+
+    reserve(_size + 1);
+    _bytes += HeaderBytes(header);
+    _heightByHash[header.hash] = height;
+    slot(height) = std::move(header);
+    ++_size;
+}
+
+//==============================================================================
+
+auto DirtyHeadersBuffer::headerAt(size_t height) const -> const Header*
+{
+    if (_size == 0 || height < _firstHeight || height > tipHeight()) {
+        return nullptr;
+    }
+
+    return &slot(height);
+}
+
+//==============================================================================
+
+boost::optional<size_t> DirtyHeadersBuffer::heightOf(const bitcoin::uint256& hash) const
+{
+    auto it = _heightByHash.find(hash);
+    return it != _heightByHash.end() ? boost::make_optional(it->second) : boost::none;
+}
+
+//==============================================================================
+
+void DirtyHeadersBuffer::clear()
+{
+    _size = 0;
+    _bytes = 0;
+    _heightByHash.clear();
+}
+
+//==============================================================================
+
+bool DirtyHeadersBuffer::empty() const
+{
+    return _size == 0;
+}
+
+//==============================================================================
+
+size_t DirtyHeadersBuffer::size() const
+{
+    return _size;
+}
+
+//==============================================================================
+
+size_t DirtyHeadersBuffer::bytes() const
+{
+    return _bytes;
+}
+
+//==============================================================================
+
+size_t DirtyHeadersBuffer::firstHeight() const
+{
+    return _firstHeight;
+}
+
+//==============================================================================
+
+size_t DirtyHeadersBuffer::tipHeight() const
+{
+    return _size > 0 ? _firstHeight + _size - 1 : 0;
+}
+
+//==============================================================================
+
+auto DirtyHeadersBuffer::slot(size_t height) -> Header&
+{
+    return _slots[height & (_slots.size() - 1)];
+}
+
+//==============================================================================
+
+auto DirtyHeadersBuffer::slot(size_t height) const -> const Header&
+{
+    return _slots[height & (_slots.size() - 1)];
+}
+
+//==============================================================================
+
+void DirtyHeadersBuffer::reserve(size_t count)
+{
+    if (count <= _slots.size()) {
+        return;
+    }
+
+    std::vector<Header> slots(NextPowerOfTwo(count));
+    for (size_t height = _firstHeight; height < _firstHeight + _size; ++height) {
+        slots[height & (slots.size() - 1)] = std::move(slot(height));
+    }
+    _slots.swap(slots);
+}
+
+//==============================================================================
+
+void DirtyHeadersBuffer::truncate(size_t height)
+{
+    while (_size > 0 && tipHeight() >= height) {
+        const auto& header = slot(tipHeight());
+        _bytes -= HeaderBytes(header);
+        _heightByHash.erase(header.hash);
+        --_size;
+    }
+}
+
+//==============================================================================
@@ -0,0 +1,57 @@
+#ifndef DIRTYHEADERSBUFFER_HPP
+#define DIRTYHEADERSBUFFER_HPP
+
+#include <Chain/BlockHeader.hpp>
+#include <boost/optional.hpp>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \brief The DirtyHeadersBuffer class keeps headers which weren't flushed to disk yet. Headers
+ * are kept packed in ring buffer where slot is selected by height, so lookups by height are O(1)
+ * and storage is reused between flushes. Pushing header at height which is already buffered drops
+ * it and everything above, that's how reorgs look like from chain side.
+ */
+class DirtyHeadersBuffer {
+public:
+    using Header = Wire::PackedBlockHeader;
+
+    explicit DirtyHeadersBuffer(size_t capacity = 1024);
+
+    // header which doesn't connect to buffered ones restarts buffer, owner has to flush buffered
+    // headers before pushing header above tip.
+    void push(Header header);
+    const Header* headerAt(size_t height) const;
+    boost::optional<size_t> heightOf(const bitcoin::uint256& hash) const;
+    void clear();
+
+    bool empty() const;
+    size_t size() const;
+    // approximate memory used by buffered headers
+    size_t bytes() const;
+    size_t firstHeight() const;
+    size_t tipHeight() const;
+
+    // visits buffered headers ordered by height
+    template <class F> void forEach(F&& func) const
+    {
+        for (size_t height = _firstHeight; height < _firstHeight + _size; ++height) {
+            func(slot(height));
+        }
+    }
+
+private:
+    Header& slot(size_t height);
+    const Header& slot(size_t height) const;
+    void reserve(size_t count);
+    void truncate(size_t height);
+
+private:
+    std::vector<Header> _slots;
+    size_t _firstHeight{ 0 };
+    size_t _size{ 0 };
+    size_t _bytes{ 0 };
+    std::unordered_map<bitcoin::uint256, size_t, Wire::Uint256Hasher> _heightByHash;
+};
+
+#endif // DIRTYHEADERSBUFFER_HPP
@@ -0,0 +1,133 @@
+#include "HeadersCache.hpp"
+
+//==============================================================================
+
+static size_t HeaderBytes(const Wire::PackedBlockHeader& header)
+{
+    // list node and index entry on top of header itself
+    static const size_t overhead = 4 * sizeof(void*) + sizeof(bitcoin::uint256);
+    return sizeof(header) + overhead + header.filter.bytes().size();
+}
+
+//==============================================================================
+
+static const size_t DEMOTED_ENTRY_BYTES = 4 * sizeof(void*);
+
+//==============================================================================
+
+HeadersCache::HeadersCache(size_t maxBytes, OnDemoted onDemoted)
+    : _maxBytes(maxBytes)
+    , _onDemoted(std::move(onDemoted))
+{
+}
+
+//==============================================================================
+
+boost::optional<HeadersCache::Header> HeadersCache::get(const bitcoin::uint256& hash)
+{
+    auto it = _index.find(hash);
+    if (it == _index.end()) {
+        return boost::none;
+    }
+
+    ++_stats.hits;
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return *it->second;
+}
+
+//==============================================================================
+
+boost::optional<uint32_t> HeadersCache::demotedHeight(const bitcoin::uint256& hash) const
+{
+    auto it = _demoted.find(hash.GetCheapHash());
+    if (it != _demoted.end()) {
+        return it->second;
+    }
+
+    return boost::none;
+}
+
+//==============================================================================
+
+void HeadersCache::insert(Header header)
+{
+    auto it = _index.find(header.hash);
+    if (it != _index.end()) {
+        _bytes -= HeaderBytes(*it->second);
+        _entries.erase(it->second);
+        _index.erase(it);
+    }
+
+    _bytes += HeaderBytes(header);
+    _entries.emplace_front(std::move(header));
+    _index.emplace(_entries.front().hash, _entries.begin());
+
+    while (_bytes > _maxBytes && _entries.size() > 1) {
+        evict();
+    }
+}
+
+//==============================================================================
+
+void HeadersCache::remember(const bitcoin::uint256& hash, uint32_t height)
+{
+    _demoted[hash.GetCheapHash()] = height;
+}
+
+//==============================================================================
+
+void HeadersCache::clear()
+{
+    _entries.clear();
+    _index.clear();
+    _demoted.clear();
+    _bytes = 0;
+}
+
+//==============================================================================
+
+void HeadersCache::clearDemoted()
+{
+    _demoted.clear();
+}
+
+//==============================================================================
+
+void HeadersCache::countDiskHit()
+{
+    ++_stats.diskHits;
+}
+
+//==============================================================================
+
+void HeadersCache::countMiss()
+{
+    ++_stats.misses;
+}
+
+//==============================================================================
+
+HeadersCacheStats HeadersCache::stats() const
+{
+    auto result = _stats;
+    result.entries = _entries.size() + _demoted.size();
+    result.bytes = _bytes + _demoted.size() * DEMOTED_ENTRY_BYTES;
+    return result;
+}
+
+//==============================================================================
+
+void HeadersCache::evict()
+{
+    const auto& header = _entries.back();
+    if (_onDemoted) {
+        _onDemoted(header);
+    }
+    _demoted[header.hash.GetCheapHash()] = header.height;
+    _bytes -= HeaderBytes(header);
+    _index.erase(header.hash);
+    _entries.pop_back();
+    ++_stats.evictions;
+}
+
+//==============================================================================
@@ -0,0 +1,63 @@
+#ifndef HEADERSCACHE_HPP
+#define HEADERSCACHE_HPP
+
+#include <Chain/BlockHeader.hpp>
+#include <boost/optional.hpp>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+struct HeadersCacheStats {
+    uint64_t hits{ 0 };
+    uint64_t diskHits{ 0 };
+    uint64_t misses{ 0 };
+    uint64_t evictions{ 0 };
+    size_t entries{ 0 };
+    size_t bytes{ 0 };
+};
+
+/*!
+ * \brief The HeadersCache class is two tier header cache of one asset. First tier is LRU of packed
+ * headers limited by bytes, not by count. Headers evicted from it are demoted to second tier which
+ * remembers only hash -> height, body can be read back by height from chain index database or from
+ * wherever onDemoted has stored it.
+ */
+class HeadersCache {
+public:
+    using Header = Wire::PackedBlockHeader;
+
+    using OnDemoted = std::function<void(const Header&)>;
+
+    explicit HeadersCache(size_t maxBytes, OnDemoted onDemoted = {});
+
+    // looks up first tier, counts hit or nothing, caller reports outcome of second tier.
+    boost::optional<Header> get(const bitcoin::uint256& hash);
+    boost::optional<uint32_t> demotedHeight(const bitcoin::uint256& hash) const;
+    void insert(Header header);
+    // indexes header which is stored in chain index database without keeping it in memory.
+    void remember(const bitcoin::uint256& hash, uint32_t height);
+    void clear();
+    // forgets demoted headers only, first tier is kept.
+    void clearDemoted();
+
+    void countDiskHit();
+    void countMiss();
+
+    HeadersCacheStats stats() const;
+
+private:
+    void evict();
+
+private:
+    using Entries = std::list<Header>;
+    size_t _maxBytes{ 0 };
+    OnDemoted _onDemoted;
+    size_t _bytes{ 0 };
+    Entries _entries; // most recently used first
+    std::unordered_map<bitcoin::uint256, Entries::iterator, Wire::Uint256Hasher> _index;
+    // cheap hash is enough, height is confirmed against full hash when header is read back.
+    std::unordered_map<uint64_t, uint32_t> _demoted;
+    HeadersCacheStats _stats;
+};
+
+#endif // HEADERSCACHE_HPP
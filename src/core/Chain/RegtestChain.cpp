@@ -761,6 +761,23 @@ Promise<Wire::TxConfrimation> RegtestDataSource::getSpendingDetails(
 
 //==============================================================================
 
+void RegtestDataSource::subscribeTips(AssetID assetID)
+{
+    QMetaObject::invokeMethod(this, [=] {
+        if (!_tipSubscriptions.insert(assetID).second) {
+            return;
+        }
+
+        connect(&chain(assetID), &RegtestChain::tipConnected, this,
+            [this, assetID](BlockHash hash, int height) {
+                tipNotified(assetID, hash, static_cast<BlockHeight>(height));
+            });
+        tipStreamStateChanged(assetID, true);
+    });
+}
+
+//==============================================================================
+
 Promise<void> RegtestChainManager::loadFromBootstrap(QString bootstrapFile)
 {
     return QtPromise::resolve();
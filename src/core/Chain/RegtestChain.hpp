@@ -113,6 +113,7 @@ public:
     Promise<int64_t> estimateNetworkFee(AssetID assetID, uint64_t blocks) const override;
     Promise<Wire::TxConfrimation> getSpendingDetails(
         AssetID assetID, Wire::OutPoint outpoint) const override;
+    void subscribeTips(AssetID assetID) override;
 
     RegtestChain& chain(AssetID assetID) const;
 
@@ -130,6 +131,7 @@ private:
     const WalletAssetsModel& _assetsModel;
     std::map<AssetID, RegtestChain*> _chains;
     std::map<AssetID, Wire::MsgBlock> _disconnectedBlocks;
+    std::set<AssetID> _tipSubscriptions;
 };
 
 //==============================================================================
@@ -2,9 +2,12 @@
 #include <Tools/DBUtils.hpp>
 #include <Utils/GenericProtoDatabase.hpp>
 #include <Utils/Logging.hpp>
+#include <Utils/Utils.hpp>
 #include <txdb.h>
 
 #include <QDir>
+#include <QTimer>
+#include <algorithm>
 #include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext.hpp>
@@ -16,13 +19,80 @@ using namespace boost::adaptors;
 //==============================================================================
 
 static const std::string DB_TRANSACTIONS_INDEX{ "transactions_cache" };
+// (asset id, tx key) -> tx date, only this index is read at startup
+static const std::string DB_TRANSACTIONS_SUMMARY_INDEX{ "transactions_summary" };
+static const std::string DB_TRANSACTIONS_SUMMARY_VERSION{ "transactions_summary_version" };
+static constexpr int32_t TRANSACTIONS_SUMMARY_VERSION = 1;
+// rows of recently paged transactions which are kept while asset's history isn't loaded
+static constexpr size_t PAGE_ROWS_CACHE_SIZE = 500;
 
 //==============================================================================
 
-AssetTransactionsCacheImpl::AssetTransactionsCacheImpl(SaveTxns onSaveTx, QObject* parent)
+static std::string TransactionKey(const Transaction& tx)
+{
+    struct Visitor {
+        std::string operator()(const OnChainTxRef& tx) const { return tx->tx().id(); }
+        std::string operator()(const LightningInvoiceRef& tx) const
+        {
+            return std::string("i_") + std::to_string(tx->addIndex());
+        }
+        std::string operator()(const LightningPaymentRef& tx) const
+        {
+            return std::string("p_") + std::to_string(tx->paymentIndex());
+        }
+        std::string operator()(const EthOnChainTxRef& tx) const { return tx->tx().id(); }
+        std::string operator()(const ConnextPaymentRef& tx) const
+        {
+            return std::string("cp_") + tx->transferId().toStdString();
+        }
+    };
+
+    return boost::variant2::visit(Visitor{}, tx);
+}
+
+//==============================================================================
+
+static int64_t TransactionDateMs(const Transaction& tx)
+{
+    return TransactionUtils::TransactionDate(tx).toMSecsSinceEpoch();
+}
+
+//==============================================================================
+
+static boost::optional<Transaction> ParseTransaction(
+    const std::vector<unsigned char>& serialization)
+{
+    chain::Transaction tx;
+    if (!tx.ParseFromArray(serialization.data(), static_cast<int>(serialization.size()))) {
+        return boost::none;
+    }
+
+    switch (tx.transaction_case()) {
+    case chain::Transaction::kOnchainTx:
+        return Transaction{ std::make_shared<OnChainTx>(tx) };
+    case chain::Transaction::kLightningPayment:
+        return Transaction{ std::make_shared<LightningPayment>(tx) };
+    case chain::Transaction::kLightningInvoice:
+        return Transaction{ std::make_shared<LightningInvoice>(tx) };
+    case chain::Transaction::kEthonchainTx:
+        return Transaction{ std::make_shared<EthOnChainTx>(tx) };
+    case chain::Transaction::kConnextPayment:
+        return Transaction{ std::make_shared<ConnextPayment>(tx) };
+    default:
+        return boost::none;
+    }
+}
+
+//==============================================================================
+
+AssetTransactionsCacheImpl::AssetTransactionsCacheImpl(
+    SaveTxns onSaveTx, LoadTxns onLoadTxns, LoadAllTxns onLoadAllTxns, QObject* parent)
     : AbstractTransactionsCache(parent)
     , _executionContext(parent)
+    , _pageRows(PAGE_ROWS_CACHE_SIZE)
     , _onSaveTx(onSaveTx)
+    , _onLoadTxns(onLoadTxns)
+    , _onLoadAllTxns(onLoadAllTxns)
 {
 }
 
@@ -45,6 +115,7 @@ Promise<TransactionsList> AssetTransactionsCacheImpl::transactionsList() const
 {
     return Promise<TransactionsList>([this](const auto& resolver, const auto&) {
         QMetaObject::invokeMethod(_executionContext, [=] {
+            this->ensureLoaded();
             TransactionsList allTransactions;
             allTransactions.reserve(_onChainTransactions.size() + _lnPayments.size()
                 + _lnInvoices.size() + _ethOnChainTransactions.size() + _connextPayments.size());
@@ -67,6 +138,78 @@ Promise<TransactionsList> AssetTransactionsCacheImpl::transactionsList() const
 
 //==============================================================================
 
+Promise<TransactionsPage> AssetTransactionsCacheImpl::transactionsPage(
+    size_t offset, size_t count) const
+{
+    return Promise<TransactionsPage>([=](const auto& resolver, const auto&) {
+        QMetaObject::invokeMethod(
+            _executionContext, [=] { resolver(this->makePage(offset, count)); });
+    });
+}
+
+//==============================================================================
+
+TransactionsPage AssetTransactionsCacheImpl::makePage(size_t offset, size_t count) const
+{
+    if (_newestFirstDirty) {
+        _newestFirst.clear();
+        _newestFirst.reserve(_summary.size());
+        for (auto&& it : _summary) {
+            _newestFirst.emplace_back(it.second, &it.first);
+        }
+
+        std::sort(std::begin(_newestFirst), std::end(_newestFirst),
+            [](const auto& lhs, const auto& rhs) {
+                return lhs.first == rhs.first ? *lhs.second < *rhs.second : lhs.first > rhs.first;
+            });
+        _newestFirstDirty = false;
+    }
+
+    TransactionsPage page;
+    page.offset = offset;
+    page.total = _newestFirst.size();
+    if (offset >= _newestFirst.size()) {
+        return page;
+    }
+
+    const auto last = std::min(_newestFirst.size(), offset + count);
+    std::unordered_map<std::string, Transaction> rows;
+    std::vector<std::string> missing;
+    for (auto i = offset; i < last; ++i) {
+        const auto& key = *_newestFirst[i].second;
+        if (_loaded) {
+            auto it = _byKey.find(key);
+            if (it != std::end(_byKey)) {
+                rows.emplace(key, it->second);
+            }
+        } else if (auto tx = _pageRows.get(key)) {
+            rows.emplace(key, *tx);
+        } else {
+            missing.emplace_back(key);
+        }
+    }
+
+    if (!missing.empty()) {
+        for (auto&& tx : _onLoadTxns(missing)) {
+            auto key = TransactionKey(tx);
+            _pageRows.insert(key, tx);
+            rows.emplace(key, tx);
+        }
+    }
+
+    page.transactions.reserve(last - offset);
+    for (auto i = offset; i < last; ++i) {
+        auto it = rows.find(*_newestFirst[i].second);
+        if (it != std::end(rows)) {
+            page.transactions.emplace_back(it->second);
+        }
+    }
+
+    return page;
+}
+
+//==============================================================================
+
 Promise<std::vector<QString>> AssetTransactionsCacheImpl::transactionsInBlock(
     BlockHash blockHash) const
 {
@@ -82,6 +225,7 @@ std::vector<QString> AssetTransactionsCacheImpl::transactionsInBlockSync(BlockHa
 {
     Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
         "Calling sync method from different thread");
+    ensureLoaded();
 
     std::vector<QString> result;
     if (_blockTransactionsIndex.count(blockHash) > 0) {
@@ -118,6 +262,7 @@ void AssetTransactionsCacheImpl::addTransactionsSync(std::vector<Transaction> tr
         return;
     }
 
+    ensureLoaded();
     _onSaveTx(transactions);
 
     struct Visitor {
@@ -130,18 +275,16 @@ void AssetTransactionsCacheImpl::addTransactionsSync(std::vector<Transaction> tr
             tx->invalidateLocalCache(std::bind(
                 &AssetTransactionsCacheImpl::getOutpointHelper, self, std::placeholders::_1));
 
-            auto it = std::find_if(std::begin(self->_onChainTransactions),
-                std::end(self->_onChainTransactions),
-                [id = tx->txId()](const auto& ref) { return id == ref->txId(); });
+            auto existing = self->findOnChainTx(tx->txId());
 
             self->maintainBlockTxIndex(*tx);
 
-            if (it != std::end(self->_onChainTransactions)) {
-                *(*it) = *tx;
-                onChainTxns.at(0).emplace_back(*it);
+            if (existing) {
+                *existing = *tx;
+                onChainTxns.at(0).emplace_back(existing);
                 txns.at(0).emplace_back(tx);
             } else {
-                self->_onChainTransactions.emplace_back(tx);
+                self->appendOnChainTx(tx);
                 onChainTxns.at(1).emplace_back(tx);
                 txns.at(1).emplace_back(tx);
             }
@@ -210,7 +353,6 @@ void AssetTransactionsCacheImpl::addTransactionsSync(std::vector<Transaction> tr
 
         void postProcess()
         {
-
             auto process = [](const auto& txns, auto onChanged, auto onAdded) {
                 if (!txns.at(0).empty()) {
                     onChanged(txns.at(0));
@@ -252,6 +394,7 @@ void AssetTransactionsCacheImpl::addTransactionsSync(std::vector<Transaction> tr
 
     for (const auto& tx : transactions) {
         boost::variant2::visit(visitor, tx);
+        updateSummary(tx);
     }
 
     visitor.postProcess();
@@ -263,7 +406,8 @@ Promise<OnChainTxRef> AssetTransactionsCacheImpl::transactionById(QString txId)
 {
     return Promise<OnChainTxRef>([=](const auto& resolver, const auto& reject) {
         QMetaObject::invokeMethod(_executionContext, [=] {
-            auto tx = TransactionUtils::FindTransaction(_onChainTransactions, txId);
+            this->ensureLoaded();
+            auto tx = this->findOnChainTx(txId);
             tx ? resolver(tx) : reject(nullptr);
         });
     });
@@ -275,7 +419,8 @@ OnChainTxRef AssetTransactionsCacheImpl::transactionByIdSync(QString txId) const
 {
     Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
         "Calling sync method from different thread");
-    return TransactionUtils::FindTransaction(_onChainTransactions, txId);
+    ensureLoaded();
+    return findOnChainTx(txId);
 }
 
 //==============================================================================
@@ -284,6 +429,7 @@ const OnChainTxList& AssetTransactionsCacheImpl::onChainTransactionsListSync() c
 {
     Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
         "Calling sync method from different thread");
+    ensureLoaded();
     return _onChainTransactions;
 }
 
@@ -292,7 +438,10 @@ const OnChainTxList& AssetTransactionsCacheImpl::onChainTransactionsListSync() c
 Promise<EthOnChainTxList> AssetTransactionsCacheImpl::onEthChainTransactionsList() const
 {
     return Promise<EthOnChainTxList>([=](const auto& resolve, const auto&) {
-        QMetaObject::invokeMethod(_executionContext, [=] { resolve(_ethOnChainTransactions); });
+        QMetaObject::invokeMethod(_executionContext, [=] {
+            this->ensureLoaded();
+            resolve(_ethOnChainTransactions);
+        });
     });
 }
 
@@ -302,6 +451,7 @@ Promise<EthOnChainTxRef> AssetTransactionsCacheImpl::ethTransactionById(QString
 {
     return Promise<EthOnChainTxRef>([=](const auto& resolver, const auto& reject) {
         QMetaObject::invokeMethod(_executionContext, [=] {
+            this->ensureLoaded();
             auto tx = TransactionUtils::FindEthTransaction(_ethOnChainTransactions, txId);
             tx ? resolver(tx) : reject(nullptr);
         });
@@ -314,8 +464,8 @@ EthOnChainTxRef AssetTransactionsCacheImpl::ethTransactionByIdSync(QString txId)
 {
     Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
         "Calling sync method from different thread");
+    ensureLoaded();
     return TransactionUtils::FindEthTransaction(_ethOnChainTransactions, txId);
-    ;
 }
 
 //==============================================================================
@@ -324,6 +474,7 @@ const EthOnChainTxList& AssetTransactionsCacheImpl::ethOnChainTransactionsListSy
 {
     Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
         "Calling sync method from different thread");
+    ensureLoaded();
     return _ethOnChainTransactions;
 }
 
@@ -332,7 +483,10 @@ const EthOnChainTxList& AssetTransactionsCacheImpl::ethOnChainTransactionsListSy
 Promise<LightningPaymentList> AssetTransactionsCacheImpl::lnPaymentsList() const
 {
     return Promise<LightningPaymentList>([this](const auto& resolve, const auto&) {
-        QMetaObject::invokeMethod(_executionContext, [=] { resolve(_lnPayments); });
+        QMetaObject::invokeMethod(_executionContext, [=] {
+            this->ensureLoaded();
+            resolve(_lnPayments);
+        });
     });
 }
 
@@ -341,7 +495,10 @@ Promise<LightningPaymentList> AssetTransactionsCacheImpl::lnPaymentsList() const
 Promise<LightningInvoiceList> AssetTransactionsCacheImpl::lnInvoicesList() const
 {
     return Promise<LightningInvoiceList>([this](const auto& resolve, const auto&) {
-        QMetaObject::invokeMethod(_executionContext, [=] { resolve(_lnInvoices); });
+        QMetaObject::invokeMethod(_executionContext, [=] {
+            this->ensureLoaded();
+            resolve(_lnInvoices);
+        });
     });
 }
 
@@ -351,6 +508,7 @@ const LightningPaymentList& AssetTransactionsCacheImpl::lnPaymentsListSync() con
 {
     Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
         "Calling sync method from different thread");
+    ensureLoaded();
     return _lnPayments;
 }
 
@@ -360,6 +518,7 @@ const LightningInvoiceList& AssetTransactionsCacheImpl::lnInvoicesListSync() con
 {
     Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
         "Calling sync method from different thread");
+    ensureLoaded();
     return _lnInvoices;
 }
 
@@ -368,7 +527,10 @@ const LightningInvoiceList& AssetTransactionsCacheImpl::lnInvoicesListSync() con
 Promise<ConnextPaymentList> AssetTransactionsCacheImpl::connextPaymentsList() const
 {
     return Promise<ConnextPaymentList>([this](const auto& resolve, const auto&) {
-        QMetaObject::invokeMethod(_executionContext, [=] { resolve(_connextPayments); });
+        QMetaObject::invokeMethod(_executionContext, [=] {
+            this->ensureLoaded();
+            resolve(_connextPayments);
+        });
     });
 }
 
@@ -378,6 +540,7 @@ const ConnextPaymentList &AssetTransactionsCacheImpl::connextPaymentsListSync()
 {
     Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
         "Calling sync method from different thread");
+    ensureLoaded();
     return _connextPayments;
 }
 
@@ -387,99 +550,28 @@ void TransactionsCacheImpl::executeLoad(bool wipe)
 {
     if (!_loaded) {
         _dbProvider->registerIndex(DB_TRANSACTIONS_INDEX, DB_TRANSACTIONS_INDEX);
-        using TxDB = Utils::GenericProtoDatabase<chain::Transaction>;
-        TxDB::Cache cache;
-
-        auto load = [&] {
-            using namespace bitcoin;
-            std::unique_ptr<CDBIterator> pcursor(_dbProvider->NewIterator());
-            std::pair<std::string, std::pair<AssetID, std::string>> key;
-            pcursor->Seek(DB_TRANSACTIONS_INDEX);
-
-            while (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_TRANSACTIONS_INDEX) {
-                std::vector<unsigned char> serialization;
-                if (pcursor->GetValue(serialization)) {
-
-                    chain::Transaction tx;
-                    if (tx.ParseFromArray(serialization.data(), serialization.size())) {
-                        auto assetID = tx.asset_id();
-
-                        switch (tx.transaction_case()) {
-                        case chain::Transaction::kOnchainTx: {
-                            this->getOrCreateCache(assetID)._onChainTransactions.emplace_back(
-                                std::make_shared<OnChainTx>(tx));
-                            break;
-                        }
-                        case chain::Transaction::kLightningPayment: {
-                            this->getOrCreateCache(assetID)._lnPayments.emplace_back(
-                                std::make_shared<LightningPayment>(tx));
-                            break;
-                        }
-                        case chain::Transaction::kLightningInvoice: {
-                            this->getOrCreateCache(assetID)._lnInvoices.emplace_back(
-                                std::make_shared<LightningInvoice>(tx));
-                            break;
-                        }
-                        case chain::Transaction::kEthonchainTx: {
-                            this->getOrCreateCache(assetID)._ethOnChainTransactions.emplace_back(
-                                std::make_shared<EthOnChainTx>(tx));
-                            break;
-                        }
-                        case chain::Transaction::kConnextPayment: {
-                            this->getOrCreateCache(assetID)._connextPayments.emplace_back(
-                                std::make_shared<ConnextPayment>(tx));
-                            break;
-                        }
-                        default:
-                            break;
-                        }
-                    }
-
-                    pcursor->Next();
-                } else {
-                }
-            }
-        };
-
-        load();
-
-        for (auto&& it : _caches) {
-            auto& cache = *it.second;
-            std::sort(std::begin(cache._onChainTransactions), std::end(cache._onChainTransactions),
-                [](const auto& lhs, const auto& rhs) {
-                    // if comparing with pending tx
-                    if (lhs->blockHeight() < 0 || rhs->blockHeight() < 0) {
-                        return lhs->tx().timestamp() < rhs->tx().timestamp();
-                    } else {
-                        return lhs->blockHeight() == rhs->blockHeight()
-                            ? lhs->transactionIndex() < rhs->transactionIndex()
-                            : lhs->blockHeight() < rhs->blockHeight();
-                    }
-                });
-
-            std::sort(std::begin(cache._ethOnChainTransactions),
-                std::end(cache._ethOnChainTransactions), [](const auto& lhs, const auto& rhs) {
-                    // sort all transactions using nonce, eth wants a strict sequential ordering of
-                    // nonces so we should be good if we have everything sorted this way.
-                    return lhs->nonce() < rhs->nonce();
-                });
-
-            for (auto&& tx : cache._onChainTransactions) {
-                tx->invalidateLocalCache(std::bind(
-                    &AssetTransactionsCacheImpl::getOutpointHelper, &cache, std::placeholders::_1));
-                cache.maintainBlockTxIndex(*tx);
-            }
+        _dbProvider->registerIndex(DB_TRANSACTIONS_SUMMARY_INDEX, DB_TRANSACTIONS_SUMMARY_INDEX);
 
-            std::sort(std::begin(cache._lnPayments), std::end(cache._lnPayments),
-                [](const auto& lhs, const auto& rhs) {
-                    return lhs->paymentIndex() < rhs->paymentIndex();
-                });
+        int32_t summaryVersion = 0;
+        if (!_dbProvider->Read(DB_TRANSACTIONS_SUMMARY_VERSION, summaryVersion)
+            || summaryVersion < TRANSACTIONS_SUMMARY_VERSION) {
+            executeBuildSummary();
+        }
 
-            std::sort(std::begin(cache._lnInvoices), std::end(cache._lnInvoices),
-                [](const auto& lhs, const auto& rhs) { return lhs->addIndex() < rhs->addIndex(); });
+        // only summary is read, transactions are loaded per asset once they are needed
+        using namespace bitcoin;
+        std::unique_ptr<CDBIterator> pcursor(_dbProvider->NewIterator());
+        std::pair<std::string, std::pair<AssetID, std::string>> key;
+        pcursor->Seek(DB_TRANSACTIONS_SUMMARY_INDEX);
+
+        while (pcursor->Valid() && pcursor->GetKey(key)
+            && key.first == DB_TRANSACTIONS_SUMMARY_INDEX) {
+            int64_t date = 0;
+            if (pcursor->GetValue(date)) {
+                this->getOrCreateCache(key.second.first)._summary.emplace(key.second.second, date);
+            }
 
-            std::sort(std::begin(cache._connextPayments), std::end(cache._connextPayments),
-                [](const auto& lhs, const auto& rhs) { return lhs->transactionDate() < rhs->transactionDate(); });
+            pcursor->Next();
         }
 
         _loaded = true;
@@ -489,49 +581,196 @@ void TransactionsCacheImpl::executeLoad(bool wipe)
 
 //==============================================================================
 
-void TransactionsCacheImpl::executeSaveTxns(
-    AssetID assetID, const std::vector<Transaction>& txns) const
+void TransactionsCacheImpl::executeBuildSummary()
 {
-    struct Visitor {
-        using Result = std::tuple<std::string, std::vector<unsigned char>>;
-        Result operator()(const OnChainTxRef& tx)
-        {
-            return std::make_tuple(tx->tx().id(), ProtobufSerializeToArray(tx->_tx));
+    // database was written before summary existed, it is built from stored transactions once
+    LogCDebug(Chains) << "Building transactions summary";
+    using namespace bitcoin;
+    static const size_t maxBatchSize = 16 << 20;
+    CDBBatch batch(*_dbProvider);
+    std::unique_ptr<CDBIterator> pcursor(_dbProvider->NewIterator());
+    std::pair<std::string, std::pair<AssetID, std::string>> key;
+    pcursor->Seek(DB_TRANSACTIONS_INDEX);
+
+    while (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_TRANSACTIONS_INDEX) {
+        std::vector<unsigned char> serialization;
+        if (pcursor->GetValue(serialization)) {
+            if (auto tx = ParseTransaction(serialization)) {
+                batch.Write(std::make_pair(DB_TRANSACTIONS_SUMMARY_INDEX, key.second),
+                    TransactionDateMs(*tx));
+            }
         }
 
-        Result operator()(const LightningInvoiceRef& tx)
-        {
-            auto id = std::string("i_") + std::to_string(tx->addIndex());
-            return std::make_tuple(id, ProtobufSerializeToArray(tx->_tx));
+        if (batch.SizeEstimate() > maxBatchSize) {
+            _dbProvider->WriteBatch(batch);
+            batch.Clear();
         }
 
-        Result operator()(const LightningPaymentRef& tx)
-        {
-            auto id = std::string("p_") + std::to_string(tx->paymentIndex());
-            return std::make_tuple(id, ProtobufSerializeToArray(tx->_tx));
+        pcursor->Next();
+    }
+
+    batch.Write(DB_TRANSACTIONS_SUMMARY_VERSION, TRANSACTIONS_SUMMARY_VERSION);
+    _dbProvider->WriteBatch(batch, true);
+}
+
+//==============================================================================
+
+void TransactionsCacheImpl::executeSaveTxns(
+    AssetID assetID, const std::vector<Transaction>& txns)
+{
+    size_t pendingWrites = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(_journalLock);
+        for (auto&& tx : txns) {
+            auto serialized = boost::variant2::visit(
+                [](const auto& ref) { return ProtobufSerializeToArray(ref->_tx); }, tx);
+            // later update of same tx replaces previous one, only latest state gets written
+            _journal[std::make_pair(assetID, TransactionKey(tx))]
+                = JournalEntry{ std::move(serialized), TransactionDateMs(tx) };
         }
-        Result operator()(const EthOnChainTxRef& tx)
-        {
-            return std::make_tuple(tx->tx().id(), ProtobufSerializeToArray(tx->_tx));
+        pendingWrites = _journal.size();
+    }
+
+    // only onchain transactions are applied again from stored best block after a crash, payments
+    // and account transactions can't be recovered that way and are written right away.
+    auto needsSync = std::any_of(std::begin(txns), std::end(txns),
+        [](const auto& tx) { return !boost::variant2::holds_alternative<OnChainTxRef>(tx); });
+
+    if (needsSync) {
+        _journalFlushTimer->stop();
+        writeJournal(true);
+    } else if (pendingWrites >= JOURNAL_MAX_PENDING_WRITES) {
+        scheduleJournalFlush();
+    } else if (!_journalFlushTimer->isActive()) {
+        _journalFlushTimer->start();
+    }
+}
+
+//==============================================================================
+
+TransactionsList TransactionsCacheImpl::executeLoadTxns(
+    AssetID assetID, const std::vector<std::string>& keys) const
+{
+    TransactionsList result;
+    for (auto&& key : keys) {
+        if (auto tx = readTransaction(assetID, key)) {
+            result.emplace_back(*tx);
         }
-        Result operator()(const ConnextPaymentRef& tx)
-        {
-            auto id = std::string("cp_") + tx->transferId().toStdString();
-            return std::make_tuple(id, ProtobufSerializeToArray(tx->_tx));
+    }
+
+    // rows are loaded without the rest of history, spent outputs are read by their tx id
+    std::unordered_map<std::string, OnChainTxRef> spentTxns;
+    auto outputById = [this, assetID, &spentTxns](const chain::TxOutpoint& outpoint) {
+        auto it = spentTxns.find(outpoint.hash());
+        if (it == std::end(spentTxns)) {
+            OnChainTxRef spentTx;
+            if (auto tx = readTransaction(assetID, outpoint.hash())) {
+                if (auto onChainTx = boost::variant2::get_if<OnChainTxRef>(&tx.get())) {
+                    spentTx = *onChainTx;
+                }
+            }
+            it = spentTxns.emplace(outpoint.hash(), spentTx).first;
         }
 
+        chain::TxOutput output;
+        if (it->second) {
+            output = TransactionUtils::FindOutput(*it->second, outpoint.index())
+                         .get_value_or(output);
+        }
+        return output;
     };
 
-    bitcoin::CDBBatch batch(*_dbProvider);
-    std::string id;
-    std::vector<unsigned char> serialized;
+    for (auto&& tx : result) {
+        if (auto onChainTx = boost::variant2::get_if<OnChainTxRef>(&tx)) {
+            (*onChainTx)->invalidateLocalCache(outputById);
+        }
+    }
 
-    for (auto&& tx : txns) {
-        std::tie(id, serialized) = boost::variant2::visit(Visitor{}, tx);
-        batch.Write(std::make_pair(DB_TRANSACTIONS_INDEX, std::make_pair(assetID, id)), serialized);
+    return result;
+}
+
+//==============================================================================
+
+TransactionsList TransactionsCacheImpl::executeLoadAllTxns(AssetID assetID) const
+{
+    using namespace bitcoin;
+    TransactionsList result;
+    std::unique_ptr<CDBIterator> pcursor(_dbProvider->NewIterator());
+    std::pair<std::string, std::pair<AssetID, std::string>> key;
+    pcursor->Seek(std::make_pair(DB_TRANSACTIONS_INDEX, std::make_pair(assetID, std::string())));
+
+    while (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_TRANSACTIONS_INDEX
+        && key.second.first == assetID) {
+        std::vector<unsigned char> serialization;
+        if (pcursor->GetValue(serialization)) {
+            if (auto tx = ParseTransaction(serialization)) {
+                result.emplace_back(*tx);
+            }
+        }
+
+        pcursor->Next();
     }
 
-    _dbProvider->WriteBatch(batch, true);
+    return result;
+}
+
+//==============================================================================
+
+boost::optional<Transaction> TransactionsCacheImpl::readTransaction(
+    AssetID assetID, const std::string& key) const
+{
+    std::vector<unsigned char> serialization;
+    if (!_dbProvider->Read(
+            std::make_pair(DB_TRANSACTIONS_INDEX, std::make_pair(assetID, key)), serialization)) {
+        return boost::none;
+    }
+
+    return ParseTransaction(serialization);
+}
+
+//==============================================================================
+
+void TransactionsCacheImpl::scheduleJournalFlush()
+{
+    _journalFlushTimer->stop();
+    if (!_journalFlushScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(_journalThread->context(), [this] {
+            _journalFlushScheduled = false;
+            writeJournal(false);
+        });
+    }
+}
+
+//==============================================================================
+
+void TransactionsCacheImpl::writeJournal(bool sync)
+{
+    std::lock_guard<std::mutex> writeLock(_journalWriteLock);
+    decltype(_journal) journal;
+    {
+        std::lock_guard<std::mutex> lock(_journalLock);
+        std::swap(journal, _journal);
+    }
+
+    // sync write persists all previous unsynced writes as well, nothing to do if there are none
+    if (journal.empty() && (!sync || !_hasUnsyncedWrites)) {
+        return;
+    }
+
+    bitcoin::CDBBatch batch(*_dbProvider);
+    for (auto&& it : journal) {
+        batch.Write(std::make_pair(DB_TRANSACTIONS_INDEX, it.first), it.second.serialized);
+        batch.Write(std::make_pair(DB_TRANSACTIONS_SUMMARY_INDEX, it.first), it.second.date);
+    }
+
+    _dbProvider->WriteBatch(batch, sync);
+    _hasUnsyncedWrites = !sync;
+    if (sync) {
+        ++_journalSyncedFlushes;
+    } else {
+        ++_journalFlushes;
+    }
 }
 
 //==============================================================================
@@ -542,7 +781,13 @@ AssetTransactionsCacheImpl& TransactionsCacheImpl::getOrCreateCache(AssetID asse
 
         AssetTransactionsCacheImpl::SaveTxns onSaveTx = std::bind(
             &TransactionsCacheImpl::executeSaveTxns, this, assetID, std::placeholders::_1);
-        _caches.emplace(assetID, new AssetTransactionsCacheImpl(onSaveTx, _executionContext));
+        AssetTransactionsCacheImpl::LoadTxns onLoadTxns = std::bind(
+            &TransactionsCacheImpl::executeLoadTxns, this, assetID, std::placeholders::_1);
+        AssetTransactionsCacheImpl::LoadAllTxns onLoadAllTxns
+            = std::bind(&TransactionsCacheImpl::executeLoadAllTxns, this, assetID);
+        _caches.emplace(assetID,
+            new AssetTransactionsCacheImpl(
+                onSaveTx, onLoadTxns, onLoadAllTxns, _executionContext));
         cacheAdded(assetID);
     }
 
@@ -555,8 +800,7 @@ chain::TxOutput AssetTransactionsCacheImpl::getOutpointHelper(const chain::TxOut
 {
     chain::TxOutput result;
 
-    if (auto tx = TransactionUtils::FindTransaction(
-            _onChainTransactions, QString::fromStdString(outpoint.hash()))) {
+    if (auto tx = findOnChainTx(QString::fromStdString(outpoint.hash()))) {
         result = TransactionUtils::FindOutput(*tx, outpoint.index()).get_value_or(result);
     }
 
@@ -574,10 +818,127 @@ void AssetTransactionsCacheImpl::maintainBlockTxIndex(const OnChainTx& tx)
 
 //==============================================================================
 
+OnChainTxRef AssetTransactionsCacheImpl::findOnChainTx(const TxID& txId) const
+{
+    auto it = _onChainTxIndex.find(txId);
+    return it != std::end(_onChainTxIndex) ? _onChainTransactions.at(it->second) : OnChainTxRef{};
+}
+
+//==============================================================================
+
+void AssetTransactionsCacheImpl::appendOnChainTx(OnChainTxRef tx)
+{
+    _onChainTxIndex.emplace(tx->txId(), _onChainTransactions.size());
+    _onChainTransactions.emplace_back(tx);
+}
+
+//==============================================================================
+
+void AssetTransactionsCacheImpl::rebuildOnChainTxIndex()
+{
+    _onChainTxIndex.clear();
+    _onChainTxIndex.reserve(_onChainTransactions.size());
+    for (size_t i = 0; i < _onChainTransactions.size(); ++i) {
+        _onChainTxIndex.emplace(_onChainTransactions[i]->txId(), i);
+    }
+}
+
+//==============================================================================
+
+void AssetTransactionsCacheImpl::ensureLoaded() const
+{
+    if (_loaded) {
+        return;
+    }
+
+    _loaded = true;
+    _pageRows.clear();
+    // loading is lazy initialization, cache doesn't change from reader's point of view
+    auto self = const_cast<AssetTransactionsCacheImpl*>(this);
+    self->loadTransactions(_onLoadAllTxns());
+}
+
+//==============================================================================
+
+void AssetTransactionsCacheImpl::loadTransactions(TransactionsList transactions)
+{
+    struct Visitor {
+        void operator()(const OnChainTxRef& tx) { self->_onChainTransactions.emplace_back(tx); }
+        void operator()(const LightningPaymentRef& tx) { self->_lnPayments.emplace_back(tx); }
+        void operator()(const LightningInvoiceRef& tx) { self->_lnInvoices.emplace_back(tx); }
+        void operator()(const EthOnChainTxRef& tx)
+        {
+            self->_ethOnChainTransactions.emplace_back(tx);
+        }
+        void operator()(const ConnextPaymentRef& tx) { self->_connextPayments.emplace_back(tx); }
+
+        AssetTransactionsCacheImpl* self;
+    };
+
+    for (auto&& tx : transactions) {
+        _byKey.emplace(TransactionKey(tx), tx);
+        boost::variant2::visit(Visitor{ this }, tx);
+    }
+
+    std::sort(std::begin(_onChainTransactions), std::end(_onChainTransactions),
+        [](const auto& lhs, const auto& rhs) {
+            // if comparing with pending tx
+            if (lhs->blockHeight() < 0 || rhs->blockHeight() < 0) {
+                return lhs->tx().timestamp() < rhs->tx().timestamp();
+            } else {
+                return lhs->blockHeight() == rhs->blockHeight()
+                    ? lhs->transactionIndex() < rhs->transactionIndex()
+                    : lhs->blockHeight() < rhs->blockHeight();
+            }
+        });
+
+    std::sort(std::begin(_ethOnChainTransactions), std::end(_ethOnChainTransactions),
+        [](const auto& lhs, const auto& rhs) {
+            // sort all transactions using nonce, eth wants a strict sequential ordering of
+            // nonces so we should be good if we have everything sorted this way.
+            return lhs->nonce() < rhs->nonce();
+        });
+
+    rebuildOnChainTxIndex();
+    for (auto&& tx : _onChainTransactions) {
+        tx->invalidateLocalCache(std::bind(
+            &AssetTransactionsCacheImpl::getOutpointHelper, this, std::placeholders::_1));
+        maintainBlockTxIndex(*tx);
+    }
+
+    std::sort(std::begin(_lnPayments), std::end(_lnPayments),
+        [](const auto& lhs, const auto& rhs) { return lhs->paymentIndex() < rhs->paymentIndex(); });
+
+    std::sort(std::begin(_lnInvoices), std::end(_lnInvoices),
+        [](const auto& lhs, const auto& rhs) { return lhs->addIndex() < rhs->addIndex(); });
+
+    std::sort(std::begin(_connextPayments), std::end(_connextPayments),
+        [](const auto& lhs, const auto& rhs) {
+            return lhs->transactionDate() < rhs->transactionDate();
+        });
+}
+
+//==============================================================================
+
+void AssetTransactionsCacheImpl::updateSummary(const Transaction& tx)
+{
+    auto key = TransactionKey(tx);
+    // updated tx is merged into one which is already cached
+    auto it = _byKey.emplace(key, tx).first;
+    // updated transactions can change their timestamp as well
+    _summary[key] = TransactionDateMs(it->second);
+    _newestFirstDirty = true;
+}
+
+//==============================================================================
+
 Promise<OnChainTxList> AssetTransactionsCacheImpl::onChainTransactionsList() const
 {
     return Promise<OnChainTxList>([=](const auto& resolve, const auto&) {
-        QMetaObject::invokeMethod(_executionContext, [=] { resolve(_onChainTransactions); });
+        QMetaObject::invokeMethod(_executionContext, [=] {
+            this->ensureLoaded();
+            resolve(_onChainTransactions);
+        });
     });
 }
 
@@ -587,7 +948,25 @@ TransactionsCacheImpl::TransactionsCacheImpl(
     std::shared_ptr<Utils::LevelDBSharedDatabase> provider, QObject* parent)
     : AssetsTransactionsCache(parent)
     , _dbProvider(provider)
+    , _journalThread(new Utils::WorkerThread)
+{
+    _journalThread->rename("Stakenet-TxCacheIO");
+    _journalThread->start();
+
+    _journalFlushTimer = new QTimer(this);
+    _journalFlushTimer->setSingleShot(true);
+    _journalFlushTimer->setInterval(JOURNAL_FLUSH_INTERVAL);
+    connect(_journalFlushTimer, &QTimer::timeout, this,
+        &TransactionsCacheImpl::scheduleJournalFlush);
+}
+
+//==============================================================================
+
+TransactionsCacheImpl::~TransactionsCacheImpl()
 {
+    // stop io thread first, whatever it didn't manage to write is written here
+    _journalThread.reset();
+    writeJournal(true);
 }
 
 //==============================================================================
@@ -629,3 +1008,27 @@ std::vector<AssetID> TransactionsCacheImpl::availableCaches() const
 }
 
 //==============================================================================
+
+void TransactionsCacheImpl::checkpointSync()
+{
+    Q_ASSERT_X(thread() == QThread::currentThread(), __FUNCTION__,
+        "Calling sync method from different thread");
+    _journalFlushTimer->stop();
+    writeJournal(true);
+}
+
+//==============================================================================
+
+TransactionsCacheImpl::JournalStats TransactionsCacheImpl::journalStats() const
+{
+    JournalStats stats;
+    {
+        std::lock_guard<std::mutex> lock(_journalLock);
+        stats.pendingWrites = _journal.size();
+    }
+    stats.flushes = _journalFlushes;
+    stats.syncedFlushes = _journalSyncedFlushes;
+    return stats;
+}
+
+//==============================================================================
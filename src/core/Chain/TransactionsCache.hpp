@@ -2,10 +2,16 @@
 #define TRANSACTIONSCACHE_HPP
 
 #include <QObject>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 
 #include <Chain/AbstractTransactionsCache.hpp>
+#include <boost/compute/detail/lru_cache.hpp>
+
+class QTimer;
 
 namespace Utils {
 class LevelDBSharedDatabase;
@@ -18,10 +24,16 @@ class AssetTransactionsCacheImpl : public AbstractTransactionsCache {
     Q_OBJECT
 public:
     using SaveTxns = std::function<void(const std::vector<Transaction>&)>;
-    explicit AssetTransactionsCacheImpl(SaveTxns onSaveTx, QObject* parent = nullptr);
+    // loads stored transactions by their keys
+    using LoadTxns = std::function<TransactionsList(const std::vector<std::string>&)>;
+    // loads every stored transaction of asset
+    using LoadAllTxns = std::function<TransactionsList()>;
+    AssetTransactionsCacheImpl(SaveTxns onSaveTx, LoadTxns onLoadTxns, LoadAllTxns onLoadAllTxns,
+        QObject* parent = nullptr);
     ~AssetTransactionsCacheImpl() override;
 
     Promise<TransactionsList> transactionsList() const override;
+    Promise<TransactionsPage> transactionsPage(size_t offset, size_t count) const override;
     Promise<std::vector<QString>> transactionsInBlock(BlockHash blockHash) const override;
     std::vector<QString> transactionsInBlockSync(BlockHash blockHash) const override;
 
@@ -48,6 +60,13 @@ public:
 private:
     chain::TxOutput getOutpointHelper(const chain::TxOutpoint& outpoint);
     void maintainBlockTxIndex(const OnChainTx& tx);
+    OnChainTxRef findOnChainTx(const TxID& txId) const;
+    void appendOnChainTx(OnChainTxRef tx);
+    void rebuildOnChainTxIndex();
+    void ensureLoaded() const;
+    void loadTransactions(TransactionsList transactions);
+    void updateSummary(const Transaction& tx);
+    TransactionsPage makePage(size_t offset, size_t count) const;
 
 private:
     friend class TransactionsCacheImpl;
@@ -56,13 +75,29 @@ private:
     using BlockTransactionsIndex = std::map<BlockHash, std::set<TxID>>;
 
     OnChainTxList _onChainTransactions;
+    // txid -> position in _onChainTransactions, has to be kept in step with it
+    std::unordered_map<TxID, size_t> _onChainTxIndex;
     LightningPaymentList _lnPayments;
     LightningInvoiceList _lnInvoices;
     EthOnChainTxList _ethOnChainTransactions;
     BlockTransactionsIndex _blockTransactionsIndex;
     ConnextPaymentList _connextPayments;
+    // key -> tx, filled together with lists above
+    std::unordered_map<std::string, Transaction> _byKey;
+    // lists above are filled on first access which needs them, paging doesn't
+    mutable bool _loaded{ false };
+
+    // key -> date in ms of every stored tx, it is resident even if lists above weren't loaded
+    std::unordered_map<std::string, int64_t> _summary;
+    // summary ordered by date for paging, rebuilt lazily once new tx was added
+    mutable std::vector<std::pair<int64_t, const std::string*>> _newestFirst;
+    mutable bool _newestFirstDirty{ true };
+    // rows of recently requested pages, used until lists above are loaded
+    mutable boost::compute::detail::lru_cache<std::string, Transaction> _pageRows;
 
     SaveTxns _onSaveTx;
+    LoadTxns _onLoadTxns;
+    LoadAllTxns _onLoadAllTxns;
 };
 
 //==============================================================================
@@ -70,23 +105,60 @@ private:
 class TransactionsCacheImpl : public AssetsTransactionsCache {
     Q_OBJECT
 public:
+    // journal is flushed once it has that many distinct transactions or after interval elapsed
+    static constexpr size_t JOURNAL_MAX_PENDING_WRITES = 1000;
+    static constexpr int JOURNAL_FLUSH_INTERVAL = 1000;
+
+    struct JournalStats {
+        size_t pendingWrites{ 0 };
+        uint64_t flushes{ 0 };
+        uint64_t syncedFlushes{ 0 };
+    };
+
     explicit TransactionsCacheImpl(
         std::shared_ptr<Utils::LevelDBSharedDatabase> provider, QObject* parent = nullptr);
+    ~TransactionsCacheImpl() override;
     Promise<void> load(bool wipe) override;
     bool isCreated() const override;
 
     AbstractTransactionsCache& cacheByIdSync(AssetID assetId) override;
     std::vector<AssetID> availableCaches() const override;
+    void checkpointSync() override;
+    JournalStats journalStats() const;
 
 private:
     void executeLoad(bool wipe);
-    void executeSaveTxns(AssetID assetID, const std::vector<Transaction>& txns) const;
+    void executeBuildSummary();
+    void executeSaveTxns(AssetID assetID, const std::vector<Transaction>& txns);
+    TransactionsList executeLoadTxns(AssetID assetID, const std::vector<std::string>& keys) const;
+    TransactionsList executeLoadAllTxns(AssetID assetID) const;
+    boost::optional<Transaction> readTransaction(AssetID assetID, const std::string& key) const;
+    void scheduleJournalFlush();
+    void writeJournal(bool sync);
     AssetTransactionsCacheImpl& getOrCreateCache(AssetID assetID);
 
 private:
+    using JournalKey = std::pair<AssetID, std::string>;
+    struct JournalEntry {
+        std::vector<unsigned char> serialized;
+        int64_t date{ 0 };
+    };
+
     std::shared_ptr<Utils::LevelDBSharedDatabase> _dbProvider;
     mutable std::map<AssetID, AssetTransactionsCacheImpl*> _caches;
     std::atomic_bool _loaded{ false };
+
+    // write-behind journal, keeps only latest serialization of every tx that wasn't written yet
+    std::map<JournalKey, JournalEntry> _journal;
+    mutable std::mutex _journalLock;
+    // keeps journal writes ordered between io thread and checkpoints
+    std::mutex _journalWriteLock;
+    std::atomic_bool _journalFlushScheduled{ false };
+    std::atomic_bool _hasUnsyncedWrites{ false };
+    std::atomic<uint64_t> _journalFlushes{ 0 };
+    std::atomic<uint64_t> _journalSyncedFlushes{ 0 };
+    std::unique_ptr<Utils::WorkerThread> _journalThread;
+    QTimer* _journalFlushTimer{ nullptr };
 };
 
 //==============================================================================
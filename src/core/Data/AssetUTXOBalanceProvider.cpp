@@ -6,8 +6,6 @@
 #include <Models/AssetTransactionsDataSource.hpp>
 #include <Models/LnDaemonInterface.hpp>
 
-static const int64_t MAX_CONFIRMATIONS = 99999999;
-
 //==============================================================================
 
 AssetUTXOBalanceProvider::AssetUTXOBalanceProvider(CoinAsset coinAsset,
@@ -17,6 +15,7 @@ AssetUTXOBalanceProvider::AssetUTXOBalanceProvider(CoinAsset coinAsset,
     , _asset(coinAsset)
     , _chainManager(chainManager)
     , _lndInterface(lndInterface)
+    , _ledger(_asset.misc().confirmationsForApproved)
 {
     Q_ASSERT(assetsTxnsCache);
     init(*assetsTxnsCache);
@@ -35,22 +34,14 @@ void AssetUTXOBalanceProvider::update()
 
 void AssetUTXOBalanceProvider::onTxnsAdded(const std::vector<Transaction>& txns)
 {
-    auto currentBalance = balance();
-    for (const auto& var : txns) {
-        if (auto tx = boost::variant2::get_if<OnChainTxRef>(&var)) {
-            currentBalance.balance += (*tx)->delta();
-            currentBalance.confirmedBalance += getConfirmedBalance(*tx);
-        }
-    }
-    setBalance(currentBalance);
+    applyTransactions(txns);
 }
 
 //==============================================================================
 
 void AssetUTXOBalanceProvider::onTxnsChanged(const std::vector<Transaction>& txns)
 {
-    Q_UNUSED(txns);
-    updateBalance();
+    applyTransactions(txns);
 }
 
 //==============================================================================
@@ -61,8 +52,8 @@ void AssetUTXOBalanceProvider::onChainHeightChanged()
         QPointer<AssetUTXOBalanceProvider> self{ this };
         _chainView->chainHeight().then([self](size_t newHeight) {
             if (self) {
-                self->_chainHeight = static_cast<int64_t>(newHeight);
-                self->updateBalance();
+                self->_ledger.setChainHeight(static_cast<int64_t>(newHeight));
+                self->publishBalance();
             }
         });
     }
@@ -74,7 +65,7 @@ void AssetUTXOBalanceProvider::init(AssetsTransactionsCache& transactionsCache)
 {
     auto assetID = _asset.coinID();
     transactionsCache.cacheById(assetID).then([this, assetID](AbstractTransactionsCache* cache) {
-        _dataSource = new AssetTransactionsDataSource(assetID, cache, this);
+        _dataSource = new AssetTransactionsDataSource(assetID, cache, 0, this);
         connect(_dataSource, &AssetTransactionsDataSource::transactionsFetched, this,
             &AssetUTXOBalanceProvider::updateBalance);
         connect(_dataSource, &AssetTransactionsDataSource::txnsAdded, this,
@@ -109,48 +100,31 @@ void AssetUTXOBalanceProvider::init(AssetsTransactionsCache& transactionsCache)
 
 void AssetUTXOBalanceProvider::updateBalance()
 {
-    AssetBalance result;
-    for (const auto& var : _dataSource->transactionsList()) {
+    _ledger.clear();
+    applyTransactions(_dataSource->transactionsList());
+}
+
+//==============================================================================
 
-        // TODO(yuraolex): optimize this later by providing new data source
+void AssetUTXOBalanceProvider::applyTransactions(const std::vector<Transaction>& txns)
+{
+    for (const auto& var : txns) {
         if (auto tx = boost::variant2::get_if<OnChainTxRef>(&var)) {
-            result.balance += (*tx)->delta();
-            result.confirmedBalance += getConfirmedBalance(*tx);
+            _ledger.apply(**tx);
         }
     }
-    result.nodeBalance = balance().nodeBalance;
-    result.availableNodeBalance = balance().availableNodeBalance;
-    result.activeNodeBalance = balance().activeNodeBalance;
 
-    setBalance(result);
+    publishBalance();
 }
 
 //==============================================================================
 
-Balance AssetUTXOBalanceProvider::getConfirmedBalance(const OnChainTxRef& transaction) const
+void AssetUTXOBalanceProvider::publishBalance()
 {
-    if (!_chainHeight) {
-        return Balance{ 0 };
-    }
-
-    int64_t minConfirmations = _asset.misc().confirmationsForApproved;
-    auto height = *_chainHeight;
-
-    Balance result{ 0 };
-    if (height >= transaction->blockHeight()) {
-        auto confirmations = height - transaction->blockHeight() + 1;
-        if (transaction->blockHeight() < 0) {
-            auto outputSum = std::accumulate(transaction->outputs().begin(),
-                transaction->outputs().end(), Balance{ 0 },
-                [](Balance accum, const auto& output) { return accum + output.value(); });
-            result = transaction->delta() - outputSum;
-        } else {
-            if (confirmations >= minConfirmations && confirmations <= MAX_CONFIRMATIONS) {
-                result = transaction->delta();
-            }
-        }
-    }
-    return result;
+    auto result = balance();
+    result.balance = _ledger.balance();
+    result.confirmedBalance = _ledger.confirmedBalance();
+    setBalance(result);
 }
 
 //==============================================================================
@@ -4,6 +4,7 @@
 #include <Data/AbstractAssetBalanceProvider.hpp>
 #include <Data/CoinAsset.hpp>
 #include <Data/TransactionEntry.hpp>
+#include <Data/UTXOBalanceLedger.hpp>
 #include <QObject>
 #include <QPointer>
 
@@ -31,7 +32,8 @@ private slots:
 private:
     void init(AssetsTransactionsCache& transactionsCache);
     void updateBalance();
-    Balance getConfirmedBalance(const OnChainTxRef& transaction) const;
+    void applyTransactions(const std::vector<Transaction>& txns);
+    void publishBalance();
 
 private:
     CoinAsset _asset;
@@ -39,7 +41,7 @@ private:
     QPointer<AbstractChainManager> _chainManager;
     QPointer<LnDaemonInterface> _lndInterface;
     std::shared_ptr<ChainView> _chainView;
-    std::optional<int64_t> _chainHeight;
+    UTXOBalanceLedger _ledger;
 };
 
 #endif // ASSETUTXOBALANCEPROVIDER_HPP
@@ -40,12 +40,11 @@ Promise<AbstractOrderbookDataSource::Orders> TradingModelBatchedDataSource::fetc
 
                 const auto isBuy = type == AbstractOrderbookDataSource::OrdersType::Buy;
 
-                auto transform = [&result](auto& orders) {
-                    result.reserve(orders.size());
-                    std::transform(std::begin(orders), std::end(orders), std::back_inserter(result),
-                        [](const auto& it) {
-                            return OrderSummary(it.second.price, it.second.amount);
-                        });
+                // levels are stored contiguously, result is filled in one pass
+                auto transform = [&result](const auto& levels) {
+                    result.reserve(levels.size());
+                    std::transform(std::begin(levels), std::end(levels), std::back_inserter(result),
+                        [](const auto& level) { return OrderSummary(level.price, level.amount); });
                 };
 
                 if (isBuy) {
@@ -29,6 +29,11 @@ OnChainTxRef TransactionUtils::FindTransaction(const OnChainTxList& where, QStri
 boost::optional<chain::TxOutput> TransactionUtils::FindOutput(const OnChainTx& tx, size_t index)
 {
     const auto& outputs = tx.tx().outputs();
+    // outputs are normally stored in order of their indexes
+    if (index < static_cast<size_t>(outputs.size()) && outputs.Get(index).index() == index) {
+        return boost::make_optional(outputs.Get(index));
+    }
+
     auto it = std::find_if(std::begin(outputs), std::end(outputs),
         [index](const auto& output) { return output.index() == index; });
 
@@ -365,14 +370,15 @@ void OnChainTx::invalidateBlockHeight()
 
 void OnChainTx::invalidateLocalCache(std::function<chain::TxOutput(chain::TxOutpoint)> outputById)
 {
-    for (auto out : tx().outputs()) {
+    for (const auto& out : tx().outputs()) {
         _delta += out.value();
         _unspentAddresses.insert(QString::fromStdString(out.address()));
     }
 
-    for (auto in : tx().inputs()) {
-        _delta -= outputById(in).value();
-        _spendAddresses.insert(QString::fromStdString(outputById(in).address()));
+    for (const auto& in : tx().inputs()) {
+        auto prevOut = outputById(in);
+        _delta -= prevOut.value();
+        _spendAddresses.insert(QString::fromStdString(prevOut.address()));
     }
 }
 
@@ -697,3 +703,44 @@ ConnextPaymentRef TransactionUtils::FindConnextPaymentTransaction(
 }
 
 //==============================================================================
+
+QDateTime TransactionUtils::TransactionDate(const Transaction& tx)
+{
+    return boost::variant2::visit([](const auto& ref) { return ref->transactionDate(); }, tx);
+}
+
+//==============================================================================
+
+void TransactionUtils::SortNewestFirst(TransactionsList& transactions)
+{
+    std::vector<std::pair<qint64, Transaction>> keyed;
+    keyed.reserve(transactions.size());
+    for (auto&& tx : transactions) {
+        keyed.emplace_back(TransactionDate(tx).toMSecsSinceEpoch(), std::move(tx));
+    }
+
+    std::stable_sort(std::begin(keyed), std::end(keyed),
+        [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        transactions[i] = std::move(keyed[i].second);
+    }
+}
+
+//==============================================================================
+
+TransactionsPage TransactionUtils::MakePage(
+    const TransactionsList& newestFirst, size_t offset, size_t count)
+{
+    TransactionsPage page;
+    page.offset = offset;
+    page.total = newestFirst.size();
+    if (offset < newestFirst.size()) {
+        auto last = std::min(newestFirst.size(), offset + count);
+        page.transactions.assign(std::begin(newestFirst) + offset, std::begin(newestFirst) + last);
+    }
+
+    return page;
+}
+
+//==============================================================================
@@ -222,6 +222,12 @@ using Transaction = boost::variant2::variant<OnChainTxRef, LightningPaymentRef,
     EthOnChainTxRef, ConnextPaymentRef>;
 using TransactionsList = std::vector<Transaction>;
 
+struct TransactionsPage {
+    TransactionsList transactions;
+    size_t offset{ 0 };
+    size_t total{ 0 };
+};
+
 // spend info about conflicting inputs, at which transaction outpoint was spent
 // using ConflictingInputs = std::map<Outpoint, QString>;
 
@@ -299,6 +305,9 @@ EthOnChainTxRef FindEthTransaction(const EthOnChainTxList& where, QString transa
 EthOnChainTxRef UpdateEthTransactionType(QString ourAddress, bool isTokenTx, EthOnChainTxRef tx);
 EthOnChainTxRef UpdateEthTransactionStatus(EthOnChainTxRef tx, QString status = "0x1");
 ConnextPaymentRef FindConnextPaymentTransaction(const ConnextPaymentList &where, QString transferId);
+QDateTime TransactionDate(const Transaction& tx);
+void SortNewestFirst(TransactionsList& transactions);
+TransactionsPage MakePage(const TransactionsList& newestFirst, size_t offset, size_t count);
 }
 
 //==============================================================================
@@ -0,0 +1,132 @@
+#include "UTXOBalanceLedger.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+//==============================================================================
+
+UTXOBalanceLedger::UTXOBalanceLedger(int64_t minConfirmations)
+    : _minConfirmations(minConfirmations)
+{
+}
+
+//==============================================================================
+
+void UTXOBalanceLedger::apply(const OnChainTx& transaction)
+{
+    Entry entry;
+    entry.blockHeight = transaction.blockHeight();
+    entry.delta = transaction.delta();
+    if (entry.blockHeight < 0) {
+        auto outputSum = std::accumulate(transaction.outputs().begin(),
+            transaction.outputs().end(), Balance{ 0 },
+            [](Balance accum, const auto& output) { return accum + output.value(); });
+        entry.unminedConfirmed = entry.delta - outputSum;
+    }
+
+    auto it = _entries.find(transaction.txId());
+    if (it != _entries.end()) {
+        post(it->second, -1);
+        it->second = entry;
+    } else {
+        _entries.emplace(transaction.txId(), entry);
+    }
+
+    post(entry, 1);
+}
+
+//==============================================================================
+
+void UTXOBalanceLedger::remove(const QString& txId)
+{
+    auto it = _entries.find(txId);
+    if (it != _entries.end()) {
+        post(it->second, -1);
+        _entries.erase(it);
+    }
+}
+
+//==============================================================================
+
+void UTXOBalanceLedger::clear()
+{
+    _entries.clear();
+    _minedByHeight.clear();
+    _balance = 0;
+    _matured = 0;
+    _unminedConfirmed = 0;
+}
+
+//==============================================================================
+
+void UTXOBalanceLedger::setChainHeight(int64_t height)
+{
+    auto oldMatured = maturedHeight();
+    _chainHeight = height;
+    auto newMatured = maturedHeight();
+
+    // only buckets between old and new threshold change their state
+    if (newMatured > oldMatured) {
+        auto end = _minedByHeight.upper_bound(newMatured);
+        for (auto it = _minedByHeight.upper_bound(oldMatured); it != end; ++it) {
+            _matured += it->second.delta;
+        }
+    } else if (newMatured < oldMatured) {
+        auto end = _minedByHeight.upper_bound(oldMatured);
+        for (auto it = _minedByHeight.upper_bound(newMatured); it != end; ++it) {
+            _matured -= it->second.delta;
+        }
+    }
+}
+
+//==============================================================================
+
+Balance UTXOBalanceLedger::balance() const
+{
+    return _balance;
+}
+
+//==============================================================================
+
+Balance UTXOBalanceLedger::confirmedBalance() const
+{
+    return _chainHeight ? _matured + _unminedConfirmed : Balance{ 0 };
+}
+
+//==============================================================================
+
+void UTXOBalanceLedger::post(const Entry& entry, int sign)
+{
+    _balance += sign * entry.delta;
+    if (entry.blockHeight < 0) {
+        _unminedConfirmed += sign * entry.unminedConfirmed;
+        return;
+    }
+
+    auto& bucket = _minedByHeight[entry.blockHeight];
+    bucket.delta += sign * entry.delta;
+    if (sign > 0) {
+        ++bucket.count;
+    } else if (--bucket.count == 0) {
+        _minedByHeight.erase(entry.blockHeight);
+    }
+
+    if (entry.blockHeight <= maturedHeight()) {
+        _matured += sign * entry.delta;
+    }
+}
+
+//==============================================================================
+
+int64_t UTXOBalanceLedger::maturedHeight() const
+{
+    if (!_chainHeight) {
+        return std::numeric_limits<int64_t>::min();
+    }
+
+    // transaction at height h has (tip - h + 1) confirmations and has to be at or below tip
+    return std::min(*_chainHeight, *_chainHeight - _minConfirmations + 1);
+}
+
+//==============================================================================
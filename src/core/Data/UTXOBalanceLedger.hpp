@@ -0,0 +1,53 @@
+#ifndef UTXOBALANCELEDGER_HPP
+#define UTXOBALANCELEDGER_HPP
+
+#include <Data/TransactionEntry.hpp>
+#include <Tools/Common.hpp>
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+/*!
+ * \brief The UTXOBalanceLedger class keeps balance of UTXO asset up to date incrementally. Every
+ * transaction posts its delta once, mined deltas are bucketed by block height, so moving chain tip
+ * touches only buckets which crossed confirmations threshold instead of whole history.
+ */
+class UTXOBalanceLedger {
+public:
+    explicit UTXOBalanceLedger(int64_t minConfirmations);
+
+    // adds transaction or replaces previously applied one with the same id
+    void apply(const OnChainTx& transaction);
+    void remove(const QString& txId);
+    void clear();
+    void setChainHeight(int64_t height);
+
+    Balance balance() const;
+    Balance confirmedBalance() const;
+
+private:
+    struct Entry {
+        int64_t blockHeight{ -1 };
+        Balance delta{ 0 };
+        Balance unminedConfirmed{ 0 };
+    };
+
+    struct Bucket {
+        Balance delta{ 0 };
+        size_t count{ 0 };
+    };
+
+    void post(const Entry& entry, int sign);
+    int64_t maturedHeight() const;
+
+private:
+    int64_t _minConfirmations{ 0 };
+    std::optional<int64_t> _chainHeight;
+    std::unordered_map<QString, Entry> _entries;
+    std::map<int64_t, Bucket> _minedByHeight;
+    Balance _balance{ 0 };
+    Balance _matured{ 0 }; // sum of buckets at or below maturedHeight()
+    Balance _unminedConfirmed{ 0 };
+};
+
+#endif // UTXOBALANCELEDGER_HPP
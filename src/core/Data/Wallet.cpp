@@ -103,23 +103,6 @@ static std::vector<bitcoin::CKeyID> GetKeyIDPool(
 
 //==============================================================================
 
-static std::vector<bitcoin::CScript> GetAddressPool(
-    bitcoin::CWallet* wallet, AssetID assetId, AddressTypes types, bool isChange)
-{
-    std::vector<bitcoin::CScript> result;
-    auto keyIDPool = GetKeyIDPool(wallet, assetId, isChange);
-    for (auto&& type : types) {
-        std::transform(std::begin(keyIDPool), std::end(keyIDPool), std::back_inserter(result),
-            [type](const bitcoin::CKeyID& keyID) {
-                return bitcoin::GetScriptForDestination(AddressFromKeyID(keyID, type));
-            });
-    }
-
-    return result;
-}
-
-//==============================================================================
-
 static std::optional<bitcoin::CPubKey> GetAccountPubKey(
     bitcoin::CWallet& wallet, const CoinAsset& asset)
 {
@@ -633,50 +616,64 @@ BFMatcherUniqueRef Wallet::createMatcher(AssetID assetID) const
     struct Matcher : public BlockFilterMatcher {
         explicit Matcher(AssetID assetID, const Wallet& wallet)
             : BlockFilterMatcher(assetID)
+            , _wallet(wallet)
+            , _addressType(wallet.getAddressTypeSync(assetID))
         {
-            auto addressesFromPoolHelper = [&wallet, assetID](bool isChange) {
-                auto addresses = GetAddressPool(wallet._wallet.get(), assetID,
-                    { wallet.getAddressTypeSync(assetID) }, isChange);
-                std::vector<std::string> result(addresses.size());
-                std::transform(std::begin(addresses), std::end(addresses), std::begin(result),
-                    [](const auto& script) { return std::string(script.begin(), script.end()); });
-                return result;
-            };
-
-            auto usedAddresses = [&wallet, assetID](bool isChange) {
-                auto addresses = wallet._wallet->GetAddressesByAssetID(assetID, isChange);
-                std::vector<std::string> result(addresses.size());
-                std::transform(std::begin(addresses), std::end(addresses), std::begin(result),
-                    [&wallet, assetID](const auto& strAddress) {
-                        auto dest = bitcoin::DecodeDestination(
-                            strAddress, GetChainParams(wallet._assetsModel, assetID));
-                        auto script = bitcoin::GetScriptForDestination(dest);
-                        return std::string(script.begin(), script.end());
-                    });
-                return result;
-            };
+            const auto& params = GetChainParams(wallet._assetsModel, assetID);
+            for (auto isChange : { false, true }) {
+                for (auto&& strAddress : wallet._wallet->GetAddressesByAssetID(assetID, isChange)) {
+                    addScript(bitcoin::GetScriptForDestination(
+                        bitcoin::DecodeDestination(strAddress, params)));
+                }
+            }
 
-            addressList = Utils::Combine(Utils::Combine(usedAddresses(false), usedAddresses(true)),
-                Utils::Combine(addressesFromPoolHelper(false), addressesFromPoolHelper(true)));
+            refresh();
         }
+
         bool match(const BlockIndex& blockIndex) const override
         {
             const auto& encodedFilter = blockIndex.filter();
             if (encodedFilter.isValid()) {
                 bitcoin::Filter::key_t key;
-                auto hashBlock = bitcoin::uint256S(blockIndex.hash().toStdString());
+                auto hashBlock = blockIndex.rawHash();
                 std::memcpy(&key[0], hashBlock.begin(), key.size());
 
-                bitcoin::Filter filter = bitcoin::Filter::FromNMPBytes(
-                    key, encodedFilter.n, encodedFilter.m, encodedFilter.p, encodedFilter.bytes);
-
-                return filter.matchAny(addressList);
+                return bitcoin::Filter::MatchAny(key, encodedFilter.n, encodedFilter.m,
+                    encodedFilter.p, encodedFilter.bytes(), _scripts);
             }
             return false;
         }
 
-        std::vector<std::string> addressList;
-        std::vector<std::string> scriptsList;
+        // Used addresses are only moved out of key pool, so we need to pick up only keys
+        // which were added to key pool when it was topped up.
+        RefreshResult refresh() override
+        {
+            auto result = RefreshResult::Unchanged;
+            for (auto isChange : { false, true }) {
+                for (auto&& keyID : GetKeyIDPool(_wallet._wallet.get(), _assetID, isChange)) {
+                    if (_knownKeys.insert(keyID).second) {
+                        auto dest = AddressFromKeyID(keyID, _addressType);
+                        addScript(bitcoin::GetScriptForDestination(dest));
+                        result = RefreshResult::Updated;
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        // match() only reads collected scripts, so copy is safe to use from other thread
+        BFMatcherUniqueRef clone() const override { return BFMatcherUniqueRef(new Matcher(*this)); }
+
+        void addScript(const bitcoin::CScript& script)
+        {
+            _scripts.add(std::begin(script), std::end(script));
+        }
+
+        const Wallet& _wallet;
+        Enums::AddressType _addressType;
+        std::set<bitcoin::CKeyID> _knownKeys;
+        bitcoin::FilterQuerySet _scripts;
     };
 
     return BFMatcherUniqueRef(new Matcher(assetID, *this));
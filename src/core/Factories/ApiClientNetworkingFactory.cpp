@@ -78,9 +78,14 @@ ApiClientNetworkingFactory::createBlockExplorerClient(AssetID assetID)
     domains.normal = QString("https://xsnexplorer.io/api/%1").arg(assetSuffix);
     domains.tor = QString("https://lightningstake.com/api/%1").arg(assetSuffix);
 
+    // tips are pushed only by explorers of UTXO chains, account chains get heads from web3.
+    bool withTipStream = assetID == BITCOINID || assetID == LITECOINID || assetID == STAKENETID
+        || assetID == DASHCOINID || assetID == GROESTLCOINID;
+
     std::unique_ptr<RequestHandlerImpl> requestHandler(new RequestHandlerImpl(
         _networkAccessManager, NetworkConnectionState::Singleton(), domains));
-    BlockExplorerHttpClient client(new XSNBlockExplorerHttpClient(std::move(requestHandler)));
+    BlockExplorerHttpClient client(
+        new XSNBlockExplorerHttpClient(std::move(requestHandler), withTipStream));
     client->moveToThread(thread());
     //    this produces assert on mingw, commenting it out is a bad idea, but still effect will be
     //    the same because networking factory gets deleted in the end of application.
@@ -110,8 +115,6 @@ AbstractNetworkingFactory::AbstractWeb3ClientPtr ApiClientNetworkingFactory::cre
     AbstractWeb3ClientPtr client(
         new Web3Client(QUrl(QString("wss://%1.infura.io/ws/v3/12535e2cda8c485eae0d513904a3723a")
                                 .arg(eth::ConvertChainId(chainId)))));
-    // TODO: jcon has broken timer, fix is before moving to thread
-//    client->moveToThread(thread());
     client->open();
     return client;
 }
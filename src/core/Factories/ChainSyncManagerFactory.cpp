@@ -9,6 +9,7 @@
 #include <Models/WalletDataSource.hpp>
 #include <Networking/AbstractAccountExplorerHttpClient.hpp>
 #include <Networking/AbstractBlockExplorerHttpClient.hpp>
+#include <Utils/Utils.hpp>
 
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
@@ -17,11 +18,13 @@
 
 ChainSyncManagerFactory::ChainSyncManagerFactory(QPointer<WalletAssetsModel> assetsModel,
     QPointer<AbstractNetworkingFactory> networkingFactory, Utils::WorkerThread& workerThread,
-    WalletDataSource& dataSource, AccountDataSource& accountDataSource,
-    AbstractChainDataSource& chainDataSource, AssetsTransactionsCache& txCache,
-    AssetsAccountsCache& accountsCashe, const BlockFilterMatchable& filterMatcher, QObject* parent)
+    Utils::KeyedWorkerThreads& assetWorkers, WalletDataSource& dataSource,
+    AccountDataSource& accountDataSource, AbstractChainDataSource& chainDataSource,
+    AssetsTransactionsCache& txCache, AssetsAccountsCache& accountsCashe,
+    const BlockFilterMatchable& filterMatcher, QObject* parent)
     : AbstractChainSyncManagerFactory(assetsModel, networkingFactory, parent)
     , _workerThread(workerThread)
+    , _assetWorkers(assetWorkers)
     , _dataSource(dataSource)
     , _accountDataSource(accountDataSource)
     , _chainDataSource(chainDataSource)
@@ -75,8 +78,12 @@ AbstractChainSyncManagerPtr ChainSyncManagerFactory::createSyncManager(Chain& ch
     AbstractChainSyncManagerPtr chainSyncManager;
     if (assetsModel() && networkingFactory()) {
         //        auto apiClient = networkingFactory()->createBlockExplorerClient(chain.assetID());
-        chainSyncManager.reset(new T(chain, _transactionsCache, _dataSource, _filterMatcher,
-            assetsModel()->assetById(chain.assetID()), _chainDataSource, nullptr));
+        auto syncManager = new T(chain, _transactionsCache, _dataSource, _filterMatcher,
+            assetsModel()->assetById(chain.assetID()), _chainDataSource, nullptr);
+        // wallet state is shared between assets so sync stays on main worker, filter matching
+        // is the cpu heavy part which can run on asset's own worker.
+        syncManager->setMatchingContext(_assetWorkers.threadFor(chain.assetID()).context());
+        chainSyncManager.reset(syncManager);
 
         chainSyncManager->moveToThread(&_workerThread);
     }
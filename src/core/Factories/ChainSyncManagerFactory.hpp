@@ -6,6 +6,7 @@
 
 namespace Utils {
 class WorkerThread;
+class KeyedWorkerThreads;
 }
 
 class WalletDataSource;
@@ -19,10 +20,10 @@ class ChainSyncManagerFactory : public AbstractChainSyncManagerFactory {
 public:
     explicit ChainSyncManagerFactory(QPointer<WalletAssetsModel> assetsModel,
         QPointer<AbstractNetworkingFactory> networkingFactory, Utils::WorkerThread& workerThread,
-        WalletDataSource& dataSource, AccountDataSource& accountDataSource,
-        AbstractChainDataSource& chainDataSource, AssetsTransactionsCache& txCache,
-        AssetsAccountsCache& accountsCashe, const BlockFilterMatchable& filterMatcher,
-        QObject* parent = nullptr);
+        Utils::KeyedWorkerThreads& assetWorkers, WalletDataSource& dataSource,
+        AccountDataSource& accountDataSource, AbstractChainDataSource& chainDataSource,
+        AssetsTransactionsCache& txCache, AssetsAccountsCache& accountsCashe,
+        const BlockFilterMatchable& filterMatcher, QObject* parent = nullptr);
 
     AbstractChainSyncManagerPtr createAPISyncManager(Chain& chain) override;
     AbstractChainSyncManagerPtr createRescanSyncManager(Chain& chain) override;
@@ -33,6 +34,7 @@ private:
 
 private:
     Utils::WorkerThread& _workerThread;
+    Utils::KeyedWorkerThreads& _assetWorkers;
     WalletDataSource& _dataSource;
     AccountDataSource& _accountDataSource;
     AbstractChainDataSource& _chainDataSource;
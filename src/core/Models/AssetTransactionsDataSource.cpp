@@ -3,20 +3,44 @@
 
 //==============================================================================
 
-template <class Container> static int IndexOf(const Container& where, const Transaction& tx)
+// identifies transaction across updates, updated transactions can come as new objects
+static QString TransactionKey(const Transaction& tx)
 {
-    auto it = std::find(std::begin(where), std::end(where), tx);
+    struct Visitor {
+        QString operator()(const OnChainTxRef& tx) const { return "onchain:" + tx->txId(); }
+        QString operator()(const LightningPaymentRef& tx) const
+        {
+            return "payment:" + QString::number(tx->paymentIndex());
+        }
+        QString operator()(const LightningInvoiceRef& tx) const
+        {
+            return "invoice:" + QString::number(tx->addIndex());
+        }
+        QString operator()(const EthOnChainTxRef& tx) const { return "eth:" + tx->txId(); }
+        QString operator()(const ConnextPaymentRef& tx) const
+        {
+            return "connext:" + tx->transferId();
+        }
+    };
 
-    return it == std::end(where) ? -1 : std::distance(std::begin(where), it);
+    return boost::variant2::visit(Visitor{}, tx);
 }
 
 //==============================================================================
 
-AssetTransactionsDataSource::AssetTransactionsDataSource(
-    AssetID assetID, QPointer<AbstractTransactionsCache> dataSource, QObject* parent)
+static qint64 TransactionTime(const Transaction& tx)
+{
+    return TransactionUtils::TransactionDate(tx).toMSecsSinceEpoch();
+}
+
+//==============================================================================
+
+AssetTransactionsDataSource::AssetTransactionsDataSource(AssetID assetID,
+    QPointer<AbstractTransactionsCache> dataSource, size_t pageSize, QObject* parent)
     : QObject(parent)
     , _dataSource(dataSource)
     , _assetID(assetID)
+    , _pageSize(pageSize)
 {
     connect(dataSource, &AbstractTransactionsCache::txnsAdded, this,
         &AssetTransactionsDataSource::onTransactionAdded);
@@ -28,14 +52,69 @@ AssetTransactionsDataSource::AssetTransactionsDataSource(
 
 void AssetTransactionsDataSource::fetchTransactions()
 {
-    _dataSource->transactionsList().then([this](TransactionsList transactions) {
-        _transactions = transactions;
+    if (_pageSize == 0) {
+        _dataSource->transactionsList().then([this](TransactionsList transactions) {
+            assign(std::move(transactions));
+            transactionsFetched();
+        });
+        return;
+    }
+
+    _fetchingPage = true;
+    _dataSource->transactionsPage(0, _pageSize).then([this](TransactionsPage page) {
+        _fetchingPage = false;
+        _fetchedOffset = page.transactions.size();
+        _total = page.total;
+        _oldestFetchedTime = page.transactions.empty()
+            ? std::numeric_limits<qint64>::max()
+            : TransactionTime(page.transactions.back());
+        assign(std::move(page.transactions));
         transactionsFetched();
     });
 }
 
 //==============================================================================
 
+bool AssetTransactionsDataSource::canFetchMore() const
+{
+    return _pageSize > 0 && !_fetchingPage && _fetchedOffset < _total;
+}
+
+//==============================================================================
+
+void AssetTransactionsDataSource::fetchMore()
+{
+    if (!canFetchMore()) {
+        return;
+    }
+
+    _fetchingPage = true;
+    _dataSource->transactionsPage(_fetchedOffset, _pageSize).then([this](TransactionsPage page) {
+        _fetchingPage = false;
+        // new transactions could have been added while page was fetched, skip the ones that we
+        // already have.
+        std::vector<Transaction> txns;
+        for (auto&& tx : page.transactions) {
+            if (_indexes.count(TransactionKey(tx)) == 0) {
+                txns.emplace_back(tx);
+            }
+        }
+
+        _fetchedOffset = page.offset + page.transactions.size();
+        _total = page.total;
+        if (!page.transactions.empty()) {
+            _oldestFetchedTime = TransactionTime(page.transactions.back());
+        }
+
+        if (!txns.empty()) {
+            append(txns);
+            pageFetched(txns);
+        }
+    });
+}
+
+//==============================================================================
+
 const TransactionsList& AssetTransactionsDataSource::transactionsList() const
 {
     return _transactions;
@@ -55,11 +134,11 @@ void AssetTransactionsDataSource::onTransactionChanged(std::vector<Transaction>
     std::vector<Transaction> filtered;
     std::vector<int> indexes;
     for (auto&& tx : txns) {
-        auto index = IndexOf(_transactions, tx);
-        if (index >= 0) {
-            _transactions[index].swap(tx);
+        auto it = _indexes.find(TransactionKey(tx));
+        if (it != _indexes.end()) {
+            _transactions[it->second] = tx;
             filtered.emplace_back(tx);
-            indexes.emplace_back(index);
+            indexes.emplace_back(static_cast<int>(it->second));
         }
     }
 
@@ -69,10 +148,45 @@ void AssetTransactionsDataSource::onTransactionChanged(std::vector<Transaction>
 //==============================================================================
 
 void AssetTransactionsDataSource::onTransactionAdded(std::vector<Transaction> txns)
+{
+    bool allFetched = _pageSize == 0 || _fetchedOffset >= _total;
+    _total += txns.size();
+
+    if (!allFetched) {
+        // added transactions don't have to be the newest ones (e.g. found by rescan). Only those
+        // which are newer than oldest fetched one shift fetched window, older ones will come with
+        // one of next pages. Transactions with the same time aren't counted, page that repeats
+        // them is deduplicated while window which moved too far would skip them.
+        auto outside = std::stable_partition(std::begin(txns), std::end(txns),
+            [this](const auto& tx) { return TransactionTime(tx) > _oldestFetchedTime; });
+        txns.erase(outside, std::end(txns));
+        _fetchedOffset += txns.size();
+    }
+
+    if (!txns.empty()) {
+        append(txns);
+        txnsAdded(txns);
+    }
+}
+
+//==============================================================================
+
+void AssetTransactionsDataSource::assign(TransactionsList transactions)
+{
+    _transactions.clear();
+    _indexes.clear();
+    append(transactions);
+}
+
+//==============================================================================
+
+void AssetTransactionsDataSource::append(const std::vector<Transaction>& txns)
 {
     _transactions.reserve(_transactions.size() + txns.size());
-    std::copy(std::begin(txns), std::end(txns), std::back_inserter(_transactions));
-    txnsAdded(txns);
+    for (auto&& tx : txns) {
+        _indexes.emplace(TransactionKey(tx), _transactions.size());
+        _transactions.emplace_back(tx);
+    }
 }
 
 //==============================================================================
@@ -5,21 +5,28 @@
 #include <Tools/Common.hpp>
 
 #include <QObject>
+#include <limits>
+#include <unordered_map>
 
 class AbstractTransactionsCache;
 
 class AssetTransactionsDataSource : public QObject {
     Q_OBJECT
 public:
-    explicit AssetTransactionsDataSource(
-        AssetID assetID, QPointer<AbstractTransactionsCache> dataSource, QObject* parent = nullptr);
+    // pageSize == 0 means that whole history is fetched at once
+    explicit AssetTransactionsDataSource(AssetID assetID,
+        QPointer<AbstractTransactionsCache> dataSource, size_t pageSize = 0,
+        QObject* parent = nullptr);
     void fetchTransactions();
+    bool canFetchMore() const;
+    void fetchMore();
 
     const TransactionsList& transactionsList() const;
     AssetID assetID() const;
 
 signals:
     void transactionsFetched();
+    void pageFetched(const std::vector<Transaction>& txns);
     void txnsAdded(const std::vector<Transaction>& tx);
     void txnsChanged(const std::vector<Transaction>& tx, std::vector<int> indexes);
 
@@ -27,10 +34,23 @@ private slots:
     void onTransactionAdded(std::vector<Transaction> txns);
     void onTransactionChanged(std::vector<Transaction> txns);
 
+private:
+    void assign(TransactionsList transactions);
+    void append(const std::vector<Transaction>& txns);
+
 private:
     QPointer<AbstractTransactionsCache> _dataSource;
     AssetID _assetID;
     TransactionsList _transactions;
+    std::unordered_map<QString, size_t> _indexes; // transaction key -> index in _transactions
+    size_t _pageSize{ 0 };
+    // how many transactions from newest first order were fetched so far
+    size_t _fetchedOffset{ 0 };
+    size_t _total{ 0 };
+    // time of the oldest transaction in fetched pages, transactions added later which are older
+    // than that are outside of fetched window
+    qint64 _oldestFetchedTime{ std::numeric_limits<qint64>::max() };
+    bool _fetchingPage{ false };
 };
 
 #endif // ASSETTRANSACTIONSDATASOURCE_HPP
@@ -45,7 +45,9 @@
 #include <ViewModels/WalletViewModel.hpp>
 
 #include <QDir>
+#include <QPointer>
 #include <QStandardPaths>
+#include <QThread>
 #include <key_io.h>
 #include <script/standard.h>
 
@@ -397,8 +399,9 @@ void Context::initSyncService()
     Q_ASSERT(_walletAssetsModel);
     Q_ASSERT(_walletDataSource);
     Q_ASSERT(_workerThread);
-    _syncService.reset(new SyncService(
-        *_syncManagersFactory, *_chainManager, *_walletAssetsModel, *_walletDataSource));
+    Q_ASSERT(_chainDataSource);
+    _syncService.reset(new SyncService(*_syncManagersFactory, *_chainManager, *_walletAssetsModel,
+        *_walletDataSource, *_chainDataSource));
 }
 
 //==============================================================================
@@ -426,8 +429,9 @@ void Context::initFactories()
             *_filterMatcher, *_emulatorViewModel));
     } else {
         _syncManagersFactory.reset(new ChainSyncManagerFactory(_walletAssetsModel,
-            _apiClientsFactory.get(), *_workerThread, *walletDataSource(), *accountDataSource(),
-            *_chainDataSource, *transactionsCache(), *accountsCache(), *_filterMatcher));
+            _apiClientsFactory.get(), *_workerThread, *_assetWorkers, *walletDataSource(),
+            *accountDataSource(), *_chainDataSource, *transactionsCache(), *accountsCache(),
+            *_filterMatcher));
     }
 }
 
@@ -471,13 +475,22 @@ void Context::initChainManager()
     } else {
         Q_ASSERT(_apiClientsFactory);
         Q_ASSERT(_transactionsCache);
-        _chainManager.reset(new ChainManager(
-            *_walletAssetsModel, GetChainIndexDir(ApplicationViewModel::IsEmulated())));
+        _chainManager.reset(new ChainManager(*_walletAssetsModel,
+            GetChainIndexDir(ApplicationViewModel::IsEmulated()),
+            [cache = QPointer<AssetsTransactionsCache>(_transactionsCache.get())] {
+                // checkpoint runs on chain manager's thread, cache has to live on the same one
+                if (cache) {
+                    Q_ASSERT_X(cache->thread() == QThread::currentThread(), "FlushCheckpoint",
+                        "Transactions cache is used from different thread");
+                    cache->checkpointSync();
+                }
+            }));
         _chainManager->moveToThread(_workerThread.get());
 
         Q_ASSERT(_chainManager);
-        _chainDataSource.reset(new CachedChainDataSource(
-            *_apiClientsFactory, *_walletAssetsModel, *_transactionsCache, *_chainManager));
+        _chainDataSource.reset(new CachedChainDataSource(*_apiClientsFactory,
+            *_walletAssetsModel, *_transactionsCache, *_chainManager,
+            GetDataDir(ApplicationViewModel::IsEmulated()).absoluteFilePath("chain/headers")));
         _chainDataSource->moveToThread(_workerThread.get());
     }
 }
@@ -489,6 +502,7 @@ void Context::initWorkerThread()
     _workerThread.reset(new Utils::WorkerThread);
     _workerThread->rename("Stakenet-MainWorker");
     _workerThread->start();
+    _assetWorkers.reset(new Utils::KeyedWorkerThreads("Stakenet-AssetWorker"));
 }
 
 //==============================================================================
@@ -106,6 +106,8 @@ private:
 
 private:
     std::shared_ptr<Utils::WorkerThread> _networkConnectionThread;
+    // declared before main worker so that it outlives jobs which main worker posts to it
+    std::unique_ptr<Utils::KeyedWorkerThreads> _assetWorkers;
     std::unique_ptr<Utils::WorkerThread> _workerThread;
     std::unique_ptr<LocalCurrency> _localCurrency;
     std::unique_ptr<AssetsRemotePriceModel> _currencyRates;
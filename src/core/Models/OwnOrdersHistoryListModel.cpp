@@ -4,13 +4,39 @@
 #include <Utils/Utils.hpp>
 #include <Tools/Common.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <variant>
 
 //==============================================================================
 
+// archived deals are loaded in windows of creation time, newest first
+static const int64_t HISTORY_WINDOW_MS = 30ll * 24 * 60 * 60 * 1000;
+
+//==============================================================================
+
+static std::vector<swaps::SwapDeal> HistoryDeals(const std::vector<swaps::SwapDeal>& deals)
+{
+    std::vector<swaps::SwapDeal> result;
+    for (auto&& deal : deals) {
+        if (deal.phase == swaps::SwapPhase::SwapCompleted
+            || deal.phase == swaps::SwapPhase::PaymentReceived) {
+            result.emplace_back(deal);
+        }
+    }
+
+    return result;
+}
+
+//==============================================================================
+
 struct OwnOrdersHistoryListModel::Impl {
     using Data = std::variant<swaps::SwapDeal, storage::RefundableFee>;
     std::vector<Data> data;
+    // archived deals created at or after this time are loaded
+    int64_t loadedFromTime{ std::numeric_limits<int64_t>::max() };
+    boost::optional<int64_t> oldestArchivedTime;
+    bool fetching{ true };
 };
 
 //==============================================================================
@@ -174,21 +200,19 @@ void OwnOrdersHistoryListModel::init()
     connect(_feeManager, &swaps::RefundableFeeManager::refundableFeeAdded, this, onFeeAdded);
     connect(_feeManager, &swaps::RefundableFeeManager::refundableFeeBurnt, this, onFeeBurnt);
 
-    using PromiseResult
-        = std::tuple<std::vector<swaps::SwapDeal>, std::vector<storage::RefundableFee>>;
+    using PromiseResult = std::tuple<std::vector<swaps::SwapDeal>,
+        std::vector<storage::RefundableFee>, int64_t, boost::optional<int64_t>>;
 
     auto promise = Promise<PromiseResult>(
         [rep = _repostiry, feeManager = _feeManager](const auto& resolve, const auto&) {
             QMetaObject::invokeMethod(rep, [=] {
-                std::vector<swaps::SwapDeal> result;
-                for (auto&& deal : rep->deals()) {
-                    if (deal.phase == swaps::SwapPhase::SwapCompleted
-                        || deal.phase == swaps::SwapPhase::PaymentReceived) {
-                        result.emplace_back(deal);
-                    }
-                }
-
-                resolve(PromiseResult{ result, feeManager->state()->fees() });
+                auto fromTime = QDateTime::currentMSecsSinceEpoch() - HISTORY_WINDOW_MS;
+                auto deals = rep->archivedDeals(fromTime, std::numeric_limits<int64_t>::max());
+                auto active = rep->activeDeals();
+                deals.insert(std::end(deals), std::begin(active), std::end(active));
+
+                resolve(PromiseResult{ HistoryDeals(deals), feeManager->state()->fees(), fromTime,
+                    rep->oldestArchivedTime() });
             });
         });
 
@@ -204,9 +228,68 @@ void OwnOrdersHistoryListModel::init()
 
         cpy(std::get<0>(values));
         cpy(std::get<1>(values));
+        _impl->loadedFromTime = std::get<2>(values);
+        _impl->oldestArchivedTime = std::get<3>(values);
+        _impl->fetching = false;
 
         this->endResetModel();
     });
 }
 
 //==============================================================================
+
+void OwnOrdersHistoryListModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    _impl->fetching = true;
+    using PromiseResult = std::tuple<std::vector<swaps::SwapDeal>, int64_t>;
+
+    auto promise = Promise<PromiseResult>([rep = _repostiry, toTime = _impl->loadedFromTime,
+                                              oldestTime = *_impl->oldestArchivedTime](
+                                              const auto& resolve, const auto&) {
+        QMetaObject::invokeMethod(rep, [=] {
+            auto fromTime = toTime;
+            std::vector<swaps::SwapDeal> deals;
+            // history can have long gaps without trading, window is moved further back until it
+            // reaches some deals.
+            while (deals.empty() && fromTime > oldestTime) {
+                auto windowEnd = fromTime;
+                fromTime = std::max(oldestTime, fromTime - HISTORY_WINDOW_MS);
+                deals = HistoryDeals(rep->archivedDeals(fromTime, windowEnd));
+            }
+
+            resolve(PromiseResult{ deals, fromTime });
+        });
+    });
+
+    QPointer<OwnOrdersHistoryListModel> self(this);
+    promise.then([self](PromiseResult values) {
+        if (!self) {
+            return;
+        }
+
+        const auto& deals = std::get<0>(values);
+        if (!deals.empty()) {
+            auto first = self->rowCount();
+            self->beginInsertRows({}, first, first + static_cast<int>(deals.size()) - 1);
+            std::copy(std::begin(deals), std::end(deals), std::back_inserter(self->_impl->data));
+            self->endInsertRows();
+        }
+
+        self->_impl->loadedFromTime = std::get<1>(values);
+        self->_impl->fetching = false;
+    });
+}
+
+//==============================================================================
+
+bool OwnOrdersHistoryListModel::canFetchMore(const QModelIndex&) const
+{
+    return !_impl->fetching && _impl->oldestArchivedTime
+        && *_impl->oldestArchivedTime < _impl->loadedFromTime;
+}
+
+//==============================================================================
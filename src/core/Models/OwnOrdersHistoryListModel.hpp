@@ -37,6 +37,8 @@ public:
     virtual int rowCount(const QModelIndex& parent = {}) const override final;
     virtual QVariant data(const QModelIndex& index, int role) const override final;
     virtual QHash<int, QByteArray> roleNames() const override final;
+    void fetchMore(const QModelIndex& parent) override;
+    bool canFetchMore(const QModelIndex& parent) const override;
 
 signals:
 
@@ -1,4 +1,5 @@
 #include "SyncService.hpp"
+#include <Chain/AbstractChainDataSource.hpp>
 #include <Chain/AbstractChainManager.hpp>
 #include <Chain/AbstractChainSyncManager.hpp>
 #include <Data/WalletAssetsModel.hpp>
@@ -19,19 +20,31 @@ static const QString SYNCED("SYNCED");
 static const QString RESCAN("RESCAN");
 }
 
+// Synced assets are resynced by timer only as a fallback, tips are pushed by chain data source
+// while its stream is up.
+static const int SCHEDULE_INTERVAL_MS = 2000;
+static const qint64 RESYNC_INTERVAL_SECS = 20;
+static const qint64 RESYNC_INTERVAL_STREAM_UP_SECS = 600;
+
 //==============================================================================
 
 SyncService::SyncService(AbstractChainSyncManagerFactory& syncManagerFactory,
     const AbstractMutableChainManager& chainManager, const WalletAssetsModel& assetModel,
-    const WalletDataSource& dataSource, QObject* parent)
+    const WalletDataSource& dataSource, AbstractChainDataSource& chainDataSource,
+    QObject* parent)
     : QObject(parent)
     , _dataSource(dataSource)
+    , _chainDataSource(chainDataSource)
     , _syncManagerFactory(syncManagerFactory)
     , _assetModel(assetModel)
     , _chainManager(chainManager)
 {
     _syncTimer = new QTimer(this);
     connect(_syncTimer, &QTimer::timeout, this, &SyncService::scheduleSync);
+    connect(&_chainDataSource, &AbstractChainDataSource::tipNotified, this,
+        [this](AssetID assetID, BlockHash, BlockHeight) { onTipNotified(assetID); });
+    connect(&_chainDataSource, &AbstractChainDataSource::tipStreamStateChanged, this,
+        &SyncService::onTipStreamStateChanged);
 }
 
 //==============================================================================
@@ -43,7 +56,7 @@ SyncService::~SyncService() {}
 void SyncService::start()
 {
     LogCDebug(Sync) << "Starting SyncService";
-    _syncTimer->start(2000);
+    _syncTimer->start(SCHEDULE_INTERVAL_MS);
 }
 
 //==============================================================================
@@ -52,6 +65,7 @@ void SyncService::stop()
 {
     _syncTimer->stop();
     _currentSyncProcessor.clear();
+    _pendingTips.clear();
     syncStopped();
 }
 
@@ -122,12 +136,16 @@ void SyncService::scheduleSync()
 
                 rescanChain(asset);
             } else if (state == SyncState::SYNCED) {
-                if (_syncState.at(id).second.secsTo(QDateTime::currentDateTimeUtc()) > 20) {
+                auto interval = _tipStreamConnected.count(id) > 0
+                    ? RESYNC_INTERVAL_STREAM_UP_SECS
+                    : RESYNC_INTERVAL_SECS;
+                if (_syncState.at(id).second.secsTo(QDateTime::currentDateTimeUtc()) > interval) {
                     startSync(asset);
                 }
             }
         } else {
             _syncState.emplace(id, std::make_pair(SyncState::INITIAL, QDateTime()));
+            _chainDataSource.subscribeTips(id);
             startSync(asset);
         }
     }
@@ -135,6 +153,39 @@ void SyncService::scheduleSync()
 
 //==============================================================================
 
+void SyncService::onTipNotified(AssetID assetID)
+{
+    if (!isActive() || _syncState.count(assetID) == 0) {
+        return;
+    }
+
+    if (_currentSyncProcessor.count(assetID) > 0) {
+        _pendingTips.insert(assetID);
+        return;
+    }
+
+    if (_syncState.at(assetID).first == SyncState::SYNCED) {
+        LogCDebug(Sync) << "New tip notified, syncing" << assetID;
+        startSync(_assetModel.assetById(assetID));
+    }
+}
+
+//==============================================================================
+
+void SyncService::onTipStreamStateChanged(AssetID assetID, bool connected)
+{
+    LogCDebug(Sync) << "Tip stream for" << assetID << (connected ? "connected" : "disconnected");
+    if (connected) {
+        _tipStreamConnected.insert(assetID);
+        // catch up with tips which could have been missed while stream was down.
+        onTipNotified(assetID);
+    } else {
+        _tipStreamConnected.erase(assetID);
+    }
+}
+
+//==============================================================================
+
 void SyncService::startSync(CoinAsset coinAsset)
 {
     LogCDebug(Sync) << "Starting sync for coin" << coinAsset.name();
@@ -144,6 +195,12 @@ void SyncService::startSync(CoinAsset coinAsset)
         }
 
         _syncState[id] = { SyncState::SYNCED, QDateTime::currentDateTimeUtc() };
+
+        // tip arrived while we were syncing, it might have not been included.
+        if (_pendingTips.erase(id) > 0) {
+            QMetaObject::invokeMethod(
+                this, [this, id] { onTipNotified(id); }, Qt::QueuedConnection);
+        }
     };
 
     AbstractSyncProcessorPtr syncProcessor(
@@ -235,6 +292,12 @@ AbstractChainSyncManager& SyncService::chainSyncManager(AssetID assetID, bool re
             std::make_pair(rescan ? _syncManagerFactory.createRescanSyncManager(chain)
                                   : _syncManagerFactory.createAPISyncManager(chain),
                 rescan));
+
+        auto syncManager = _syncManagerMap.at(assetID).first.get();
+        connect(syncManager, &AbstractChainSyncManager::tipNotified, this,
+            [this, assetID] { onTipNotified(assetID); });
+        connect(syncManager, &AbstractChainSyncManager::tipStreamStateChanged, this,
+            [this, assetID](bool connected) { onTipStreamStateChanged(assetID, connected); });
     }
 
     // Store only one sync manager, rescan or api, if it's different then delete old and recreate.
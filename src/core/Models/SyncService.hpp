@@ -9,6 +9,7 @@
 #include <QPointer>
 #include <QSet>
 #include <memory>
+#include <set>
 #include <unordered_map>
 
 class QTimer;
@@ -16,6 +17,7 @@ class AbstractChainSyncManagerFactory;
 class AbstractChainSyncManager;
 class WalletAssetsModel;
 class AbstractMutableChainManager;
+class AbstractChainDataSource;
 class SyncStateProvider;
 class WalletDataSource;
 
@@ -68,7 +70,8 @@ class SyncService : public QObject {
 public:
     explicit SyncService(AbstractChainSyncManagerFactory& syncManagerFactory,
         const AbstractMutableChainManager& chainManager, const WalletAssetsModel& assetModel,
-        const WalletDataSource& dataSource, QObject* parent = nullptr);
+        const WalletDataSource& dataSource, AbstractChainDataSource& chainDataSource,
+        QObject* parent = nullptr);
     virtual ~SyncService();
 
     void start();
@@ -92,6 +95,8 @@ signals:
 private slots:
     void onCurrentSyncProcessorTaskFinished(AssetID id);
     void scheduleSync();
+    void onTipNotified(AssetID assetID);
+    void onTipStreamStateChanged(AssetID assetID, bool connected);
 
 private:
     AbstractChainSyncManager& chainSyncManager(AssetID assetID, bool rescan);
@@ -113,6 +118,7 @@ private:
 
     QTimer* _syncTimer = nullptr;
     const WalletDataSource& _dataSource;
+    AbstractChainDataSource& _chainDataSource;
     std::map<AssetID, std::pair<QString, QDateTime>> _syncState;
     AbstractChainSyncManagerFactory& _syncManagerFactory;
     std::unordered_map<AssetID, ChainSyncManagerEntry> _syncManagerMap;
@@ -120,6 +126,8 @@ private:
     const WalletAssetsModel& _assetModel;
     const AbstractMutableChainManager& _chainManager;
     std::unordered_map<AssetID, SyncStateProviderPtr> _assetSyncProviders;
+    std::set<AssetID> _tipStreamConnected;
+    std::set<AssetID> _pendingTips;
 };
 
 //==============================================================================
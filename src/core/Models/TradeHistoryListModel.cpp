@@ -5,7 +5,7 @@
 
 //==============================================================================
 
-static Trade Convert(io::stakenet::orderbook::protos::Trade trade)
+static Trade Convert(const io::stakenet::orderbook::protos::Trade& trade)
 {
     return Trade(QString::fromStdString(trade.id()), orderbook::ConvertBigInt(trade.size()),
         orderbook::ConvertBigInt(trade.price()), QDateTime::fromMSecsSinceEpoch(trade.executedon()),
@@ -98,13 +98,18 @@ void TradeHistoryListModel::onHistoricTradesFetched()
 
     auto lastTradeId = _lastTradeId;
 
-    auto promise = Promise<orderbook::TradingOrdersModel::HistoricTrades>(
-        [this, lastTradeId](const auto& resolve, const auto&) {
-            QMetaObject::invokeMethod(
-                _ordersModel, [=] { resolve(_ordersModel->historicTrades(_pairId, lastTradeId)); });
-        });
-
-    promise.then([self, lastTradeId](orderbook::TradingOrdersModel::HistoricTrades trades) {
+    // trades are converted right from order book's buffer, without intermediate copy
+    auto promise
+        = Promise<std::vector<Trade>>([this, lastTradeId](const auto& resolve, const auto&) {
+              QMetaObject::invokeMethod(_ordersModel, [=] {
+                  std::vector<Trade> trades;
+                  _ordersModel->traverseHistoricTrades(_pairId, lastTradeId,
+                      [&trades](const auto& trade) { trades.emplace_back(Convert(trade)); });
+                  resolve(trades);
+              });
+          });
+
+    promise.then([self, lastTradeId](std::vector<Trade> trades) {
         if (!self) {
             return;
         }
@@ -114,7 +119,7 @@ void TradeHistoryListModel::onHistoricTradesFetched()
             return;
         }
 
-        auto firstId = QString::fromStdString(trades.begin()->id());
+        auto firstId = trades.front().id;
         auto it = std::find_if(std::begin(self->_trades), std::end(self->_trades),
             [firstId](const auto& trade) { return trade.id == firstId; });
 
@@ -124,10 +129,8 @@ void TradeHistoryListModel::onHistoricTradesFetched()
 
         auto rows = self->rowCount();
         self->beginInsertRows(QModelIndex(), rows, rows + trades.size() - 1);
-        self->_trades.resize(rows + trades.size());
-        std::transform(
-            std::begin(trades), std::end(trades), std::begin(self->_trades) + rows, Convert);
-        self->_lastTradeId = trades.back().id();
+        self->_lastTradeId = trades.back().id.toStdString();
+        std::move(std::begin(trades), std::end(trades), std::back_inserter(self->_trades));
         self->endInsertRows();
     });
 }
@@ -8,7 +8,9 @@
 #include <Utils/Logging.hpp>
 
 #include <QVector>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 //==============================================================================
 
@@ -225,6 +227,23 @@ static QString GetStatus(
         : (isFailed ? "failed"
                     : (confirmations >= confirmationsForApproved ? "success" : "pending"));
 }
+
+//==============================================================================
+
+// only on chain transactions depend on chain tip, 0 when transaction is not mined
+static int64_t BlockHeight(const Transaction& transaction)
+{
+    if (auto tx = boost::variant2::get_if<OnChainTxRef>(&transaction)) {
+        return (*tx)->blockHeight();
+    }
+
+    if (auto tx = boost::variant2::get_if<EthOnChainTxRef>(&transaction)) {
+        return (*tx)->blockHeight();
+    }
+
+    return 0;
+}
+
 //==============================================================================
 
 WalletTransactionsListModel::WalletTransactionsListModel(
@@ -252,6 +271,28 @@ int WalletTransactionsListModel::rowCount(const QModelIndex& parent) const
 
 //==============================================================================
 
+bool WalletTransactionsListModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (parent.isValid() || !_dataSource) {
+        return false;
+    }
+
+    return _dataSource->canFetchMore();
+}
+
+//==============================================================================
+
+void WalletTransactionsListModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid() || !_dataSource) {
+        return;
+    }
+
+    _dataSource->fetchMore();
+}
+
+//==============================================================================
+
 QVariant WalletTransactionsListModel::data(const QModelIndex& index, int role) const
 {
     if (!index.isValid())
@@ -538,6 +579,7 @@ void WalletTransactionsListModel::onTransactionsFetched()
     updateConfirmations();
     beginResetModel();
     _rowCount = _dataSource->transactionsList().size();
+    resetConfirmingRows();
     endResetModel();
 }
 
@@ -549,16 +591,30 @@ void WalletTransactionsListModel::onTxnsAdded(const std::vector<Transaction>& tx
     int rows = rowCount(QModelIndex());
     beginInsertRows(QModelIndex(), rows, rows + txns.size() - 1);
     _rowCount += txns.size();
+    _confirmingRowHeights.resize(_rowCount, 0);
+    for (int row = rows; row < static_cast<int>(_rowCount); ++row) {
+        indexConfirmingRow(row);
+    }
     endInsertRows();
 }
 
 //==============================================================================
 
+void WalletTransactionsListModel::onPageFetched(const std::vector<Transaction>& txns)
+{
+    // older transactions are appended to the end, proxy model takes care of ordering
+    onTxnsAdded(txns);
+}
+
+//==============================================================================
+
 void WalletTransactionsListModel::onTxnsChanged(
     const std::vector<Transaction>& txns, std::vector<int> indexes)
 {
     Q_UNUSED(txns)
     for (auto i : indexes) {
+        // transaction could have been mined or reorged out
+        indexConfirmingRow(i);
         auto row = index(i);
         dataChanged(row, row);
     }
@@ -569,10 +625,7 @@ void WalletTransactionsListModel::onTxnsChanged(
 void WalletTransactionsListModel::updateConfirmations()
 {
     if (_chainView) {
-        _chainView->chainHeight().then([=](size_t newHeight) {
-            _tipHeight = newHeight;
-            dataChanged(index(0), index(rowCount(QModelIndex()) - 1));
-        });
+        _chainView->chainHeight().then([=](size_t newHeight) { onTipHeightChanged(newHeight); });
     }
 }
 
@@ -605,6 +658,8 @@ void WalletTransactionsListModel::init()
             &WalletTransactionsListModel::onTransactionsFetched);
         connect(_dataSource, &AssetTransactionsDataSource::txnsAdded, this,
             &WalletTransactionsListModel::onTxnsAdded);
+        connect(_dataSource, &AssetTransactionsDataSource::pageFetched, this,
+            &WalletTransactionsListModel::onPageFetched);
         connect(_dataSource, &AssetTransactionsDataSource::txnsChanged, this,
             &WalletTransactionsListModel::onTxnsChanged);
         connect(_chainManager, &AbstractChainManager::chainsLoaded, this,
@@ -616,6 +671,86 @@ void WalletTransactionsListModel::init()
 
 //==============================================================================
 
+void WalletTransactionsListModel::onTipHeightChanged(size_t newHeight)
+{
+    const auto oldTip = static_cast<int64_t>(_tipHeight);
+    const auto newTip = static_cast<int64_t>(newHeight);
+    _tipHeight = newHeight;
+
+    // capped confirmations of rows at or below this height are the same for both tips
+    const int64_t unchangedHeight = std::min(oldTip, newTip) - CONFIRMATIONS_DISPLAY_CAP + 1;
+    const auto lastRow = std::numeric_limits<int>::max();
+    auto changed = _confirmingRows.upper_bound({ unchangedHeight, lastRow });
+    std::vector<int> rows;
+    for (auto it = changed; it != _confirmingRows.end(); ++it) {
+        rows.emplace_back(it->second);
+    }
+
+    pruneConfirmedRows();
+
+    std::sort(rows.begin(), rows.end());
+    static const QVector<int> roles{ StatusRole, TxDataRole };
+    for (size_t first = 0; first < rows.size();) {
+        size_t last = first;
+        while (last + 1 < rows.size() && rows[last + 1] == rows[last] + 1) {
+            ++last;
+        }
+
+        dataChanged(index(rows[first]), index(rows[last]), roles);
+        first = last + 1;
+    }
+}
+
+//==============================================================================
+
+void WalletTransactionsListModel::resetConfirmingRows()
+{
+    _confirmingRows.clear();
+    _confirmingRowHeights.assign(_rowCount, 0);
+    for (int row = 0; row < static_cast<int>(_rowCount); ++row) {
+        indexConfirmingRow(row);
+    }
+}
+
+//==============================================================================
+
+void WalletTransactionsListModel::indexConfirmingRow(int row)
+{
+    auto& indexedHeight = _confirmingRowHeights.at(static_cast<size_t>(row));
+    if (indexedHeight > 0) {
+        _confirmingRows.erase({ indexedHeight, row });
+        indexedHeight = 0;
+    }
+
+    auto height = BlockHeight(_dataSource->transactionsList().at(static_cast<size_t>(row)));
+    auto tip = static_cast<int64_t>(_tipHeight);
+    if (height > 0 && (tip == 0 || height > tip - CONFIRMATIONS_DISPLAY_CAP + 1)) {
+        _confirmingRows.emplace(height, row);
+        indexedHeight = height;
+    }
+}
+
+//==============================================================================
+
+void WalletTransactionsListModel::pruneConfirmedRows()
+{
+    if (_tipHeight == 0) {
+        return;
+    }
+
+    // these rows reached display cap, only reorg deeper than the cap could change them back
+    const int64_t cappedHeight
+        = static_cast<int64_t>(_tipHeight) - CONFIRMATIONS_DISPLAY_CAP + 1;
+    const auto lastRow = std::numeric_limits<int>::max();
+    auto end = _confirmingRows.upper_bound({ cappedHeight, lastRow });
+    for (auto it = _confirmingRows.begin(); it != end; ++it) {
+        _confirmingRowHeights[static_cast<size_t>(it->second)] = 0;
+    }
+    _confirmingRows.erase(_confirmingRows.begin(), end);
+}
+
+//==============================================================================
+
 QVariantList WalletTransactionsListModel::getAddresses(const OnChainTx& transaction) const
 {
     QVariantList result;
@@ -631,7 +766,8 @@ QVariantList WalletTransactionsListModel::getAddresses(const OnChainTx& transact
 int WalletTransactionsListModel::getConfirmations(const OnChainTx& transaction) const
 {
     return _tipHeight > 0 && transaction.blockHeight() > 0
-        ? (_tipHeight - transaction.blockHeight() + 1)
+        ? std::min<int64_t>(static_cast<int64_t>(_tipHeight) - transaction.blockHeight() + 1,
+              CONFIRMATIONS_DISPLAY_CAP)
         : 0;
 }
 
@@ -640,7 +776,8 @@ int WalletTransactionsListModel::getConfirmations(const OnChainTx& transaction)
 int WalletTransactionsListModel::getConfirmations(const EthOnChainTx& transaction) const
 {
     return _tipHeight > 0 && transaction.blockHeight() > 0
-        ? (_tipHeight - transaction.blockHeight() + 1)
+        ? std::min<int64_t>(static_cast<int64_t>(_tipHeight) - transaction.blockHeight() + 1,
+              CONFIRMATIONS_DISPLAY_CAP)
         : 0;
 }
 
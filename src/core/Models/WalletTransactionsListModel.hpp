@@ -6,6 +6,7 @@
 #include <QPointer>
 
 #include <Models/WalletDataSource.hpp>
+#include <set>
 
 class AssetTransactionsDataSource;
 class WalletAssetsModel;
@@ -38,21 +39,31 @@ public:
     };
     Q_ENUMS(Roles)
 
+    // confirmations are displayed as "1000+" from this count on, such rows don't change anymore
+    static constexpr int CONFIRMATIONS_DISPLAY_CAP = 1000;
+
     virtual int rowCount(const QModelIndex& parent) const override final;
     virtual QVariant data(const QModelIndex& index, int role) const override final;
     virtual QHash<int, QByteArray> roleNames() const override final;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
 
 public slots:
 
 private slots:
     void onTransactionsFetched();
     void onTxnsAdded(const std::vector<Transaction>& txns);
+    void onPageFetched(const std::vector<Transaction>& txns);
     void onTxnsChanged(const std::vector<Transaction>& txns, std::vector<int> indexes);
     void updateConfirmations();
     void onChainsLoaded();
 
 private:
     void init();
+    void onTipHeightChanged(size_t newHeight);
+    void resetConfirmingRows();
+    void indexConfirmingRow(int row);
+    void pruneConfirmedRows();
     QVariantList getAddresses(const OnChainTx& transaction) const;
     int getConfirmations(const OnChainTx& transaction) const;
     QString getOnChainTxActivity(const OnChainTx& transaction) const;
@@ -69,6 +80,9 @@ private:
     std::map<BlockHash, size_t> _blockConfirmations;
     size_t _tipHeight{ 0 };
     size_t _rowCount{ 0 };
+    // rows which still change with new tips, ordered by block height
+    std::set<std::pair<int64_t, int>> _confirmingRows;
+    std::vector<int64_t> _confirmingRowHeights; // per row, 0 if row isn't indexed
 };
 
 #endif // WALLETTRANSACTIONSLISTMODEL_HPP
@@ -24,6 +24,7 @@
 #include <QFutureWatcher>
 #include <QThread>
 #include <QtConcurrent>
+#include <unordered_map>
 
 using namespace grpc;
 using namespace lightwalletrpc;
@@ -45,14 +46,25 @@ static std::string EncodedBlockHeader(Wire::VerboseBlockHeader::Header data)
 
 //==============================================================================
 
-static AssetID ExtractAssetID(grpc::ServerContext* context)
+static void LogHeadersCacheStats(
+    const AbstractChainDataSource& dataSource, AssetID assetID, const char* event)
 {
-    auto metadata = context->client_metadata();
-    auto it = metadata.find("assetid");
+    dataSource.headersCacheStats(assetID).then([assetID, event](HeadersCacheStats stats) {
+        LogCCInfo(General) << event << "headers cache, asset:" << assetID
+                           << "hits:" << stats.hits << "disk hits:" << stats.diskHits
+                           << "misses:" << stats.misses << "evictions:" << stats.evictions
+                           << "entries:" << stats.entries << "bytes:" << stats.bytes;
+    });
+}
 
-    if (it != std::end(metadata)) {
-        std::string value(it->second.begin(), it->second.end());
-        return std::atoi(value.c_str());
+//==============================================================================
+
+static AssetID ExtractAssetID(const qgrpc::ClientMetadata* metadata)
+{
+    auto it = metadata->find("assetid");
+
+    if (it != std::end(*metadata)) {
+        return std::atoi(it->second.c_str());
     } else {
         return static_cast<AssetID>(-1);
     }
@@ -66,8 +78,10 @@ struct GRPCServer::ServerImpl : public qgrpc::BaseGrpcServer {
 
     explicit ServerImpl(const WalletAssetsModel& assetsModel, AbstractChainManager& chain,
         AbstractChainDataSource& dataSource, AssetsTransactionsCache& txCache,
-        WalletDataSource& walletDataSource, UTXOSetDataSource* utxoDataSource, QObject* parent)
-        : qgrpc::BaseGrpcServer("0.0.0.0:" + std::to_string(AppConfig::Instance().config().rpcPort))
+        WalletDataSource& walletDataSource, UTXOSetDataSource* utxoDataSource, QObject* parent,
+        size_t serverThreads = 1)
+        : qgrpc::BaseGrpcServer(
+              "0.0.0.0:" + std::to_string(AppConfig::Instance().config().rpcPort), serverThreads)
         , _assetsModel(assetsModel)
         , _chain(chain)
         , _dataSource(dataSource)
@@ -133,12 +147,19 @@ struct GRPCServer::ServerImpl : public qgrpc::BaseGrpcServer {
                             [=](AbstractTransactionsCache* cache) {
                                 return cache->onChainTransactionsList().then(
                                     [=](OnChainTxList list) {
+                                        std::unordered_map<QString, OnChainTxRef> txById;
+                                        txById.reserve(list.size());
+                                        for (auto&& tx : list) {
+                                            txById.emplace(tx->txId(), tx);
+                                        }
+
                                         std::vector<UTXOMeta> result;
                                         for (auto&& it : utxos) {
                                             auto txid = QString::fromStdString(
                                                 std::get<0>(it).hash.ToString());
-                                            if (auto tx
-                                                = TransactionUtils::FindTransaction(list, txid)) {
+                                            auto txIt = txById.find(txid);
+                                            if (txIt != std::end(txById)) {
+                                                const auto& tx = txIt->second;
                                                 if (tx->blockHeight() > 0
                                                     && height >= tx->blockHeight()) {
                                                     auto confirmations = height - tx->blockHeight() + 1;
@@ -527,7 +548,7 @@ void GRPCServer::ServerImpl::registerLightWalletService()
                     response.set_n(filter.n);
                     response.set_m(filter.m);
                     response.set_p(filter.p);
-                    response.set_bytes(bitcoin::HexStr(filter.bytes));
+                    response.set_bytes(bitcoin::HexStr(filter.bytes()));
                     sender->finish(response);
                 })
                 .fail([sender](const std::exception& ex) {
@@ -818,7 +839,8 @@ void GRPCServer::ServerImpl::registerLightWalletService()
 
             AbstractChainDataSource::Interrupt interrupt;
             _dataSource.loadSecondLayerCache(assetID, request->startheight(), &interrupt)
-                .then([sender]() {
+                .then([this, sender, assetID]() {
+                    LogHeadersCacheStats(_dataSource, assetID, "Loaded");
                     LoadCacheResponse response;
                     response.set_loaded(true);
                     sender->finish(response);
@@ -838,6 +860,7 @@ void GRPCServer::ServerImpl::registerLightWalletService()
     registerCall(&LightWalletService::AsyncService::RequestFreeSecondLayerCache, lightWalletService,
         [this](auto context, auto /*request*/, auto sender) {
             auto assetID = ExtractAssetID(context);
+            LogHeadersCacheStats(_dataSource, assetID, "Freeing");
             _dataSource.freeSecondLayerCache(assetID)
                 .then([sender]() {
                     lightwalletrpc::Empty response;
@@ -169,7 +169,7 @@ struct RPCServer::Impl : public QObject, jsonrpc::AbstractServer<RPCServer::Impl
                 response["n"] = filter.n;
                 response["m"] = static_cast<Json::UInt64>(filter.m);
                 response["p"] = filter.p;
-                auto bytes = filter.bytes;
+                const auto& bytes = filter.bytes();
                 response["bytes"] = bitcoin::HexStr(bytes);
             }).wait();
         });
@@ -2,13 +2,16 @@
 #include <Tools/Common.hpp>
 #include <Tools/DBUtils.hpp>
 #include <Utils/Logging.hpp>
+#include <crypto/sha256.h>
 #include <serialize.h>
 #include <streams.h>
 #include <txdb.h>
 
 //==============================================================================
 
-static constexpr int BOOTSTRAP_VERSION = 1;
+static constexpr int BOOTSTRAP_VERSION = 2;
+static constexpr uint32_t BOOTSTRAP_MAGIC = 0x42534e58; // "XNSB"
+static constexpr size_t BOOTSTRAP_CHUNK_SIZE = 2000;
 
 //==============================================================================
 
@@ -102,8 +105,18 @@ private:
 
 //==============================================================================
 
-BootstrapWriter::BootstrapWriter(QObject* parent)
+static bitcoin::uint256 ChunkChecksum(const std::vector<unsigned char>& payload)
+{
+    bitcoin::uint256 result;
+    CSHA256().Write(payload.data(), payload.size()).Finalize(result.begin());
+    return result;
+}
+
+//==============================================================================
+
+BootstrapWriter::BootstrapWriter(QString dataDir, QObject* parent)
     : QObject(parent)
+    , _dataDir(dataDir)
 {
 }
 
@@ -123,41 +136,55 @@ std::unique_ptr<BootstrapBuilder> BootstrapWriter::createBuilder(
 
 std::unique_ptr<BlockIndexProvider> BootstrapWriter::create(AssetID assetID)
 {
-
-#if 0
     struct BlockIndexProviderImpl : public BlockIndexProvider {
-        explicit BlockIndexProviderImpl(std::vector<BlockHash> blockHashes, AssetID assetID, bitcoin::CBlockTreeDB &blockTreeDb) :
-            BlockIndexProvider(blockHashes, assetID),
-            _blockTreeDb(blockTreeDb)
-        { }
-        virtual std::vector<bitcoin::CDiskBlockIndex> getBlockIndexes()
+        BlockIndexProviderImpl(AssetID assetID, uint32_t firstHeight, uint32_t bestHeight,
+            bitcoin::CBlockTreeDB& blockTreeDb)
+            : BlockIndexProvider(assetID, firstHeight, bestHeight)
+            , _blockTreeDb(blockTreeDb)
+        {
+        }
+
+        std::vector<bitcoin::CDiskBlockIndex> getBlockIndexes(size_t maxCount) override
         {
             std::vector<bitcoin::CDiskBlockIndex> result;
-            auto blocksToRead = std::min(remainingBlocks(), size_t(500));
+            auto blocksToRead = std::min(remainingBlocks(), maxCount);
+            result.reserve(blocksToRead);
 
-            for(size_t i = 0; i < blocksToRead; ++i)
-            {
-                auto hash = _blockHashes.at(_readBlocks++);
+            for (size_t i = 0; i < blocksToRead; ++i) {
+                auto height = static_cast<uint32_t>(_firstHeight + _readBlocks++);
                 bitcoin::CDiskBlockIndex diskIndex;
-                if(!_blockTreeDb.ReadBlockIndex(_assetID, bitcoin::uint256S(hash.toStdString()), diskIndex))
-                {
+                if (!_blockTreeDb.ReadBlockIndex(_assetID, height, diskIndex)) {
                     throw std::runtime_error(
-                                QString("Failed to read block index from db, shouldn't happen, hash: %1, height: %2")
-                                .arg(hash).arg(_readBlocks - 1).toStdString());
+                        QString("Failed to read block index from db, asset: %1, height: %2")
+                            .arg(_assetID)
+                            .arg(height)
+                            .toStdString());
                 }
 
-                result.push_back(diskIndex);
+                result.emplace_back(std::move(diskIndex));
             }
 
             return result;
         }
 
-        bitcoin::CBlockTreeDB &_blockTreeDb;
+        bitcoin::CBlockTreeDB& _blockTreeDb;
     };
 
-    return std::unique_ptr<BlockIndexProvider>(new BlockIndexProviderImpl(readBlockHashes(assetID), assetID, db()));
-#endif
-    throw std::runtime_error("No implemented");
+    uint32_t bestHeight = 0;
+    if (!db().ReadBestBlock(assetID, bestHeight) || bestHeight == 0) {
+        return std::unique_ptr<BlockIndexProvider>(
+            new BlockIndexProviderImpl(assetID, 1, 0, db()));
+    }
+
+    // ChainManager keeps only recent part of the chain, walk back to the oldest stored index.
+    bitcoin::CDiskBlockIndex diskIndex;
+    uint32_t firstHeight = bestHeight;
+    while (firstHeight > 1 && db().ReadBlockIndex(assetID, firstHeight - 1, diskIndex)) {
+        --firstHeight;
+    }
+
+    return std::unique_ptr<BlockIndexProvider>(
+        new BlockIndexProviderImpl(assetID, firstHeight, bestHeight, db()));
 }
 
 //==============================================================================
@@ -165,59 +192,13 @@ std::unique_ptr<BlockIndexProvider> BootstrapWriter::create(AssetID assetID)
 bitcoin::CBlockTreeDB& BootstrapWriter::db()
 {
     if (!_blockTreeDb) {
-        _blockTreeDb.reset(new bitcoin::CBlockTreeDB(GetChainIndexDir(false).toStdString(), 10000));
+        _blockTreeDb.reset(new bitcoin::CBlockTreeDB(_dataDir.toStdString(), 10000));
     }
     return *_blockTreeDb;
 }
 
 //==============================================================================
 
-std::vector<BlockHash> BootstrapWriter::readBlockHashes(AssetID assetID)
-{
-#if 0
-    std::pair<bitcoin::uint256, uint64_t> hashBestBlock;
-    std::vector<BlockHash> result;
-    if(db().ReadBestBlock(assetID, hashBestBlock))
-    {
-        auto readIndex = [this, assetID](bitcoin::uint256 blockHash) {
-            bitcoin::CDiskBlockIndex diskIndex;
-            bool result = db().ReadBlockIndex(assetID, blockHash, diskIndex);
-            return std::make_tuple(diskIndex, result);
-        };
-
-        bitcoin::uint256 prevIndexHash = hashBestBlock.first;
-        int lastHeight = -1;
-        while(!prevIndexHash.IsNull())
-        {
-            result.push_back(QString::fromStdString(prevIndexHash.ToString()));
-
-            bitcoin::CDiskBlockIndex diskIndex;
-            bool success;
-            std::tie(diskIndex, success) = readIndex(prevIndexHash);
-            if(!success)
-            {
-                break;
-            }
-
-            if(lastHeight > 0 && diskIndex.nHeight != (lastHeight - 1))
-            {
-                throw std::runtime_error("Unordered chain");
-            }
-
-            lastHeight = diskIndex.nHeight;
-            prevIndexHash = diskIndex.hashPrevBlock;
-        }
-
-        std::reverse(std::begin(result), std::end(result));
-    }
-
-    return result;
-#endif
-    return {};
-}
-
-//==============================================================================
-
 BootstrapBuilder::BootstrapBuilder(QString filePath,
     BlockIndexProviderFactory& blockIndexProviderFactory, std::vector<AssetID> assets,
     QObject* parent)
@@ -238,6 +219,7 @@ BootstrapBuilder::BootstrapBuilder(QString filePath,
         tempPath = tempPath.replace(whereToReplace, targetFileInfo.baseName().length(),
             QString("%1_temp").arg(targetFileInfo.baseName()));
         _stream->open(tempPath, QFile::WriteOnly);
+        (*_stream) << BOOTSTRAP_MAGIC << static_cast<uint32_t>(BOOTSTRAP_VERSION);
     }
 }
 
@@ -267,20 +249,24 @@ void BootstrapBuilder::build()
         return;
     }
 
-    QString bestBlockHash;
-
     auto blockIndexProvider = _blockIndexProviderFactory.create(currentAssetID());
+    auto blocksCount = blockIndexProvider->remainingBlocks();
     LogCDebug(General) << "Starting building for asset" << currentAssetID()
-                       << "blocks: " << blockIndexProvider->remainingBlocks();
+                       << "blocks: " << blocksCount;
 
-    if (blockIndexProvider->remainingBlocks() > 0) {
-        (*_stream) << std::make_pair<uint32_t, uint32_t>(
-            currentAssetID(), blockIndexProvider->remainingBlocks());
+    if (blocksCount > 0) {
+        auto chunksCount = static_cast<uint32_t>(
+            (blocksCount + BOOTSTRAP_CHUNK_SIZE - 1) / BOOTSTRAP_CHUNK_SIZE);
+        (*_stream) << static_cast<uint32_t>(currentAssetID()) << blockIndexProvider->firstHeight()
+                   << blockIndexProvider->bestHeight() << chunksCount;
 
         while (blockIndexProvider->remainingBlocks() > 0) {
-            for (auto&& index : blockIndexProvider->getBlockIndexes()) {
-                (*_stream) << index;
-            }
+            auto records = blockIndexProvider->getBlockIndexes(BOOTSTRAP_CHUNK_SIZE);
+            CDataStream ss(bitcoin::SER_DISK, BOOTSTRAP_VERSION);
+            ss << records;
+            std::vector<unsigned char> payload(ss.begin(), ss.end());
+            (*_stream) << static_cast<uint32_t>(records.size()) << ChunkChecksum(payload)
+                       << payload;
         }
     }
 
@@ -302,17 +288,39 @@ void BootstrapBuilder::finalize()
 
 //==============================================================================
 
-BlockIndexProvider::BlockIndexProvider(std::vector<BlockHash> blockHashes, AssetID assetID)
-    : _blockHashes(blockHashes)
-    , _assetID(assetID)
+BlockIndexProvider::BlockIndexProvider(AssetID assetID, uint32_t firstHeight, uint32_t bestHeight)
+    : _assetID(assetID)
+    , _firstHeight(firstHeight)
+    , _bestHeight(bestHeight)
+{
+}
+
+//==============================================================================
+
+AssetID BlockIndexProvider::assetID() const
+{
+    return _assetID;
+}
+
+//==============================================================================
+
+uint32_t BlockIndexProvider::firstHeight() const
+{
+    return _firstHeight;
+}
+
+//==============================================================================
+
+uint32_t BlockIndexProvider::bestHeight() const
 {
+    return _bestHeight;
 }
 
 //==============================================================================
 
 size_t BlockIndexProvider::remainingBlocks() const
 {
-    return _blockHashes.size() - _readBlocks;
+    return _bestHeight >= _firstHeight ? _bestHeight - _firstHeight + 1 - _readBlocks : 0;
 }
 
 //==============================================================================
@@ -330,6 +338,16 @@ BootstrapReader::BootstrapReader(QString filePath)
 {
     _stream.reset(new QFileStream(bitcoin::SER_DISK, BOOTSTRAP_VERSION));
     _stream->open(_filePath, QFile::ReadOnly);
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    (*_stream) >> magic >> version;
+    if (magic != BOOTSTRAP_MAGIC || version != BOOTSTRAP_VERSION) {
+        throw std::runtime_error(QString("Unsupported bootstrap file %1, version: %2")
+                                     .arg(_filePath)
+                                     .arg(version)
+                                     .toStdString());
+    }
 }
 
 //==============================================================================
@@ -355,41 +373,88 @@ void BootstrapReader::finalize()
 
 std::unique_ptr<BootstrapReader::ReaderContext> BootstrapReader::readNextAsset()
 {
-    std::pair<uint32_t, uint32_t> assetEntry;
-    (*_stream) >> assetEntry;
+    uint32_t assetID = 0;
+    uint32_t firstHeight = 0;
+    uint32_t bestHeight = 0;
+    uint32_t chunksCount = 0;
+    (*_stream) >> assetID >> firstHeight >> bestHeight >> chunksCount;
 
     struct ReaderContextImpl : public ReaderContext {
-        ReaderContextImpl(AssetID assetID, size_t blockCount, BootstrapReader& reader)
-            : ReaderContext(assetID)
-            , blockCount(blockCount)
+        ReaderContextImpl(AssetID assetID, uint32_t firstHeight, uint32_t bestHeight,
+            size_t chunksCount, BootstrapReader& reader)
+            : ReaderContext(assetID, firstHeight, bestHeight)
+            , chunksCount(chunksCount)
+            , nextHeight(firstHeight)
             , reader(reader)
         {
         }
-        bool canReadMore() const override { return blockCount > 0; }
-        bitcoin::CDiskBlockIndex readNext() override
+        bool canReadMore() const override { return chunksCount > 0; }
+        std::vector<bitcoin::CDiskBlockIndex> readNextChunk() override
         {
-            bitcoin::CDiskBlockIndex diskIndex;
-            if (canReadMore()) {
-                (*reader._stream) >> diskIndex;
-                --blockCount;
+            std::vector<bitcoin::CDiskBlockIndex> records;
+            if (!canReadMore()) {
+                return records;
+            }
+
+            uint32_t recordsCount = 0;
+            bitcoin::uint256 checksum;
+            std::vector<unsigned char> payload;
+            (*reader._stream) >> recordsCount >> checksum >> payload;
+            --chunksCount;
+
+            if (ChunkChecksum(payload) != checksum) {
+                throw std::runtime_error(
+                    QString("Bootstrap chunk checksum mismatch, asset: %1, height: %2")
+                        .arg(assetID)
+                        .arg(nextHeight)
+                        .toStdString());
+            }
+
+            CDataStream ss(payload, bitcoin::SER_DISK, BOOTSTRAP_VERSION);
+            ss >> records;
+
+            if (records.size() != recordsCount) {
+                throw std::runtime_error("Bootstrap chunk has unexpected records count");
+            }
+
+            for (auto&& record : records) {
+                if (record.nHeight != nextHeight
+                    || (!prevHash.IsNull() && record.hashPrevBlock != prevHash)) {
+                    throw std::runtime_error(
+                        QString("Bootstrap chain is not connected, asset: %1, height: %2")
+                            .arg(assetID)
+                            .arg(record.nHeight)
+                            .toStdString());
+                }
+                prevHash = record.hashBlock;
+                ++nextHeight;
+            }
+
+            if (!canReadMore() && nextHeight != bestHeight + 1) {
+                throw std::runtime_error("Bootstrap asset ended before best height");
             }
 
-            return diskIndex;
+            return records;
         }
 
-        size_t remainingBlocks() const override { return blockCount; }
+        size_t remainingChunks() const override { return chunksCount; }
 
-        size_t blockCount;
+        size_t chunksCount;
+        uint32_t nextHeight;
+        bitcoin::uint256 prevHash;
         BootstrapReader& reader;
     };
 
     return std::unique_ptr<ReaderContext>(
-        new ReaderContextImpl(assetEntry.first, assetEntry.second, *this));
+        new ReaderContextImpl(assetID, firstHeight, bestHeight, chunksCount, *this));
 }
 
 //==============================================================================
 
-BootstrapReader::ReaderContext::ReaderContext(AssetID assetID)
+BootstrapReader::ReaderContext::ReaderContext(
+    AssetID assetID, uint32_t firstHeight, uint32_t bestHeight)
     : assetID(assetID)
+    , firstHeight(firstHeight)
+    , bestHeight(bestHeight)
 {
 }
@@ -9,6 +9,18 @@
 
 class QFileStream;
 
+/*!
+ * Bootstrap snapshot layout, all values are serialized with bitcoin serialization:
+ *
+ *   file header:  magic, version
+ *   per asset:    assetID, firstHeight, bestHeight, chunksCount
+ *   per chunk:    recordsCount, sha256(payload), payload
+ *
+ * Payload is serialized std::vector<CDiskBlockIndex> ordered by height, every record carries
+ * header and encoded block filter. Chunks are verified one by one while streaming, so whole
+ * snapshot never needs to be kept in memory.
+ */
+
 //==============================================================================
 
 /*!
@@ -17,15 +29,20 @@ class QFileStream;
  */
 class BlockIndexProvider {
 public:
-    explicit BlockIndexProvider(std::vector<BlockHash> blockHashes, AssetID assetID);
-    virtual std::vector<bitcoin::CDiskBlockIndex> getBlockIndexes() = 0;
-    size_t remainingBlocks() const;
-
+    explicit BlockIndexProvider(AssetID assetID, uint32_t firstHeight, uint32_t bestHeight);
     virtual ~BlockIndexProvider();
 
+    virtual std::vector<bitcoin::CDiskBlockIndex> getBlockIndexes(size_t maxCount) = 0;
+
+    AssetID assetID() const;
+    uint32_t firstHeight() const;
+    uint32_t bestHeight() const;
+    size_t remainingBlocks() const;
+
 protected:
-    std::vector<BlockHash> _blockHashes;
     AssetID _assetID;
+    uint32_t _firstHeight{ 0 };
+    uint32_t _bestHeight{ 0 };
     size_t _readBlocks{ 0 };
 };
 
@@ -61,20 +78,24 @@ private:
 
 class BootstrapReader : public QObject {
 public:
+    // throws if file can't be opened or has unsupported version.
     explicit BootstrapReader(QString filePath);
     ~BootstrapReader() override;
     bool canReadMore() const;
     void finalize();
 
     struct ReaderContext {
-        explicit ReaderContext(AssetID assetID);
+        explicit ReaderContext(AssetID assetID, uint32_t firstHeight, uint32_t bestHeight);
 
         virtual ~ReaderContext() = default;
         virtual bool canReadMore() const = 0;
-        virtual bitcoin::CDiskBlockIndex readNext() = 0;
-        virtual size_t remainingBlocks() const = 0;
+        // throws when chunk is corrupted or doesn't connect to previous one.
+        virtual std::vector<bitcoin::CDiskBlockIndex> readNextChunk() = 0;
+        virtual size_t remainingChunks() const = 0;
 
         AssetID assetID;
+        uint32_t firstHeight;
+        uint32_t bestHeight;
     };
 
     std::unique_ptr<ReaderContext> readNextAsset();
@@ -86,24 +107,24 @@ private:
 
 //==============================================================================
 
+/*!
+ * \brief The BootstrapWriter class provides block indexes stored by ChainManager in chain index
+ * database located at dataDir.
+ */
 class BootstrapWriter : public QObject, public BlockIndexProviderFactory {
     Q_OBJECT
 public:
-    explicit BootstrapWriter(QObject* parent = nullptr);
+    explicit BootstrapWriter(QString dataDir, QObject* parent = nullptr);
     ~BootstrapWriter() override;
     std::unique_ptr<BootstrapBuilder> createBuilder(QString filePath, std::vector<AssetID> assets);
     std::unique_ptr<BlockIndexProvider> create(AssetID assetID) override;
 
-signals:
-
-public slots:
-
 private:
     bitcoin::CBlockTreeDB& db();
-    std::vector<BlockHash> readBlockHashes(AssetID assetID);
 
 private:
     std::unique_ptr<bitcoin::CBlockTreeDB> _blockTreeDb;
+    QString _dataDir;
 };
 
 //==============================================================================
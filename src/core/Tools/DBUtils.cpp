@@ -12,7 +12,7 @@ bitcoin::CDiskBlockIndex BlockIndexToDisk(const Wire::VerboseBlockHeader& index)
     return bitcoin::CDiskBlockIndex(header.version, bitcoin::uint256S(header.prevBlock),
         bitcoin::uint256S(header.merkleRoot), header.timestamp, header.bits, header.nonce,
         index.height, bitcoin::uint256S(index.hash),
-        bitcoin::CDiskBlockFilter(filter.n, filter.m, filter.p, filter.bytes));
+        bitcoin::CDiskBlockFilter(filter.n, filter.m, filter.p, filter.bytes()));
 }
 
 //==============================================================================
@@ -36,5 +36,35 @@ Wire::VerboseBlockHeader DiskIndexToBlockIndex(const bitcoin::CDiskBlockIndex& d
     return header;
 }
 
+//==============================================================================
+
+bitcoin::CDiskBlockIndex BlockIndexToDisk(const Wire::PackedBlockHeader& index)
+{
+    const auto& filter = index.filter;
+    return bitcoin::CDiskBlockIndex(index.version, index.prevBlock, index.merkleRoot,
+        index.timestamp, index.bits, index.nonce, index.height, index.hash,
+        bitcoin::CDiskBlockFilter(filter.n, filter.m, filter.p, filter.bytes()));
+}
+
+//==============================================================================
+
+Wire::PackedBlockHeader DiskIndexToPackedHeader(const bitcoin::CDiskBlockIndex& diskIndex)
+{
+    Wire::PackedBlockHeader header;
+    header.version = diskIndex.nVersion;
+    header.prevBlock = diskIndex.hashPrevBlock;
+    header.merkleRoot = diskIndex.hashMerkleRoot;
+    header.bits = diskIndex.nBits;
+    header.nonce = diskIndex.nNonce;
+    header.timestamp = diskIndex.nTimestamp;
+    header.height = diskIndex.nHeight;
+    header.hash = diskIndex.hashBlock;
+
+    const auto& filter = diskIndex.blockFilter;
+    header.filter = Wire::EncodedBlockFilter(filter.n, filter.m, filter.p, filter.vchBlockFilter);
+
+    return header;
+}
+
 //==============================================================================
 }
@@ -10,6 +10,9 @@
 namespace DBUtils {
 bitcoin::CDiskBlockIndex BlockIndexToDisk(const Wire::VerboseBlockHeader& index);
 Wire::VerboseBlockHeader DiskIndexToBlockIndex(const bitcoin::CDiskBlockIndex& diskIndex);
+// same as above without hex round trip for hashes.
+bitcoin::CDiskBlockIndex BlockIndexToDisk(const Wire::PackedBlockHeader& index);
+Wire::PackedBlockHeader DiskIndexToPackedHeader(const bitcoin::CDiskBlockIndex& diskIndex);
 }
 
 #endif // DBUTILS_HPP
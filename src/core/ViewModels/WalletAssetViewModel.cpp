@@ -11,6 +11,8 @@
 #include <ViewModels/ReceiveUTXOTransactionViewModel.hpp>
 #include <key_io.h>
 
+static const size_t TRANSACTIONS_PAGE_SIZE = 100;
+
 //==============================================================================
 
 WalletAssetViewModel::WalletAssetViewModel(QObject* parent)
@@ -96,7 +98,8 @@ void WalletAssetViewModel::onCurrentAssetIDChanged()
     auto assetID = _currentAssetID.get();
     if (_walletTransactionsListModels.count(assetID) == 0) {
         _dataSource->cacheById(assetID).then([this, assetID](AbstractTransactionsCache* cache) {
-            auto transactionsDataSource = new AssetTransactionsDataSource(assetID, cache, this);
+            auto transactionsDataSource = new AssetTransactionsDataSource(
+                assetID, cache, TRANSACTIONS_PAGE_SIZE, this);
             _walletTransactionsListModels.emplace(assetID,
                 TransactionsListModelPtr(new WalletTransactionsListModel(
                     transactionsDataSource, _walletAssetsModel, _chainManager)));
@@ -11,6 +11,7 @@
 #include <ViewModels/WalletViewModel.hpp>
 
 #include <QDateTime>
+#include <QFile>
 #include <QFileInfo>
 #include <QProcess>
 
@@ -228,9 +229,9 @@ Promise<void> WalletViewModel::loadChains()
 {
     std::vector<AssetID> chains = _walletAssetsModel.activeAssets();
 
-    //    bool canBoostrap = false;
-    //    QString path;
-    //    std::tie(canBoostrap, path) = canBootstrap();
+    bool canBoostrap = false;
+    QString path;
+    std::tie(canBoostrap, path) = canBootstrap();
 
     auto loadChainsHelper = [chains, this] {
         loadingProcessChanged(LoadingState::Chain);
@@ -238,22 +239,22 @@ Promise<void> WalletViewModel::loadChains()
             [this] { loadingProcessFailed(LoadingState::Chain); });
     };
 
-#if 0
-    if(canBoostrap)
-    {
-        loadingProcessChanged("bootstrap");
-        return _chainManager.loadFromBootstrap(path).then([loadChainsHelper, this] {
-            _syncService.rescanChains(_chainManager.chains());
-            startSync();
-            emit walletLoaded();
-            return loadChainsHelper();
-        }).tapFail([this]{
-            loadingProcessFailed("bootstrap");
-        });
+    if (canBoostrap) {
+        loadingProcessChanged(LoadingState::Chain);
+        return _chainManager.loadFromBootstrap(path)
+            .then([this, chains, path] {
+                // imported headers are past wallet's transactions, they have to be rescanned
+                _syncService.rescanChains(chains);
+                // same as bitcoin core, file is imported only once
+                QFile::rename(path, path + ".old");
+            })
+            .fail([](const std::exception& ex) {
+                // existing index is kept if bootstrap is broken, chains are synced from network
+                LogCWarning(General) << "Bootstrap was not imported:" << ex.what();
+            })
+            .then(loadChainsHelper);
     }
 
-#endif
-
     return loadChainsHelper();
 }
 
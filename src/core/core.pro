@@ -43,6 +43,7 @@ SOURCES += \
     Data/OrderBookData.cpp \
     Data/OwnOrdersDataSource.cpp \
     Data/TransactionEntry.cpp \
+    Data/UTXOBalanceLedger.cpp \
     Data/WalletAssetsModel.cpp \
     Factories/AbstractNetworkingFactory.cpp \
     Models/AbstractKeychain.cpp \
@@ -96,6 +97,8 @@ SOURCES += \
     Chain/BlockFilterMatcher.cpp \
     Chain/AbstractChainManager.cpp \
     Chain/ChainManager.cpp \
+    Chain/DirtyHeadersBuffer.cpp \
+    Chain/HeadersCache.cpp \
     ViewModels/ChainViewModel.cpp \
     ViewModels/LocalCurrencyViewModel.cpp \
     ViewModels/SendTransactionViewModel.cpp \
@@ -131,6 +134,7 @@ HEADERS += \
     Data/OrderBookData.hpp \
     Data/OwnOrdersDataSource.hpp \
     Data/TransactionEntry.hpp \
+    Data/UTXOBalanceLedger.hpp \
     Data/WalletAssetsModel.hpp \
     Factories/AbstractNetworkingFactory.hpp \
     Models/AbstractKeychain.hpp \
@@ -182,6 +186,8 @@ HEADERS += \
     Chain/BlockFilterMatcher.hpp \
     Chain/AbstractChainManager.hpp \
     Chain/ChainManager.hpp \
+    Chain/DirtyHeadersBuffer.hpp \
+    Chain/HeadersCache.hpp \
     ViewModels/ChainViewModel.hpp \
     ViewModels/LocalCurrencyViewModel.hpp \
     ViewModels/SendTransactionViewModel.hpp \
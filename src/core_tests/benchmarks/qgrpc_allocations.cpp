@@ -0,0 +1,111 @@
+#include <GRPCTools/ClientUtils.hpp>
+#include <Tools/Common.hpp>
+#include <Utils/Utils.hpp>
+#include <gen-grpc/tesgrpcserver.grpc.pb.h>
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QSemaphore>
+#include <QTimer>
+#include <atomic>
+#include <cstdlib>
+#include <grpcpp/grpcpp.h>
+#include <iostream>
+
+// counts heap allocations made by all threads while enabled
+static std::atomic<size_t> AllocationsCount{ 0 };
+static std::atomic_bool CountAllocations{ false };
+
+void* operator new(size_t size)
+{
+    if (CountAllocations) {
+        ++AllocationsCount;
+    }
+
+    if (auto ptr = std::malloc(size > 0 ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+class EchoServer : public test::TestService::Service {
+    // Service interface
+public:
+    grpc::Status UnaryCall(grpc::ServerContext*, const test::RequestCall* request,
+        test::ResponseCall* response) override
+    {
+        response->set_requestid(request->requestid());
+        return grpc::Status{};
+    }
+};
+
+TEST(QGrpcClientAllocations, UnaryCallBenchmark)
+{
+    const size_t numberOfCalls = 200;
+    const std::string rpcChannel{ "0.0.0.0:50052" };
+
+    EchoServer service;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(rpcChannel, grpc::InsecureServerCredentials());
+    builder.RegisterService(&service);
+    auto server = builder.BuildAndStart();
+    ASSERT_TRUE(server);
+
+    auto stub = test::TestService::NewStub(
+        grpc::CreateChannel(rpcChannel, grpc::InsecureChannelCredentials()));
+    BaseGrpcClient client(QString::fromStdString(rpcChannel), [] { return std::string{}; },
+        [] { return std::string{}; }, BaseGrpcClient::AuthType::None);
+    client.connect();
+
+    // includes allocations made by grpc itself on all threads, blocking stub is the baseline
+    auto measure = [&](std::function<void(test::RequestCall)> call) {
+        test::RequestCall request;
+        request.set_requestid("1");
+        call(request); // warm up channel
+        AllocationsCount = 0;
+        CountAllocations = true;
+        for (size_t i = 0; i < numberOfCalls; ++i) {
+            call(request);
+        }
+        CountAllocations = false;
+        return static_cast<double>(AllocationsCount) / numberOfCalls;
+    };
+
+    auto baseline = measure([&stub](test::RequestCall request) {
+        grpc::ClientContext ctx;
+        test::ResponseCall response;
+        ASSERT_TRUE(stub->UnaryCall(&ctx, request, &response).ok());
+    });
+
+    auto async = measure([&client, &stub](test::RequestCall request) {
+        client
+            .makeUnaryRequest<test::ResponseCall>(
+                stub.get(), &test::TestService::Stub::PrepareAsyncUnaryCall, request, 0)
+            .wait();
+    });
+
+    std::cout << "Allocations per unary call: blocking stub " << baseline << ", BaseGrpcClient "
+              << async << ", overhead " << async - baseline << std::endl;
+
+    server->Shutdown();
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    QCoreApplication app(argc, argv);
+    RegisterCommonQtTypes();
+    QTimer::singleShot(0, [] { QCoreApplication::exit(RUN_ALL_TESTS()); });
+    return app.exec();
+}
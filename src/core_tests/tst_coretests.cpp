@@ -1,17 +1,33 @@
 // Copyright (c) %YEAR The XSN developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include <Chain/Chain.hpp>
+#include <Chain/ChainManager.hpp>
+#include <Chain/DirtyHeadersBuffer.hpp>
+#include <Chain/HeadersCache.hpp>
+#include <Chain/TransactionsCache.hpp>
 #include <Data/TransactionEntry.hpp>
+#include <Data/UTXOBalanceLedger.hpp>
+#include <Data/WalletAssetsModel.hpp>
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QSignalSpy>
+#include <Tools/Bootstrap.hpp>
 #include <Tools/Common.hpp>
+#include <Tools/DBUtils.hpp>
 #include <Utils/GenericProtoDatabase.hpp>
+#include <boost/compute/detail/lru_cache.hpp>
 #include <boost/progress.hpp>
+#include <chrono>
+#include <fstream>
 #include <gen-grpc/tesgrpcserver.pb.h>
 #include <golomb/gcs.h>
 #include <gtest/gtest.h>
 #include <random>
 #include <serialize.h>
 #include <streams.h>
+#include <thread>
+#include <txdb.h>
 #include <utilstrencodings.h>
 #include <EthCore/Encodings.hpp>
 
@@ -74,9 +90,10 @@ TEST(CoreTests, GolumbBenchmark)
     auto testFilter = [](int numberOfItems, int numberOfTries, int numberOfTestItems) {
         std::vector<std::string> addresses(numberOfTestItems);
         bitcoin::Filter filter = bitcoin::Filter::WithKeyMP(key, M, 19);
+        std::string lastItem;
         for (size_t i = 0; i < numberOfItems; ++i) {
-            auto str = random_string(nAddressBytes);
-            filter.addEntry(std::vector<unsigned char>(str.begin(), str.end()));
+            lastItem = random_string(nAddressBytes);
+            filter.addEntry(std::vector<unsigned char>(lastItem.begin(), lastItem.end()));
         }
 
         for (size_t i = 0; i < numberOfTestItems; ++i) {
@@ -90,24 +107,26 @@ TEST(CoreTests, GolumbBenchmark)
 
         {
             progress_timer timer;
-            std::mt19937 rng;
             for (size_t i = 0; i < numberOfTries; ++i) {
                 filter.matchAny(addresses);
             }
         }
+
+        addresses.back() = lastItem;
+        ASSERT_TRUE(filter.matchAny(addresses));
     };
 
     using Entry = std::tuple<int, int, int>;
     for (auto&& testSet : { Entry{ 100, 1, 50 }, Entry{ 100, 10, 50 }, Entry{ 20000, 1, 100 },
-             Entry{ 20000, 1, 1000 } }) {
+             Entry{ 20000, 1, 1000 }, Entry{ 5000, 10, 10 }, Entry{ 5000, 10, 100 },
+             Entry{ 5000, 10, 1000 }, Entry{ 5000, 10, 2000 }, Entry{ 5000, 10, 10000 },
+             Entry{ 5000, 10, 100000 } }) {
         std::cout << "Benchmarking test with params, numberOfItems = " << std::get<0>(testSet)
                   << " numberOfTries = " << std::get<1>(testSet)
-                  << "numberOfTestItems = " << std::get<2>(testSet) << std::endl;
+                  << " numberOfTestItems = " << std::get<2>(testSet) << std::endl;
         testFilter(std::get<0>(testSet), std::get<1>(testSet), std::get<2>(testSet));
         std::cout << std::endl;
     }
-
-    ASSERT_TRUE(true);
 }
 
 TEST(CoreTests, PromiseMultipleResolve)
@@ -341,6 +360,937 @@ TEST(CoreTests, GenericProtobufDbTest)
     }
 }
 
+TEST(CoreTests, TransactionsCacheLoadBenchmark)
+{
+    static const std::string txCacheIndex{ "transactions_cache" };
+    static const AssetID assetID = 384;
+
+    auto path = QString("%1/tx_cache_benchmark")
+                    .arg(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+
+    auto txIdAt = [](size_t i) {
+        return QString("%1").arg(static_cast<qulonglong>(i), 64, 16, QChar('0')).toStdString();
+    };
+
+    auto generate = [&](size_t numberOfTxns) {
+        QDir(path).removeRecursively();
+        QDir().mkpath(path);
+        auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 100000);
+        bitcoin::CDBBatch batch(*db);
+        for (size_t i = 0; i < numberOfTxns; ++i) {
+            chain::Transaction tx;
+            tx.set_asset_id(assetID);
+            auto& onChainTx = *tx.mutable_onchain_tx();
+            onChainTx.set_id(txIdAt(i));
+            onChainTx.set_block_height(static_cast<int64_t>(i + 1));
+            for (uint32_t index = 0; index < 2; ++index) {
+                auto& output = *onChainTx.add_outputs();
+                output.set_index(index);
+                output.set_value(1000);
+                output.set_address("address");
+            }
+
+            // every tx spends one output of previous one, so loading resolves all inputs
+            if (i > 0) {
+                auto& input = *onChainTx.add_inputs();
+                input.set_hash(txIdAt(i - 1));
+                input.set_index(1);
+            }
+
+            std::vector<unsigned char> serialized(tx.ByteSizeLong());
+            tx.SerializeToArray(serialized.data(), static_cast<int>(serialized.size()));
+            batch.Write(
+                std::make_pair(txCacheIndex, std::make_pair(assetID, txIdAt(i))), serialized);
+        }
+        db->WriteBatch(batch, true);
+    };
+
+    for (size_t numberOfTxns : { 1000, 10000, 100000 }) {
+        generate(numberOfTxns);
+        {
+            // summary is built from stored transactions on first load only
+            std::cout << "Benchmarking tx cache summary build, numberOfTxns = " << numberOfTxns
+                      << std::endl;
+            auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 100000);
+            progress_timer timer;
+            TransactionsCacheImpl(db).load(false).wait();
+        }
+
+        auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 100000);
+        TransactionsCacheImpl cache(db);
+        std::cout << "Benchmarking tx cache load, numberOfTxns = " << numberOfTxns << std::endl;
+        {
+            progress_timer timer;
+            cache.load(false).wait();
+        }
+
+        auto& assetCache = cache.cacheByIdSync(assetID);
+        {
+            std::cout << "first page: ";
+            progress_timer timer;
+            TransactionsPage page;
+            assetCache.transactionsPage(0, 50)
+                .then([&page](TransactionsPage result) { page = result; })
+                .wait();
+            ASSERT_EQ(numberOfTxns, page.total);
+            ASSERT_EQ(50u, page.transactions.size());
+        }
+
+        {
+            std::cout << "whole history: ";
+            progress_timer timer;
+            ASSERT_EQ(numberOfTxns, assetCache.onChainTransactionsListSync().size());
+        }
+        auto lastTxId = QString::fromStdString(txIdAt(numberOfTxns - 1));
+        auto last = assetCache.transactionByIdSync(lastTxId);
+        ASSERT_TRUE(last);
+        ASSERT_EQ(1000, last->_delta);
+    }
+
+    QDir(path).removeRecursively();
+}
+
+TEST(CoreTests, TransactionsCachePagesFromSummary)
+{
+    static const AssetID assetID = 384;
+    auto path = QString("%1/tx_cache_pages")
+                    .arg(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+    QDir(path).removeRecursively();
+    QDir().mkpath(path);
+
+    auto makeTx = [](std::string id, int64_t timestamp, int64_t value, std::string spentId) {
+        chain::Transaction tx;
+        tx.set_asset_id(assetID);
+        auto& onChainTx = *tx.mutable_onchain_tx();
+        onChainTx.set_id(id);
+        onChainTx.set_block_height(-1);
+        onChainTx.set_timestamp(timestamp);
+        auto& output = *onChainTx.add_outputs();
+        output.set_index(0);
+        output.set_value(value);
+        output.set_address("address");
+        if (!spentId.empty()) {
+            auto& input = *onChainTx.add_inputs();
+            input.set_hash(spentId);
+            input.set_index(0);
+        }
+        return Transaction{ std::make_shared<OnChainTx>(tx) };
+    };
+
+    auto pageOf = [](AbstractTransactionsCache& cache, size_t offset, size_t count) {
+        TransactionsPage page;
+        cache.transactionsPage(offset, count)
+            .then([&page](TransactionsPage result) { page = result; })
+            .wait();
+        return page;
+    };
+
+    {
+        auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 1000);
+        TransactionsCacheImpl cache(db);
+        cache.load(false).wait();
+        cache.cacheByIdSync(assetID).addTransactionsSync({ makeTx("a", 1000, 1000, ""),
+            makeTx("b", 2000, 400, "a"), makeTx("c", 3000, 100, "b") });
+    }
+
+    auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 1000);
+    TransactionsCacheImpl cache(db);
+    cache.load(false).wait();
+    auto& assetCache = cache.cacheByIdSync(assetID);
+
+    // rows are read from database by summary order, spent outputs are resolved from database
+    auto page = pageOf(assetCache, 0, 2);
+    ASSERT_EQ(3u, page.total);
+    ASSERT_EQ(2u, page.transactions.size());
+    auto newest = boost::variant2::get<OnChainTxRef>(page.transactions.at(0));
+    auto middle = boost::variant2::get<OnChainTxRef>(page.transactions.at(1));
+    ASSERT_EQ("c", newest->txId().toStdString());
+    ASSERT_EQ(100 - 400, newest->delta());
+    ASSERT_EQ("b", middle->txId().toStdString());
+    ASSERT_EQ(400 - 1000, middle->delta());
+
+    page = pageOf(assetCache, 2, 2);
+    ASSERT_EQ(1u, page.transactions.size());
+    ASSERT_EQ("a",
+        boost::variant2::get<OnChainTxRef>(page.transactions.at(0))->txId().toStdString());
+
+    // adding tx loads whole history, pages keep the same order
+    assetCache.addTransactionsSync({ makeTx("d", 4000, 50, "c") });
+    ASSERT_EQ(4u, assetCache.onChainTransactionsListSync().size());
+    page = pageOf(assetCache, 0, 2);
+    ASSERT_EQ(4u, page.total);
+    ASSERT_EQ("d",
+        boost::variant2::get<OnChainTxRef>(page.transactions.at(0))->txId().toStdString());
+    ASSERT_EQ("c",
+        boost::variant2::get<OnChainTxRef>(page.transactions.at(1))->txId().toStdString());
+
+    QDir(path).removeRecursively();
+}
+
+static Transaction MakeJournalTx(AssetID assetID, std::string id, int64_t value)
+{
+    chain::Transaction tx;
+    tx.set_asset_id(assetID);
+    auto& onChainTx = *tx.mutable_onchain_tx();
+    onChainTx.set_id(id);
+    onChainTx.set_block_height(-1);
+    onChainTx.set_timestamp(1000);
+    auto& output = *onChainTx.add_outputs();
+    output.set_index(0);
+    output.set_value(value);
+    output.set_address("address");
+    return Transaction{ std::make_shared<OnChainTx>(tx) };
+}
+
+static bool WaitFor(std::function<bool()> predicate, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!predicate() && timer.elapsed() < timeoutMs) {
+        QCoreApplication::processEvents();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return predicate();
+}
+
+static QString CleanTempDir(QString name)
+{
+    auto path = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation))
+                    .absoluteFilePath(name);
+    QDir(path).removeRecursively();
+    QDir().mkpath(path);
+    return path;
+}
+
+TEST(CoreTests, TransactionsCacheJournalCoalescesUpdates)
+{
+    static const AssetID assetID = 384;
+    auto path = CleanTempDir("tx_cache_journal_coalesce");
+    {
+        auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 1000);
+        TransactionsCacheImpl cache(db);
+        cache.load(false).wait();
+        auto& assetCache = cache.cacheByIdSync(assetID);
+        for (int64_t value = 1; value <= 3; ++value) {
+            assetCache.addTransactionsSync({ MakeJournalTx(assetID, "a", value) });
+        }
+
+        // every update replaced previous one, nothing was written yet
+        auto stats = cache.journalStats();
+        ASSERT_EQ(1u, stats.pendingWrites);
+        ASSERT_EQ(0u, stats.flushes);
+        ASSERT_EQ(0u, stats.syncedFlushes);
+
+        cache.checkpointSync();
+        stats = cache.journalStats();
+        ASSERT_EQ(0u, stats.pendingWrites);
+        ASSERT_EQ(1u, stats.syncedFlushes);
+    }
+
+    auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 1000);
+    TransactionsCacheImpl cache(db);
+    cache.load(false).wait();
+    auto& assetCache = cache.cacheByIdSync(assetID);
+    ASSERT_EQ(1u, assetCache.onChainTransactionsListSync().size());
+    ASSERT_EQ(3, assetCache.transactionByIdSync("a")->delta());
+
+    QDir(path).removeRecursively();
+}
+
+TEST(CoreTests, TransactionsCacheJournalFlushesOnThreshold)
+{
+    static const AssetID assetID = 384;
+    auto path = CleanTempDir("tx_cache_journal_threshold");
+    {
+        auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 1000);
+        TransactionsCacheImpl cache(db);
+        cache.load(false).wait();
+
+        std::vector<Transaction> txns;
+        for (size_t i = 0; i < TransactionsCacheImpl::JOURNAL_MAX_PENDING_WRITES - 1; ++i) {
+            txns.emplace_back(MakeJournalTx(assetID, std::to_string(i), 1));
+        }
+        auto& assetCache = cache.cacheByIdSync(assetID);
+        assetCache.addTransactionsSync(txns);
+        ASSERT_EQ(txns.size(), cache.journalStats().pendingWrites);
+
+        // threshold is reached, io thread writes journal without waiting for timer
+        QElapsedTimer timer;
+        timer.start();
+        assetCache.addTransactionsSync({ MakeJournalTx(assetID, "last", 1) });
+        ASSERT_TRUE(WaitFor([&cache] { return cache.journalStats().flushes == 1; },
+            TransactionsCacheImpl::JOURNAL_FLUSH_INTERVAL));
+        ASSERT_LT(timer.elapsed(), TransactionsCacheImpl::JOURNAL_FLUSH_INTERVAL);
+        ASSERT_EQ(0u, cache.journalStats().pendingWrites);
+        ASSERT_EQ(0u, cache.journalStats().syncedFlushes);
+    }
+
+    QDir(path).removeRecursively();
+}
+
+TEST(CoreTests, TransactionsCacheJournalFlushesOnTimer)
+{
+    static const AssetID assetID = 384;
+    auto path = CleanTempDir("tx_cache_journal_timer");
+    {
+        auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 1000);
+        TransactionsCacheImpl cache(db);
+        cache.load(false).wait();
+        cache.cacheByIdSync(assetID).addTransactionsSync({ MakeJournalTx(assetID, "a", 1) });
+
+        // timer lives on cache's thread, nothing is written while its events aren't processed
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(TransactionsCacheImpl::JOURNAL_FLUSH_INTERVAL * 2));
+        ASSERT_EQ(1u, cache.journalStats().pendingWrites);
+        ASSERT_EQ(0u, cache.journalStats().flushes);
+
+        ASSERT_TRUE(WaitFor([&cache] { return cache.journalStats().flushes == 1; },
+            TransactionsCacheImpl::JOURNAL_FLUSH_INTERVAL * 3));
+        ASSERT_EQ(0u, cache.journalStats().pendingWrites);
+        ASSERT_EQ(0u, cache.journalStats().syncedFlushes);
+    }
+
+    QDir(path).removeRecursively();
+}
+
+TEST(CoreTests, TransactionsCacheJournalSyncsOffChainTransactions)
+{
+    static const AssetID assetID = 384;
+    auto path = CleanTempDir("tx_cache_journal_offchain");
+    {
+        auto db = std::make_shared<Utils::LevelDBSharedDatabase>(path.toStdString(), 1000);
+        TransactionsCacheImpl cache(db);
+        cache.load(false).wait();
+        auto& assetCache = cache.cacheByIdSync(assetID);
+        assetCache.addTransactionsSync({ MakeJournalTx(assetID, "a", 1) });
+        ASSERT_EQ(1u, cache.journalStats().pendingWrites);
+
+        chain::Transaction tx;
+        tx.set_asset_id(assetID);
+        auto& payment = *tx.mutable_lightning_payment();
+        payment.set_payment_index(1);
+        payment.set_timestamp(1000);
+        payment.set_value(10);
+        assetCache.addTransactionsSync({ Transaction{ std::make_shared<LightningPayment>(tx) } });
+
+        // payment can't be recovered by chain sync, it's durable once added, pending onchain too
+        auto stats = cache.journalStats();
+        ASSERT_EQ(0u, stats.pendingWrites);
+        ASSERT_EQ(1u, stats.syncedFlushes);
+        ASSERT_EQ(0u, stats.flushes);
+    }
+
+    QDir(path).removeRecursively();
+}
+
+TEST(CoreTests, TransactionsCacheJournalReplaysFromBestBlockAfterCrash)
+{
+    // child process is started from scratch instead of forked from this one with its threads
+    testing::GTEST_FLAG(death_test_style) = "threadsafe";
+
+    static const AssetID assetID = 384;
+    auto txPath = CleanTempDir("tx_cache_journal_crash");
+    auto chainPath = CleanTempDir("tx_cache_journal_crash_chain");
+    auto hashOf = [](size_t height) {
+        return bitcoin::uint256S(QString::number(height, 16).toStdString()).ToString();
+    };
+    auto makeHeader = [&hashOf](size_t height, size_t prevHeight) {
+        Wire::VerboseBlockHeader header;
+        header.height = static_cast<uint32_t>(height);
+        header.hash = hashOf(height);
+        header.header.prevBlock = hashOf(prevHeight);
+        return header;
+    };
+    auto txIdOf = [](size_t height) { return "tx" + std::to_string(height); };
+
+    auto syncAndCrash = [&] {
+        WalletAssetsModel assetsModel("assets_conf.json");
+        auto db = std::make_shared<Utils::LevelDBSharedDatabase>(txPath.toStdString(), 1000);
+        // nothing is destroyed, process dies with whatever is still in memory
+        auto cache = new TransactionsCacheImpl(db);
+        cache->load(false).wait();
+        auto chainManager
+            = new ChainManager(assetsModel, chainPath, [cache] { cache->checkpointSync(); });
+        chainManager->loadChains({ assetID }).wait();
+        auto& chain = chainManager->chainById(assetID);
+        auto& assetCache = cache->cacheByIdSync(assetID);
+        for (size_t height = 1; height <= 5; ++height) {
+            assetCache.addTransactionsSync({ MakeJournalTx(assetID, txIdOf(height), 1) });
+            chain.connectTip(makeHeader(height, height - 1));
+        }
+
+        // gap makes chain manager write best block 5, checkpoint makes its transactions durable
+        chain.connectTip(makeHeader(10, 5));
+        assetCache.addTransactionsSync({ MakeJournalTx(assetID, txIdOf(10), 1) });
+        std::_Exit(0);
+    };
+    EXPECT_EXIT(syncAndCrash(), testing::ExitedWithCode(0), "");
+
+    WalletAssetsModel assetsModel("assets_conf.json");
+    auto db = std::make_shared<Utils::LevelDBSharedDatabase>(txPath.toStdString(), 1000);
+    TransactionsCacheImpl cache(db);
+    cache.load(false).wait();
+    ChainManager chainManager(assetsModel, chainPath, [&cache] { cache.checkpointSync(); });
+    chainManager.loadChains({ assetID }).wait();
+    auto& chain = chainManager.chainById(assetID);
+    auto& assetCache = cache.cacheByIdSync(assetID);
+
+    // stored best block never runs ahead of transactions, unsynced journal is lost
+    ASSERT_EQ(5u, chain.getHeight());
+    ASSERT_EQ(5u, assetCache.onChainTransactionsListSync().size());
+    ASSERT_FALSE(assetCache.transactionByIdSync(QString::fromStdString(txIdOf(10))));
+
+    // sync replays blocks after best block, adding known transaction again is no-op
+    assetCache.addTransactionsSync({ MakeJournalTx(assetID, txIdOf(5), 1),
+        MakeJournalTx(assetID, txIdOf(10), 1) });
+    ASSERT_EQ(6u, assetCache.onChainTransactionsListSync().size());
+    ASSERT_TRUE(assetCache.transactionByIdSync(QString::fromStdString(txIdOf(10))));
+
+    QDir(txPath).removeRecursively();
+    QDir(chainPath).removeRecursively();
+}
+
+//==============================================================================
+
+TEST(CoreTests, BootstrapInitialSyncBenchmark)
+{
+    static const AssetID assetID = 384;
+    static const uint32_t blocksCount = 10000;
+    auto tempDir = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+    auto sourcePath = tempDir.absoluteFilePath("bootstrap_source");
+    auto targetPath = tempDir.absoluteFilePath("bootstrap_target");
+    auto bootstrapPath = tempDir.absoluteFilePath("bootstrap_benchmark.dat");
+
+    auto hashAt = [](uint32_t height) {
+        return bitcoin::uint256S(QString::number(height, 16).toStdString());
+    };
+
+    QDir(sourcePath).removeRecursively();
+    QDir(targetPath).removeRecursively();
+    QDir().mkpath(sourcePath);
+    QDir().mkpath(targetPath);
+
+    {
+        bitcoin::CBlockTreeDB db(sourcePath.toStdString(), 1000);
+        bitcoin::CDBBatch batch(db);
+        for (uint32_t height = 1; height <= blocksCount; ++height) {
+            bitcoin::CDiskBlockFilter filter(
+                20, 784931, 19, std::vector<unsigned char>(250, height % 255));
+            bitcoin::CDiskBlockIndex index(1, hashAt(height - 1), hashAt(height), height, 0, 0,
+                height, hashAt(height), filter);
+            db.WriteBlockIndex(batch, assetID, index);
+        }
+        db.WriteBestBlock(batch, assetID, blocksCount);
+        db.WriteBatch(batch, true);
+    }
+
+    {
+        BootstrapWriter writer(sourcePath);
+        auto builder = writer.createBuilder(bootstrapPath, { assetID });
+        while (builder->canBuildNext()) {
+            builder->build();
+        }
+        builder->finalize();
+    }
+
+    WalletAssetsModel assetsModel("assets_conf.json");
+    {
+        ChainManager chainManager(assetsModel, targetPath);
+        std::cout << "Benchmarking initial sync from bootstrap, blocks = " << blocksCount
+                  << std::endl;
+        {
+            progress_timer timer;
+            chainManager.loadFromBootstrap(bootstrapPath).wait();
+            chainManager.loadChains({ assetID }).wait();
+        }
+
+        const auto& chain = chainManager.chainById(assetID);
+        ASSERT_EQ(blocksCount, chain.getHeight());
+        ASSERT_EQ(QString::fromStdString(hashAt(blocksCount).ToString()), chain.bestBlockHash());
+        auto header = chain.headerAt(blocksCount / 2);
+        ASSERT_TRUE(header);
+        ASSERT_EQ(250u, header->filter.bytes().size());
+    }
+
+    // corrupted chunk has to be rejected and leave chain index untouched
+    QFile::rename(bootstrapPath + ".old", bootstrapPath);
+    {
+        QFile file(bootstrapPath);
+        ASSERT_TRUE(file.open(QFile::ReadWrite));
+        file.seek(file.size() - 10);
+        file.write("corrupted");
+    }
+
+    {
+        ChainManager chainManager(assetsModel, targetPath);
+        ASSERT_ANY_THROW(chainManager.loadFromBootstrap(bootstrapPath).wait());
+        chainManager.loadChains({ assetID }).wait();
+        ASSERT_EQ(blocksCount, chainManager.chainById(assetID).getHeight());
+    }
+
+    QDir(sourcePath).removeRecursively();
+    QDir(targetPath).removeRecursively();
+    QFile::remove(bootstrapPath);
+}
+
+TEST(CoreTests, DirtyHeadersBuffer)
+{
+    auto hashOf = [](std::string value) { return bitcoin::uint256S(value); };
+    auto makeHeader = [&hashOf](size_t height, std::string hash) {
+        Wire::PackedBlockHeader header;
+        header.height = static_cast<uint32_t>(height);
+        header.hash = hashOf(hash);
+        return header;
+    };
+
+    DirtyHeadersBuffer buffer(4);
+    for (size_t height = 10; height < 30; ++height) {
+        buffer.push(makeHeader(height, std::to_string(height)));
+    }
+
+    ASSERT_EQ(20u, buffer.size());
+    ASSERT_EQ(29u, buffer.tipHeight());
+    ASSERT_EQ(nullptr, buffer.headerAt(9));
+    ASSERT_EQ(hashOf("15"), buffer.headerAt(15)->hash);
+    ASSERT_EQ(15u, buffer.heightOf(hashOf("15")).get());
+
+    // reorg drops everything above new header
+    buffer.push(makeHeader(20, "20b"));
+    ASSERT_EQ(20u, buffer.tipHeight());
+    ASSERT_EQ(hashOf("20b"), buffer.headerAt(20)->hash);
+    ASSERT_EQ(nullptr, buffer.headerAt(21));
+    ASSERT_FALSE(buffer.heightOf(hashOf("25")));
+
+    size_t expectedHeight = 10;
+    buffer.forEach([&](const auto& header) { ASSERT_EQ(expectedHeight++, header.height); });
+    ASSERT_EQ(21u, expectedHeight);
+
+    buffer.clear();
+    ASSERT_TRUE(buffer.empty());
+    ASSERT_EQ(nullptr, buffer.headerAt(15));
+}
+
+TEST(CoreTests, ChainManagerFlushesHeadersBeforeGap)
+{
+    static const AssetID assetID = 384;
+    auto path = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation))
+                    .absoluteFilePath("chain_headers_gap");
+    auto hashOf = [](size_t height) {
+        return bitcoin::uint256S(QString::number(height, 16).toStdString()).ToString();
+    };
+    auto makeHeader = [&hashOf](size_t height, size_t prevHeight) {
+        Wire::VerboseBlockHeader header;
+        header.height = static_cast<uint32_t>(height);
+        header.hash = hashOf(height);
+        header.header.prevBlock = hashOf(prevHeight);
+        return header;
+    };
+
+    QDir(path).removeRecursively();
+    QDir().mkpath(path);
+    {
+        WalletAssetsModel assetsModel("assets_conf.json");
+        ChainManager chainManager(assetsModel, path);
+        chainManager.loadChains({ assetID }).wait();
+        auto& chain = chainManager.chainById(assetID);
+        for (size_t height = 1; height <= 10; ++height) {
+            chain.connectTip(makeHeader(height, height - 1));
+        }
+
+        // tip doesn't follow buffered headers, they have to be flushed instead of dropped
+        chain.connectTip(makeHeader(20, 10));
+        auto header = chain.headerAt(5);
+        ASSERT_TRUE(header);
+        ASSERT_EQ(hashOf(5), header->hash);
+        ASSERT_EQ(hashOf(20), chain.headerAt(20)->hash);
+    }
+
+    QDir(path).removeRecursively();
+}
+
+TEST(CoreTests, ChainManagerKeepsBestBlockAfterReorgToShorterChain)
+{
+    static const AssetID assetID = 384;
+    const size_t forkOffset = 0x1000;
+    auto path = CleanTempDir("chain_headers_reorg");
+    auto hashOf = [](size_t value) {
+        return bitcoin::uint256S(QString::number(value, 16).toStdString()).ToString();
+    };
+    auto makeHeader = [](size_t height, std::string hash, std::string prevHash) {
+        Wire::VerboseBlockHeader header;
+        header.height = static_cast<uint32_t>(height);
+        header.hash = hash;
+        header.header.prevBlock = prevHash;
+        return header;
+    };
+
+    WalletAssetsModel assetsModel("assets_conf.json");
+    {
+        size_t flushes = 0;
+        ChainManager chainManager(assetsModel, path, [&flushes] { ++flushes; });
+        chainManager.loadChains({ assetID }).wait();
+        auto& chain = chainManager.chainById(assetID);
+        for (size_t height = 1; height <= 20; ++height) {
+            chain.connectTip(makeHeader(height, hashOf(height), hashOf(height - 1)));
+        }
+        ASSERT_TRUE(WaitFor([&flushes] { return flushes == 1; }, 5000));
+
+        // reorg to shorter chain which forks off at 15
+        while (chain.getHeight() > 15) {
+            chain.disconnectTip();
+        }
+        chain.connectTip(makeHeader(16, hashOf(forkOffset + 16), hashOf(15)));
+        ASSERT_EQ(hashOf(forkOffset + 16), chain.headerAt(16)->hash);
+        ASSERT_EQ(hashOf(15), chain.headerAt(15)->hash);
+        ASSERT_TRUE(WaitFor([&flushes] { return flushes == 2; }, 5000));
+    }
+
+    {
+        ChainManager chainManager(assetsModel, path);
+        chainManager.loadChains({ assetID }).wait();
+        // stored best block doesn't go down when tip moves to shorter chain
+        ASSERT_EQ(20u, chainManager.chainById(assetID).getHeight());
+    }
+
+    QDir(path).removeRecursively();
+}
+
+TEST(CoreTests, HeadersCacheBudget)
+{
+    auto makeHeader = [](uint32_t height) {
+        Wire::PackedBlockHeader header;
+        header.height = height;
+        header.hash = bitcoin::uint256S(QString::number(height, 16).toStdString());
+        header.filter = Wire::EncodedBlockFilter(
+            20, 784931, 19, std::vector<uint8_t>(250, static_cast<uint8_t>(height)));
+        return header;
+    };
+
+    const size_t maxBytes = 100 * 1024;
+    std::map<uint32_t, Wire::PackedBlockHeader> persisted;
+    HeadersCache cache(
+        maxBytes, [&](const auto& header) { persisted.emplace(header.height, header); });
+    for (uint32_t height = 1; height <= 10000; ++height) {
+        cache.insert(makeHeader(height));
+    }
+
+    auto stats = cache.stats();
+    ASSERT_GT(stats.evictions, 0u);
+    ASSERT_EQ(10000u, stats.entries);
+    // demoted headers cost only their index entry
+    ASSERT_LT(stats.bytes, maxBytes + 10000 * 64);
+
+    // most recent headers stay in memory, oldest are demoted to hash -> height
+    auto tip = cache.get(makeHeader(10000).hash);
+    ASSERT_TRUE(tip);
+    ASSERT_EQ(250u, tip->filter.bytes().size());
+    ASSERT_FALSE(cache.get(makeHeader(1).hash));
+    ASSERT_EQ(1u, cache.demotedHeight(makeHeader(1).hash).get_value_or(0));
+    ASSERT_EQ(1u, cache.stats().hits);
+
+    // demoted headers were handed over with their bodies
+    ASSERT_EQ(stats.evictions, persisted.size());
+    ASSERT_EQ(250u, persisted.at(1).filter.bytes().size());
+
+    // dropping second tier keeps recent headers in memory
+    cache.clearDemoted();
+    ASSERT_FALSE(cache.demotedHeight(makeHeader(1).hash));
+    ASSERT_TRUE(cache.get(makeHeader(10000).hash));
+
+    cache.clear();
+    ASSERT_FALSE(cache.demotedHeight(makeHeader(1).hash));
+    ASSERT_EQ(0u, cache.stats().entries);
+}
+
+TEST(CoreTests, ChainManagerHeadersBenchmark)
+{
+    static const AssetID assetID = 384;
+    auto path = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation))
+                    .absoluteFilePath("chain_headers_benchmark");
+
+    auto makeHeader = [](size_t height) {
+        Wire::VerboseBlockHeader header;
+        header.height = static_cast<uint32_t>(height);
+        header.hash = bitcoin::uint256S(QString::number(height, 16).toStdString()).ToString();
+        header.header.prevBlock
+            = bitcoin::uint256S(QString::number(height - 1, 16).toStdString()).ToString();
+        header.filter = Wire::EncodedBlockFilter(
+            20, 784931, 19, std::vector<uint8_t>(250, static_cast<uint8_t>(height)));
+        return header;
+    };
+
+    WalletAssetsModel assetsModel("assets_conf.json");
+    for (size_t chainLength : { 1000, 10000, 100000 }) {
+        // in-memory tier, previous implementation scanned unflushed headers linearly
+        {
+            DirtyHeadersBuffer buffer;
+            std::vector<Wire::VerboseBlockHeader> list;
+            for (size_t height = 1; height <= chainLength; ++height) {
+                buffer.push(Wire::PackedBlockHeader(makeHeader(height)));
+                list.emplace_back(makeHeader(height));
+            }
+
+            const size_t lookups = 1000;
+            std::cout << "Benchmarking " << lookups
+                      << " headerAt lookups, chainLength = " << chainLength << std::endl;
+            {
+                std::cout << "ring buffer: ";
+                progress_timer timer;
+                for (size_t i = 0; i < lookups; ++i) {
+                    ASSERT_NE(nullptr, buffer.headerAt(chainLength - i % chainLength));
+                }
+            }
+            {
+                std::cout << "linear scan: ";
+                progress_timer timer;
+                for (size_t i = 0; i < lookups; ++i) {
+                    auto height = chainLength - i % chainLength;
+                    auto it = std::find_if(std::begin(list), std::end(list),
+                        [height](const auto& item) { return item.height == height; });
+                    ASSERT_NE(std::end(list), it);
+                }
+            }
+        }
+
+        QDir(path).removeRecursively();
+        QDir().mkpath(path);
+        {
+            ChainManager chainManager(assetsModel, path);
+            chainManager.loadChains({ assetID }).wait();
+            auto& chain = chainManager.chainById(assetID);
+
+            std::cout << "Benchmarking connect and flush, chainLength = " << chainLength
+                      << std::endl;
+            {
+                progress_timer timer;
+                for (size_t height = 1; height <= chainLength; ++height) {
+                    chain.connectTip(makeHeader(height));
+                }
+            }
+
+            {
+                std::cout << "headerAt over last 1000 blocks: ";
+                progress_timer timer;
+                for (size_t height = chainLength; height > chainLength - 1000; --height) {
+                    ASSERT_TRUE(chain.headerAt(height));
+                }
+            }
+        }
+    }
+
+    QDir(path).removeRecursively();
+}
+
+static Wire::VerboseBlockHeader MakeBenchmarkHeader(size_t height)
+{
+    auto hashOf = [](size_t value) {
+        return bitcoin::uint256S(QString::number(value * 2654435761u, 16).toStdString()).ToString();
+    };
+    Wire::VerboseBlockHeader header;
+    header.height = static_cast<uint32_t>(height);
+    header.hash = hashOf(height);
+    header.header.version = 536870912;
+    header.header.prevBlock = hashOf(height - 1);
+    header.header.merkleRoot = hashOf(height + 1000000);
+    header.header.timestamp = static_cast<uint32_t>(1560000000 + height * 60);
+    header.header.bits = 0x1b0404cb;
+    header.header.nonce = static_cast<uint32_t>(height);
+    header.filter = Wire::EncodedBlockFilter(
+        20, 784931, 19, std::vector<uint8_t>(250, static_cast<uint8_t>(height)));
+    return header;
+}
+
+#ifdef Q_OS_LINUX
+static size_t ResidentMemoryKb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return std::stoul(line.substr(6));
+        }
+    }
+
+    return 0;
+}
+#endif
+
+TEST(CoreTests, PackedBlockHeaderMemoryBenchmark)
+{
+#ifdef Q_OS_LINUX
+    static const AssetID assetID = 384;
+    const size_t count = 10000;
+    boost::compute::detail::lru_cache<std::pair<AssetID, QString>, Wire::VerboseBlockHeader>
+        verboseCache(count);
+    boost::compute::detail::lru_cache<std::pair<AssetID, bitcoin::uint256>,
+        Wire::PackedBlockHeader>
+        packedCache(count);
+
+    // both caches are kept alive so that second one doesn't reuse memory freed by first one.
+    auto before = ResidentMemoryKb();
+    for (size_t height = 1; height <= count; ++height) {
+        auto header = MakeBenchmarkHeader(height);
+        verboseCache.insert({ assetID, QString::fromStdString(header.hash) }, header);
+    }
+    auto verboseKb = ResidentMemoryKb() - before;
+
+    before = ResidentMemoryKb();
+    for (size_t height = 1; height <= count; ++height) {
+        Wire::PackedBlockHeader packed(MakeBenchmarkHeader(height));
+        packedCache.insert({ assetID, packed.hash }, packed);
+    }
+    auto packedKb = ResidentMemoryKb() - before;
+
+    std::cout << "RSS per " << count << " cached headers, verbose: " << verboseKb
+              << " KB, packed: " << packedKb << " KB" << std::endl;
+#else
+    GTEST_SKIP() << "resident memory is read from /proc";
+#endif
+}
+
+TEST(CoreTests, PackedBlockHeaderBenchmark)
+{
+    {
+        auto header = MakeBenchmarkHeader(42);
+        Wire::PackedBlockHeader packed(header);
+        auto unpacked = packed.unpack();
+        ASSERT_EQ(header.hash, unpacked.hash);
+        ASSERT_EQ(header.header.prevBlock, unpacked.header.prevBlock);
+        ASSERT_EQ(header.header.merkleRoot, unpacked.header.merkleRoot);
+        ASSERT_EQ(header.header.timestamp, unpacked.header.timestamp);
+        ASSERT_EQ(header.height, unpacked.height);
+        // filter blob is shared, not copied
+        ASSERT_EQ(&header.filter.bytes(), &unpacked.filter.bytes());
+
+        auto restored = DBUtils::DiskIndexToPackedHeader(DBUtils::BlockIndexToDisk(packed));
+        ASSERT_EQ(packed.hash, restored.hash);
+        ASSERT_EQ(packed.prevBlock, restored.prevBlock);
+        ASSERT_EQ(header.filter.bytes(), restored.filter.bytes());
+    }
+
+    const size_t iterations = 100000;
+    std::vector<Wire::VerboseBlockHeader> headers;
+    for (size_t height = 1; height <= 1000; ++height) {
+        headers.emplace_back(MakeBenchmarkHeader(height));
+    }
+    std::vector<Wire::PackedBlockHeader> packedHeaders(headers.begin(), headers.end());
+
+    std::cout << "Benchmarking " << iterations << " conversions" << std::endl;
+    {
+        std::cout << "pack: ";
+        progress_timer timer;
+        for (size_t i = 0; i < iterations; ++i) {
+            Wire::PackedBlockHeader packed(headers[i % headers.size()]);
+            ASSERT_NE(0u, packed.height);
+        }
+    }
+    {
+        std::cout << "unpack: ";
+        progress_timer timer;
+        for (size_t i = 0; i < iterations; ++i) {
+            ASSERT_FALSE(packedHeaders[i % packedHeaders.size()].unpack().hash.empty());
+        }
+    }
+    {
+        std::cout << "serialize and deserialize, verbose: ";
+        progress_timer timer;
+        for (size_t i = 0; i < iterations; ++i) {
+            CDataStream ss(bitcoin::SER_DISK, 0);
+            ss << DBUtils::BlockIndexToDisk(headers[i % headers.size()]);
+            bitcoin::CDiskBlockIndex diskIndex;
+            ss >> diskIndex;
+            ASSERT_FALSE(DBUtils::DiskIndexToBlockIndex(diskIndex).hash.empty());
+        }
+    }
+    {
+        std::cout << "serialize and deserialize, packed: ";
+        progress_timer timer;
+        for (size_t i = 0; i < iterations; ++i) {
+            CDataStream ss(bitcoin::SER_DISK, 0);
+            ss << DBUtils::BlockIndexToDisk(packedHeaders[i % packedHeaders.size()]);
+            bitcoin::CDiskBlockIndex diskIndex;
+            ss >> diskIndex;
+            ASSERT_FALSE(DBUtils::DiskIndexToPackedHeader(diskIndex).hash.IsNull());
+        }
+    }
+}
+
+TEST(CoreTests, UTXOBalanceLedgerBenchmark)
+{
+    const AssetID assetID = 384;
+    const int64_t minConfirmations = 6;
+    const size_t txCount = 100000;
+    const int64_t blocksCount = 10000;
+
+    std::vector<OnChainTxRef> transactions;
+    transactions.reserve(txCount);
+    for (size_t i = 0; i < txCount; ++i) {
+        // every tenth transaction is still in mempool
+        int64_t height = i % 10 == 0 ? -1 : static_cast<int64_t>(i % blocksCount);
+        OnChainTx::Outputs outputs(1);
+        outputs.back().set_value(1000);
+        auto tx = std::make_shared<OnChainTx>(assetID, QString::number(i), QString(), height, 0,
+            QDateTime(), OnChainTx::Inputs{}, outputs,
+            chain::OnChainTransaction_TxType::OnChainTransaction_TxType_PAYMENT, TxMemo{});
+        tx->_delta = i % 3 == 0 ? -700 : 1500;
+        transactions.emplace_back(tx);
+    }
+
+    // same math as full scan which was done on every tip before
+    auto fullScan = [&](int64_t chainHeight) {
+        Balance confirmed = 0;
+        for (const auto& tx : transactions) {
+            if (tx->blockHeight() < 0) {
+                confirmed += tx->delta() - tx->outputs().Get(0).value();
+            } else if (chainHeight >= tx->blockHeight()
+                && chainHeight - tx->blockHeight() + 1 >= minConfirmations) {
+                confirmed += tx->delta();
+            }
+        }
+        return confirmed;
+    };
+
+    UTXOBalanceLedger ledger(minConfirmations);
+    for (const auto& tx : transactions) {
+        ledger.apply(*tx);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration ledgerTime{ 0 };
+    for (int64_t height = 0; height < blocksCount; ++height) {
+        auto start = Clock::now();
+        ledger.setChainHeight(height);
+        ledgerTime += Clock::now() - start;
+        if (height % 1000 == 0) {
+            ASSERT_EQ(fullScan(height), ledger.confirmedBalance());
+        }
+    }
+
+    // full scan is too slow to run for every tip, sample is enough for per tip cost
+    const int64_t sampledTips = 100;
+    auto start = Clock::now();
+    for (int64_t height = 0; height < sampledTips; ++height) {
+        volatile Balance confirmed = fullScan(blocksCount - height);
+        Q_UNUSED(confirmed);
+    }
+    auto scanTime = Clock::now() - start;
+
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+    std::cout << "Per tip update cost, txns = " << txCount << ", full scan: "
+              << duration_cast<nanoseconds>(scanTime).count() / sampledTips
+              << " ns, ledger: " << duration_cast<nanoseconds>(ledgerTime).count() / blocksCount
+              << " ns" << std::endl;
+
+    // reorg back and replacing transaction keep ledger consistent
+    ledger.setChainHeight(blocksCount / 2);
+    ASSERT_EQ(fullScan(blocksCount / 2), ledger.confirmedBalance());
+    transactions.front()->tx().set_block_height(blocksCount / 4);
+    ledger.apply(*transactions.front());
+    ASSERT_EQ(fullScan(blocksCount / 2), ledger.confirmedBalance());
+}
+
 TEST(CoreTests, EthExp10DecimalCache)
 {
     ASSERT_EQ(eth::u256(1), eth::exp10(0));
@@ -1,18 +1,31 @@
 #ifndef TST_PORTALHTTPCLIENT_HPP
 #define TST_PORTALHTTPCLIENT_HPP
 
+#include <QAbstractItemModelTester>
+#include <QElapsedTimer>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QPointer>
 #include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+#include <QThread>
 #include <QTimer>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <atomic>
 #include <gtest/gtest.h>
+#include <iostream>
 #include <memory>
 
 #include <Chain/AbstractAssetAccount.hpp>
 #include <Chain/AbstractTransactionsCache.hpp>
+#include <Chain/AccountSyncManager.hpp>
+#include <Chain/CachedChainDataSource.hpp>
 #include <Chain/Chain.hpp>
 #include <Chain/ChainManager.hpp>
 #include <Chain/ChainSyncManager.hpp>
@@ -21,10 +34,15 @@
 #include <Data/WalletAssetsModel.hpp>
 #include <Factories/ApiClientNetworkingFactory.hpp>
 #include <Factories/ChainSyncManagerFactory.hpp>
+#include <Models/AssetTransactionsDataSource.hpp>
 #include <Models/SyncService.hpp>
+#include <Models/WalletTransactionsListModel.hpp>
+#include <Networking/AbstractAccountExplorerHttpClient.hpp>
 #include <Networking/AbstractBlockExplorerHttpClient.hpp>
+#include <Networking/BlockExplorerTipStream.hpp>
 #include <Networking/NetworkConnectionState.hpp>
 #include <Networking/RequestHandlerImpl.hpp>
+#include <Networking/Web3Client.hpp>
 #include <Networking/XSNBlockExplorerHttpClient.hpp>
 #include <golomb/gcs.h>
 #include <utilstrencodings.h>
@@ -328,23 +346,26 @@ public:
         return *_caches.at(assetId);
     }
     std::vector<AssetID> availableCaches() const override { return { 0 }; }
+    void checkpointSync() override {}
 
     std::unordered_map<AssetID, std::unique_ptr<MockTransactionsCache>> _caches;
 };
 
 struct MockFilterMatcher : public BlockFilterMatcher {
-    MockFilterMatcher(AssetID assetID, std::set<QString> matches)
+    MockFilterMatcher(AssetID assetID, std::set<QString> matches, bool matchAll = false)
         : BlockFilterMatcher(assetID)
         , _matches(matches)
+        , _matchAll(matchAll)
     {
     }
 
     bool match(const BlockIndex& blockIndex) const override
     {
-        return _matches.count(blockIndex.hash()) > 0;
+        return _matchAll || _matches.count(blockIndex.hash()) > 0;
     }
 
     std::set<QString> _matches;
+    bool _matchAll{ false };
 };
 
 struct MockFilterMatchable : public BlockFilterMatchable {
@@ -389,6 +410,8 @@ public:
     {
         return Promise<void>([](const auto& resolve, const auto& reject) { reject(); });
     }
+
+    Chain& chainById(AssetID assetID) const { return *_chains.at(assetID); }
 };
 
 class MockedChainDataSource : public AbstractChainDataSource {
@@ -516,6 +539,7 @@ protected:
     std::unique_ptr<ChainSyncManagerFactory> _smFactory;
     std::unique_ptr<AbstractNetworkingFactory> _ntFactory;
     std::unique_ptr<Utils::WorkerThread> _worker;
+    std::unique_ptr<Utils::KeyedWorkerThreads> _assetWorkers;
     std::unique_ptr<MockDataSource> _mockDataSource;
     std::unique_ptr<MockAssetsTransactionsCache> _cache;
     std::unique_ptr<MockFilterMatchable> _filterMatchable;
@@ -537,6 +561,7 @@ protected:
         NetworkConnectionState::Initialize();
         _worker.reset(new Utils::WorkerThread);
         _worker->start();
+        _assetWorkers.reset(new Utils::KeyedWorkerThreads("AssetWorker"));
         _filterMatchable.reset(new MockFilterMatchable);
         _mockDataSource.reset(new MockDataSource);
         _cache.reset(new MockAssetsTransactionsCache);
@@ -544,7 +569,7 @@ protected:
         _assetsAccountsCache.reset(new MockedAssetsAccountsCache);
         _accountDataSource.reset(new MockedAccountDataSource);
         _smFactory.reset(new ChainSyncManagerFactory(&assetsModel, &_apiClientsFactory, *_worker,
-            *_mockDataSource, *_accountDataSource, *_chainDataSource, *_cache,
+            *_assetWorkers, *_mockDataSource, *_accountDataSource, *_chainDataSource, *_cache,
             *_assetsAccountsCache, *_filterMatchable));
         _ntFactory.reset(new ApiClientNetworkingFactory);
         _chainManager.reset(new MockChainManager(assetsModel));
@@ -556,6 +581,7 @@ protected:
         _worker->quit();
         _worker->wait();
         _worker.reset();
+        _assetWorkers.reset();
         _filterMatchable.reset();
         _mockDataSource.reset();
         _cache.reset();
@@ -1068,6 +1094,962 @@ TEST_F(WalletTests, ReorgTest)
     ASSERT_EQ(localChain.bestBlockHash().toStdString(), bestChain.bestBlockHash());
 }
 
+// Matches everything, batches are held on matching thread until test releases them.
+struct GatedFilterMatcher : public BlockFilterMatcher {
+    struct Gate {
+        std::atomic<int> entered{ 0 };
+        std::atomic<int> left{ 0 };
+        std::atomic<bool> released{ false };
+    };
+
+    GatedFilterMatcher(AssetID assetID, std::shared_ptr<Gate> gate)
+        : BlockFilterMatcher(assetID)
+        , _gate(gate)
+    {
+    }
+
+    bool match(const BlockIndex&) const override { return true; }
+
+    std::vector<size_t> matchBatch(const std::vector<BlockIndex>& indexes) const override
+    {
+        ++_gate->entered;
+        while (!_gate->released) {
+            QThread::msleep(1);
+        }
+
+        auto result = BlockFilterMatcher::matchBatch(indexes);
+        ++_gate->left;
+        return result;
+    }
+
+    BFMatcherUniqueRef clone() const override
+    {
+        return BFMatcherUniqueRef(new GatedFilterMatcher(*this));
+    }
+
+    std::shared_ptr<Gate> _gate;
+};
+
+struct GatedFilterMatchable : public BlockFilterMatchable {
+    BFMatcherUniqueRef createMatcher(AssetID assetID) const override
+    {
+        return BFMatcherUniqueRef(new GatedFilterMatcher(assetID, _gate));
+    }
+
+    std::shared_ptr<GatedFilterMatcher::Gate> _gate{ std::make_shared<GatedFilterMatcher::Gate>() };
+};
+
+TEST_F(WalletTests, BackgroundMatchingDropsResultsAfterInterrupt)
+{
+    const AssetID assetID = 384;
+    RegtestDataSource regtestDataSource(assetsModel);
+    RegtestChainManager regtestChainManager(regtestDataSource, assetsModel);
+    regtestChainManager.loadChains({ assetID }).wait();
+
+    std::map<size_t, Wire::VerboseBlockHeader> connectedBlocks;
+    auto set = [&connectedBlocks](
+                   auto verboseHeader) { connectedBlocks[verboseHeader.height] = verboseHeader; };
+    auto get = [&connectedBlocks](auto height) -> boost::optional<Wire::VerboseBlockHeader> {
+        return connectedBlocks.count(height) > 0 ? boost::make_optional(connectedBlocks.at(height))
+                                                 : boost::none;
+    };
+
+    Chain localChain(assetID, set, get);
+    GatedFilterMatchable filterMatchable;
+    auto gate = filterMatchable._gate;
+    ChainSyncManager syncManager(localChain, *_cache, *_mockDataSource, filterMatchable,
+        assetsModel.assetById(assetID), regtestDataSource);
+    syncManager.setMatchingContext(_assetWorkers->threadFor(assetID).context());
+
+    regtestDataSource.chain(assetID).generateBlocks(bitcoin::CScript(), 100);
+    const auto heightBefore = localChain.getHeight();
+
+    auto waitFor = [](auto predicate) {
+        QElapsedTimer timer;
+        timer.start();
+        while (!predicate() && timer.elapsed() < 5000) {
+            QTest::qWait(1);
+        }
+        return predicate();
+    };
+
+    syncManager.trySync();
+    ASSERT_TRUE(waitFor([&gate] { return gate->entered > 0; }));
+    ASSERT_NE(QThread::currentThread(), _assetWorkers->threadFor(assetID).context()->thread());
+
+    syncManager.interrupt();
+    ASSERT_TRUE(waitFor([&syncManager] { return !syncManager.isSyncing(); }));
+
+    // batch was matched with generation that is not synced anymore, nothing can be applied
+    gate->released = true;
+    ASSERT_TRUE(waitFor([&gate] { return gate->left > 0; }));
+    QTest::qWait(100);
+
+    ASSERT_EQ(gate->entered, 1);
+    ASSERT_EQ(localChain.getHeight(), heightBefore);
+    ASSERT_FALSE(syncManager.isSyncing());
+}
+
+TEST_F(WalletTests, TipStreamFakeServer)
+{
+    QWebSocketServer server("fake-explorer", QWebSocketServer::NonSecureMode);
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+
+    QPointer<QWebSocket> peer;
+    QObject::connect(&server, &QWebSocketServer::newConnection,
+        [&server, &peer] { peer = server.nextPendingConnection(); });
+
+    BlockExplorerTipStream stream(server.serverUrl());
+    QSignalSpy connectedSpy(&stream, &BlockExplorerTipStream::connectedChanged);
+    QSignalSpy tipSpy(&stream, &BlockExplorerTipStream::tipReceived);
+    stream.open();
+
+    ASSERT_TRUE(connectedSpy.wait());
+    ASSERT_TRUE(connectedSpy.takeFirst().at(0).toBool());
+    ASSERT_TRUE(peer);
+
+    peer->sendTextMessage("not a tip");
+    peer->sendTextMessage(R"({"hash": "00ff", "height": 42})");
+    ASSERT_TRUE(tipSpy.wait());
+    ASSERT_EQ(tipSpy.count(), 1);
+    ASSERT_EQ(tipSpy.at(0).at(0).toString(), QString("00ff"));
+    ASSERT_EQ(tipSpy.at(0).at(1).toUInt(), 42u);
+
+    peer->close();
+    ASSERT_TRUE(connectedSpy.wait());
+    ASSERT_FALSE(connectedSpy.takeFirst().at(0).toBool());
+
+    // stream reconnects by itself
+    ASSERT_TRUE(connectedSpy.wait(10000));
+    ASSERT_TRUE(connectedSpy.takeFirst().at(0).toBool());
+    stream.close();
+}
+
+TEST_F(WalletTests, TipStreamRetriesRefusedConnection)
+{
+    QWebSocketServer server("fake-explorer", QWebSocketServer::NonSecureMode);
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+    const auto url = server.serverUrl();
+    const auto port = server.serverPort();
+    server.close();
+
+    // nothing listens yet, refused connection isn't a reason to give up
+    BlockExplorerTipStream stream(url);
+    QSignalSpy connectedSpy(&stream, &BlockExplorerTipStream::connectedChanged);
+    stream.open();
+    QTest::qWait(500);
+    ASSERT_EQ(connectedSpy.count(), 0);
+
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost, port));
+    ASSERT_TRUE(connectedSpy.wait(10000));
+    ASSERT_TRUE(connectedSpy.takeFirst().at(0).toBool());
+    stream.close();
+}
+
+TEST_F(WalletTests, TipStreamGivesUpOnPlainHttpResponse)
+{
+    QTcpServer server;
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+    int connections = 0;
+    QObject::connect(&server, &QTcpServer::newConnection, [&server, &connections] {
+        ++connections;
+        auto peer = server.nextPendingConnection();
+        QObject::connect(peer, &QTcpSocket::readyRead, [peer] {
+            peer->readAll();
+            // connection stays open, client has to give up because of the response alone
+            peer->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+        });
+    });
+
+    BlockExplorerTipStream stream(QUrl(QString("ws://127.0.0.1:%1").arg(server.serverPort())));
+    stream.open();
+
+    // first reconnect would happen after 5 seconds
+    QTest::qWait(7000);
+    ASSERT_EQ(connections, 1);
+    ASSERT_FALSE(stream.isConnected());
+}
+
+// Keeps transactions which account sync stores, stored transaction replaces one with the same id.
+class EthTransactionsCache : public MockTransactionsCache {
+public:
+    void addTransactionsSync(std::vector<Transaction> transactions) override
+    {
+        for (auto&& transaction : transactions) {
+            auto tx = *boost::variant2::get_if<EthOnChainTxRef>(&transaction);
+            auto it = std::find_if(_ethTransactions.begin(), _ethTransactions.end(),
+                [tx](const auto& stored) { return stored->txId() == tx->txId(); });
+            if (it != _ethTransactions.end()) {
+                *it = tx;
+            } else {
+                _ethTransactions.emplace_back(tx);
+            }
+        }
+    }
+
+    const EthOnChainTxList& ethOnChainTransactionsListSync() const override
+    {
+        return _ethTransactions;
+    }
+
+    EthOnChainTxList _ethTransactions;
+};
+
+class BalancesAccountsCache : public MockedAssetsAccountsCache {
+public:
+    struct Account : AbstractMutableAccount {
+        void setAccountBalance(Balance newBalance) override { balance = newBalance; }
+        void setAccountNonce(Balance) override {}
+        void setUpdateHeight(Balance) override {}
+
+        Balance balance{ -1 };
+    };
+
+    AbstractMutableAccount& mutableCacheByIdSync(AssetID assetId) override
+    {
+        return _accounts[assetId];
+    }
+
+    std::map<AssetID, Account> _accounts;
+};
+
+class FixedAccountDataSource : public MockedAccountDataSource {
+public:
+    explicit FixedAccountDataSource(QString address)
+        : _address(address)
+    {
+    }
+
+    Promise<QString> getAccountAddress(AssetID) const override
+    {
+        return QtPromise::resolve(_address);
+    }
+
+    QString _address;
+};
+
+// Explorer which returns the same page of transactions every time, it answers after a delay as
+// remote one would.
+class FixedAccountExplorerHttpClient : public AbstractAccountExplorerHttpClient {
+public:
+    explicit FixedAccountExplorerHttpClient(QJsonArray transactions)
+        : _transactions(transactions)
+    {
+    }
+
+    Promise<QByteArray> getAccountTransactionsForAddress(QString, size_t, QString) override
+    {
+        QJsonObject page{ { "data", _transactions },
+            { "scrollId", _transactions.last().toObject().value("hash") } };
+        return QtPromise::resolve(QJsonDocument(page).toJson()).delay(10);
+    }
+
+    QJsonArray _transactions;
+};
+
+TEST_F(WalletTests, Web3BatchedSyncCycle)
+{
+    const AssetID ethAssetID = 60;
+    const QString address = "0x8055b3bddfc17f15851205fc327a693970292ce7";
+    const int unconfirmedCount = 5;
+
+    QWebSocketServer server("fake-web3", QWebSocketServer::NonSecureMode);
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+
+    size_t roundTrips = 0;
+    size_t requests = 0;
+    auto respond = [&requests](const QJsonObject& request) {
+        ++requests;
+        auto method = request.value("method").toString();
+        auto params = request.value("params").toArray();
+        QJsonObject response{ { "jsonrpc", "2.0" }, { "id", request.value("id") } };
+        if (method == "eth_getBlockByNumber") {
+            response["result"] = QJsonObject{ { "number", "0x10" }, { "hash", "0xbb" } };
+        } else if (method == "eth_getTransactionByHash") {
+            response["result"] = QJsonObject{ { "hash", params.at(0) }, { "blockHash", "0xbb" },
+                { "blockNumber", "0x10" } };
+        } else if (method == "eth_subscribe") {
+            response["result"] = "0x1";
+        } else {
+            response["result"] = "0x64";
+        }
+        return response;
+    };
+
+    QPointer<QWebSocket> peer;
+    QObject::connect(&server, &QWebSocketServer::newConnection, [&] {
+        peer = server.nextPendingConnection();
+        QObject::connect(peer, &QWebSocket::textMessageReceived, [&](QString message) {
+            ++roundTrips;
+            auto document = QJsonDocument::fromJson(message.toUtf8());
+            if (document.isArray()) {
+                QJsonArray responses;
+                for (auto&& request : document.array()) {
+                    responses.append(respond(request.toObject()));
+                }
+                peer->sendTextMessage(QJsonDocument(responses).toJson());
+            } else {
+                peer->sendTextMessage(QJsonDocument(respond(document.object())).toJson());
+            }
+        });
+    });
+
+    auto waitFor = [](auto predicate) {
+        QElapsedTimer timer;
+        timer.start();
+        while (!predicate() && timer.elapsed() < 5000) {
+            QTest::qWait(1);
+        }
+        return predicate();
+    };
+
+    // explorer knows transactions of account which are still pending
+    QJsonArray pending;
+    for (int i = 0; i < unconfirmedCount; ++i) {
+        pending.append(QJsonObject{ { "hash", QString("0x%1").arg(i) }, { "from", address },
+            { "to", "0x1111111111111111111111111111111111111111" }, { "value", 1000 },
+            { "gas", 21000 }, { "gasPrice", 1 }, { "nonce", i }, { "input", "0x" } });
+    }
+
+    std::vector<CoinAsset> tokens;
+    for (auto&& asset : assetsModel.assets()) {
+        if (asset.token() && asset.token()->chainID() == ethAssetID) {
+            tokens.emplace_back(asset);
+        }
+    }
+
+    auto txCache = new EthTransactionsCache;
+    _cache->_caches[ethAssetID].reset(txCache);
+    BalancesAccountsCache accountsCache;
+    FixedAccountDataSource accountDataSource(address);
+    Chain chain(ethAssetID, [](Wire::VerboseBlockHeader) {},
+        [](size_t) -> boost::optional<Wire::VerboseBlockHeader> { return boost::none; });
+
+    auto web3Client = new Web3Client(server.serverUrl());
+    QSignalSpy connectedSpy(web3Client, &Web3Client::connected);
+    web3Client->open();
+    ASSERT_TRUE(connectedSpy.wait());
+
+    AccountSyncManager syncManager(chain, *_cache, assetsModel.assetById(ethAssetID),
+        accountsCache, accountDataSource,
+        qobject_delete_later_unique_ptr<AbstractWeb3Client>(web3Client),
+        qobject_delete_later_unique_ptr<AbstractAccountExplorerHttpClient>(
+            new FixedAccountExplorerHttpClient(pending)),
+        tokens, nullptr);
+
+    // manager subscribes for new heads right away
+    ASSERT_TRUE(waitFor([&requests] { return requests == 1; }));
+    roundTrips = 0;
+    requests = 0;
+    auto statsBefore = web3Client->schedulerStats();
+
+    QSignalSpy finishedSpy(&syncManager, &AccountSyncManager::finished);
+    syncManager.trySync();
+    ASSERT_TRUE(finishedSpy.wait());
+
+    // tip and balances leave together, pending transactions are looked up once explorer answers
+    auto stats = web3Client->schedulerStats();
+    std::cout << "Web3 round trips per sync cycle: " << roundTrips << ", requests: " << requests
+              << ", calls: " << stats.calls - statsBefore.calls << std::endl;
+    ASSERT_EQ(2u, roundTrips);
+    ASSERT_EQ(2u + tokens.size() + unconfirmedCount, requests);
+    ASSERT_EQ(statsBefore.merged, stats.merged);
+
+    ASSERT_EQ(tokens.size() + 1, accountsCache._accounts.size());
+    ASSERT_EQ(static_cast<size_t>(unconfirmedCount), txCache->_ethTransactions.size());
+    for (auto&& tx : txCache->_ethTransactions) {
+        ASSERT_EQ(16, tx->blockHeight());
+    }
+
+    // tips are pushed by subscription, no polling needed between cycles
+    QSignalSpy tipSpy(&syncManager, &AccountSyncManager::tipNotified);
+    QJsonObject head{ { "number", "0x11" }, { "hash", "0xcc" } };
+    QJsonObject notification{ { "jsonrpc", "2.0" }, { "method", "eth_subscription" },
+        { "params", QJsonObject{ { "subscription", "0x1" }, { "result", head } } } };
+    peer->sendTextMessage(QJsonDocument(notification).toJson());
+    ASSERT_TRUE(tipSpy.wait());
+    ASSERT_EQ(QString("0xcc"), chain.bestBlockHash());
+}
+
+class RegtestSyncManagerFactory : public AbstractChainSyncManagerFactory {
+public:
+    RegtestSyncManagerFactory(WalletAssetsModel& assetsModel, AssetsTransactionsCache& cache,
+        WalletDataSource& dataSource, const BlockFilterMatchable& filterMatcher,
+        AbstractChainDataSource& chainDataSource)
+        : AbstractChainSyncManagerFactory(&assetsModel, nullptr)
+        , _cache(cache)
+        , _dataSource(dataSource)
+        , _filterMatcher(filterMatcher)
+        , _chainDataSource(chainDataSource)
+    {
+    }
+
+    AbstractChainSyncManagerPtr createAPISyncManager(Chain& chain) override
+    {
+        auto assetID = chain.assetID();
+        auto& headers = _headers[assetID];
+        auto set = [&headers](auto header) { headers[header.height] = header; };
+        auto get = [&headers](auto height) -> boost::optional<Wire::VerboseBlockHeader> {
+            return headers.count(height) > 0 ? boost::make_optional(headers.at(height))
+                                             : boost::none;
+        };
+
+        _localChains[assetID].reset(new Chain(assetID, set, get));
+        return AbstractChainSyncManagerPtr(new ChainSyncManager(*_localChains.at(assetID), _cache,
+            _dataSource, _filterMatcher, assetsModel()->assetById(assetID), _chainDataSource));
+    }
+
+    AbstractChainSyncManagerPtr createRescanSyncManager(Chain& chain) override
+    {
+        return createAPISyncManager(chain);
+    }
+
+    const Chain& localChain(AssetID assetID) const { return *_localChains.at(assetID); }
+
+private:
+    AssetsTransactionsCache& _cache;
+    WalletDataSource& _dataSource;
+    const BlockFilterMatchable& _filterMatcher;
+    AbstractChainDataSource& _chainDataSource;
+    std::map<AssetID, std::map<size_t, Wire::VerboseBlockHeader>> _headers;
+    std::map<AssetID, std::unique_ptr<Chain>> _localChains;
+};
+
+// Serves regtest blocks as light wallet blocks, outputs are addressed by hex of their script.
+class LightWalletRegtestDataSource : public RegtestDataSource {
+public:
+    using RegtestDataSource::RegtestDataSource;
+
+    Promise<Wire::StrippedBlock> getLightWalletBlock(
+        AssetID assetID, BlockHash hash, int64_t blockHeight) const override
+    {
+        const auto txType = chain::OnChainTransaction_TxType::OnChainTransaction_TxType_PAYMENT;
+        const auto& block = chain(assetID).blockByHash(hash);
+        OnChainTxList txns;
+        for (size_t i = 0; i < block.transactions.size(); ++i) {
+            OnChainTx::Outputs outputs;
+            const auto& txOut = block.transactions[i].txOut;
+            for (size_t j = 0; j < txOut.size(); ++j) {
+                chain::TxOutput output;
+                output.set_address(bitcoin::HexStr(txOut[j].pkScript));
+                output.set_index(static_cast<uint32_t>(j));
+                output.set_value(txOut[j].value);
+                outputs.emplace_back(output);
+            }
+            txns.emplace_back(std::make_shared<OnChainTx>(assetID,
+                QString("%1:%2").arg(hash).arg(i), hash, blockHeight, static_cast<uint32_t>(i),
+                QDateTime::currentDateTime(), OnChainTx::Inputs{}, outputs, txType, TxMemo{}));
+        }
+
+        Wire::StrippedBlock result(hash);
+        result.addTransactions(txns);
+        return QtPromise::resolve(result);
+    }
+};
+
+// Wallet which owns outputs paying to one script, balance is whatever sync has applied so far.
+class ScriptBalanceDataSource : public MockDataSource {
+public:
+    explicit ScriptBalanceDataSource(QString script)
+        : _script(script)
+    {
+    }
+
+    OnChainTxRef applyTransaction(OnChainTxRef source, LookupTxById) override
+    {
+        OnChainTxRef result;
+        for (auto&& output : source->outputs()) {
+            if (QString::fromStdString(output.address()) == _script) {
+                _balance += output.value();
+                result = source;
+            }
+        }
+
+        return result;
+    }
+
+    int64_t balance() const { return _balance; }
+
+private:
+    QString _script;
+    std::atomic<int64_t> _balance{ 0 };
+};
+
+struct MatchAllFilterMatchable : public BlockFilterMatchable {
+    BFMatcherUniqueRef createMatcher(AssetID assetID) const override
+    {
+        return BFMatcherUniqueRef(new MockFilterMatcher(assetID, {}, true));
+    }
+};
+
+TEST_F(WalletTests, SyncServiceTipToBalanceLatency)
+{
+    const AssetID assetID = 384;
+    const std::vector<unsigned char> walletScript{ 0x51 };
+    _cache->_caches.emplace(assetID, std::make_unique<MockTransactionsCache>());
+
+    LightWalletRegtestDataSource regtestDataSource(assetsModel);
+    RegtestChainManager regtestChainManager(regtestDataSource, assetsModel);
+    regtestChainManager.loadChains({ assetID }).wait();
+
+    ScriptBalanceDataSource wallet(QString::fromStdString(bitcoin::HexStr(walletScript)));
+    MatchAllFilterMatchable filterMatchable;
+    RegtestSyncManagerFactory factory(
+        assetsModel, *_cache, wallet, filterMatchable, regtestDataSource);
+    SyncService syncService(factory, regtestChainManager, assetsModel, wallet, regtestDataSource);
+    QSignalSpy syncFinished(&syncService, &SyncService::syncTaskFinished);
+
+    const auto& producer = regtestDataSource.chain(assetID);
+    auto waitForTip = [&](int timeout) {
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < timeout) {
+            if (syncService.isChainSynced(assetID)
+                && factory.localChain(assetID).bestBlockHash().toStdString()
+                    == producer.bestBlockHash()) {
+                return true;
+            }
+            syncFinished.wait(timeout - static_cast<int>(timer.elapsed()));
+        }
+        return false;
+    };
+
+    auto waitForBalance = [&](int64_t previous, int timeout) {
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < timeout) {
+            if (wallet.balance() > previous) {
+                return true;
+            }
+            QTest::qWait(1);
+        }
+        return false;
+    };
+
+    syncService.start();
+    ASSERT_TRUE(waitForTip(30000));
+
+    // latency is measured until block paying to wallet is reflected in its balance
+    std::vector<qint64> latencies;
+    for (int i = 0; i < 20; ++i) {
+        auto previous = wallet.balance();
+        QElapsedTimer timer;
+        timer.start();
+        regtestDataSource.chain(assetID).generateBlocks(
+            bitcoin::CScript(walletScript.begin(), walletScript.end()), 1);
+        ASSERT_TRUE(waitForBalance(previous, 30000));
+        latencies.push_back(timer.elapsed());
+    }
+
+    syncService.stop();
+
+    std::sort(std::begin(latencies), std::end(latencies));
+    std::cout << "Tip to balance latency, p50: " << latencies.at(latencies.size() / 2)
+              << " ms, max: " << latencies.back() << " ms" << std::endl;
+
+    // polling picked new blocks after up to 22 seconds
+    ASSERT_LT(latencies.back(), 5000);
+}
+
+// In-process explorer which serves transactions of generated blocks and counts requests.
+// Holds light wallet block requests and answers them newest first once sync stops requesting.
+class ReversedRegtestDataSource : public LightWalletRegtestDataSource {
+public:
+    using LightWalletRegtestDataSource::LightWalletRegtestDataSource;
+
+    Promise<Wire::StrippedBlock> getLightWalletBlock(
+        AssetID assetID, BlockHash hash, int64_t blockHeight) const override
+    {
+        auto block = LightWalletRegtestDataSource::getLightWalletBlock(assetID, hash, blockHeight);
+        return Promise<Wire::StrippedBlock>([=](const auto& resolve, const auto&) {
+            _held.emplace_back([=] {
+                _deliveredHeights.emplace_back(blockHeight);
+                block.then([resolve](Wire::StrippedBlock value) { resolve(value); });
+            });
+            _maxHeld = std::max(_maxHeld, _held.size());
+            if (_held.size() == 1) {
+                QTimer::singleShot(0, [this] {
+                    auto held = std::move(_held);
+                    _held.clear();
+                    for (auto it = held.rbegin(); it != held.rend(); ++it) {
+                        (*it)();
+                    }
+                });
+            }
+        });
+    }
+
+    mutable std::vector<std::function<void()>> _held;
+    mutable std::vector<int64_t> _deliveredHeights;
+    mutable size_t _maxHeld{ 0 };
+};
+
+// Records height of every transaction that sync applies, doesn't own any of them.
+class AppliedHeightsDataSource : public MockDataSource {
+public:
+    OnChainTxRef applyTransaction(OnChainTxRef source, LookupTxById) override
+    {
+        _appliedHeights.emplace_back(source->blockHeight());
+        return {};
+    }
+
+    std::vector<int64_t> _appliedHeights;
+};
+
+TEST_F(WalletTests, PipelinedBlocksAppliedInHeightOrder)
+{
+    const AssetID assetID = 384;
+    _cache->_caches.emplace(assetID, std::make_unique<MockTransactionsCache>());
+
+    ReversedRegtestDataSource regtestDataSource(assetsModel);
+    RegtestChainManager regtestChainManager(regtestDataSource, assetsModel);
+    regtestChainManager.loadChains({ assetID }).wait();
+    regtestDataSource.chain(assetID).generateBlocks(bitcoin::CScript(), 50);
+
+    std::map<size_t, Wire::VerboseBlockHeader> connectedBlocks;
+    auto set = [&connectedBlocks](
+                   auto verboseHeader) { connectedBlocks[verboseHeader.height] = verboseHeader; };
+    auto get = [&connectedBlocks](auto height) -> boost::optional<Wire::VerboseBlockHeader> {
+        return connectedBlocks.count(height) > 0 ? boost::make_optional(connectedBlocks.at(height))
+                                                 : boost::none;
+    };
+
+    Chain localChain(assetID, set, get);
+    AppliedHeightsDataSource wallet;
+    MatchAllFilterMatchable filterMatchable;
+    ChainSyncManager syncManager(localChain, *_cache, wallet, filterMatchable,
+        assetsModel.assetById(assetID), regtestDataSource);
+
+    QSignalSpy syncFinished(&syncManager, &ChainSyncManager::finished);
+    syncManager.trySync();
+    ASSERT_TRUE(syncFinished.wait());
+    ASSERT_EQ(localChain.bestBlockHash().toStdString(),
+        regtestDataSource.chain(assetID).bestBlockHash());
+
+    // several blocks were requested at once and delivered out of order
+    const auto& delivered = regtestDataSource._deliveredHeights;
+    ASSERT_GT(regtestDataSource._maxHeld, 1u);
+    ASSERT_LE(regtestDataSource._maxHeld, syncManager.maxBlocksInFlight());
+    ASSERT_FALSE(std::is_sorted(std::begin(delivered), std::end(delivered)));
+
+    // but transactions were applied strictly in height order, every block exactly once
+    const auto& applied = wallet._appliedHeights;
+    ASSERT_TRUE(std::is_sorted(std::begin(applied), std::end(applied)));
+    std::set<int64_t> deliveredSet(std::begin(delivered), std::end(delivered));
+    std::set<int64_t> appliedSet(std::begin(applied), std::end(applied));
+    ASSERT_EQ(delivered.size(), deliveredSet.size());
+    ASSERT_EQ(deliveredSet, appliedSet);
+}
+
+class FakeBlockExplorerClient : public AbstractBlockExplorerHttpClient {
+public:
+    struct Stats {
+        size_t rawTxRequests{ 0 };
+        size_t blockRawTxRequests{ 0 };
+        bool blockRawTxSupported{ true };
+    };
+
+    using Blocks = std::map<QString, std::vector<std::pair<QString, QString>>>;
+
+    FakeBlockExplorerClient(const Blocks& blocks, Stats& stats)
+        : _blocks(blocks)
+        , _stats(stats)
+    {
+    }
+
+    Promise<QByteArray> getRawTransaction(QString transactionHash) override
+    {
+        ++_stats.rawTxRequests;
+        for (auto&& block : _blocks) {
+            for (auto&& tx : block.second) {
+                if (tx.first == transactionHash) {
+                    QJsonObject obj{ { "blockhash", block.first }, { "hex", tx.second } };
+                    return Promise<QByteArray>::resolve(QJsonDocument(obj).toJson());
+                }
+            }
+        }
+        return Promise<QByteArray>::reject(NetworkUtils::ApiErrorException{ 404, "" });
+    }
+
+    Promise<QByteArray> getBlockRawTransactions(QString blockHash) override
+    {
+        ++_stats.blockRawTxRequests;
+        if (!_stats.blockRawTxSupported) {
+            return Promise<QByteArray>::reject(NetworkUtils::ApiErrorException{ 404, "" });
+        }
+
+        QJsonArray data;
+        if (_blocks.count(blockHash) > 0) {
+            for (auto&& tx : _blocks.at(blockHash)) {
+                data.append(QJsonObject{ { "id", tx.first }, { "hex", tx.second } });
+            }
+        }
+        QJsonObject obj{ { "data", data } };
+        return Promise<QByteArray>::resolve(QJsonDocument(obj).toJson());
+    }
+
+    Promise<QByteArray> getTransactionsForAddress(QString, size_t, QString, QString) override
+    {
+        return unsupported();
+    }
+    Promise<QByteArray> getBlockHeaders(QString, size_t) override { return unsupported(); }
+    Promise<QByteArray> getBlockHeader(QString) override { return unsupported(); }
+    Promise<QByteArray> getBlock(QString) override { return unsupported(); }
+    Promise<QByteArray> getBestBlockHash() override { return unsupported(); }
+    Promise<QByteArray> getBlockTxByHash(QString, QString, size_t) override
+    {
+        return unsupported();
+    }
+    Promise<QByteArray> getTransaction(QString) override { return unsupported(); }
+    Promise<QByteArray> getRawTxByIndex(int64_t, uint32_t) override { return unsupported(); }
+    Promise<QString> sendTransaction(QString) override
+    {
+        return Promise<QString>::reject(std::runtime_error("unsupported"));
+    }
+    Promise<double> estimateSmartFee(unsigned) override
+    {
+        return Promise<double>::reject(std::runtime_error("unsupported"));
+    }
+    Promise<QByteArray> getBlockHashByHeight(unsigned) override { return unsupported(); }
+    Promise<QByteArray> getBlockFilter(QString) override { return unsupported(); }
+    Promise<QByteArray> getTxOut(QString, unsigned int) override { return unsupported(); }
+    Promise<QByteArray> getSpendingTx(QString, unsigned int) override { return unsupported(); }
+
+private:
+    Promise<QByteArray> unsupported()
+    {
+        return Promise<QByteArray>::reject(std::runtime_error("unsupported"));
+    }
+
+    const Blocks& _blocks;
+    Stats& _stats;
+};
+
+class FakeExplorerNetworkingFactory : public AbstractNetworkingFactory {
+public:
+    FakeExplorerNetworkingFactory(
+        const FakeBlockExplorerClient::Blocks& blocks, FakeBlockExplorerClient::Stats& stats)
+        : _blocks(blocks)
+        , _stats(stats)
+    {
+    }
+
+    BlockExplorerHttpClient createBlockExplorerClient(AssetID) override
+    {
+        return BlockExplorerHttpClient(new FakeBlockExplorerClient(_blocks, _stats));
+    }
+    RemotePriceProviderPtr createRemotePriceProvider() override { return {}; }
+    AbstractWeb3ClientPtr createWeb3Client(uint32_t) override { return {}; }
+    AccountExplorerHttpClientPtr createAccountExplorerClient(AssetID) override { return {}; }
+
+private:
+    const FakeBlockExplorerClient::Blocks& _blocks;
+    FakeBlockExplorerClient::Stats& _stats;
+};
+
+class BlockTransactionsCache : public MockTransactionsCache {
+public:
+    Promise<std::vector<QString>> transactionsInBlock(BlockHash blockHash) const override
+    {
+        return Promise<std::vector<QString>>::resolve(transactionsInBlockSync(blockHash));
+    }
+    std::vector<QString> transactionsInBlockSync(BlockHash blockHash) const override
+    {
+        return _walletTxs.count(blockHash) > 0 ? _walletTxs.at(blockHash)
+                                               : std::vector<QString>{};
+    }
+
+    std::map<BlockHash, std::vector<QString>> _walletTxs;
+};
+
+TEST_F(WalletTests, FilteredBlockBatching)
+{
+    const AssetID assetID = 384;
+    const size_t blockTxsCount = 3000;
+    const size_t walletTxsCount = 50;
+    const QString blockHash = QString::fromStdString(bitcoin::uint256S("ff").ToString());
+
+    FakeBlockExplorerClient::Blocks blocks;
+    FakeBlockExplorerClient::Stats stats;
+    auto txCache = new BlockTransactionsCache;
+    for (size_t i = 0; i < blockTxsCount; ++i) {
+        auto txid = QString::fromStdString(bitcoin::uint256S(std::to_string(i + 1)).ToString());
+        blocks[blockHash].emplace_back(txid, QString("%1").arg(i, 8, 16, QChar('0')));
+        if (i % (blockTxsCount / walletTxsCount) == 0) {
+            txCache->_walletTxs[blockHash].emplace_back(txid);
+        }
+    }
+    // wallet knows about tx which explorer doesn't list in this block anymore
+    auto staleTxid = QString::fromStdString(bitcoin::uint256S("abcdef").ToString());
+    txCache->_walletTxs[blockHash].emplace_back(staleTxid);
+    blocks[QString::fromStdString(bitcoin::uint256S("ee").ToString())].emplace_back(
+        staleTxid, "deadbeef");
+
+    _cache->_caches.emplace(assetID, std::unique_ptr<MockTransactionsCache>(txCache));
+
+    RegtestDataSource regtestDataSource(assetsModel);
+    RegtestChainManager regtestChainManager(regtestDataSource, assetsModel);
+    FakeExplorerNetworkingFactory networkingFactory(blocks, stats);
+    CachedChainDataSource dataSource(networkingFactory, assetsModel, *_cache, regtestChainManager);
+
+    for (int i = 0; i < 2; ++i) {
+        auto txns = dataSource.getFilteredBlock(assetID, blockHash).wait();
+        ASSERT_TRUE(txns.isFulfilled());
+        txns.then([&](const std::vector<std::string>& result) {
+            ASSERT_EQ(walletTxsCount + 1, result.size());
+            for (size_t j = 0; j < walletTxsCount; ++j) {
+                auto index = j * (blockTxsCount / walletTxsCount);
+                ASSERT_EQ(blocks.at(blockHash).at(index).second.toStdString(), result.at(j));
+            }
+            ASSERT_EQ("deadbeef", result.back());
+        });
+    }
+
+    // block is fetched once and served from block cache afterwards, previously every wallet tx
+    // was a separate request on every call.
+    ASSERT_EQ(1u, stats.blockRawTxRequests);
+    ASSERT_EQ(2u, stats.rawTxRequests);
+
+    // explorer without bulk endpoint, txs are fetched one by one and endpoint isn't asked again
+    const QString otherBlockHash = QString::fromStdString(bitcoin::uint256S("dd").ToString());
+    txCache->_walletTxs[otherBlockHash] = txCache->_walletTxs.at(blockHash);
+    stats = {};
+    stats.blockRawTxSupported = false;
+    for (int i = 0; i < 2; ++i) {
+        auto txns = dataSource.getFilteredBlock(assetID, otherBlockHash).wait();
+        ASSERT_TRUE(txns.isFulfilled());
+        txns.then([&](const std::vector<std::string>& result) {
+            ASSERT_EQ(walletTxsCount + 1, result.size());
+            ASSERT_EQ("deadbeef", result.back());
+        });
+    }
+
+    ASSERT_EQ(1u, stats.blockRawTxRequests);
+    ASSERT_EQ(2 * (walletTxsCount + 1), stats.rawTxRequests);
+
+    // block with single wallet tx isn't downloaded as a whole
+    const QString singleTxBlockHash = QString::fromStdString(bitcoin::uint256S("cc").ToString());
+    txCache->_walletTxs[singleTxBlockHash] = { staleTxid };
+    stats = {};
+    auto single = dataSource.getFilteredBlock(assetID, singleTxBlockHash).wait();
+    ASSERT_TRUE(single.isFulfilled());
+    ASSERT_EQ(0u, stats.blockRawTxRequests);
+    ASSERT_EQ(1u, stats.rawTxRequests);
+}
+
+class ListTransactionsCache : public MockTransactionsCache {
+public:
+    Promise<TransactionsList> transactionsList() const override
+    {
+        return Promise<TransactionsList>::resolve(_transactions);
+    }
+
+    TransactionsList _transactions;
+};
+
+TEST_F(WalletTests, TransactionsModelConfirmationsRefresh)
+{
+    const AssetID assetID = 384;
+    const int64_t blocksCount = 5000;
+    const int tipsCount = 5;
+    const int64_t cap = WalletTransactionsListModel::CONFIRMATIONS_DISPLAY_CAP;
+    const auto chainID = _xsnAsset.params().params.extCoinType();
+    const auto txType = chain::OnChainTransaction_TxType::OnChainTransaction_TxType_PAYMENT;
+
+    // one wallet transaction per block, newest first as transactions cache gives them
+    ListTransactionsCache txCache;
+    for (int64_t height = blocksCount; height > 0; --height) {
+        txCache._transactions.emplace_back(std::make_shared<OnChainTx>(assetID,
+            QString::number(height), QString(), height, 0, QDateTime(), OnChainTx::Inputs{},
+            OnChainTx::Outputs{}, txType, TxMemo{}));
+    }
+
+    _chainManager->loadChains({ chainID }).wait();
+    auto& chain = _chainManager->chainById(chainID);
+    chain.setEthChain(QString::number(blocksCount), blocksCount);
+
+    AssetTransactionsDataSource dataSource(assetID, &txCache);
+    WalletTransactionsListModel model(&dataSource, &assetsModel, _chainManager.get());
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::Fatal);
+    QTest::qWait(100);
+    ASSERT_EQ(blocksCount, model.rowCount(QModelIndex()));
+
+    size_t roleFetches = 0;
+    QSignalSpy spy(&model, &WalletTransactionsListModel::dataChanged);
+    QObject::connect(&model, &WalletTransactionsListModel::dataChanged,
+        [&](const QModelIndex& topLeft, const QModelIndex& bottomRight, QVector<int> roles) {
+            ASSERT_EQ(2, roles.size());
+            roleFetches += (bottomRight.row() - topLeft.row() + 1) * roles.size();
+        });
+
+    for (int i = 1; i <= tipsCount; ++i) {
+        spy.clear();
+        roleFetches = 0;
+        auto tip = blocksCount + i;
+        chain.setEthChain(QString::number(tip), tip);
+        ASSERT_TRUE(spy.wait(2000));
+
+        // rows are ordered by height, so everything below the cap is one contiguous range
+        ASSERT_EQ(1, spy.count());
+        ASSERT_EQ(static_cast<size_t>(cap - 1) * 2, roleFetches);
+        std::cout << "Tip " << tip << ", role fetches: " << roleFetches << ", full refresh: "
+                  << blocksCount * model.roleNames().size() << std::endl;
+    }
+
+    auto confirmations = [&](int row) {
+        return model.data(model.index(row), WalletTransactionsListModel::TxDataRole)
+            .toMap()
+            .value("confirmations")
+            .toInt();
+    };
+    ASSERT_EQ(tipsCount + 1, confirmations(0));
+    ASSERT_EQ(cap, confirmations(blocksCount - 1));
+}
+
+TEST_F(WalletTests, TransactionsPagingRescan)
+{
+    const AssetID assetID = 384;
+    const size_t pageSize = 10;
+    const auto txType = chain::OnChainTransaction_TxType::OnChainTransaction_TxType_PAYMENT;
+    auto makeTx = [&](int64_t height) {
+        return std::make_shared<OnChainTx>(assetID, QString::number(height), QString(), height, 0,
+            QDateTime::fromSecsSinceEpoch(height * 60), OnChainTx::Inputs{}, OnChainTx::Outputs{},
+            txType, TxMemo{});
+    };
+
+    ListTransactionsCache txCache;
+    for (int64_t height = 100; height > 0; height -= 2) {
+        txCache._transactions.emplace_back(makeTx(height));
+    }
+
+    AssetTransactionsDataSource dataSource(assetID, &txCache, pageSize);
+    dataSource.fetchTransactions();
+    QTest::qWait(10);
+    ASSERT_EQ(pageSize, dataSource.transactionsList().size());
+
+    // rescan finds older transactions, most of them belong to pages which weren't fetched yet
+    std::vector<Transaction> found;
+    for (int64_t height = 99; height > 0; height -= 2) {
+        found.emplace_back(makeTx(height));
+        txCache._transactions.emplace_back(found.back());
+    }
+    txCache.txnsAdded(found);
+    QTest::qWait(10);
+
+    for (int i = 0; i < 100 && dataSource.canFetchMore(); ++i) {
+        dataSource.fetchMore();
+        QTest::qWait(10);
+    }
+
+    std::set<QString> ids;
+    for (auto&& tx : dataSource.transactionsList()) {
+        ids.emplace(boost::variant2::get<OnChainTxRef>(tx)->txId());
+    }
+
+    ASSERT_EQ(100u, dataSource.transactionsList().size());
+    ASSERT_EQ(100u, ids.size());
+}
+
 static chain::TxOutpoint GenerateOutpoint(std::string hash, uint32_t index)
 {
     chain::TxOutpoint r;
@@ -1165,7 +2147,7 @@ TEST_F(WalletTests, BlockFilter)
                          auto hashBlock = bitcoin::uint256S(hash.toStdString());
                          std::memcpy(&key[0], hashBlock.begin(), key.size());
                          bitcoin::Filter gcs = bitcoin::Filter::FromNMPBytes(
-                             key, filter.n, filter.m, filter.p, filter.bytes);
+                             key, filter.n, filter.m, filter.p, filter.bytes());
                          ASSERT_TRUE(gcs.matchAny(outpoints));
                      })
                      .wait()
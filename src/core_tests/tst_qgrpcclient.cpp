@@ -1,4 +1,5 @@
 #include <GRPCTools/ClientUtils.hpp>
+#include <GRPCTools/ServerUtils.hpp>
 #include <Utils/Utils.hpp>
 #include <gen-grpc/tesgrpcserver.grpc.pb.h>
 #include <gtest/gtest.h>
@@ -6,8 +7,12 @@
 #include <QDateTime>
 #include <QSemaphore>
 #include <QSignalSpy>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <grpcpp/grpcpp.h>
+#include <set>
+#include <thread>
 
 using namespace testing;
 using namespace std::chrono_literals;
@@ -222,6 +227,286 @@ TEST_F(QGrpcClientTests, StreamingConnectPromise)
                      .isRejected());
 }
 
+TEST_F(QGrpcClientTests, UnaryCallLatencyBenchmark)
+{
+    const size_t numberOfCalls = 200;
+    using Clock = std::chrono::steady_clock;
+
+    auto percentile = [](std::vector<double> samples, double p) {
+        std::sort(std::begin(samples), std::end(samples));
+        auto index = static_cast<size_t>(p * (samples.size() - 1));
+        return samples.at(index);
+    };
+
+    auto measure = [&](std::function<void(test::RequestCall)> call) {
+        std::vector<double> samples;
+        samples.reserve(numberOfCalls);
+        for (size_t i = 0; i < numberOfCalls; ++i) {
+            test::RequestCall request;
+            request.set_requestid(std::to_string(i));
+            auto start = Clock::now();
+            call(request);
+            samples.emplace_back(
+                std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return samples;
+    };
+
+    // blocking stub is the baseline which doesn't include any dispatching overhead
+    auto baseline = measure([this](test::RequestCall request) {
+        ClientContext ctx;
+        test::ResponseCall response;
+        ASSERT_TRUE(_stub->UnaryCall(&ctx, request, &response).ok());
+        ASSERT_EQ(request.requestid(), response.requestid());
+    });
+
+    // dispatching which BaseGrpcClient used before CompletionQueuePump: completion queue is
+    // polled with 20 ms deadline and queued Qt events are processed between polls
+    Utils::WorkerThread pollingWorker;
+    pollingWorker.start();
+    grpc::CompletionQueue pollingCq;
+    std::atomic_bool stopPolling{ false };
+    QMetaObject::invokeMethod(pollingWorker.context(), [&pollingCq, &stopPolling] {
+        while (!stopPolling) {
+            void* tag = nullptr;
+            bool ok = false;
+            auto deadline = std::chrono::system_clock::now() + 20ms;
+            auto status = pollingCq.DoThenAsyncNext(
+                [] { QCoreApplication::processEvents(); }, &tag, &ok, deadline);
+            if (status == grpc::CompletionQueue::GOT_EVENT) {
+                static_cast<QSemaphore*>(tag)->release();
+            }
+        }
+    });
+
+    auto polling = measure([this, &pollingWorker, &pollingCq](test::RequestCall request) {
+        QSemaphore done;
+        ClientContext ctx;
+        test::ResponseCall response;
+        grpc::Status status;
+        std::unique_ptr<grpc::ClientAsyncResponseReader<test::ResponseCall>> reader;
+        QMetaObject::invokeMethod(pollingWorker.context(), [&] {
+            reader = _stub->PrepareAsyncUnaryCall(&ctx, request, &pollingCq);
+            reader->StartCall();
+            reader->Finish(&response, &status, &done);
+        });
+        done.acquire();
+        ASSERT_TRUE(status.ok());
+        ASSERT_EQ(request.requestid(), response.requestid());
+    });
+
+    stopPolling = true;
+    pollingWorker.quit();
+    pollingWorker.wait();
+    pollingCq.Shutdown();
+    {
+        void* tag = nullptr;
+        bool ok = false;
+        while (pollingCq.Next(&tag, &ok)) {
+        }
+    }
+
+    auto async = measure([this](test::RequestCall request) {
+        bool resolved = false;
+        _client
+            ->makeUnaryRequest<test::ResponseCall>(
+                _stub.get(), &test::TestService::Stub::PrepareAsyncUnaryCall, request, 0)
+            .then([request, &resolved](test::ResponseCall response) {
+                resolved = response.requestid() == request.requestid();
+            })
+            .wait();
+        ASSERT_TRUE(resolved);
+    });
+
+    std::cout << "Unary round-trip, ms: blocking stub p50 " << percentile(baseline, 0.5)
+              << " p99 " << percentile(baseline, 0.99) << ", polled queue (before) p50 "
+              << percentile(polling, 0.5) << " p99 " << percentile(polling, 0.99)
+              << ", BaseGrpcClient (after) p50 " << percentile(async, 0.5) << " p99 "
+              << percentile(async, 0.99) << std::endl;
+}
+
+template <class T> static std::vector<T> DrainChannel(qgrpc::StreamingChannel<T>& channel)
+{
+    std::vector<T> result;
+    T value;
+    size_t remaining = 0;
+    while (channel.pop(value, remaining)) {
+        result.emplace_back(value);
+    }
+
+    return result;
+}
+
+TEST(StreamingChannelTests, DropOldestKeepsNewestMessages)
+{
+    QObject context;
+    auto channel = std::make_shared<qgrpc::StreamingChannel<int>>(&context);
+    channel->_notifyDataReady = [] {};
+    channel->setPolicy({ qgrpc::StreamingChannelPolicy::Overflow::DropOldest, 3 });
+
+    for (int i = 1; i <= 5; ++i) {
+        channel->send(i);
+    }
+
+    auto stats = channel->stats();
+    ASSERT_EQ(stats.queueDepth, 3u);
+    ASSERT_EQ(stats.maxQueueDepth, 3u);
+    ASSERT_EQ(stats.dropped, 2u);
+    ASSERT_EQ(stats.coalesced, 0u);
+    ASSERT_EQ(DrainChannel(*channel), std::vector<int>({ 3, 4, 5 }));
+    ASSERT_EQ(channel->stats().queueDepth, 0u);
+}
+
+TEST(StreamingChannelTests, CoalesceKeepsPositionsAfterCancelledEntries)
+{
+    using Delta = std::pair<std::string, int>;
+    QObject context;
+    auto channel = std::make_shared<qgrpc::StreamingChannel<Delta>>(&context);
+    channel->_notifyDataReady = [] {};
+    channel->setPolicy({ qgrpc::StreamingChannelPolicy::Overflow::Coalesce, 3 },
+        [](const Delta& delta) { return delta.first; },
+        [](Delta& queued, const Delta& incoming) {
+            queued.second += incoming.second;
+            return queued.second != 0;
+        });
+
+    channel->send({ "a", 1 });
+    channel->send({ "b", 1 });
+    channel->send({ "c", 1 });
+
+    // cancels "a" out, entry stays queued but isn't counted
+    channel->send({ "a", -1 });
+    ASSERT_EQ(channel->stats().queueDepth, 2u);
+
+    // key of cancelled entry starts new one at the back
+    channel->send({ "a", 5 });
+    // merged through position which is behind cancelled entry
+    channel->send({ "b", 2 });
+    ASSERT_EQ(channel->stats().queueDepth, 3u);
+
+    // full, cancelled "a" and oldest live "b" leave the queue, head moves by two
+    channel->send({ "d", 1 });
+    // positions stay valid after head moved
+    channel->send({ "c", 1 });
+
+    Delta value;
+    size_t remaining = 0;
+    ASSERT_TRUE(channel->pop(value, remaining));
+    ASSERT_EQ(value, Delta("c", 2));
+    ASSERT_EQ(remaining, 2u);
+
+    // "b" was dropped, it's queued again instead of merged into stale position
+    channel->send({ "b", 7 });
+
+    auto stats = channel->stats();
+    ASSERT_EQ(stats.queueDepth, 3u);
+    ASSERT_EQ(stats.maxQueueDepth, 3u);
+    ASSERT_EQ(stats.dropped, 1u);
+    ASSERT_EQ(stats.coalesced, 3u);
+    ASSERT_EQ(DrainChannel(*channel), std::vector<Delta>({ { "a", 5 }, { "d", 1 }, { "b", 7 } }));
+
+    // popped entries don't take new messages
+    channel->send({ "a", 1 });
+    ASSERT_EQ(DrainChannel(*channel), std::vector<Delta>({ { "a", 1 } }));
+}
+
+TEST(StreamingChannelTests, CoalesceWithoutCapacityNeverDrops)
+{
+    QObject context;
+    auto channel = std::make_shared<qgrpc::StreamingChannel<int>>(&context);
+    channel->_notifyDataReady = [] {};
+    channel->setPolicy({ qgrpc::StreamingChannelPolicy::Overflow::Coalesce },
+        [](int value) { return std::to_string(value % 100); });
+
+    for (int i = 0; i < 1000; ++i) {
+        channel->send(i);
+    }
+
+    auto stats = channel->stats();
+    ASSERT_EQ(stats.queueDepth, 100u);
+    ASSERT_EQ(stats.dropped, 0u);
+    ASSERT_EQ(stats.coalesced, 900u);
+
+    auto values = DrainChannel(*channel);
+    ASSERT_EQ(values.size(), 100u);
+    ASSERT_EQ(values.front(), 900);
+    ASSERT_EQ(values.back(), 999);
+}
+
+// echoes "requestid" metadata back, records threads on which receivers were executed
+class MetadataEchoServer : public qgrpc::BaseGrpcServer {
+public:
+    explicit MetadataEchoServer(std::string address, size_t completionQueues)
+        : qgrpc::BaseGrpcServer(address, completionQueues)
+    {
+    }
+
+    void run() { BaseGrpcServer::run({ &_service }); }
+
+    std::set<QThread*> receiverThreads;
+
+protected:
+    void registerService() override
+    {
+        registerCall(&test::TestService::AsyncService::RequestUnaryCall, &_service,
+            [this](auto metadata, auto /*request*/, auto sender) {
+                receiverThreads.insert(QThread::currentThread());
+                auto it = metadata->find("requestid");
+                test::ResponseCall response;
+                response.set_requestid(it != std::end(*metadata) ? it->second : std::string{});
+                sender->finish(response);
+            });
+    }
+
+private:
+    test::TestService::AsyncService _service;
+};
+
+TEST(GrpcServerTests, MultipleQueuesPassMetadataToReceivers)
+{
+    const std::string rpcChannel{ "0.0.0.0:50053" };
+    const size_t numberOfClients = 8;
+    const size_t callsPerClient = 20;
+
+    Utils::WorkerThread serverThread;
+    serverThread.start();
+    MetadataEchoServer server(rpcChannel, 4);
+    QMetaObject::invokeMethod(serverThread.context(), [&server] { server.run(); });
+
+    auto stub = test::TestService::NewStub(
+        grpc::CreateChannel(rpcChannel, grpc::InsecureChannelCredentials()));
+    std::atomic<size_t> mismatches{ 0 };
+    std::vector<std::thread> clients;
+    for (size_t client = 0; client < numberOfClients; ++client) {
+        clients.emplace_back([&stub, &mismatches, client] {
+            for (size_t i = 0; i < callsPerClient; ++i) {
+                auto id = std::to_string(client) + ":" + std::to_string(i);
+                grpc::ClientContext ctx;
+                ctx.set_wait_for_ready(true);
+                ctx.set_deadline(std::chrono::system_clock::now() + 5s);
+                ctx.AddMetadata("requestid", id);
+                test::RequestCall request;
+                test::ResponseCall response;
+                auto status = stub->UnaryCall(&ctx, request, &response);
+                if (!status.ok() || response.requestid() != id) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+
+    for (auto&& client : clients) {
+        client.join();
+    }
+
+    server.shutdown();
+    serverThread.quit();
+    serverThread.wait();
+
+    ASSERT_EQ(mismatches, 0u);
+    ASSERT_EQ(server.receiverThreads, std::set<QThread*>{ &serverThread });
+}
+
 #if 0
 TEST_F(QGrpcClientTests, StreamingReadWriteAsyncCallSuccess)
 {
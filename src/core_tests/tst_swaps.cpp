@@ -8,6 +8,9 @@
 #include <Orderbook/OrderbookApiClient.hpp>
 #include <Orderbook/OrderbookClient.hpp>
 #include <Orderbook/OrderbookEventDispatcher.hpp>
+#include <Orderbook/HistoricTradesBuffer.hpp>
+#include <Orderbook/OwnOrdersStore.hpp>
+#include <Orderbook/PriceLevels.hpp>
 #include <Orderbook/Types.hpp>
 #include <SwapService.hpp>
 #include <Swaps/AbstractSwapClientFactory.hpp>
@@ -17,12 +20,25 @@
 #include <Swaps/ConnextSwapClient.hpp>
 #include <Swaps/LndSwapClient.hpp>
 #include <Swaps/SwapClientPool.hpp>
+#include <Swaps/SwapRepository.hpp>
 
+#include <QDir>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
 #include <QNetworkAccessManager>
 #include <QSignalSpy>
+#include <QStandardPaths>
 #include <QUuid>
 #include <QtNetwork>
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/progress.hpp>
 #include <cmath>
+#include <iostream>
+#include <mutex>
+#include <thread>
 
 //==============================================================================
 
@@ -387,9 +403,40 @@ struct MockedRepository : public swaps::AbstractSwapRepository {
 
     // AbstractSwapRepository interface
 protected:
-    Deals executeLoadAll() override { return {}; }
+    Deals executeLoadActive() override { return {}; }
+    std::vector<std::string> executeLoadArchivedHashes() override { return {}; }
 
     void executeSaveDeal(SwapDeal deal) override { _deals[deal.rHash] = deal; }
+
+    boost::optional<SwapDeal> executeLoadArchived(std::string rHash) const override
+    {
+        return _deals.count(rHash) > 0 ? boost::make_optional(_deals.at(rHash)) : boost::none;
+    }
+
+    Deals executeLoadArchived(int64_t fromTime, int64_t toTime) const override
+    {
+        Deals result;
+        for (auto&& it : _deals) {
+            auto& deal = it.second;
+            if (deal.state != SwapState::Active && deal.createTime >= fromTime
+                && deal.createTime < toTime) {
+                result.emplace_back(deal);
+            }
+        }
+        return result;
+    }
+
+    boost::optional<int64_t> executeLoadOldestArchivedTime() const override
+    {
+        boost::optional<int64_t> result;
+        for (auto&& it : _deals) {
+            if (it.second.state != SwapState::Active
+                && (!result || it.second.createTime < *result)) {
+                result = it.second.createTime;
+            }
+        }
+        return result;
+    }
 };
 
 //==============================================================================
@@ -644,6 +691,41 @@ TEST_F(SwapTests, executeSwap)
     ASSERT_EQ(takerSwapPaid.count(), count);
 }
 
+TEST_F(SwapTests, executeSwapStress)
+{
+    const size_t count = 1000;
+    std::vector<Promise<void>> promises;
+    std::vector<int64_t> latencies;
+    QElapsedTimer clock;
+    clock.start();
+
+    for (size_t i = 0; i < count; ++i) {
+        PeerOrder makerOrder;
+        OwnOrder takerOrder;
+        std::tie(takerOrder, makerOrder) = createDefaultTestOrder();
+
+        orderbook::OwnOrder makerOwnOrder = ConvertToOrderbookOrder(makerOrder);
+        maker.orderbook->_orders[makerOrder.pairId].emplace(makerOwnOrder.id, makerOwnOrder);
+        orderbook::OwnOrder takerOwnOrder = ConvertToOrderbookOrder(takerOrder);
+        taker.orderbook->_orders[takerOrder.pairId].emplace(takerOwnOrder.id, takerOwnOrder);
+
+        auto startedAt = clock.elapsed();
+        promises.emplace_back(taker.manager->executeSwap(makerOrder, takerOrder)
+                                  .then([&latencies, &clock, startedAt] {
+                                      latencies.push_back(clock.elapsed() - startedAt);
+                                  }));
+    }
+
+    ASSERT_FALSE(QtPromise::all(promises).wait().isRejected());
+    ASSERT_EQ(latencies.size(), count);
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](size_t p) { return latencies[latencies.size() * p / 100]; };
+    std::cout << "Swap completion latency ms, swaps = " << count << " p50 = " << percentile(50)
+              << " p90 = " << percentile(90) << " p99 = " << percentile(99)
+              << " max = " << latencies.back() << " total = " << clock.elapsed() << std::endl;
+}
+
 TEST_F(SwapTests, executeSwapImmediateFailure)
 {
     PeerOrder makerOrder;
@@ -1077,3 +1159,430 @@ TEST_F(OrderbookClientTests, PartialOrderMatching)
     ASSERT_FALSE(makerOrderbook->tryGetOwnOrder(pairId, baseOrder->id).is_initialized());
     ASSERT_EQ(makerOrderCompleted.count(), 1);
 }
+
+//==============================================================================
+
+TEST(OrderbookApiClientTests, ReplayUpdateStreamBenchmark)
+{
+    using namespace io::stakenet::orderbook::protos;
+    orderbook::OrderbookApiClient apiClient(QUrl("ws://localhost"), {});
+    auto connection = apiClient.findChild<orderbook::OrderbookConnection*>();
+    ASSERT_NE(connection, nullptr);
+
+    // recorded stream of order book updates, every 10th update is resent by server
+    const int64_t updatesCount = 50000;
+    std::vector<QByteArray> stream;
+    for (int64_t i = 1; i <= updatesCount; ++i) {
+        Event event;
+        event.set_messagecounter(i);
+        auto serverEvent = event.mutable_event();
+        auto order = i % 3 == 0 ? serverEvent->mutable_ordercanceled()->mutable_order()
+                                : serverEvent->mutable_orderplaced()->mutable_order();
+        order->set_tradingpair("XSN_BTC");
+        order->set_side(i % 2 ? Order::OrderSide::Order_OrderSide_buy
+                              : Order::OrderSide::Order_OrderSide_sell);
+        order->mutable_details()->set_orderid(std::to_string(i));
+        auto serialized = ProtobufSerializeToArray(event);
+        stream.emplace_back(
+            reinterpret_cast<const char*>(serialized.data()), static_cast<int>(serialized.size()));
+        if (i % 10 == 0) {
+            stream.emplace_back(stream.back());
+        }
+    }
+
+    int64_t placed = 0;
+    int64_t received = 0;
+    QObject::connect(&apiClient, &orderbook::OrderbookApiClient::notificationReceived,
+        [&](const orderbook::Event::ServerEvent& event) {
+            ++received;
+            placed += event.has_orderplaced();
+        });
+
+    QLoggingCategory::setFilterRules("stakenet.orderbook.debug=false");
+    std::cout << "Benchmarking orderbook replay, updates = " << updatesCount
+              << " messages = " << stream.size() << std::endl;
+    {
+        boost::progress_timer timer;
+        for (auto&& payload : stream) {
+            connection->payloadReceived(payload);
+        }
+    }
+    QLoggingCategory::setFilterRules(QString());
+
+    ASSERT_EQ(received, updatesCount);
+    ASSERT_EQ(placed, updatesCount - updatesCount / 3);
+}
+
+//==============================================================================
+
+TEST(SwapRepositoryTests, LoadWithArchivedDealsBenchmark)
+{
+    auto path = QString("%1/swap_repository_benchmark")
+                    .arg(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+    QDir(path).removeRecursively();
+
+    auto hashAt = [](int64_t i) {
+        return QString("%1").arg(static_cast<qulonglong>(i), 64, 16, QChar('0')).toStdString();
+    };
+
+    auto makeDeal = [&hashAt](int64_t i, SwapState state) {
+        SwapDeal deal{};
+        deal.rHash = hashAt(i);
+        deal.orderId = deal.localId = std::to_string(i);
+        deal.pairId = "XSN_BTC";
+        deal.state = state;
+        deal.phase = state == SwapState::Active ? SwapPhase::SwapAccepted
+                                                : SwapPhase::SwapCompleted;
+        deal.createTime = i;
+        return deal;
+    };
+
+    const int64_t archivedCount = 1000000;
+    {
+        swaps::SwapRepository repository(path.toStdString());
+        repository.load();
+        for (int64_t i = 0; i < archivedCount; ++i) {
+            repository.saveDeal(makeDeal(i, i % 10 ? SwapState::Completed : SwapState::Error));
+        }
+        repository.saveDeal(makeDeal(archivedCount, SwapState::Active));
+    }
+
+    swaps::SwapRepository repository(path.toStdString());
+    std::cout << "Benchmarking swap repository load, archived deals = " << archivedCount
+              << std::endl;
+    {
+        boost::progress_timer timer;
+        repository.load();
+    }
+
+    ASSERT_EQ(repository.activeDeals().size(), 1);
+    ASSERT_TRUE(repository.isHashUsed(hashAt(0)));
+    ASSERT_TRUE(repository.isHashUsed(hashAt(archivedCount)));
+    ASSERT_FALSE(repository.isHashUsed(hashAt(archivedCount + 1)));
+
+    auto archived = repository.deal(hashAt(42));
+    ASSERT_TRUE(archived.is_initialized());
+    ASSERT_EQ(archived->createTime, 42);
+    ASSERT_EQ(archived->state, SwapState::Completed);
+
+    auto page = repository.archivedDeals(5000, 5100);
+    ASSERT_EQ(page.size(), 100);
+    ASSERT_EQ(page.front().createTime, 5000);
+    ASSERT_EQ(page.back().createTime, 5099);
+    ASSERT_EQ(repository.oldestArchivedTime(), boost::make_optional<int64_t>(0));
+
+    QDir(path).removeRecursively();
+}
+
+//==============================================================================
+
+TEST(OwnOrdersStoreTests, FillsBenchmark)
+{
+    const std::string pairId{ "XSN_BTC" };
+    const size_t ordersCount = 10000;
+    // one minute of trading at 100 fills per second
+    const size_t fillsCount = 6000;
+
+    auto makeOrder = [&pairId](size_t i) {
+        return orderbook::OwnOrder{
+            orderbook::OwnLimitOrder{
+                orderbook::LimitOrder{ orderbook::MarketOrder{ 1000, pairId, i % 2 == 0 }, 100 },
+                orderbook::Local{ "local-" + std::to_string(i), 0 }, {} },
+            orderbook::Stamp{ orderbook::OrderIdentifier{ "order-" + std::to_string(i) }, 0, 1000 },
+            true
+        };
+    };
+
+    orderbook::OwnOrdersStore store;
+    for (size_t i = 0; i < ordersCount; ++i) {
+        ASSERT_TRUE(store.insert(makeOrder(i)));
+        auto order = store.find(pairId, "order-" + std::to_string(i));
+        ASSERT_NE(order, nullptr);
+        for (size_t p = 0; p < 2; ++p) {
+            store.addPortion(*order,
+                orderbook::OrderPortion{ pairId,
+                    "portion-" + std::to_string(i) + "-" + std::to_string(p), 500 });
+        }
+    }
+
+    std::cout << "Benchmarking own order fills, orders = " << ordersCount
+              << " fills = " << fillsCount << std::endl;
+    {
+        boost::progress_timer timer;
+        for (size_t fill = 0; fill < fillsCount; ++fill) {
+            auto i = fill * 7919 % ordersCount;
+            auto portionId = "portion-" + std::to_string(i) + "-" + std::to_string(fill % 2);
+            auto order = store.findBase(pairId, portionId);
+            ASSERT_NE(order, nullptr);
+            ASSERT_EQ(store.find(pairId, order->localId), order);
+            ASSERT_TRUE(store.closePortion(*order, portionId, 500));
+        }
+    }
+
+    size_t openPortions = 0;
+    store.forEach(
+        [&openPortions](const auto& order) { openPortions += order.openPortions.size(); });
+    ASSERT_EQ(openPortions, ordersCount * 2 - fillsCount);
+
+    // closed portion still resolves its base order until base order is erased
+    ASSERT_NE(store.findBase(pairId, "portion-0-0"), nullptr);
+    store.erase(pairId, "local-0");
+    ASSERT_EQ(store.findBase(pairId, "portion-0-0"), nullptr);
+    ASSERT_EQ(store.find(pairId, "order-0"), nullptr);
+
+    // failed portion is removed only once and keeps resolving its base order as well
+    ASSERT_TRUE(store.insert(makeOrder(ordersCount)));
+    auto order = store.find(pairId, "order-" + std::to_string(ordersCount));
+    store.addPortion(*order, orderbook::OrderPortion{ pairId, "failed-portion", 500 });
+    ASSERT_TRUE(store.removePortion(*order, "failed-portion"));
+    ASSERT_EQ(store.findBase(pairId, "failed-portion"), order);
+    ASSERT_FALSE(store.removePortion(*order, "failed-portion"));
+    store.erase(pairId, order->localId);
+    ASSERT_EQ(store.findBase(pairId, "failed-portion"), nullptr);
+}
+
+//==============================================================================
+
+TEST(ConnextHttpResolveServiceTests, ConcurrentResolveBenchmark)
+{
+    using Clock = std::chrono::steady_clock;
+    namespace http = boost::beast::http;
+    const size_t connections = 8;
+    const size_t requestsPerConnection = 500;
+    const size_t count = connections * requestsPerConnection;
+
+    swaps::ConnextHttpResolveService service;
+    service.start("127.0.0.1", 0);
+    ASSERT_NE(service.port(), 0);
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Clock::time_point> sentAt;
+    // from sending request till its delivery on service's thread, in microseconds
+    std::vector<int64_t> latencies;
+    QEventLoop loop;
+    QObject::connect(&service, &swaps::ConnextHttpResolveService::receivedResolveRequest,
+        [&](swaps::ResolveRequest request) {
+            auto deliveredAt = Clock::now();
+            std::lock_guard<std::mutex> lock(mutex);
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                deliveredAt - sentAt.at(request.rHash));
+            latencies.push_back(latency.count());
+            if (latencies.size() == count) {
+                loop.quit();
+            }
+        });
+
+    QElapsedTimer clock;
+    clock.start();
+    std::vector<std::thread> clients;
+    for (size_t c = 0; c < connections; ++c) {
+        clients.emplace_back([&, c] {
+            boost::asio::io_context ioc;
+            boost::beast::tcp_stream stream(ioc);
+            stream.connect(boost::asio::ip::tcp::endpoint(
+                boost::asio::ip::make_address("127.0.0.1"), service.port()));
+            boost::beast::flat_buffer buffer;
+            for (size_t i = 0; i < requestsPerConnection; ++i) {
+                auto rHash = QString::number(c * requestsPerConnection + i)
+                                 .rightJustified(64, '0')
+                                 .toStdString();
+                http::request<http::string_body> request{ http::verb::post, "/created", 11 };
+                request.set(http::field::content_type, "application/json");
+                request.keep_alive(true);
+                request.body() = R"({"transfer":{"transferState":{"lockHash":"0x)" + rHash
+                    + R"("},"balance":{"amount":["100","0"]},"transferTimeout":"8640"}})";
+                request.prepare_payload();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    sentAt.emplace(rHash, Clock::now());
+                }
+                http::write(stream, request);
+                http::response<http::string_body> response;
+                http::read(stream, buffer, response);
+                EXPECT_EQ(response.result(), http::status::ok);
+            }
+
+            boost::beast::error_code ec;
+            stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+        });
+    }
+
+    // requests are delivered through this thread's event loop, it has to spin while clients run
+    QTimer::singleShot(30000, &loop, &QEventLoop::quit);
+    loop.exec();
+    for (auto&& client : clients) {
+        client.join();
+    }
+
+    ASSERT_EQ(latencies.size(), count);
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](size_t p) { return latencies[latencies.size() * p / 100]; };
+    std::cout << "Connext resolve latency us, connections = " << connections
+              << " requests = " << count << " p50 = " << percentile(50)
+              << " p99 = " << percentile(99) << " max = " << latencies.back()
+              << " total ms = " << clock.elapsed() << std::endl;
+}
+
+//==============================================================================
+
+TEST(ConnextHttpResolveServiceTests, StopClosesKeepAliveSessions)
+{
+    namespace http = boost::beast::http;
+    swaps::ConnextHttpResolveService service;
+    service.start("127.0.0.1", 0);
+    ASSERT_NE(service.port(), 0);
+
+    boost::asio::io_context ioc;
+    boost::beast::tcp_stream stream(ioc);
+    stream.connect(boost::asio::ip::tcp::endpoint(
+        boost::asio::ip::make_address("127.0.0.1"), service.port()));
+
+    http::request<http::string_body> request{ http::verb::post, "/unknown", 11 };
+    request.keep_alive(true);
+    request.prepare_payload();
+    http::write(stream, request);
+
+    boost::beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    http::read(stream, buffer, response);
+    ASSERT_EQ(response.result(), http::status::bad_request);
+    ASSERT_TRUE(response.keep_alive());
+
+    // session is waiting for next request, stop has to close it instead of hanging on it
+    service.stop();
+
+    boost::beast::error_code ec;
+    http::read(stream, buffer, response, ec);
+    ASSERT_TRUE(ec);
+
+    // service can be started again
+    service.start("127.0.0.1", 0);
+    ASSERT_NE(service.port(), 0);
+    service.stop();
+}
+
+//==============================================================================
+
+TEST(PriceLevelsTests, ReplayLevelChangesBenchmark)
+{
+    const size_t changesCount = 1000000;
+    // deep book, every side keeps up to 2000 levels
+    const int64_t levelsCount = 2000;
+    const int64_t basePrice = 100000;
+
+    struct Change {
+        bool isAsk;
+        orderbook::PriceLevel delta;
+        bool isAdd;
+    };
+
+    // level changes resemble order placement and cancellation, every cancel hits existing level
+    std::vector<Change> changes;
+    changes.reserve(changesCount);
+    std::map<int64_t, int64_t> placed[2];
+    uint64_t seed = 42;
+    auto next = [&seed] {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return seed >> 33;
+    };
+    for (size_t i = 0; i < changesCount; ++i) {
+        bool isAsk = next() % 2 == 0;
+        auto& side = placed[isAsk];
+        auto price = isAsk ? basePrice + static_cast<int64_t>(next() % levelsCount)
+                           : basePrice - 1 - static_cast<int64_t>(next() % levelsCount);
+        auto it = side.find(price);
+        if (it != side.end() && next() % 2 == 0) {
+            auto amount = std::min<int64_t>(it->second, 1 + next() % 1000);
+            changes.push_back({ isAsk, { price, amount }, false });
+            if ((it->second -= amount) == 0) {
+                side.erase(it);
+            }
+        } else {
+            auto amount = static_cast<int64_t>(1 + next() % 1000);
+            changes.push_back({ isAsk, { price, amount }, true });
+            side[price] += amount;
+        }
+    }
+
+    std::cout << "Benchmarking order book, level changes = " << changesCount << std::endl;
+
+    std::map<int64_t, orderbook::PriceLevel> mapAsks;
+    std::map<int64_t, orderbook::PriceLevel, std::greater<int64_t>> mapBids;
+    {
+        std::cout << "std::map levels: ";
+        boost::progress_timer timer;
+        auto apply = [](auto& where, const Change& change) {
+            if (change.isAdd) {
+                auto& level = where[change.delta.price];
+                level.price = change.delta.price;
+                level += change.delta;
+            } else {
+                auto it = where.find(change.delta.price);
+                if (it != where.end() && (it->second -= change.delta).amount <= 0) {
+                    where.erase(it);
+                }
+            }
+        };
+        for (auto&& change : changes) {
+            if (change.isAsk) {
+                apply(mapAsks, change);
+            } else {
+                apply(mapBids, change);
+            }
+        }
+    }
+
+    orderbook::PriceLevels asks{ false };
+    orderbook::PriceLevels bids{ true };
+    {
+        std::cout << "flat levels: ";
+        boost::progress_timer timer;
+        for (auto&& change : changes) {
+            auto& where = change.isAsk ? asks : bids;
+            if (change.isAdd) {
+                where.add(change.delta);
+            } else {
+                ASSERT_TRUE(where.subtract(change.delta));
+            }
+        }
+    }
+
+    auto expectSame = [](const auto& expected, const orderbook::PriceLevels& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(),
+            [](const auto& level, const auto& it) {
+                return level.price == it.second.price && level.amount == it.second.amount;
+            }));
+    };
+    expectSame(mapAsks, asks);
+    expectSame(mapBids, bids);
+}
+
+//==============================================================================
+
+TEST(HistoricTradesBufferTests, OverwritesOldestTrade)
+{
+    orderbook::HistoricTradesBuffer trades(3);
+    auto makeTrade = [](std::string id) {
+        orderbook::HistoricTradesBuffer::Trade trade;
+        trade.set_id(id);
+        return trade;
+    };
+
+    for (auto&& id : { "1", "2", "3", "4" }) {
+        ASSERT_TRUE(trades.push(makeTrade(id)));
+    }
+    ASSERT_FALSE(trades.push(makeTrade("4")));
+    ASSERT_EQ(trades.size(), 3);
+    ASSERT_FALSE(trades.contains("1"));
+    ASSERT_EQ(trades.back()->id(), "4");
+
+    std::vector<std::string> seen;
+    trades.traverseAfter("2", [&seen](const auto& trade) { seen.push_back(trade.id()); });
+    ASSERT_EQ(seen, (std::vector<std::string>{ "3", "4" }));
+
+    seen.clear();
+    trades.traverseAfter("1", [&seen](const auto& trade) { seen.push_back(trade.id()); });
+    ASSERT_TRUE(seen.empty());
+}
@@ -0,0 +1,72 @@
+#include "HistoricTradesBuffer.hpp"
+
+#include <algorithm>
+
+namespace orderbook {
+
+//==============================================================================
+
+HistoricTradesBuffer::HistoricTradesBuffer(size_t capacity)
+    : _capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+//==============================================================================
+
+bool HistoricTradesBuffer::push(Trade trade)
+{
+    if (!_sequences.emplace(trade.id(), _nextSequence).second) {
+        return false;
+    }
+
+    if (_trades.size() < _capacity) {
+        _trades.emplace_back(std::move(trade));
+    } else {
+        auto& slot = _trades[_nextSequence % _capacity];
+        _sequences.erase(slot.id());
+        slot = std::move(trade);
+    }
+
+    ++_nextSequence;
+    return true;
+}
+
+//==============================================================================
+
+void HistoricTradesBuffer::clear()
+{
+    _trades.clear();
+    _sequences.clear();
+    _nextSequence = 0;
+}
+
+//==============================================================================
+
+bool HistoricTradesBuffer::contains(const std::string& id) const
+{
+    return _sequences.count(id) > 0;
+}
+
+//==============================================================================
+
+const HistoricTradesBuffer::Trade* HistoricTradesBuffer::back() const
+{
+    return _trades.empty() ? nullptr : &_trades[(_nextSequence - 1) % _capacity];
+}
+
+//==============================================================================
+
+size_t HistoricTradesBuffer::size() const
+{
+    return _trades.size();
+}
+
+//==============================================================================
+
+bool HistoricTradesBuffer::empty() const
+{
+    return _trades.empty();
+}
+
+//==============================================================================
+}
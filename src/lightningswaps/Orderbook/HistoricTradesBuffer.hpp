@@ -0,0 +1,57 @@
+#ifndef HISTORICTRADESBUFFER_HPP
+#define HISTORICTRADESBUFFER_HPP
+
+#include <Orderbook/Protos/stakenet/orderbook/models.pb.h>
+#include <unordered_map>
+#include <vector>
+
+namespace orderbook {
+
+/*!
+ * \brief The HistoricTradesBuffer class keeps last trades of one pair in fixed capacity ring, the
+ * oldest trade is overwritten once ring is full. Trades are indexed by id, reader continues from
+ * last trade it has seen without scanning the ring.
+ */
+class HistoricTradesBuffer {
+public:
+    using Trade = io::stakenet::orderbook::protos::Trade;
+
+    explicit HistoricTradesBuffer(size_t capacity = 10000);
+
+    // returns false when trade with the same id is already in ring
+    bool push(Trade trade);
+    void clear();
+
+    bool contains(const std::string& id) const;
+    // most recently pushed trade
+    const Trade* back() const;
+    size_t size() const;
+    bool empty() const;
+
+    // calls func for trades pushed after lastSeenId or for all trades when lastSeenId is empty,
+    // nothing is traversed when lastSeenId is unknown or was already overwritten.
+    template <class Func> void traverseAfter(const std::string& lastSeenId, Func&& func) const
+    {
+        auto from = _nextSequence - _trades.size();
+        if (!lastSeenId.empty()) {
+            auto it = _sequences.find(lastSeenId);
+            if (it == _sequences.end()) {
+                return;
+            }
+            from = it->second + 1;
+        }
+
+        for (auto sequence = from; sequence < _nextSequence; ++sequence) {
+            func(_trades[sequence % _capacity]);
+        }
+    }
+
+private:
+    size_t _capacity{ 0 };
+    uint64_t _nextSequence{ 0 };
+    std::vector<Trade> _trades; // trade with sequence s lives in slot s % capacity
+    std::unordered_map<std::string, uint64_t> _sequences; // id -> sequence
+};
+}
+
+#endif // HISTORICTRADESBUFFER_HPP
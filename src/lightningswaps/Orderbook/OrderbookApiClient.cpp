@@ -10,10 +10,9 @@ namespace orderbook {
 
 //==============================================================================
 
-static bool IsDuplicateMsg(const QByteArray& payload, const QByteArray& lastMsgChecksum)
-{
-    return QCryptographicHash::hash(payload, QCryptographicHash::Sha1) == lastMsgChecksum;
-}
+// server resends messages which were already delivered, anything older than window can't be
+// a repeat and means that server counter was reset, it has to be handled as a gap.
+static const int64_t DUPLICATE_MSG_WINDOW = 64;
 
 //==============================================================================
 
@@ -53,13 +52,13 @@ Promise<Event::CommandResponse> OrderbookApiClient::makeRequest(Command command)
         if (_orderbookConnection->isConnected()) {
             auto seq = this->generateId();
             command.set_clientmessageid(seq);
-            LogCDebug(Orderbook) << "Sending orderbook request:" << command.DebugString().data()
+            LogCDebug(Orderbook) << "Sending orderbook request:" << command.value_case()
                                  << seq.data();
+            LogCDebug(OrderbookPayload) << "Request payload:" << command.DebugString().data();
             _pendingCalls.emplace(seq, RequestSender{ resolve, reject });
             _orderbookConnection->sendCommand(ProtobufSerializeToArray(command));
         } else {
-            LogCDebug(Orderbook) << "Failing command, no connection:"
-                                 << command.DebugString().data();
+            LogCDebug(Orderbook) << "Failing command, no connection:" << command.value_case();
             reject(std::runtime_error("Api No Connection"));
         }
     });
@@ -85,7 +84,6 @@ void OrderbookApiClient::onConnected()
 {
     _pingTimer->start(_pingTimer->interval());
     _messageCounter = 0;
-    _lastMsgChecksum.clear();
     connected();
 }
 
@@ -128,37 +126,39 @@ void OrderbookApiClient::onConnectionError(QAbstractSocket::SocketError error)
 void OrderbookApiClient::onDataReceived(QByteArray payload)
 {
     Event event;
-    if (!event.ParseFromArray(payload.data(), payload.size())) {
+    if (!event.ParseFromArray(payload.constData(), payload.size())) {
         LogCDebug(Orderbook) << "Received unknown event";
         return;
     }
 
-    LogCDebug(Orderbook) << "Received payload:" << event.DebugString().data();
+    LogCDebug(Orderbook) << "Received message:" << event.messagecounter() << event.value_case();
+    LogCDebug(OrderbookPayload) << "Received payload:" << event.DebugString().data();
 
     try {
-        if ((_messageCounter + 1) != event.messagecounter()) {
-            if (IsDuplicateMsg(payload, _lastMsgChecksum)) {
-                return;
-            } else {
-                LogCCritical(Orderbook) << "Detected missed messages, state:" << _messageCounter
-                                        << "vs" << event.messagecounter();
-                _orderbookConnection->reconnect();
+        auto counter = event.messagecounter();
+        if (counter != _messageCounter + 1) {
+            if (counter <= _messageCounter && counter > _messageCounter - DUPLICATE_MSG_WINDOW) {
+                LogCDebug(Orderbook) << "Skipping duplicate message:" << counter;
                 return;
             }
+
+            LogCCritical(Orderbook) << "Detected missed messages, state:" << _messageCounter
+                                    << "vs" << counter;
+            _orderbookConnection->reconnect();
+            return;
         }
 
         ++_messageCounter;
-        _lastMsgChecksum = QCryptographicHash::hash(payload, QCryptographicHash::Sha1);
 
         if (event.value_case() == Event::ValueCase::kResponse) {
-            auto response = event.response();
+            auto& response = *event.mutable_response();
             if (response.value_case() == Event::CommandResponse::ValueCase::kPingResponse) {
                 return;
             }
 
             auto it = _pendingCalls.find(response.clientmessageid());
             if (it != std::end(_pendingCalls)) {
-                auto sender = it->second;
+                auto sender = std::move(it->second);
                 auto uid = it->first;
                 _pendingCalls.erase(it);
                 if (response.value_case() == Event::CommandResponse::ValueCase::kCommandFailed) {
@@ -173,7 +173,7 @@ void OrderbookApiClient::onDataReceived(QByteArray payload)
                         << "Command:" << uid.data() << "failed, reason:" << reason.c_str();
                     std::get<1>(sender)(reason);
                 } else {
-                    std::get<0>(sender)(response);
+                    std::get<0>(sender)(std::move(response));
                 }
             }
         } else if (event.value_case() == Event::ValueCase::kEvent) {
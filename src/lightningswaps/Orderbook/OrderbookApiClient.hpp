@@ -28,7 +28,7 @@ public:
     Promise<Event::CommandResponse> makeRequest(Command command);
 
 signals:
-    void notificationReceived(Event::ServerEvent event);
+    void notificationReceived(const Event::ServerEvent& event);
     void connected();
     void disconnected();
     void connectionError(QAbstractSocket::SocketError error);
@@ -55,8 +55,7 @@ private:
     std::unordered_map<std::string, RequestSender> _pendingCalls;
     OrderbookConnection* _orderbookConnection{ nullptr };
     QTimer* _pingTimer{ nullptr };
-    int64_t _messageCounter{ 0 };
-    QByteArray _lastMsgChecksum;
+    int64_t _messageCounter{ 0 }; // counter of last message which was processed
     State _state{ State::Disconnected };
 };
 }
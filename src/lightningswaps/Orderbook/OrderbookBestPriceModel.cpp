@@ -65,7 +65,7 @@ void OrderbookBestPriceModel::onOrdersChanged(std::string pairId)
     auto transform = [&data](const auto& from) {
         data.resize(from.size());
         std::transform(std::begin(from), std::end(from), std::begin(data),
-            [](const auto& it) { return it.second.price; });
+            [](const auto& level) { return level.price; });
     };
 
     if (_isAsk) {
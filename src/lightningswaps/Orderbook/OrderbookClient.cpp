@@ -89,13 +89,8 @@ OrderbookClient::~OrderbookClient() {}
 boost::optional<OwnOrder> OrderbookClient::tryGetOwnOrder(
     std::string pairId, std::string orderId) const
 {
-    if (_myorders.count(pairId) > 0) {
-        const auto& orders = _myorders.at(pairId);
-        auto it = findOrderById(orders, pairId, orderId);
-
-        if (it != std::end(orders)) {
-            return it->second;
-        }
+    if (auto ownOrder = _myorders.find(pairId, orderId)) {
+        return *ownOrder;
     }
 
     return boost::none;
@@ -112,26 +107,14 @@ OwnOrder orderbook::OrderbookClient::getOwnOrder(std::string pairId, std::string
     }
 
     LogCDebug(Swaps) << "Fetching:" << pairId.data() << orderId.data();
-    LogCDebug(Swaps) << "Own orders:";
-    for (const auto& [key, value] : _myorders) {
-        LogCDebug(Swaps) << "Pair:" << key.data();
-        for (const auto& [id, order] : value) {
-            LogCDebug(Swaps) << id.data() << order.id.data() << order.localId.data();
-        }
-    }
-    LogCDebug(Swaps) << "MyPartialOrdersIndex:";
-    for (const auto& [key, value] : _partialOrdersIndex) {
-        LogCDebug(Swaps) << "Pair:" << key.data();
-        for (const auto& [partial, base] : value) {
-            LogCDebug(Swaps) << partial.data() << base.data();
-        }
-    }
-    LogCDebug(Swaps) << "LocalIndex:";
-    for (const auto& [key, value] : _orderIdToLocalIdIndex) {
-        LogCDebug(Swaps) << "Pair:" << key.data();
-        for (const auto& [partial, base] : value) {
-            LogCDebug(Swaps) << partial.data() << base.data();
-        }
+    if (Swaps().isDebugEnabled()) {
+        LogCDebug(Swaps) << "Own orders:";
+        _myorders.forEach([](const OwnOrder& order) {
+            LogCDebug(Swaps) << order.pairId.data() << order.id.data() << order.localId.data();
+            for (auto&& portion : order.openPortions) {
+                LogCDebug(Swaps) << "Portion:" << portion.orderId.data();
+            }
+        });
     }
 
     throw std::runtime_error("Own order with id " + orderId + " not found");
@@ -156,23 +139,17 @@ boost::optional<OrderbookClient::MatchedTrade> OrderbookClient::tryGetMatchedTra
 boost::optional<OwnOrder> OrderbookClient::tryGetOrderPortion(
     std::string pairId, std::string partialOrderId) const
 {
-    if (_partialOrdersIndex.count(pairId) > 0) {
-        if (_partialOrdersIndex.at(pairId).count(partialOrderId) > 0) {
-            if (auto ownBaseOrder
-                = tryGetOwnOrder(pairId, _partialOrdersIndex.at(pairId).at(partialOrderId))) {
-                auto it = std::find_if(std::begin(ownBaseOrder->openPortions),
-                    std::end(ownBaseOrder->openPortions), [partialOrderId](const auto& portion) {
-                        return portion.orderId == partialOrderId;
-                    });
-
-                if (it != std::end(ownBaseOrder->openPortions)) {
-                    OwnOrder partialOrder(*ownBaseOrder);
-                    partialOrder.openPortions.clear();
-                    partialOrder.id = it->orderId;
-                    partialOrder.quantity = it->quantity;
-                    return boost::make_optional(partialOrder);
-                }
-            }
+    if (auto ownBaseOrder = _myorders.findBase(pairId, partialOrderId)) {
+        auto it = std::find_if(std::begin(ownBaseOrder->openPortions),
+            std::end(ownBaseOrder->openPortions),
+            [&partialOrderId](const auto& portion) { return portion.orderId == partialOrderId; });
+
+        if (it != std::end(ownBaseOrder->openPortions)) {
+            OwnOrder partialOrder(*ownBaseOrder);
+            partialOrder.openPortions.clear();
+            partialOrder.id = it->orderId;
+            partialOrder.quantity = it->quantity;
+            return boost::make_optional(partialOrder);
         }
     }
 
@@ -184,10 +161,8 @@ boost::optional<OwnOrder> OrderbookClient::tryGetOrderPortion(
 boost::optional<OwnOrder> OrderbookClient::tryGetBaseOrder(
     std::string pairId, std::string partialOrderId) const
 {
-    if (_partialOrdersIndex.count(pairId) > 0) {
-        if (_partialOrdersIndex.at(pairId).count(partialOrderId) > 0) {
-            return tryGetOwnOrder(pairId, _partialOrdersIndex.at(pairId).at(partialOrderId));
-        }
+    if (auto ownBaseOrder = _myorders.findBase(pairId, partialOrderId)) {
+        return *ownBaseOrder;
     }
 
     return boost::none;
@@ -219,7 +194,6 @@ Promise<void> OrderbookClient::registerConnextKey(std::string currency, std::str
     auto cmd = msgCommand.mutable_registerpublicidentifiercommand();
     cmd->set_currency(std::move(currency));
     cmd->set_publicidentifier(std::move(pubkey));
-    LogCDebug(Orderbook) << "Sending orderbook request:" << msgCommand.DebugString().data();
     return _apiClient->makeRequest(msgCommand).then([](OrderbookResponse) {});
 }
 
@@ -373,7 +347,7 @@ Promise<PlaceOrderOutcome> OrderbookClient::placeOrder(orderbook::OwnLimitOrder
             ownLimitOrder.quantity },
         true);
 
-    addMyOrder(_myorders[ownOrder.pairId], ownOrder);
+    addMyOrder(ownOrder);
 
     return _apiClient->makeRequest(ConvertToPlaceOrderCmd(ownLimitOrder))
         .then([ownLimitOrder, localId, this](OrderbookResponse response) {
@@ -408,7 +382,7 @@ Promise<PlaceOrderOutcome> OrderbookClient::placeOrder(orderbook::OwnLimitOrder
                 LogCDebug(Orderbook)
                     << "Order placed:" << ownOrder.pairId.c_str() << ownOrder.id.c_str();
 
-                this->addMyOrder(_myorders[ownOrder.pairId], ownOrder);
+                this->addMyOrder(ownOrder);
 
                 return PlaceOrderOutcome(ownOrder);
             }
@@ -440,7 +414,7 @@ Promise<PlaceOrderOutcome> OrderbookClient::placeOrder(orderbook::OwnLimitOrder
                 ownOrder.orderType
                     = ownLimitOrder.price > 0 ? OwnOrderType::Limit : OwnOrderType::Market;
 
-                this->addMyOrder(_myorders[ownOrder.pairId], ownOrder);
+                this->addMyOrder(ownOrder);
 
                 orderbook::Trade trade(matchedTrade.existingorderid(), price,
                     ConvertBigInt(matchedTrade.size()), ownOrder,
@@ -472,14 +446,10 @@ Promise<PlaceOrderOutcome> OrderbookClient::placeOrder(orderbook::OwnLimitOrder
             throw std::runtime_error("Invalid place order response");
         })
         .tapFail([this, pairId = ownLimitOrder.pairId, localId]() {
-            auto ordersIt = _myorders.find(pairId);
-            if (ordersIt != std::end(_myorders)) {
-                auto it = findOrderById(ordersIt->second, pairId, localId);
-                if (it != std::end(ordersIt->second)) {
-                    LogCDebug(Swaps) << "Place order tapFail:" << localId.data();
-                    this->eraseMyOrder(ordersIt->second, it);
-                    this->ownOrderCanceled(localId);
-                }
+            if (auto ownOrder = _myorders.find(pairId, localId)) {
+                LogCDebug(Swaps) << "Place order tapFail:" << localId.data();
+                this->eraseMyOrder(*ownOrder);
+                this->ownOrderCanceled(localId);
             }
         });
 }
@@ -594,13 +564,7 @@ Promise<PlaceOrderOutcome> OrderbookClient::placeOrderPortion(
 
 void OrderbookClient::ownOrders(std::function<void(const OwnOrder&)> func) const
 {
-    for (auto pair : _myorders) {
-        if (_myorders.count(pair.first) > 0) {
-            for (auto it : pair.second) {
-                func(it.second);
-            }
-        }
-    }
+    _myorders.forEach(func);
 }
 
 //==============================================================================
@@ -608,8 +572,8 @@ void OrderbookClient::ownOrders(std::function<void(const OwnOrder&)> func) const
 void OrderbookClient::ownOrdersByPairId(
     std::function<void(const OwnOrder&)> func, std::string pairId) const
 {
-    if (_myorders.count(pairId) > 0) {
-        for (auto it : _myorders.at(pairId)) {
+    if (auto orders = _myorders.orders(pairId)) {
+        for (auto&& it : *orders) {
             func(it.second);
         }
     }
@@ -626,8 +590,8 @@ Promise<void> OrderbookClient::cancelOrder(std::string pairId, std::string order
 
 void OrderbookClient::cancelOrders(std::string pairId)
 {
-    if (_myorders.count(pairId) > 0) {
-        _myorders.at(pairId).clear();
+    if (_myorders.hasPair(pairId)) {
+        _myorders.clear(pairId);
         Command clearOrdersCommand;
         auto cmd = new io::stakenet::orderbook::protos::CleanTradingPairOrdersCommand;
         cmd->set_tradingpair(pairId);
@@ -655,28 +619,15 @@ OrderbookSwapPeerPool& OrderbookClient::peerPool()
 
 void OrderbookClient::onOwnOrderSwapSuccess(swaps::SwapSuccess swap)
 {
-    if (auto baseOrder = tryGetBaseOrder(swap.pairId, swap.orderId)) {
-        auto& ownOrder
-            = findOrderById(_myorders.at(baseOrder->pairId), swap.pairId, baseOrder->localId)
-                  ->second;
-        auto it = std::find_if(std::begin(ownOrder.openPortions), std::end(ownOrder.openPortions),
-            [id = swap.orderId](const auto& portion) { return id == portion.orderId; });
-
-        if (it != std::end(ownOrder.openPortions)) {
-            ownOrder.closedPortions.emplace_back(
-                swap.pairId, it->orderId, ownOrder.isBuy ? swap.amountReceived : swap.amountSent);
-            ownOrder.openPortions.erase(it);
-            ownOrderChanged(ownOrder);
-        }
-    } else if (_myorders.count(swap.pairId) > 0) {
-        auto& orders = _myorders.at(swap.pairId);
-        auto it = findOrderById(orders, swap.pairId, swap.localId);
-        if (it != std::end(orders)) {
-            auto& ownOrder = it->second;
-            ownOrder.closedPortions.emplace_back(
-                swap.pairId, swap.localId, ownOrder.isBuy ? swap.amountReceived : swap.amountSent);
-            ownOrderChanged(ownOrder);
+    if (auto ownOrder = _myorders.findBase(swap.pairId, swap.orderId)) {
+        auto quantity = ownOrder->isBuy ? swap.amountReceived : swap.amountSent;
+        if (_myorders.closePortion(*ownOrder, swap.orderId, quantity)) {
+            ownOrderChanged(*ownOrder);
         }
+    } else if (auto ownOrder = _myorders.find(swap.pairId, swap.localId)) {
+        ownOrder->closedPortions.emplace_back(
+            swap.pairId, swap.localId, ownOrder->isBuy ? swap.amountReceived : swap.amountSent);
+        ownOrderChanged(*ownOrder);
     }
 
     removeMatchedOrder(swap.pairId, swap.orderId);
@@ -687,15 +638,9 @@ void OrderbookClient::onOwnOrderSwapSuccess(swaps::SwapSuccess swap)
 void OrderbookClient::onOwnOrderSwapFailure(std::string pairId, const swaps::SwapFailure& failure)
 {
     removeMatchedOrder(pairId, failure.orderId);
-    if (auto baseOrderOpt = tryGetBaseOrder(pairId, failure.orderId)) {
-        auto& baseOrder = findOrderById(
-            _myorders.at(baseOrderOpt->pairId), baseOrderOpt->pairId, baseOrderOpt->id)
-                              ->second;
-        auto it = std::find_if(std::begin(baseOrder.openPortions), std::end(baseOrder.openPortions),
-            [id = failure.orderId](const auto& portion) { return id == portion.orderId; });
-        if (it != std::end(baseOrder.openPortions)) {
-            baseOrder.openPortions.erase(it);
-            ownOrderChanged(baseOrder);
+    if (auto baseOrder = _myorders.findBase(pairId, failure.orderId)) {
+        if (_myorders.removePortion(*baseOrder, failure.orderId)) {
+            ownOrderChanged(*baseOrder);
         }
     } else {
         LogCDebug(Swaps) << "Swap failed, removing own order:" << failure.localId.data();
@@ -714,9 +659,9 @@ void OrderbookClient::onOwnOrderCompleted(const OwnOrder& ownOrder)
 
 //==============================================================================
 
-void OrderbookClient::onOwnOrderMatched(Event::ServerEvent event)
+void OrderbookClient::onOwnOrderMatched(const Event::ServerEvent& event)
 {
-    auto matchedTrade = event.myordermatched().trade();
+    const auto& matchedTrade = event.myordermatched().trade();
     try {
         LogCDebug(Swaps) << "Own order matched:" << matchedTrade.existingorderid().data()
                          << matchedTrade.executingorderid().data();
@@ -814,15 +759,17 @@ void OrderbookClient::init()
 
 Promise<void> OrderbookClient::cancelOwnOrder(std::string pairId, std::string localId)
 {
-    if (_myorders.count(pairId) > 0) {
+    if (_myorders.hasPair(pairId)) {
 
         std::string orderId;
         std::vector<std::string> ordersToCancel;
         {
-            auto baseOrder = tryGetBaseOrder(pairId, localId);
-            auto ownOrder = tryGetOwnOrder(pairId, localId);
-            if (baseOrder || ownOrder) {
-                baseOrder = baseOrder ? baseOrder : ownOrder;
+            auto baseOrder = _myorders.findBase(pairId, localId);
+            if (!baseOrder) {
+                baseOrder = _myorders.find(pairId, localId);
+            }
+
+            if (baseOrder) {
                 orderId = baseOrder->id;
                 std::transform(std::begin(baseOrder->openPortions),
                     std::end(baseOrder->openPortions), std::back_inserter(ordersToCancel),
@@ -839,17 +786,12 @@ Promise<void> OrderbookClient::cancelOwnOrder(std::string pairId, std::string lo
 
         ordersToCancel.emplace_back(orderId);
 
-        auto& ownOrders = _myorders.at(pairId);
-
-        std::for_each(std::begin(ordersToCancel), std::end(ordersToCancel),
-            [&ownOrders, &pairId, &localId, this](const auto& orderId) {
-                auto it = this->findOrderById(ownOrders, pairId, orderId);
-                if (it != std::end(ownOrders)) {
-                    LogCDebug(Swaps) << "Own order canceled:" << localId.data() << orderId.data()
-                                     << "erasing from own orders";
-                    this->eraseMyOrder(ownOrders, it);
-                }
-            });
+        // portions are not own orders on their own, only base order has to be erased
+        if (auto ownOrder = _myorders.find(pairId, orderId)) {
+            LogCDebug(Swaps) << "Own order canceled:" << localId.data() << orderId.data()
+                             << "erasing from own orders";
+            eraseMyOrder(*ownOrder);
+        }
 
         return QtPromise::each(ordersToCancel,
             [this](const std::string& orderId, ...) { return cancelRemoteOwnOrder(orderId); })
@@ -874,74 +816,21 @@ Promise<void> OrderbookClient::cancelRemoteOwnOrder(std::string orderId)
 
 //==============================================================================
 
-auto OrderbookClient::findOrderById(const OrderbookClient::MyOrders& where, std::string pairId,
-    std::string orderId) const -> MyOrders::const_iterator
-{
-    auto it = where.find(orderId);
-    if (it == std::cend(where)) {
-        if (_orderIdToLocalIdIndex.count(pairId) > 0) {
-            const auto& index = _orderIdToLocalIdIndex.at(pairId);
-            auto lIt = index.find(orderId);
-            if (lIt != std::cend(index)) {
-                it = where.find(lIt->second);
-            }
-        }
-    }
-
-    return it;
-}
-
-//==============================================================================
-
-auto OrderbookClient::findOrderById(MyOrders& where, std::string pairId, std::string orderId) const
-    -> MyOrders::iterator
+void OrderbookClient::eraseMyOrder(const OwnOrder& ownOrder)
 {
-    auto it = where.find(orderId);
-    if (it == std::end(where)) {
-        if (_orderIdToLocalIdIndex.count(pairId) > 0) {
-            const auto& index = _orderIdToLocalIdIndex.at(pairId);
-            auto lIt = index.find(orderId);
-            if (lIt != std::end(index)) {
-                it = where.find(lIt->second);
-            }
-        }
-    }
-
-    return it;
+    LogCDebug(Swaps) << "Removing own order:" << ownOrder.localId.data() << ownOrder.id.data();
+    _myorders.erase(ownOrder.pairId, ownOrder.localId);
 }
 
 //==============================================================================
 
-void OrderbookClient::eraseMyOrder(
-    OrderbookClient::MyOrders& where, const MyOrders::const_iterator& it)
-{
-    auto localId = it->first;
-    auto orderId = it->second.id;
-    auto pairId = it->second.pairId;
-    LogCDebug(Swaps) << "Removing own order:" << localId.data() << orderId.data();
-    where.erase(it);
-    auto ordersIt = _orderIdToLocalIdIndex.find(pairId);
-    if (ordersIt != std::end(_orderIdToLocalIdIndex)) {
-        ordersIt->second.erase(orderId);
-    }
-}
-
-//==============================================================================
-
-void OrderbookClient::addMyOrder(OrderbookClient::MyOrders& where, OwnOrder ownOrder)
+void OrderbookClient::addMyOrder(OwnOrder ownOrder)
 {
     LogCDebug(Swaps) << "Adding own order:" << ownOrder.id.data() << ownOrder.localId.data();
-    bool isUpdate = where.count(ownOrder.localId) > 0;
-
-    where[ownOrder.localId] = ownOrder;
-    if (!ownOrder.id.empty()) {
-        _orderIdToLocalIdIndex[ownOrder.pairId][ownOrder.id] = ownOrder.localId;
-    }
-
-    if (isUpdate) {
-        ownOrderChanged(ownOrder);
-    } else {
+    if (_myorders.insert(ownOrder)) {
         ownOrderPlaced(ownOrder);
+    } else {
+        ownOrderChanged(ownOrder);
     }
 }
 
@@ -952,7 +841,7 @@ std::string OrderbookClient::generateId() const
     std::string id;
     do {
         id = QUuid::createUuid().toString().toStdString();
-    } while (_myorders.count(id) > 0);
+    } while (_myorders.containsId(id));
 
     return id;
 }
@@ -961,25 +850,10 @@ std::string OrderbookClient::generateId() const
 
 void OrderbookClient::removeOwnOrder(std::string pairId, std::string orderId)
 {
-    if (_myorders.count(pairId) == 0)
-        return;
-
-    auto& myOrders = _myorders.at(pairId);
-
-    auto it = findOrderById(myOrders, pairId, orderId);
-
-    if (it != std::end(myOrders)) {
-        auto order = it->second;
-        auto localId = order.localId;
-        if (_partialOrdersIndex.count(pairId) > 0) {
-            auto& portionsIndex = _partialOrdersIndex.at(pairId);
-            for (auto&& portion : order.openPortions) {
-                portionsIndex.erase(portion.orderId);
-            }
-        }
-
+    if (auto ownOrder = _myorders.find(pairId, orderId)) {
+        auto localId = ownOrder->localId;
         LogCDebug(Swaps) << "requested to remove own order" << orderId.data();
-        eraseMyOrder(myOrders, it);
+        eraseMyOrder(*ownOrder);
         ownOrderMatched(localId);
     }
 }
@@ -998,15 +872,18 @@ void OrderbookClient::removeMatchedOrder(std::string pairId, std::string orderId
 void OrderbookClient::addOrderPortion(
     std::string pairId, std::string baseLocalId, OrderPortion portion)
 {
-    auto& ownBaseOrder = _myorders.at(pairId).at(baseLocalId);
-    ownBaseOrder.openPortions.emplace_back(portion);
-    _partialOrdersIndex[pairId][portion.orderId] = baseLocalId;
-    ownOrderChanged(ownBaseOrder);
+    auto ownBaseOrder = _myorders.find(pairId, baseLocalId);
+    if (!ownBaseOrder) {
+        throw std::runtime_error("Own order with id " + baseLocalId + " not found");
+    }
+
+    _myorders.addPortion(*ownBaseOrder, std::move(portion));
+    ownOrderChanged(*ownBaseOrder);
 }
 
 //==============================================================================
 
-int64_t ConvertBigInt(io::stakenet::orderbook::protos::BigInteger bigInt)
+int64_t ConvertBigInt(const io::stakenet::orderbook::protos::BigInteger& bigInt)
 {
     auto result = std::stoll(bigInt.value());
     return result;
@@ -8,6 +8,7 @@
 
 #include <Orderbook/AbstractOrderbookClient.hpp>
 #include <Orderbook/OrderbookApiClient.hpp>
+#include <Orderbook/OwnOrdersStore.hpp>
 #include <Swaps/Types.hpp>
 #include <Utils/Utils.hpp>
 
@@ -86,12 +87,11 @@ public slots:
     void onOwnOrderCompleted(const OwnOrder& ownOrder);
 
 private slots:
-    void onOwnOrderMatched(Event::ServerEvent event);
+    void onOwnOrderMatched(const Event::ServerEvent& event);
     void onConnectedToOrderbook();
     void onApiClientStateChanged(OrderbookApiClient::State newState);
 
 private:
-    using MyOrders = std::unordered_map<std::string, OwnOrder>;
     void init();
     void setState(OrderbookApiClient::State state);
     void removeOwnOrder(std::string pairId, std::string orderId);
@@ -101,18 +101,10 @@ private:
     Promise<void> cancelRemoteOwnOrder(std::string orderId);
     std::string generateId() const;
 
-    MyOrders::const_iterator findOrderById(
-        const MyOrders& where, std::string pairId, std::string orderId) const;
-    MyOrders::iterator findOrderById(
-        MyOrders& where, std::string pairId, std::string orderId) const;
-    void eraseMyOrder(MyOrders& where, const MyOrders::const_iterator& it);
-    void addMyOrder(MyOrders& where, OwnOrder ownOrder);
+    void eraseMyOrder(const OwnOrder& ownOrder);
+    void addMyOrder(OwnOrder ownOrder);
 
 private:
-    using OrderIdToLocalIdIndex
-        = std::unordered_map<std::string, std::string>; // mapping OrderId -> LocalId
-    using MyPartialOrdersIndex
-        = std::unordered_map<std::string, std::string>; // mapping PartialOrderId -> BaseOrderId
     using MatchedOrders = std::unordered_map<std::string, MatchedTrade>;
 
     OrderbookApiClient* _apiClient{ nullptr };
@@ -122,15 +114,13 @@ private:
     OrderbookChannelRenting* _channelRenting{ nullptr };
     OrderbookRefundableFees* _refundableFees{ nullptr };
     std::unordered_map<std::string, MatchedOrders> _matchedOrders;
-    std::unordered_map<std::string, MyOrders> _myorders;
-    std::unordered_map<std::string, MyPartialOrdersIndex> _partialOrdersIndex;
-    std::unordered_map<std::string, OrderIdToLocalIdIndex> _orderIdToLocalIdIndex;
+    OwnOrdersStore _myorders;
     std::set<std::string> _subscriptions;
     OrderbookApiClient::State _state{ OrderbookApiClient::State::Disconnected };
 };
 
 std::unique_ptr<io::stakenet::orderbook::protos::BigInteger> ConvertToBigInt(int64_t value);
-int64_t ConvertBigInt(io::stakenet::orderbook::protos::BigInteger bigInt);
+int64_t ConvertBigInt(const io::stakenet::orderbook::protos::BigInteger& bigInt);
 }
 
 #endif // ORDERBOOKCLIENT_HPP
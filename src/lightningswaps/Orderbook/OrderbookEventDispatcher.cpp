@@ -22,7 +22,7 @@ void OrderbookEventDispatcher::addEventHandler(
 
 //==============================================================================
 
-void OrderbookEventDispatcher::onEventReceived(Event::ServerEvent event)
+void OrderbookEventDispatcher::onEventReceived(const Event::ServerEvent& event)
 {
     auto it = _handlers.find(event.value_case());
 
@@ -17,7 +17,7 @@ public:
     void addEventHandler(Event::ServerEvent::ValueCase event, OnEventHandler handler);
 
 private slots:
-    void onEventReceived(Event::ServerEvent event);
+    void onEventReceived(const Event::ServerEvent& event);
 
 private:
     std::unordered_map<unsigned int, std::vector<OnEventHandler>> _handlers;
@@ -44,9 +44,9 @@ void OrderbookSwapPeerPool::addSwapPeer(std::string pubKey)
 
 //==============================================================================
 
-void OrderbookSwapPeerPool::onPeerMessageReceived(Event::ServerEvent event)
+void OrderbookSwapPeerPool::onPeerMessageReceived(const Event::ServerEvent& event)
 {
-    auto message = event.newordermessage();
+    const auto& message = event.newordermessage();
     auto id = message.orderid();
     if (auto peer = getPeerByPubKey(id)) {
         // in case of orderbook is sending messages, we will parse everything here and just
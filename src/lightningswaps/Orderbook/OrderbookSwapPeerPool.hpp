@@ -28,7 +28,7 @@ signals:
 public slots:
 
 private slots:
-    void onPeerMessageReceived(Event::ServerEvent event);
+    void onPeerMessageReceived(const Event::ServerEvent& event);
 
 private:
     OrderbookSwapPeer* getPeerByPubKey(std::string pubKey) const;
@@ -0,0 +1,200 @@
+#include "OwnOrdersStore.hpp"
+
+#include <algorithm>
+
+namespace orderbook {
+
+//==============================================================================
+
+template <class Index>
+static auto FindInPair(const Index& index, const std::string& pairId, const std::string& id)
+    -> OwnOrder*
+{
+    auto it = index.find(id);
+    return it != std::end(index) && it->second->pairId == pairId ? it->second : nullptr;
+}
+
+//==============================================================================
+
+bool OwnOrdersStore::insert(OwnOrder order)
+{
+    auto& orders = _orders[order.pairId];
+    auto it = orders.find(order.localId);
+    auto isNew = it == std::end(orders);
+    if (isNew) {
+        it = orders.emplace(order.localId, std::move(order)).first;
+    } else {
+        unindex(it->second);
+        it->second = std::move(order);
+    }
+
+    index(it->second);
+    return isNew;
+}
+
+//==============================================================================
+
+void OwnOrdersStore::erase(const std::string& pairId, const std::string& localId)
+{
+    auto ordersIt = _orders.find(pairId);
+    if (ordersIt != std::end(_orders)) {
+        auto it = ordersIt->second.find(localId);
+        if (it != std::end(ordersIt->second)) {
+            unindex(it->second);
+            ordersIt->second.erase(it);
+        }
+    }
+}
+
+//==============================================================================
+
+void OwnOrdersStore::clear(const std::string& pairId)
+{
+    auto ordersIt = _orders.find(pairId);
+    if (ordersIt != std::end(_orders)) {
+        for (auto&& it : ordersIt->second) {
+            unindex(it.second);
+        }
+        ordersIt->second.clear();
+    }
+}
+
+//==============================================================================
+
+OwnOrder* OwnOrdersStore::find(const std::string& pairId, const std::string& id)
+{
+    return FindInPair(_ids, pairId, id);
+}
+
+//==============================================================================
+
+const OwnOrder* OwnOrdersStore::find(const std::string& pairId, const std::string& id) const
+{
+    return FindInPair(_ids, pairId, id);
+}
+
+//==============================================================================
+
+OwnOrder* OwnOrdersStore::findBase(const std::string& pairId, const std::string& portionId)
+{
+    return FindInPair(_portions, pairId, portionId);
+}
+
+//==============================================================================
+
+const OwnOrder* OwnOrdersStore::findBase(
+    const std::string& pairId, const std::string& portionId) const
+{
+    return FindInPair(_portions, pairId, portionId);
+}
+
+//==============================================================================
+
+void OwnOrdersStore::addPortion(OwnOrder& order, OrderPortion portion)
+{
+    _portions[portion.orderId] = &order;
+    order.openPortions.emplace_back(std::move(portion));
+}
+
+//==============================================================================
+
+bool OwnOrdersStore::closePortion(OwnOrder& order, const std::string& portionId, int64_t quantity)
+{
+    auto it = std::find_if(std::begin(order.openPortions), std::end(order.openPortions),
+        [&portionId](const auto& portion) { return portion.orderId == portionId; });
+
+    if (it == std::end(order.openPortions)) {
+        return false;
+    }
+
+    // portion stays indexed, base order can be still resolved by id of closed portion
+    order.closedPortions.emplace_back(order.pairId, it->orderId, quantity);
+    order.openPortions.erase(it);
+    return true;
+}
+
+//==============================================================================
+
+bool OwnOrdersStore::removePortion(OwnOrder& order, const std::string& portionId)
+{
+    auto it = std::find_if(std::begin(order.openPortions), std::end(order.openPortions),
+        [&portionId](const auto& portion) { return portion.orderId == portionId; });
+
+    if (it == std::end(order.openPortions)) {
+        return false;
+    }
+
+    // portion stays indexed, repeated failure of the same portion resolves to its base order
+    _removedPortions[&order].emplace_back(it->orderId);
+    order.openPortions.erase(it);
+    return true;
+}
+
+//==============================================================================
+
+bool OwnOrdersStore::hasPair(const std::string& pairId) const
+{
+    return _orders.count(pairId) > 0;
+}
+
+//==============================================================================
+
+bool OwnOrdersStore::containsId(const std::string& id) const
+{
+    return _ids.count(id) > 0;
+}
+
+//==============================================================================
+
+auto OwnOrdersStore::orders(const std::string& pairId) const -> const Orders*
+{
+    auto it = _orders.find(pairId);
+    return it != std::end(_orders) ? &it->second : nullptr;
+}
+
+//==============================================================================
+
+void OwnOrdersStore::index(OwnOrder& order)
+{
+    _ids[order.localId] = &order;
+    if (!order.id.empty()) {
+        _ids[order.id] = &order;
+    }
+
+    for (auto&& portions : { &order.openPortions, &order.closedPortions }) {
+        for (auto&& portion : *portions) {
+            _portions[portion.orderId] = &order;
+        }
+    }
+}
+
+//==============================================================================
+
+void OwnOrdersStore::unindex(const OwnOrder& order)
+{
+    auto eraseIfOwned = [&order](auto& index, const std::string& id) {
+        auto it = index.find(id);
+        if (it != std::end(index) && it->second == &order) {
+            index.erase(it);
+        }
+    };
+
+    eraseIfOwned(_ids, order.localId);
+    eraseIfOwned(_ids, order.id);
+    for (auto&& portions : { &order.openPortions, &order.closedPortions }) {
+        for (auto&& portion : *portions) {
+            eraseIfOwned(_portions, portion.orderId);
+        }
+    }
+
+    auto removedIt = _removedPortions.find(&order);
+    if (removedIt != std::end(_removedPortions)) {
+        for (auto&& portionId : removedIt->second) {
+            eraseIfOwned(_portions, portionId);
+        }
+        _removedPortions.erase(removedIt);
+    }
+}
+
+//==============================================================================
+}
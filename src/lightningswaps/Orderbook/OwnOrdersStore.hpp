@@ -0,0 +1,64 @@
+#ifndef OWNORDERSSTORE_HPP
+#define OWNORDERSSTORE_HPP
+
+#include <Orderbook/Types.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace orderbook {
+
+/*!
+ * \brief The OwnOrdersStore class keeps own orders grouped by pair and local id. Local id,
+ * orderbook id and id of every portion point directly to order slot. Slots are hash map nodes,
+ * they stay valid until order is erased.
+ */
+class OwnOrdersStore {
+public:
+    using Orders = std::unordered_map<std::string, OwnOrder>; // localId -> order
+
+    // returns false when order with the same local id was replaced
+    bool insert(OwnOrder order);
+    void erase(const std::string& pairId, const std::string& localId);
+    void clear(const std::string& pairId);
+
+    // accepts local id or orderbook id
+    OwnOrder* find(const std::string& pairId, const std::string& id);
+    const OwnOrder* find(const std::string& pairId, const std::string& id) const;
+    // accepts id of open, closed or removed portion, returns order it belongs to
+    OwnOrder* findBase(const std::string& pairId, const std::string& portionId);
+    const OwnOrder* findBase(const std::string& pairId, const std::string& portionId) const;
+
+    void addPortion(OwnOrder& order, OrderPortion portion);
+    // moves open portion to closed ones, returns false if there is no such open portion
+    bool closePortion(OwnOrder& order, const std::string& portionId, int64_t quantity);
+    // drops open portion, its id still resolves base order so that repeated failures of the
+    // same portion don't fall back to base order
+    bool removePortion(OwnOrder& order, const std::string& portionId);
+
+    bool hasPair(const std::string& pairId) const;
+    bool containsId(const std::string& id) const;
+    const Orders* orders(const std::string& pairId) const;
+
+    template <class Func> void forEach(Func&& func) const
+    {
+        for (auto&& pair : _orders) {
+            for (auto&& it : pair.second) {
+                func(it.second);
+            }
+        }
+    }
+
+private:
+    void index(OwnOrder& order);
+    void unindex(const OwnOrder& order);
+
+private:
+    std::unordered_map<std::string, Orders> _orders; // pairId -> orders
+    std::unordered_map<std::string, OwnOrder*> _ids; // local and orderbook ids
+    std::unordered_map<std::string, OwnOrder*> _portions; // portion id -> base order
+    // ids of removed portions, they are still indexed until base order is erased
+    std::unordered_map<const OwnOrder*, std::vector<std::string>> _removedPortions;
+};
+}
+
+#endif // OWNORDERSSTORE_HPP
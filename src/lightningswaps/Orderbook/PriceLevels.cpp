@@ -0,0 +1,144 @@
+#include "PriceLevels.hpp"
+
+#include <algorithm>
+
+namespace orderbook {
+
+//==============================================================================
+
+PriceLevel& PriceLevel::operator+=(const PriceLevel& rhs)
+{
+    this->amount += rhs.amount;
+    return *this;
+}
+
+//==============================================================================
+
+PriceLevel& PriceLevel::operator-=(const PriceLevel& rhs)
+{
+    this->amount -= rhs.amount;
+    return *this;
+}
+
+//==============================================================================
+
+PriceLevels::PriceLevels(bool descending)
+    : _descending(descending)
+{
+}
+
+//==============================================================================
+
+void PriceLevels::assign(Levels levels)
+{
+    std::stable_sort(levels.begin(), levels.end(),
+        [this](const auto& lhs, const auto& rhs) { return isBefore(lhs.price, rhs.price); });
+
+    _levels.clear();
+    _levels.reserve(levels.size());
+    for (auto&& level : levels) {
+        if (!_levels.empty() && _levels.back().price == level.price) {
+            _levels.back() += level;
+        } else {
+            _levels.push_back(level);
+        }
+    }
+}
+
+//==============================================================================
+
+void PriceLevels::clear()
+{
+    _levels.clear();
+}
+
+//==============================================================================
+
+const PriceLevel& PriceLevels::add(const PriceLevel& delta)
+{
+    auto it = position(delta.price);
+    if (it == _levels.end() || it->price != delta.price) {
+        it = _levels.insert(it, PriceLevel{ delta.price, 0 });
+    }
+
+    *it += delta;
+    return *it;
+}
+
+//==============================================================================
+
+bool PriceLevels::subtract(const PriceLevel& delta)
+{
+    auto it = position(delta.price);
+    if (it == _levels.end() || it->price != delta.price) {
+        return false;
+    }
+
+    *it -= delta;
+    if (it->amount <= 0) {
+        _levels.erase(it);
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+const PriceLevel* PriceLevels::find(int64_t price) const
+{
+    auto it = lowerBound(price);
+    return it != _levels.end() && it->price == price ? &*it : nullptr;
+}
+
+//==============================================================================
+
+PriceLevels::const_iterator PriceLevels::lowerBound(int64_t price) const
+{
+    return std::lower_bound(_levels.begin(), _levels.end(), price,
+        [this](const auto& level, int64_t value) { return isBefore(level.price, value); });
+}
+
+//==============================================================================
+
+PriceLevels::const_iterator PriceLevels::begin() const
+{
+    return _levels.begin();
+}
+
+//==============================================================================
+
+PriceLevels::const_iterator PriceLevels::end() const
+{
+    return _levels.end();
+}
+
+//==============================================================================
+
+size_t PriceLevels::size() const
+{
+    return _levels.size();
+}
+
+//==============================================================================
+
+bool PriceLevels::empty() const
+{
+    return _levels.empty();
+}
+
+//==============================================================================
+
+PriceLevels::Levels::iterator PriceLevels::position(int64_t price)
+{
+    return _levels.begin() + std::distance(_levels.cbegin(), lowerBound(price));
+}
+
+//==============================================================================
+
+bool PriceLevels::isBefore(int64_t lhs, int64_t rhs) const
+{
+    return _descending ? lhs > rhs : lhs < rhs;
+}
+
+//==============================================================================
+}
@@ -0,0 +1,58 @@
+#ifndef PRICELEVELS_HPP
+#define PRICELEVELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace orderbook {
+
+struct PriceLevel {
+    int64_t price{ 0 };
+    int64_t amount{ 0 };
+
+    PriceLevel& operator+=(const PriceLevel& rhs);
+    PriceLevel& operator-=(const PriceLevel& rhs);
+};
+
+/*!
+ * \brief The PriceLevels class is one side of aggregated order book, levels are kept in flat array
+ * sorted from best to worst price. Level is looked up by binary search and readers walk levels
+ * contiguously without copying them. Storage is reused as levels come and go.
+ */
+class PriceLevels {
+public:
+    using Levels = std::vector<PriceLevel>;
+    using const_iterator = Levels::const_iterator;
+
+    // asks are sorted ascending, bids descending
+    explicit PriceLevels(bool descending = false);
+
+    // replaces all levels, levels with the same price are merged
+    void assign(Levels levels);
+    void clear();
+    // adds amount to level, level is created when missing
+    const PriceLevel& add(const PriceLevel& delta);
+    // subtracts amount from existing level, level is dropped once it is empty. Returns false when
+    // there is no such level.
+    bool subtract(const PriceLevel& delta);
+
+    const PriceLevel* find(int64_t price) const;
+    // first level with given or worse price
+    const_iterator lowerBound(int64_t price) const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    size_t size() const;
+    bool empty() const;
+
+private:
+    Levels::iterator position(int64_t price);
+    bool isBefore(int64_t lhs, int64_t rhs) const;
+
+private:
+    bool _descending{ false };
+    Levels _levels;
+};
+}
+
+#endif // PRICELEVELS_HPP
@@ -8,15 +8,14 @@ namespace orderbook {
 
 //==============================================================================
 
-template <typename Container, typename F>
-static void TraverseHelper(const Container& where, uint64_t lastKey, uint32_t limit, F func)
+static void TraverseHelper(const PriceLevels& where, int64_t lastKnownPrice, uint32_t limit,
+    const TradingOrdersModel::Traverser& func)
 {
-    auto it = lastKey > 0 ? std::begin(where) : where.lower_bound(lastKey);
-    while (it != std::end(where) && --limit > 0) {
-        func(it->second);
-        ++it;
+    auto it = lastKnownPrice > 0 ? where.lowerBound(lastKnownPrice) : std::begin(where);
+    for (; it != std::end(where) && limit > 0; ++it, --limit) {
+        func(*it);
     }
-};
+}
 
 //==============================================================================
 
@@ -76,34 +75,31 @@ Promise<void> TradingOrdersModel::subscribe(std::string tradingPair)
             return;
         }
 
-        auto& asks = self->_activeAsks[tradingPair];
-        auto& bids = self->_activeBids[tradingPair];
-
-        asks.clear();
-        bids.clear();
+        auto& book = self->_books[tradingPair];
 
-        auto copyHelper = [](const auto& from, auto& to) {
+        // bids come with funds in quote currency, they are converted to base currency
+        auto copyHelper = [&tradingPair](const auto& from, auto& to, bool isBuy) {
+            PriceLevels::Levels levels;
+            levels.reserve(from.size());
             for (auto&& item : from) {
                 OrderSummary summary;
                 summary.price = ConvertBigInt(item.price());
                 summary.amount = ConvertBigInt(item.amount());
-                to.emplace(ConvertBigInt(item.price()), summary);
+                if (isBuy) {
+                    summary.amount = swaps::MakerTakerAmounts::CalculateOrderAmount(
+                        summary.amount, summary.price, tradingPair);
+                }
+                levels.push_back(summary);
             }
+            to.assign(std::move(levels));
         };
 
-        auto subscribeResponse = response.subscriberesponse();
+        const auto& subscribeResponse = response.subscriberesponse();
 
-        copyHelper(subscribeResponse.summaryasks(), asks);
-        copyHelper(subscribeResponse.summarybids(), bids);
-
-        for (auto& bid : bids) {
-            auto funds = swaps::MakerTakerAmounts::CalculateOrderAmount(
-                bid.second.amount, bid.second.price, tradingPair);
-
-            bid.second.amount = funds;
-        }
+        copyHelper(subscribeResponse.summaryasks(), book.asks, false);
+        copyHelper(subscribeResponse.summarybids(), book.bids, true);
 
-        LogCDebug(Orderbook) << "Got asks:" << asks.size() << "got bids:" << bids.size()
+        LogCDebug(Orderbook) << "Got asks:" << book.asks.size() << "got bids:" << book.bids.size()
                              << "trades for" << tradingPair.c_str();
         self->ordersChanged(tradingPair);
     });
@@ -126,8 +122,9 @@ Promise<void> TradingOrdersModel::unsubsribe(std::string tradingPair)
 void TradingOrdersModel::traverseAsks(
     std::string pairId, int64_t lastKnownPrice, uint32_t limit, Traverser func) const
 {
-    if (_activeAsks.count(pairId) > 0) {
-        TraverseHelper(_activeAsks.at(pairId), lastKnownPrice, limit, func);
+    auto it = _books.find(pairId);
+    if (it != _books.end()) {
+        TraverseHelper(it->second.asks, lastKnownPrice, limit, func);
     }
 }
 
@@ -136,8 +133,9 @@ void TradingOrdersModel::traverseAsks(
 void TradingOrdersModel::traverseBids(
     std::string pairId, int64_t lastKnownPrice, uint32_t limit, Traverser func) const
 {
-    if (_activeBids.count(pairId) > 0) {
-        TraverseHelper(_activeBids.at(pairId), lastKnownPrice, limit, func);
+    auto it = _books.find(pairId);
+    if (it != _books.end()) {
+        TraverseHelper(it->second.bids, lastKnownPrice, limit, func);
     }
 }
 
@@ -153,49 +151,37 @@ bool TradingOrdersModel::canFetchMore(std::string pairId) const
 Promise<void> TradingOrdersModel::fetchMoreHistoricTrades(std::string pairId)
 {
     const auto& trades = _historicTrades[pairId];
-    return fetchHistoricTrades(pairId, trades.empty() ? std::string() : trades.back().id());
+    return fetchHistoricTrades(pairId, trades.empty() ? std::string() : trades.back()->id());
 }
 
 //==============================================================================
 
-TradingOrdersModel::HistoricTrades TradingOrdersModel::historicTrades(
-    std::string pairId, std::string lastSeenId) const
+void TradingOrdersModel::traverseHistoricTrades(
+    std::string pairId, std::string lastSeenId, HistoricTradesTraverser func) const
 {
-    HistoricTrades result;
-    if (_historicTrades.count(pairId) > 0) {
-        const auto& trades = _historicTrades.at(pairId);
-        auto it = std::find_if(std::begin(trades), std::end(trades),
-            [lastSeenId](const auto& trade) { return trade.id() == lastSeenId; });
-
-        if (it == std::end(trades)) {
-            if (lastSeenId.empty()) {
-                it = std::begin(trades);
-            }
-        } else {
-            // we don't want to include lastSeenId
-            std::advance(it, 1);
-        }
-
-        std::copy(it, std::end(trades), std::back_inserter(result));
+    auto it = _historicTrades.find(pairId);
+    if (it != _historicTrades.end()) {
+        // we don't want to include lastSeenId
+        it->second.traverseAfter(lastSeenId, func);
     }
-
-    return result;
 }
 
 //==============================================================================
 
 const TradingOrdersModel::Asks& TradingOrdersModel::askOrders(std::string pairId) const
 {
-    static Asks empty;
-    return _activeAsks.count(pairId) > 0 ? _activeAsks.at(pairId) : empty;
+    static const Asks empty{ false };
+    auto it = _books.find(pairId);
+    return it != _books.end() ? it->second.asks : empty;
 }
 
 //==============================================================================
 
 const TradingOrdersModel::Bids& TradingOrdersModel::bidOrders(std::string pairId) const
 {
-    static Bids empty;
-    return _activeBids.count(pairId) > 0 ? _activeBids.at(pairId) : empty;
+    static const Bids empty{ true };
+    auto it = _books.find(pairId);
+    return it != _books.end() ? it->second.bids : empty;
 }
 
 //==============================================================================
@@ -215,7 +201,7 @@ Promise<void> TradingOrdersModel::fetchHistoricTrades(
     getHistoricTradesCmd.set_allocated_gethistorictrades(cmd);
     return _client.makeRequest(getHistoricTradesCmd)
         .then([this, pairId, lastSeenTradeId](OrderbookResponse response) {
-            auto historicTradesResponse = response.gethistorictradesresponse();
+            const auto& historicTradesResponse = response.gethistorictradesresponse();
             if (historicTradesResponse.trades_size() == 0) {
                 _fetchedAllHistoricTrades.insert(pairId);
                 return;
@@ -223,17 +209,12 @@ Promise<void> TradingOrdersModel::fetchHistoricTrades(
 
             auto& trades = historicTradesResponse.trades();
             auto& tradesDest = _historicTrades[pairId];
-            auto firstId = trades.begin()->id();
-
-            auto it = std::find_if(std::begin(tradesDest), std::end(tradesDest),
-                [firstId](const auto& trade) { return trade.id() == firstId; });
-
-            if (it != std::end(tradesDest)) {
+            if (tradesDest.contains(trades.begin()->id())) {
                 return;
             }
 
             for (auto&& trade : trades) {
-                tradesDest.emplace_back(trade);
+                tradesDest.push(trade);
             }
         });
 }
@@ -242,15 +223,16 @@ Promise<void> TradingOrdersModel::fetchHistoricTrades(
 
 void TradingOrdersModel::addHistoricTrade(io::stakenet::orderbook::protos::Trade trade)
 {
-    _historicTrades[trade.tradingpair()].emplace_back(trade);
-    emit historicTradeAdded(trade.tradingpair(), trade);
+    if (_historicTrades[trade.tradingpair()].push(trade)) {
+        emit historicTradeAdded(trade.tradingpair(), trade);
+    }
 }
 
 //==============================================================================
 
-void TradingOrdersModel::onOrderPlaced(Event::ServerEvent event)
+void TradingOrdersModel::onOrderPlaced(const Event::ServerEvent& event)
 {
-    auto order = event.orderplaced().order();
+    const auto& order = event.orderplaced().order();
     auto isBuy
         = order.side() == io::stakenet::orderbook::protos::Order::OrderSide::Order_OrderSide_buy;
 
@@ -258,10 +240,11 @@ void TradingOrdersModel::onOrderPlaced(Event::ServerEvent event)
                          << order.details().orderid().c_str() << isBuy;
     auto summary = ConvertToOrderSummary(order);
 
+    auto& book = _books[order.tradingpair()];
     if (isBuy) {
-        _activeBids[order.tradingpair()][summary.price] += summary;
+        book.bids.add(summary);
     } else {
-        _activeAsks[order.tradingpair()][summary.price] += summary;
+        book.asks.add(summary);
     }
 
     orderAdded(order.tradingpair(), summary, !isBuy);
@@ -269,40 +252,28 @@ void TradingOrdersModel::onOrderPlaced(Event::ServerEvent event)
 
 //==============================================================================
 
-void TradingOrdersModel::onOrderMatched(Event::ServerEvent event)
+void TradingOrdersModel::onOrderMatched(const Event::ServerEvent& event)
 {
-    auto trade = event.ordersmatched().trade();
-
-    auto deleteOrder = [this, trade](auto& where, bool isAsk) {
-        auto pairId = trade.tradingpair();
-        if (where.count(pairId) > 0) {
-            auto& orders = where.at(pairId);
-            auto it = orders.find(ConvertBigInt(trade.price()));
-            if (it != std::end(orders)) {
-                OrderSummary summary;
-                summary.price = ConvertBigInt(trade.price());
-                summary.amount = ConvertBigInt(trade.existingorderfunds());
-
-                if (!isAsk) {
-                    auto funds = swaps::MakerTakerAmounts::CalculateOrderAmount(
-                        summary.amount, summary.price, pairId);
-                    summary.amount = funds;
-                }
-
-                it->second -= summary;
-                if (it->second.amount <= 0) {
-                    orders.erase(it);
-                }
-
-                this->orderRemoved(pairId, summary, isAsk);
+    const auto& trade = event.ordersmatched().trade();
+
+    const auto& pairId = trade.tradingpair();
+    auto bookIt = _books.find(pairId);
+    if (bookIt != _books.end()) {
+        auto isAsk = QString::fromStdString(trade.executingorderside()).toLower() != "sell";
+        auto& levels = isAsk ? bookIt->second.asks : bookIt->second.bids;
+
+        OrderSummary summary;
+        summary.price = ConvertBigInt(trade.price());
+        if (levels.find(summary.price)) {
+            summary.amount = ConvertBigInt(trade.existingorderfunds());
+            if (!isAsk) {
+                summary.amount = swaps::MakerTakerAmounts::CalculateOrderAmount(
+                    summary.amount, summary.price, pairId);
             }
-        }
-    };
 
-    if (QString::fromStdString(trade.executingorderside()).toLower() == "sell") {
-        deleteOrder(_activeBids, false);
-    } else {
-        deleteOrder(_activeAsks, true);
+            levels.subtract(summary);
+            this->orderRemoved(pairId, summary, isAsk);
+        }
     }
 
     addHistoricTrade(trade);
@@ -310,55 +281,22 @@ void TradingOrdersModel::onOrderMatched(Event::ServerEvent event)
 
 //==============================================================================
 
-void TradingOrdersModel::onOrderCanceled(Event::ServerEvent event)
+void TradingOrdersModel::onOrderCanceled(const Event::ServerEvent& event)
 {
-    auto order = event.ordercanceled().order();
-    auto deleteOrder = [this, summary = ConvertToOrderSummary(order), pairId = order.tradingpair()](
-                           auto& where, bool isAsk) {
-        if (where.count(pairId) > 0) {
-            auto& orders = where.at(pairId);
-            auto it = orders.find(summary.price);
-            if (it != std::end(orders)) {
-                it->second -= summary;
-                if (it->second.amount <= 0) {
-                    orders.erase(it);
-                }
-
-                this->orderRemoved(pairId, summary, isAsk);
-                return true;
-            }
-        }
-
-        return false;
-    };
+    const auto& order = event.ordercanceled().order();
+    auto bookIt = _books.find(order.tradingpair());
+    if (bookIt == _books.end()) {
+        return;
+    }
 
     auto isBuy
         = order.side() == io::stakenet::orderbook::protos::Order::OrderSide::Order_OrderSide_buy;
-
-    if (isBuy) {
-        deleteOrder(_activeBids, false);
-    } else {
-        deleteOrder(_activeAsks, true);
+    auto& levels = isBuy ? bookIt->second.bids : bookIt->second.asks;
+    auto summary = ConvertToOrderSummary(order);
+    if (levels.subtract(summary)) {
+        this->orderRemoved(order.tradingpair(), summary, !isBuy);
     }
 }
 
-//==============================================================================
-
-TradingOrdersModel::OrderSummary& TradingOrdersModel::OrderSummary::operator+=(
-    const OrderSummary& rhs)
-{
-    this->amount += rhs.amount;
-    return *this;
-}
-
-//==============================================================================
-
-TradingOrdersModel::OrderSummary& TradingOrdersModel::OrderSummary::operator-=(
-    const OrderSummary& rhs)
-{
-    this->amount -= rhs.amount;
-    return *this;
-}
-
 //==============================================================================
 }
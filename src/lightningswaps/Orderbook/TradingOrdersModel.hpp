@@ -1,8 +1,10 @@
 #ifndef TRADINGORDERSMODEL_HPP
 #define TRADINGORDERSMODEL_HPP
 
+#include <Orderbook/HistoricTradesBuffer.hpp>
 #include <Orderbook/OrderbookApiClient.hpp>
 #include <Orderbook/OrderbookEventDispatcher.hpp>
+#include <Orderbook/PriceLevels.hpp>
 #include <QMetaType>
 #include <QObject>
 #include <boost/optional.hpp>
@@ -15,14 +17,7 @@ public:
     explicit TradingOrdersModel(OrderbookApiClient& client, OrderbookEventDispatcher& dispatcher,
         QObject* parent = nullptr);
 
-    struct OrderSummary {
-        int64_t price{ 0 };
-        int64_t amount{ 0 };
-
-        OrderSummary& operator+=(const OrderSummary& rhs);
-        OrderSummary& operator-=(const OrderSummary& rhs);
-    };
-
+    using OrderSummary = PriceLevel;
     using Details = OrderSummary;
     using HistoricTrade = io::stakenet::orderbook::protos::Trade;
     struct Trade {
@@ -32,17 +27,19 @@ public:
         int64_t executedOn;
     };
 
-    using Asks = std::map<int64_t, Details>;
-    using Bids = std::map<int64_t, Details, std::greater<int64_t>>;
+    // levels are iterated from best to worst price, contiguously and without copying
+    using Asks = PriceLevels;
+    using Bids = PriceLevels;
     using Trades = std::unordered_map<std::string, Trade>;
     using MyOrders = std::vector<io::stakenet::orderbook::protos::Order>;
-    using HistoricTrades = std::vector<io::stakenet::orderbook::protos::Trade>;
 
     Promise<void> subscribe(std::string tradingPair);
     Promise<void> unsubsribe(std::string tradingPair);
 
     using Traverser = std::function<void(Details)>;
+    using HistoricTradesTraverser = std::function<void(const HistoricTrade&)>;
 
+    // lastKnownPrice = 0 starts from the best level
     void traverseAsks(
         std::string pairId, int64_t lastKnownPrice, uint32_t limit, Traverser func) const;
     void traverseBids(
@@ -50,7 +47,9 @@ public:
 
     bool canFetchMore(std::string pairId) const;
     Promise<void> fetchMoreHistoricTrades(std::string pairId);
-    HistoricTrades historicTrades(std::string pairId, std::string lastSeenId) const;
+    // trades newer than lastSeenId, oldest first, empty lastSeenId traverses all of them
+    void traverseHistoricTrades(
+        std::string pairId, std::string lastSeenId, HistoricTradesTraverser func) const;
 
     const Asks& askOrders(std::string pairId) const;
     const Bids& bidOrders(std::string pairId) const;
@@ -67,9 +66,9 @@ signals:
     void historicTradeAdded(std::string pairId, HistoricTrade trade);
 
 private slots:
-    void onOrderPlaced(Event::ServerEvent event);
-    void onOrderMatched(Event::ServerEvent event);
-    void onOrderCanceled(Event::ServerEvent event);
+    void onOrderPlaced(const Event::ServerEvent& event);
+    void onOrderMatched(const Event::ServerEvent& event);
+    void onOrderCanceled(const Event::ServerEvent& event);
 
 private:
     Promise<void> fetchHistoricTrades(
@@ -77,12 +76,16 @@ private:
     void addHistoricTrade(io::stakenet::orderbook::protos::Trade trade);
 
 private:
+    struct Book {
+        Asks asks{ false };
+        Bids bids{ true };
+    };
+
     OrderbookApiClient& _client;
     OrderbookEventDispatcher& _dispatcher;
 
-    std::unordered_map<std::string, Asks> _activeAsks;
-    std::unordered_map<std::string, Bids> _activeBids;
-    std::unordered_map<std::string, HistoricTrades> _historicTrades;
+    std::unordered_map<std::string, Book> _books;
+    std::unordered_map<std::string, HistoricTradesBuffer> _historicTrades;
     std::set<std::string> _fetchedAllHistoricTrades;
 };
 }
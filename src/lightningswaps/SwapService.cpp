@@ -156,7 +156,8 @@ Promise<std::vector<std::string>> SwapService::activatedPairs()
 Promise<std::vector<orderbook::LimitOrder>> SwapService::listOrders(
     std::string pairId, int64_t lastKnownPrice, uint32_t limit)
 {
-    limit = std::min<uint32_t>(limit, 100);
+    // 0 means client didn't set limit, it gets the same page as with maximum one
+    limit = limit == 0 ? 100 : std::min<uint32_t>(limit, 100);
     return Promise<std::vector<orderbook::LimitOrder>>([=](const auto& resolve, const auto&) {
         QMetaObject::invokeMethod(this, [=] {
             std::vector<orderbook::LimitOrder> result;
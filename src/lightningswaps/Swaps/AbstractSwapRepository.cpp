@@ -1,10 +1,20 @@
 #include "AbstractSwapRepository.hpp"
 #include <Utils/Logging.hpp>
 
+#include <algorithm>
+
 namespace swaps {
 
 //==============================================================================
 
+static size_t CompactHash(const std::string& rHash)
+{
+    // collision only makes fresh hash look used, which is rejected as reuse, safe side
+    return std::hash<std::string>()(rHash);
+}
+
+//==============================================================================
+
 AbstractSwapRepository::AbstractSwapRepository(QObject* parent)
     : QObject(parent)
 {
@@ -15,7 +25,19 @@ AbstractSwapRepository::AbstractSwapRepository(QObject* parent)
 void AbstractSwapRepository::load()
 {
     try {
-        _deals = executeLoadAll();
+        _activeDeals.clear();
+        for (auto&& deal : executeLoadActive()) {
+            _activeDeals.emplace(deal.rHash, deal);
+        }
+
+        auto hashes = executeLoadArchivedHashes();
+        _archivedHashes.clear();
+        _archivedHashes.reserve(hashes.size());
+        std::transform(std::begin(hashes), std::end(hashes), std::back_inserter(_archivedHashes),
+            CompactHash);
+        std::sort(std::begin(_archivedHashes), std::end(_archivedHashes));
+        _recentlyArchived.clear();
+        _oldestArchivedTime = executeLoadOldestArchivedTime();
     } catch (std::exception& ex) {
         LogCCritical(Swaps) << "Failed to load deals from database" << ex.what();
     }
@@ -25,11 +47,10 @@ void AbstractSwapRepository::load()
 
 void AbstractSwapRepository::saveDeal(SwapDeal deal)
 {
-    if (this->deal(deal.rHash)) {
+    if (_activeDeals.count(deal.rHash) > 0 || isArchived(deal.rHash)) {
         updateDeal(deal);
     } else {
-        executeSaveDeal(deal);
-        _deals.emplace_back(deal);
+        storeDeal(deal);
         dealAdded(deal);
     }
 }
@@ -38,12 +59,8 @@ void AbstractSwapRepository::saveDeal(SwapDeal deal)
 
 void AbstractSwapRepository::updateDeal(SwapDeal deal)
 {
-    auto it = std::find_if(std::begin(_deals), std::end(_deals),
-        [rHash = deal.rHash](const auto& deal) { return deal.rHash == rHash; });
-
-    if (it != std::end(_deals)) {
-        executeSaveDeal(deal);
-        *it = deal;
+    if (_activeDeals.count(deal.rHash) > 0 || isArchived(deal.rHash)) {
+        storeDeal(deal);
         dealChanged(deal);
     }
 }
@@ -52,17 +69,71 @@ void AbstractSwapRepository::updateDeal(SwapDeal deal)
 
 boost::optional<SwapDeal> AbstractSwapRepository::deal(std::string rHash) const
 {
-    auto it = std::find_if(std::begin(_deals), std::end(_deals),
-        [rHash](const auto& deal) { return deal.rHash == rHash; });
+    auto it = _activeDeals.find(rHash);
+    if (it != std::end(_activeDeals)) {
+        return it->second;
+    }
+
+    return isArchived(rHash) ? executeLoadArchived(rHash) : boost::none;
+}
+
+//==============================================================================
+
+auto AbstractSwapRepository::activeDeals() const -> Deals
+{
+    Deals result;
+    result.reserve(_activeDeals.size());
+    for (auto&& it : _activeDeals) {
+        result.emplace_back(it.second);
+    }
+
+    return result;
+}
+
+//==============================================================================
 
-    return it != std::end(_deals) ? boost::make_optional(*it) : boost::none;
+auto AbstractSwapRepository::archivedDeals(int64_t fromTime, int64_t toTime) const -> Deals
+{
+    return fromTime < toTime ? executeLoadArchived(fromTime, toTime) : Deals{};
+}
+
+//==============================================================================
+
+boost::optional<int64_t> AbstractSwapRepository::oldestArchivedTime() const
+{
+    return _oldestArchivedTime;
+}
+
+//==============================================================================
+
+bool AbstractSwapRepository::isHashUsed(const std::string& rHash) const
+{
+    return _activeDeals.count(rHash) > 0 || isArchived(rHash);
+}
+
+//==============================================================================
+
+void AbstractSwapRepository::storeDeal(const SwapDeal& deal)
+{
+    executeSaveDeal(deal);
+    if (deal.state == SwapState::Active) {
+        _activeDeals[deal.rHash] = deal;
+    } else {
+        _activeDeals.erase(deal.rHash);
+        _recentlyArchived.insert(CompactHash(deal.rHash));
+        if (!_oldestArchivedTime || deal.createTime < *_oldestArchivedTime) {
+            _oldestArchivedTime = deal.createTime;
+        }
+    }
 }
 
 //==============================================================================
 
-auto swaps::AbstractSwapRepository::deals() const -> const Deals&
+bool AbstractSwapRepository::isArchived(const std::string& rHash) const
 {
-    return _deals;
+    auto hash = CompactHash(rHash);
+    return _recentlyArchived.count(hash) > 0
+        || std::binary_search(std::begin(_archivedHashes), std::end(_archivedHashes), hash);
 }
 
 //==============================================================================
@@ -3,9 +3,17 @@
 
 #include <QObject>
 #include <Swaps/Types.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace swaps {
 
+/*!
+ * \brief The AbstractSwapRepository class keeps only active deals in memory. Finished deals are
+ * moved to archive, from which they are read back on demand, only compact hashes of their rHash
+ * stay resident to detect payment hash reuse.
+ */
 class AbstractSwapRepository : public QObject {
     Q_OBJECT
 public:
@@ -16,7 +24,12 @@ public:
     void saveDeal(SwapDeal deal);
     void updateDeal(SwapDeal deal);
     boost::optional<SwapDeal> deal(std::string rHash) const;
-    const Deals& deals() const;
+    Deals activeDeals() const;
+    // finished deals created in [fromTime, toTime), ordered by creation time
+    Deals archivedDeals(int64_t fromTime, int64_t toTime) const;
+    // creation time of the oldest finished deal, none when archive is empty
+    boost::optional<int64_t> oldestArchivedTime() const;
+    bool isHashUsed(const std::string& rHash) const;
 
 signals:
     void dealAdded(SwapDeal deal);
@@ -25,11 +38,23 @@ signals:
 public slots:
 
 protected:
-    virtual Deals executeLoadAll() = 0;
+    virtual Deals executeLoadActive() = 0;
+    virtual std::vector<std::string> executeLoadArchivedHashes() = 0;
+    // stores active deal or moves finished one to archive, depending on deal state
     virtual void executeSaveDeal(SwapDeal deal) = 0;
+    virtual boost::optional<SwapDeal> executeLoadArchived(std::string rHash) const = 0;
+    virtual Deals executeLoadArchived(int64_t fromTime, int64_t toTime) const = 0;
+    virtual boost::optional<int64_t> executeLoadOldestArchivedTime() const = 0;
 
 private:
-    Deals _deals;
+    void storeDeal(const SwapDeal& deal);
+    bool isArchived(const std::string& rHash) const;
+
+private:
+    std::unordered_map<std::string, SwapDeal> _activeDeals;
+    std::vector<size_t> _archivedHashes; // sorted, archived before load
+    std::unordered_set<size_t> _recentlyArchived;
+    boost::optional<int64_t> _oldestArchivedTime;
 };
 }
 
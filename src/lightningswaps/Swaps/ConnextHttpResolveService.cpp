@@ -4,12 +4,15 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QThreadPool>
+#include <QThread>
 #include <boost/asio.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
 
+#include <algorithm>
+#include <vector>
+
 //==============================================================================
 
 namespace ip = boost::asio::ip; // from <boost/asio.hpp>
@@ -17,297 +20,304 @@ using tcp = boost::asio::ip::tcp; // from <boost/asio.hpp>
 namespace http = boost::beast::http; // from <boost/beast/http.hpp>
 
 //==============================================================================
-namespace swaps {
 
-struct ConnextHttpResolveService::HttpWorker {
-public:
-    HttpWorker(HttpWorker const&) = delete;
-    HttpWorker& operator=(HttpWorker const&) = delete;
+static const std::chrono::seconds REQUEST_TIMEOUT{ 60 };
 
-    HttpWorker(boost::asio::io_context& ioc, std::string address, unsigned short port,
-        ConnextHttpResolveService* resolveService)
-        : _acceptor(ioc, { boost::asio::ip::make_address(address), port })
-        , _socket(ioc)
-        , _resolveService(resolveService)
-    {
-    }
+//==============================================================================
 
-    void start()
+static QJsonObject ParseTransfer(const std::string& body)
+{
+    return QJsonDocument::fromJson(QByteArray::fromRawData(body.data(), body.size()))
+        .object()
+        .value("transfer")
+        .toObject();
+}
+
+//==============================================================================
+
+static swaps::ResolveRequest ParseResolveRequest(const std::string& body)
+{
+    //        https://connext.github.io/vector/reference/nodeAPI/#conditiona-transfer-created
+
+    /*
     {
-        accept();
-        check_deadline();
+      "aliceIdentifier": "indra6RJffyPFY7D4pAkyooRxgXVyocxYkRUW3NFQVznHazn98vcadh",
+      "bobIdentifier": "indra82HffkBSTeSuvuEApLqLvY4wStnQYk7ysxZfYR2MmkwEe4XBbt",
+      "channelAddress": "0xaE55b9aDdcD1cF5F5ECbff958F8C610d58f896d9",
+      "channelBalance": {
+        "to": [
+          "0x9caCb917abf1966C4AD59e1f7233D9C9A93568a2",
+          "0xC2FD5FE40adb1cA722079a0314Bb8b166150BDDE"
+        ],
+        "amount": [
+          "856",
+          "509027"
+        ]
+      },
+      "transfer": {
+        "balance": {
+          "to": [
+            "0x9caCb917abf1966C4AD59e1f7233D9C9A93568a2",
+            "0xC2FD5FE40adb1cA722079a0314Bb8b166150BDDE"
+          ],
+          "amount": [
+            "127",
+            "0"
+          ]
+        },
+        "assetId": "0x0000000000000000000000000000000000000000",
+        "transferId": "0x07617f96952ca8f53d89387cb13272251bbef0e3a6d2623ddec0a349195ca7e5",
+        "channelAddress": "0xaE55b9aDdcD1cF5F5ECbff958F8C610d58f896d9",
+        "transferDefinition": "0xd69ABEf7eF08957F47d5B060B63D0b71Ee8d4621",
+        "transferEncodings": [
+          "tuple(bytes32 lockHash, uint256 expiry)",
+          "tuple(bytes32 preImage)"
+        ],
+        "transferTimeout": "8640",
+        "initialStateHash":
+    "0xb40e01a1bde58598b8afe0c6e075eb44c28e70e234b10e4460c322154ade842a", "transferState": {
+          "lockHash": "0x79a157d5572d9954c257c0ed29dc167b50579065acd8d329aa06e1344cf69f70",
+          "expiry": "0"
+        },
+        "channelFactoryAddress": "0x70b3673264E9D56Cc8e53597bF3105eF281a5a0c",
+        "chainId": 4,
+        "initiator": "0x9caCb917abf1966C4AD59e1f7233D9C9A93568a2",
+        "responder": "0xC2FD5FE40adb1cA722079a0314Bb8b166150BDDE",
+        "meta": {
+          "hello": "world123"
+        }
+      },
+      "conditionType": "HashlockTransfer",
+      "activeTransferIds": [
+        "0x07617f96952ca8f53d89387cb13272251bbef0e3a6d2623ddec0a349195ca7e5"
+      ]
     }
 
-private:
-    // The acceptor used to listen for incoming connections.
-    boost::asio::basic_socket_acceptor<tcp, boost::asio::io_context::executor_type> _acceptor;
+    */
+
+    auto transfer = ParseTransfer(body);
+
+    swaps::ResolveRequest request;
+    request.rHash = transfer.value("transferState")
+                        .toObject()
+                        .value("lockHash")
+                        .toString()
+                        .mid(2)
+                        .toStdString();
+
+    request.amount = static_cast<int64_t>(transfer.value("balance")
+                                              .toObject()
+                                              .value("amount")
+                                              .toArray()
+                                              .first()
+                                              .toString()
+                                              .toDouble());
+
+    request.expiration = transfer.value("transferTimeout").toString().toInt();
+    request.initiatorIdentifier = transfer.value("initiatorIdentifier").toString().toStdString();
+    request.responderIdentifier = transfer.value("responderIdentifier").toString().toStdString();
+    request.transferId = transfer.value("transferId").toString().toStdString();
+    request.channelAddress = transfer.value("channelAddress").toString().toStdString();
+    return request;
+}
 
-    // The socket for the currently connected client.
-    boost::asio::basic_stream_socket<tcp, boost::asio::io_context::executor_type> _socket;
+//==============================================================================
 
-    // The buffer for performing reads
-    boost::beast::flat_buffer _buffer{ 8192 };
+static swaps::ResolvedTransferResponse ParseResolvedTransfer(const std::string& body)
+{
+    auto transfer = ParseTransfer(body);
 
-    // The timer putting a time limit on requests.
-    boost::asio::basic_waitable_timer<std::chrono::steady_clock> _requestDeadline{
-        _acceptor.get_executor().context(), (std::chrono::steady_clock::time_point::max)()
-    };
+    swaps::ResolvedTransferResponse response;
+    response.lockHash = transfer.value("transferState")
+                            .toObject()
+                            .value("lockHash")
+                            .toString()
+                            .mid(2)
+                            .toStdString();
 
-    // The request message.
-    http::request<http::dynamic_body> _request;
+    response.rPreimage = transfer.value("transferResolver")
+                             .toObject()
+                             .value("preImage")
+                             .toString()
+                             .mid(2)
+                             .toStdString();
+    return response;
+}
 
-    // The response message.
-    http::response<http::dynamic_body> _response;
+//==============================================================================
 
-    ConnextHttpResolveService* _resolveService{ nullptr };
+namespace swaps {
 
-    void accept()
+struct ConnextHttpResolveService::Session : std::enable_shared_from_this<Session> {
+public:
+    Session(tcp::socket&& socket, ConnextHttpResolveService* resolveService)
+        : _stream(std::move(socket))
+        , _resolveService(resolveService)
     {
-        // Clean up any previous connection.
-        boost::beast::error_code ec;
-        _socket.close(ec);
-        _buffer.consume(_buffer.size());
-        _request = {};
+    }
 
-        LogDebug() << "Accepting on socket";
+    void start() { readRequest(); }
 
-        _acceptor.async_accept(_socket, [this](boost::beast::error_code ec) {
-            if (ec) {
-                LogCCritical(Connext) << "Failed to accept: " << ec.message().data();
-                accept();
-            } else {
-                // Request must be fully processed within 60 seconds.
-                _requestDeadline.expires_after(std::chrono::seconds(60));
+    // cancels pending operations, their handlers release the session.
+    void abort() { _stream.close(); }
 
-                readRequest();
-            }
-        });
-    }
+private:
+    boost::beast::tcp_stream _stream;
+    boost::beast::flat_buffer _buffer;
+    http::request<http::string_body> _request;
+    http::response<http::string_body> _response;
+    ConnextHttpResolveService* _resolveService{ nullptr };
 
     void readRequest()
     {
-        LogDebug() << "Preparing async_read";
-        http::async_read(
-            _socket, _buffer, _request, [this](boost::beast::error_code ec, std::size_t size) {
-                if (ec) {
-                    LogCCritical(Swaps) << "Failed to async_read: " << ec.message().data();
-                    accept();
-                } else {
-                    processRequest();
-                }
+        _request = {};
+        // every request on keep-alive connection must be fully received within timeout.
+        _stream.expires_after(REQUEST_TIMEOUT);
+        http::async_read(_stream, _buffer, _request,
+            [self = shared_from_this()](boost::beast::error_code ec, std::size_t) {
+                self->onRead(ec);
             });
     }
 
-    void processRequest()
+    void onRead(boost::beast::error_code ec)
     {
-        LogDebug() << "Incomming request:" << _request.method_string().data()
-                   << _request.target().data();
-        switch (_request.method()) {
-        case http::verb::post:
-            if (_request.target() == "/created") {
-                resolveHash(_request.body());
-                break;
-            } else if (_request.target() == "/resolved") {
-                settleTransfer(_request.body());
-                break;
+        if (ec == http::error::end_of_stream) {
+            close();
+        } else if (ec) {
+            if (ec != boost::asio::error::operation_aborted) {
+                LogCDebug(Connext) << "Failed to read request:" << ec.message().data();
             }
+        } else {
+            processRequest();
+        }
+    }
 
-        default:
+    void processRequest()
+    {
+        LogCDebug(Connext) << "Incoming request:" << _request.method_string().to_string().data()
+                           << _request.target().to_string().data();
+
+        _response = {};
+        _response.version(_request.version());
+        _response.keep_alive(_request.keep_alive());
+
+        if (_request.method() == http::verb::post && _request.target() == "/created") {
+            auto request = ParseResolveRequest(_request.body());
+            _resolveService->enqueue([service = _resolveService, request] {
+                service->receivedResolveRequest(request);
+            });
+            sendResponse();
+        } else if (_request.method() == http::verb::post && _request.target() == "/resolved") {
+            auto response = ParseResolvedTransfer(_request.body());
+            _resolveService->enqueue([service = _resolveService, response] {
+                service->receivedResolvedTransfer(response);
+            });
+            sendResponse();
+        } else {
             // We return responses indicating an error if
             // we do not recognize the request method.
             sendBadResponse();
-            break;
         }
     }
 
-    void resolveHash(boost::beast::multi_buffer const& body)
+    void sendResponse()
     {
-        auto bodyAsString = boost::beast::buffers_to_string(body.data());
-        LogDebug() << "Got transfer created request:" << bodyAsString.data();
-        //        https://connext.github.io/vector/reference/nodeAPI/#conditiona-transfer-created
-
-        /*
-        {
-          "aliceIdentifier": "indra6RJffyPFY7D4pAkyooRxgXVyocxYkRUW3NFQVznHazn98vcadh",
-          "bobIdentifier": "indra82HffkBSTeSuvuEApLqLvY4wStnQYk7ysxZfYR2MmkwEe4XBbt",
-          "channelAddress": "0xaE55b9aDdcD1cF5F5ECbff958F8C610d58f896d9",
-          "channelBalance": {
-            "to": [
-              "0x9caCb917abf1966C4AD59e1f7233D9C9A93568a2",
-              "0xC2FD5FE40adb1cA722079a0314Bb8b166150BDDE"
-            ],
-            "amount": [
-              "856",
-              "509027"
-            ]
-          },
-          "transfer": {
-            "balance": {
-              "to": [
-                "0x9caCb917abf1966C4AD59e1f7233D9C9A93568a2",
-                "0xC2FD5FE40adb1cA722079a0314Bb8b166150BDDE"
-              ],
-              "amount": [
-                "127",
-                "0"
-              ]
-            },
-            "assetId": "0x0000000000000000000000000000000000000000",
-            "transferId": "0x07617f96952ca8f53d89387cb13272251bbef0e3a6d2623ddec0a349195ca7e5",
-            "channelAddress": "0xaE55b9aDdcD1cF5F5ECbff958F8C610d58f896d9",
-            "transferDefinition": "0xd69ABEf7eF08957F47d5B060B63D0b71Ee8d4621",
-            "transferEncodings": [
-              "tuple(bytes32 lockHash, uint256 expiry)",
-              "tuple(bytes32 preImage)"
-            ],
-            "transferTimeout": "8640",
-            "initialStateHash":
-        "0xb40e01a1bde58598b8afe0c6e075eb44c28e70e234b10e4460c322154ade842a", "transferState": {
-              "lockHash": "0x79a157d5572d9954c257c0ed29dc167b50579065acd8d329aa06e1344cf69f70",
-              "expiry": "0"
-            },
-            "channelFactoryAddress": "0x70b3673264E9D56Cc8e53597bF3105eF281a5a0c",
-            "chainId": 4,
-            "initiator": "0x9caCb917abf1966C4AD59e1f7233D9C9A93568a2",
-            "responder": "0xC2FD5FE40adb1cA722079a0314Bb8b166150BDDE",
-            "meta": {
-              "hello": "world123"
-            }
-          },
-          "conditionType": "HashlockTransfer",
-          "activeTransferIds": [
-            "0x07617f96952ca8f53d89387cb13272251bbef0e3a6d2623ddec0a349195ca7e5"
-          ]
-        }
-
-        */
-
-        QJsonObject requestBody
-            = QJsonDocument::fromJson(QByteArray::fromStdString(bodyAsString)).object();
-
-        ResolveRequest request;
-        request.rHash = requestBody.value("transfer")
-                            .toObject()
-                            .value("transferState")
-                            .toObject()
-                            .value("lockHash")
-                            .toString()
-                            .mid(2)
-                            .toStdString();
-
-        request.amount = static_cast<int64_t>((requestBody.value("transfer")
-                                                   .toObject()
-                                                   .value("balance")
-                                                   .toObject()
-                                                   .value("amount")
-                                                   .toArray()
-                                                   .first()
-                                                   .toString()
-                                                   .toDouble()));
-
-        request.expiration
-            = requestBody.value("transfer").toObject().value("transferTimeout").toString().toInt();
-        request.initiatorIdentifier = requestBody.value("transfer")
-                                          .toObject()
-                                          .value("initiatorIdentifier")
-                                          .toString()
-                                          .toStdString();
-        request.responderIdentifier = requestBody.value("transfer")
-                                          .toObject()
-                                          .value("responderIdentifier")
-                                          .toString()
-                                          .toStdString();
-        request.transferId
-            = requestBody.value("transfer").toObject().value("transferId").toString().toStdString();
-        request.channelAddress = requestBody.value("transfer")
-                                     .toObject()
-                                     .value("channelAddress")
-                                     .toString()
-                                     .toStdString();
-
-        QMetaObject::invokeMethod(_resolveService,
-            std::bind(&ConnextHttpResolveService::receivedResolveRequest, _resolveService, request),
-            Qt::QueuedConnection);
-
-        auto response = QJsonDocument(QJsonObject{}).toJson(QJsonDocument::Compact);
-        LogDebug() << "Sending response" << response;
+        _response.result(http::status::ok);
         _response.set(http::field::content_type, "application/json");
-        boost::beast::ostream(_response.body()) << response.toStdString();
-        this->writeResponse();
+        _response.body() = "{}";
+        writeResponse();
     }
 
-    void settleTransfer(boost::beast::multi_buffer const& body)
+    void sendBadResponse()
     {
-        auto bodyAsString = boost::beast::buffers_to_string(body.data());
-        LogDebug() << "Got transfer resolved request:" << bodyAsString.data();
-
-        QJsonObject requestBody
-            = QJsonDocument::fromJson(QByteArray::fromStdString(bodyAsString)).object();
-
-        ResolvedTransferResponse request;
-        request.lockHash = requestBody.value("transfer")
-                               .toObject()
-                               .value("transferState")
-                               .toObject()
-                               .value("lockHash")
-                               .toString()
-                               .mid(2)
-                               .toStdString();
-
-        request.rPreimage = requestBody.value("transfer")
-                                .toObject()
-                                .value("transferResolver")
-                                .toObject()
-                                .value("preImage")
-                                .toString()
-                                .mid(2)
-                                .toStdString();
-
-        QMetaObject::invokeMethod(_resolveService,
-            std::bind(
-                &ConnextHttpResolveService::receivedResolvedTransfer, _resolveService, request));
-
-        auto response = QJsonDocument(QJsonObject{}).toJson(QJsonDocument::Compact);
-        LogDebug() << "Sending response" << response;
-        _response.set(http::field::content_type, "application/json");
-        boost::beast::ostream(_response.body()) << response.toStdString();
-        this->writeResponse();
+        _response.result(http::status::bad_request);
+        _response.set(http::field::content_type, "text/plain");
+        writeResponse();
     }
 
     void writeResponse()
     {
-        LogDebug() << "Writting response";
-        _response.content_length(_response.body().size());
-        http::async_write(_socket, _response, [this](boost::beast::error_code ec, std::size_t) {
-            LogDebug() << "Response written:" << ec.message().data();
-            _response = {};
-            _socket.shutdown(tcp::socket::shutdown_send, ec);
-            _requestDeadline.cancel();
-            this->accept();
-        });
+        _response.prepare_payload();
+        http::async_write(_stream, _response,
+            [self = shared_from_this()](boost::beast::error_code ec, std::size_t) {
+                if (ec) {
+                    LogCDebug(Connext) << "Failed to write response:" << ec.message().data();
+                } else if (self->_response.keep_alive()) {
+                    self->readRequest();
+                } else {
+                    self->close();
+                }
+            });
     }
 
-    void sendBadResponse()
+    void close()
     {
-        _response.result(http::status::bad_request);
-        _response.set(http::field::content_type, "text/plain");
-        writeResponse();
+        boost::beast::error_code ec;
+        _stream.socket().shutdown(tcp::socket::shutdown_send, ec);
     }
+};
 
-    void check_deadline()
+//==============================================================================
+
+struct ConnextHttpResolveService::Listener : std::enable_shared_from_this<Listener> {
+public:
+    Listener(boost::asio::io_context& ioc, std::string address, unsigned short port,
+        ConnextHttpResolveService* resolveService)
+        : _acceptor(ioc, { boost::asio::ip::make_address(address), port })
+        , _resolveService(resolveService)
+    {
+    }
+
+    void start() { accept(); }
+
+    void close()
     {
-        // The deadline may have moved, so check it has really passed.
-        if (_requestDeadline.expiry() <= std::chrono::steady_clock::now()) {
-            LogDebug() << "Request expired, closing socket";
-            // Close socket to cancel any outstanding operation.
-            boost::beast::error_code ec;
-            _socket.close();
-
-            // Sleep indefinitely until we're given a new deadline.
-            _requestDeadline.expires_at(std::chrono::steady_clock::time_point::max());
+        boost::beast::error_code ec;
+        _acceptor.close(ec);
+
+        for (auto&& weakSession : _sessions) {
+            if (auto session = weakSession.lock()) {
+                session->abort();
+            }
         }
+        _sessions.clear();
+    }
+
+    unsigned short port() const { return _acceptor.local_endpoint().port(); }
+
+private:
+    tcp::acceptor _acceptor;
+    ConnextHttpResolveService* _resolveService{ nullptr };
+    // keep-alive sessions, they are owned by their pending operations.
+    std::vector<std::weak_ptr<Session>> _sessions;
 
-        _requestDeadline.async_wait([this](boost::beast::error_code) { check_deadline(); });
+    void accept()
+    {
+        _acceptor.async_accept(
+            [self = shared_from_this()](boost::beast::error_code ec, tcp::socket socket) {
+                if (ec == boost::asio::error::operation_aborted) {
+                    return;
+                }
+
+                if (ec) {
+                    LogCCritical(Connext) << "Failed to accept: " << ec.message().data();
+                } else {
+                    auto session
+                        = std::make_shared<Session>(std::move(socket), self->_resolveService);
+                    self->track(session);
+                    session->start();
+                }
+
+                self->accept();
+            });
+    }
+
+    void track(std::shared_ptr<Session> session)
+    {
+        _sessions.erase(std::remove_if(_sessions.begin(), _sessions.end(),
+                            [](const auto& weakSession) { return weakSession.expired(); }),
+            _sessions.end());
+        _sessions.emplace_back(session);
     }
 };
 
@@ -323,19 +333,29 @@ ConnextHttpResolveService::ConnextHttpResolveService(QObject* parent)
 ConnextHttpResolveService::~ConnextHttpResolveService()
 {
     stop();
+
+    Notification* notification = nullptr;
+    while (_notifications.pop(notification)) {
+        delete notification;
+    }
 }
 
 //==============================================================================
 
 void ConnextHttpResolveService::start(std::string address, unsigned short port)
 {
-    _timerId = startTimer(100);
+    if (_ioThread.joinable()) {
+        return;
+    }
+
     try {
-        _server = std::make_unique<HttpWorker>(_ioc, address, port, this);
+        _listener = std::make_shared<Listener>(_ioc, address, port, this);
+        _port = _listener->port();
         LogDebug() << "Starting resolving on address " << QString::fromStdString(address) << ":"
-                   << port;
-        _server->start();
-        _ioc.poll();
+                   << _port;
+        _listener->start();
+        _ioc.restart();
+        _ioThread = std::thread([this] { _ioc.run(); });
     } catch (std::exception& ex) {
         LogCCritical(Swaps) << "Failed to init connext http resolver:" << ex.what();
     }
@@ -345,16 +365,48 @@ void ConnextHttpResolveService::start(std::string address, unsigned short port)
 
 void ConnextHttpResolveService::stop()
 {
-    if (_timerId >= 0) {
-        killTimer(_timerId);
+    if (!_ioThread.joinable()) {
+        return;
+    }
+
+    // acceptor and sessions belong to io thread, they are closed there. Loop returns once aborted
+    // handlers have run, so no session outlives the service or leaks into next start.
+    boost::asio::post(_ioc, [this] { _listener->close(); });
+    _ioThread.join();
+    _listener.reset();
+}
+
+//==============================================================================
+
+unsigned short ConnextHttpResolveService::port() const
+{
+    return _port;
+}
+
+//==============================================================================
+
+void ConnextHttpResolveService::enqueue(Notification notification)
+{
+    _notifications.push(new Notification(std::move(notification)));
+    if (!_dispatchScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(this, [this] { dispatch(); }, Qt::QueuedConnection);
     }
 }
 
 //==============================================================================
 
-void ConnextHttpResolveService::timerEvent(QTimerEvent*)
+void ConnextHttpResolveService::dispatch()
 {
-    _ioc.poll();
+    Q_ASSERT_X(QThread::currentThread() == thread(), __FUNCTION__, "Missmatched thread affinity");
+
+    // reset before draining, notification that is pushed meanwhile schedules one more dispatch
+    _dispatchScheduled = false;
+
+    Notification* notification = nullptr;
+    while (_notifications.pop(notification)) {
+        std::unique_ptr<Notification> guard(notification);
+        (*guard)();
+    }
 }
 
 //==============================================================================
@@ -2,16 +2,24 @@
 #define CONNEXTHTTPRESOLVER_HPP
 
 #include <QObject>
-#include <QThread>
 #include <QtPromise>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <thread>
 
 #include <Swaps/AbstractSwapConnextClient.hpp>
 #include <Swaps/Types.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/lockfree/queue.hpp>
 
 namespace swaps {
 
+/*!
+ * \brief The ConnextHttpResolveService class serves connext node callbacks over http. Its
+ * io_context runs on a dedicated thread and keeps one session per keep-alive connection, parsed
+ * requests are handed over to owner's thread through lock-free queue and emitted from there.
+ */
 class ConnextHttpResolveService : public AbstractConnextResolveService {
     Q_OBJECT
 public:
@@ -20,15 +28,25 @@ public:
 
     void start(std::string address, unsigned short port);
     void stop();
+    // port which is actually listened on, differs from requested one when started with 0.
+    unsigned short port() const;
 
-protected:
-    void timerEvent(QTimerEvent* event) override;
+private:
+    struct Listener;
+    struct Session;
+    using Notification = std::function<void()>;
+
+    // called from io thread, owner's thread is woken up once per batch of notifications.
+    void enqueue(Notification notification);
+    void dispatch();
 
 private:
-    struct HttpWorker;
     boost::asio::io_context _ioc{ 1 };
-    std::unique_ptr<HttpWorker> _server;
-    int _timerId{ -1 };
+    std::shared_ptr<Listener> _listener;
+    std::thread _ioThread;
+    unsigned short _port{ 0 };
+    boost::lockfree::queue<Notification*> _notifications{ 128 };
+    std::atomic_bool _dispatchScheduled{ false };
 };
 }
 
@@ -15,6 +15,8 @@
 #include <QCryptographicHash>
 #include <QDateTime>
 #include <QPointer>
+#include <QTimerEvent>
+#include <algorithm>
 #include <boost/math/distributions/poisson.hpp>
 #include <cmath>
 
@@ -125,48 +127,39 @@ SwapManager::SwapManager(const AbstractSwapPeerPool& peers, AbstractSwapClientPo
     , _repository(repository)
     , _orderbook(orderbook)
 {
+    _clock.start();
     connectSignals();
     // Load Swaps from database
     _repository.load();
-    for (auto&& deal : _repository.deals()) {
-        _usedHashes.insert(deal.rHash);
-    }
 }
 
 //==============================================================================
 
 Promise<SwapSuccess> SwapManager::executeSwap(PeerOrder maker, OwnOrder taker)
 {
-    QObject* context = new QObject;
     auto failBody = std::make_shared<packets::SwapFailedPacketBody>();
     return Promise<SwapSuccess>([=](const auto& resolve, const auto& reject) {
         try {
             this->verifyExecution(maker, taker);
             auto rHash = this->beginSwap(maker, taker);
-            connect(this, &SwapManager::swapPaid, context, [resolve, rHash](SwapSuccess success) {
-                if (rHash == success.rHash) {
-                    resolve(success);
-                }
-            });
-
-            connect(
-                this, &SwapManager::swapFailed, context, [reject, rHash, failBody](SwapDeal deal) {
-                    if (rHash == deal.rHash) {
-                        SwapFailure failure;
-                        failure.pairId = deal.pairId;
-                        failure.orderId = deal.orderId;
-                        failure.localId = deal.localId;
-                        failure.quantity = deal.takerAmount;
-                        failure.failureReason = deal.failureReason.get();
-                        failure.failureMessage = deal.errorMessage.get_value_or({});
-                        failure.role = deal.role;
-
-                        failBody->set_rhash(rHash);
-                        failBody->set_failurereason(static_cast<int>(failure.failureReason));
-                        failBody->set_errormessage(failure.failureMessage);
-                        reject(failure);
-                    }
-                });
+            SwapCompletion completion;
+            completion.onPaid = [resolve](SwapSuccess success) { resolve(success); };
+            completion.onFailed = [reject, rHash, failBody](const SwapDeal& deal) {
+                SwapFailure failure;
+                failure.pairId = deal.pairId;
+                failure.orderId = deal.orderId;
+                failure.localId = deal.localId;
+                failure.quantity = deal.takerAmount;
+                failure.failureReason = deal.failureReason.get();
+                failure.failureMessage = deal.errorMessage.get_value_or({});
+                failure.role = deal.role;
+
+                failBody->set_rhash(rHash);
+                failBody->set_failurereason(static_cast<int>(failure.failureReason));
+                failBody->set_errormessage(failure.failureMessage);
+                reject(failure);
+            };
+            _completions.emplace(rHash, std::move(completion));
         } catch (SwapException& ex) {
             SwapFailure failure;
             failure.pairId = taker.pairId;
@@ -192,32 +185,41 @@ Promise<SwapSuccess> SwapManager::executeSwap(PeerOrder maker, OwnOrder taker)
             } catch (std::exception& ex) {
                 qCCritical(Swaps) << "Failed to send swap failure:" << ex.what();
             }
-        })
-        .finally([context] { context->deleteLater(); });
+        });
 }
 
 //==============================================================================
 
 void SwapManager::timerEvent(QTimerEvent* event)
 {
-    auto it = std::find_if(std::begin(_timeouts), std::end(_timeouts),
-        [id = event->timerId()](const auto& it) { return it.second.timerId == id; });
-
-    if (it == std::end(_timeouts)) {
+    if (event->timerId() != _timeoutTimer.timerId()) {
+        QObject::timerEvent(event);
         return;
     }
 
-    auto rHash = it->first;
-    auto data = it->second;
-    _timeouts.erase(it);
+    _timeoutTimer.stop();
 
-    try {
-        auto deal = dealByHash(rHash);
-        LogCCritical(Swaps) << "Swap timed out:" << deal.rHash.c_str()
-                            << "reason:" << static_cast<int>(data.failReason);
-        failDeal(deal, data.failReason);
-    } catch (...) {
+    // failing deal changes timeouts, expired ones are collected first
+    std::vector<std::pair<RHash, SwapFailureReason>> expired;
+    auto now = _clock.elapsed();
+    while (!_deadlines.empty() && _deadlines.begin()->first <= now) {
+        auto rHash = _deadlines.begin()->second;
+        _deadlines.erase(_deadlines.begin());
+        expired.emplace_back(rHash, _timeouts.at(rHash).failReason);
+        _timeouts.erase(rHash);
+    }
+
+    for (auto&& timeout : expired) {
+        try {
+            auto deal = dealByHash(timeout.first);
+            LogCCritical(Swaps) << "Swap timed out:" << deal.rHash.c_str()
+                                << "reason:" << static_cast<int>(timeout.second);
+            failDeal(deal, timeout.second);
+        } catch (...) {
+        }
     }
+
+    scheduleTimeoutTimer();
 }
 
 //==============================================================================
@@ -632,7 +634,7 @@ std::string SwapManager::beginSwap(PeerOrder maker, OwnOrder taker)
     std::string rPreimage, rHash;
     do {
         std::tie(rPreimage, rHash) = GeneratePreimage();
-    } while (_usedHashes.count(rHash) > 0);
+    } while (_usedHashes.count(rHash) > 0 || _repository.isHashUsed(rHash));
 
     packets::SwapRequestPacketBody body;
     body.set_orderid(maker.id);
@@ -854,6 +856,9 @@ void SwapManager::setDealPhase(SwapDeal deal, SwapPhase newPhase)
         swapSuccess.type = deal.orderType;
         swapPaid(swapSuccess);
         clearTimeout(deal.rHash);
+        if (auto completion = takeCompletion(deal.rHash)) {
+            completion->onPaid(swapSuccess);
+        }
     }
 }
 
@@ -1014,6 +1019,9 @@ void SwapManager::failDeal(
     }
 
     this->swapFailed(deal);
+    if (auto completion = takeCompletion(deal.rHash)) {
+        completion->onFailed(deal);
+    }
 }
 
 //==============================================================================
@@ -1025,7 +1033,7 @@ bool SwapManager::acceptDeal(OrderToAccept orderToAccept, packets::SwapRequestPa
     // TODO: consider the time gap between taking the routes and using them.
 
     auto rHash = body.rhash();
-    if (_usedHashes.count(rHash) > 0) {
+    if (_usedHashes.count(rHash) > 0 || _repository.isHashUsed(rHash)) {
         throw SwapException(SwapFailureReason::PaymentHashReuse, "Payment hash reuse");
     }
 
@@ -1310,20 +1318,53 @@ std::string SwapManager::resolveSanitySwap(std::string rHash, u256 amount, std::
 
 void SwapManager::setTimeout(SwapManager::RHash rHash, int timeoutMs, SwapFailureReason reason)
 {
-    auto& timeoutData = _timeouts[rHash];
-    timeoutData.failReason = reason;
-    timeoutData.timerId = startTimer(timeoutMs);
+    clearTimeout(rHash);
+    auto deadline = _clock.elapsed() + timeoutMs;
+    _timeouts.emplace(rHash, SwapTimeout{ reason, deadline });
+    _deadlines.emplace(deadline, rHash);
+
+    if (!_timeoutTimer.isActive() || _deadlines.begin()->second == rHash) {
+        scheduleTimeoutTimer();
+    }
 }
 
 //==============================================================================
 
 void SwapManager::clearTimeout(SwapManager::RHash rHash)
 {
-    if (_timeouts.count(rHash) > 0) {
-        killTimer(_timeouts.at(rHash).timerId);
-        _timeouts.erase(rHash);
+    // timer stays armed, it is re-armed for next deadline once it fires
+    auto it = _timeouts.find(rHash);
+    if (it != _timeouts.end()) {
+        _deadlines.erase({ it->second.deadline, rHash });
+        _timeouts.erase(it);
     }
 }
 
+//==============================================================================
+
+void SwapManager::scheduleTimeoutTimer()
+{
+    if (_deadlines.empty()) {
+        _timeoutTimer.stop();
+    } else {
+        auto remaining = std::max<int64_t>(0, _deadlines.begin()->first - _clock.elapsed());
+        _timeoutTimer.start(static_cast<int>(remaining), this);
+    }
+}
+
+//==============================================================================
+
+boost::optional<SwapManager::SwapCompletion> SwapManager::takeCompletion(const RHash& rHash)
+{
+    auto it = _completions.find(rHash);
+    if (it == _completions.end()) {
+        return boost::none;
+    }
+
+    auto completion = std::move(it->second);
+    _completions.erase(it);
+    return completion;
+}
+
 //==============================================================================
 }
@@ -1,10 +1,14 @@
 #ifndef ABSTRACTSWAPSMANAGER_HPP
 #define ABSTRACTSWAPSMANAGER_HPP
 
+#include <QBasicTimer>
+#include <QElapsedTimer>
 #include <QObject>
 #include <Swaps/Packets.hpp>
 #include <Swaps/Types.hpp>
 #include <Utils/Utils.hpp>
+#include <functional>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -112,20 +116,33 @@ private:
     std::string resolveSanitySwap(std::string rHash, u256 amount, std::string currency);
     void setTimeout(RHash rHash, int timeoutMs, SwapFailureReason reason);
     void clearTimeout(RHash rHash);
+    void scheduleTimeoutTimer();
 
 private:
     struct SwapTimeout {
         SwapFailureReason failReason;
-        int timerId;
+        int64_t deadline;
     };
 
+    // resolves promise returned by executeSwap, only deal with matching rHash is notified.
+    struct SwapCompletion {
+        std::function<void(SwapSuccess)> onPaid;
+        std::function<void(const SwapDeal&)> onFailed;
+    };
+
+    boost::optional<SwapCompletion> takeCompletion(const RHash& rHash);
+
     const AbstractSwapPeerPool& _peers;
     AbstractSwapClientPool& _clients;
     AbstractSwapRepository& _repository;
     orderbook::AbstractOrderbookClient& _orderbook;
     std::unordered_map<RHash, SwapDeal> _deals;
-    std::unordered_set<RHash> _usedHashes;
+    std::unordered_set<RHash> _usedHashes; // hashes of this session, repository knows the rest
+    std::unordered_map<RHash, SwapCompletion> _completions;
     std::unordered_map<RHash, SwapTimeout> _timeouts;
+    std::set<std::pair<int64_t, RHash>> _deadlines; // earliest first
+    QBasicTimer _timeoutTimer; // armed for earliest deadline
+    QElapsedTimer _clock;
 };
 }
 
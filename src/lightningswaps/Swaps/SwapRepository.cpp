@@ -4,7 +4,34 @@
 
 namespace swaps {
 
+// active deals, 'd' -> rHash -> deal
 static const char DB_DEALS_INDEX{ 'd' };
+// finished deals, 'a' -> rHash -> createTime, 't' -> (createTime, rHash) -> deal
+static const char DB_ARCHIVE_HASH_INDEX{ 'a' };
+static const char DB_ARCHIVE_TIME_INDEX{ 't' };
+
+//==============================================================================
+
+struct DealTimeKey {
+    int64_t createTime{ 0 };
+    std::string rHash;
+
+    template <typename Stream> void Serialize(Stream& s) const
+    {
+        // big endian, so iteration order follows creation time
+        auto time = htobe64(static_cast<uint64_t>(createTime));
+        s.write(reinterpret_cast<const char*>(&time), sizeof(time));
+        s << rHash;
+    }
+
+    template <typename Stream> void Unserialize(Stream& s)
+    {
+        uint64_t time;
+        s.read(reinterpret_cast<char*>(&time), sizeof(time));
+        createTime = static_cast<int64_t>(be64toh(time));
+        s >> rHash;
+    }
+};
 
 //==============================================================================
 
@@ -13,6 +40,21 @@ struct SwapRepository::DBImpl : public bitcoin::CDBWrapper {
         : bitcoin::CDBWrapper(dataDir, nCacheSize, fMemory, fWipe)
     {
     }
+
+    void writeDeal(bitcoin::CDBBatch& batch, const SwapDeal& deal)
+    {
+        auto timeKey
+            = std::make_pair(DB_ARCHIVE_TIME_INDEX, DealTimeKey{ deal.createTime, deal.rHash });
+        if (deal.state == SwapState::Active) {
+            batch.Write(std::make_pair(DB_DEALS_INDEX, deal.rHash), deal);
+            batch.Erase(std::make_pair(DB_ARCHIVE_HASH_INDEX, deal.rHash));
+            batch.Erase(timeKey);
+        } else {
+            batch.Write(std::make_pair(DB_ARCHIVE_HASH_INDEX, deal.rHash), deal.createTime);
+            batch.Write(timeKey, deal);
+            batch.Erase(std::make_pair(DB_DEALS_INDEX, deal.rHash));
+        }
+    }
 };
 
 //==============================================================================
@@ -29,21 +71,26 @@ SwapRepository::~SwapRepository() {}
 
 //==============================================================================
 
-AbstractSwapRepository::Deals SwapRepository::executeLoadAll()
+AbstractSwapRepository::Deals SwapRepository::executeLoadActive()
 {
     using namespace bitcoin;
     Deals result;
+    CDBBatch archiveBatch(*_db);
     std::unique_ptr<CDBIterator> pcursor(_db->NewIterator());
     std::pair<char, std::string> key;
     pcursor->Seek(DB_DEALS_INDEX);
 
-    // Load mapBlockIndex
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         if (pcursor->GetKey(key) && key.first == DB_DEALS_INDEX) {
             SwapDeal deal;
             if (pcursor->GetValue(deal)) {
-                result.emplace_back(deal);
+                if (deal.state == SwapState::Active) {
+                    result.emplace_back(deal);
+                } else {
+                    // finished deals stored before archive existed are migrated once
+                    _db->writeDeal(archiveBatch, deal);
+                }
                 pcursor->Next();
             } else {
                 throw std::runtime_error("Failed to read swap repository value");
@@ -53,6 +100,30 @@ AbstractSwapRepository::Deals SwapRepository::executeLoadAll()
         }
     }
 
+    _db->WriteBatch(archiveBatch);
+    return result;
+}
+
+//==============================================================================
+
+std::vector<std::string> SwapRepository::executeLoadArchivedHashes()
+{
+    using namespace bitcoin;
+    std::vector<std::string> result;
+    std::unique_ptr<CDBIterator> pcursor(_db->NewIterator());
+    std::pair<char, std::string> key;
+    pcursor->Seek(DB_ARCHIVE_HASH_INDEX);
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        if (pcursor->GetKey(key) && key.first == DB_ARCHIVE_HASH_INDEX) {
+            result.emplace_back(std::move(key.second));
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
     return result;
 }
 
@@ -60,7 +131,69 @@ AbstractSwapRepository::Deals SwapRepository::executeLoadAll()
 
 void SwapRepository::executeSaveDeal(SwapDeal deal)
 {
-    _db->Write(std::make_pair(DB_DEALS_INDEX, deal.rHash), deal);
+    bitcoin::CDBBatch batch(*_db);
+    _db->writeDeal(batch, deal);
+    _db->WriteBatch(batch);
+}
+
+//==============================================================================
+
+boost::optional<SwapDeal> SwapRepository::executeLoadArchived(std::string rHash) const
+{
+    int64_t createTime;
+    SwapDeal deal;
+    if (_db->Read(std::make_pair(DB_ARCHIVE_HASH_INDEX, rHash), createTime)
+        && _db->Read(std::make_pair(DB_ARCHIVE_TIME_INDEX, DealTimeKey{ createTime, rHash }),
+            deal)) {
+        return deal;
+    }
+
+    return boost::none;
+}
+
+//==============================================================================
+
+AbstractSwapRepository::Deals SwapRepository::executeLoadArchived(
+    int64_t fromTime, int64_t toTime) const
+{
+    using namespace bitcoin;
+    Deals result;
+    std::unique_ptr<CDBIterator> pcursor(_db->NewIterator());
+    std::pair<char, DealTimeKey> key;
+    pcursor->Seek(std::make_pair(DB_ARCHIVE_TIME_INDEX, DealTimeKey{ fromTime, {} }));
+
+    while (pcursor->Valid()) {
+        if (pcursor->GetKey(key) && key.first == DB_ARCHIVE_TIME_INDEX
+            && key.second.createTime < toTime) {
+            SwapDeal deal;
+            if (pcursor->GetValue(deal)) {
+                result.emplace_back(deal);
+                pcursor->Next();
+            } else {
+                throw std::runtime_error("Failed to read swap repository value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return result;
+}
+
+//==============================================================================
+
+boost::optional<int64_t> SwapRepository::executeLoadOldestArchivedTime() const
+{
+    std::unique_ptr<bitcoin::CDBIterator> pcursor(_db->NewIterator());
+    std::pair<char, DealTimeKey> key;
+    pcursor->Seek(DB_ARCHIVE_TIME_INDEX);
+
+    // time index is ordered by creation time, first key is the oldest deal
+    if (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_ARCHIVE_TIME_INDEX) {
+        return key.second.createTime;
+    }
+
+    return boost::none;
 }
 
 //==============================================================================
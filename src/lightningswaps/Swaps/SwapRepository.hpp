@@ -114,8 +114,12 @@ public:
 
     // AbstractSwapRepository interface
 protected:
-    Deals executeLoadAll() override;
+    Deals executeLoadActive() override;
+    std::vector<std::string> executeLoadArchivedHashes() override;
     void executeSaveDeal(SwapDeal deal) override;
+    boost::optional<SwapDeal> executeLoadArchived(std::string rHash) const override;
+    Deals executeLoadArchived(int64_t fromTime, int64_t toTime) const override;
+    boost::optional<int64_t> executeLoadOldestArchivedTime() const override;
 
 private:
     struct DBImpl;
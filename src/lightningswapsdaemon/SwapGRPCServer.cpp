@@ -11,26 +11,9 @@ using namespace lssdrpc;
 
 //==============================================================================
 
-static int64_t ConvertBigInt(BigInteger bigInt)
-{
-    auto result = std::stoll(bigInt.value());
-    return result;
-}
-
-//==============================================================================
-
-static std::unique_ptr<BigInteger> ConvertToBigInt(int64_t value)
-{
-    std::unique_ptr<BigInteger> result(new BigInteger);
-    result->set_value(std::to_string(value));
-    return result;
-}
-
-//==============================================================================
-
-SwapGRPCServer::SwapGRPCServer(
-    ::swaps::SwapService& swapService, LssdSwapClientFactory& swapClientFactory, uint32_t port)
-    : qgrpc::BaseGrpcServer("0.0.0.0:" + std::to_string(port))
+SwapGRPCServer::SwapGRPCServer(::swaps::SwapService& swapService,
+    LssdSwapClientFactory& swapClientFactory, uint32_t port, size_t serverThreads)
+    : qgrpc::BaseGrpcServer("0.0.0.0:" + std::to_string(port), serverThreads)
     , _swapService(swapService)
     , _swapClientFactory(swapClientFactory)
     , _swapsServiceNotifications(swapService)
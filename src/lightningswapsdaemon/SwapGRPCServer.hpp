@@ -12,8 +12,8 @@ class LssdSwapClientFactory;
 
 class SwapGRPCServer : public qgrpc::BaseGrpcServer {
 public:
-    explicit SwapGRPCServer(
-        swaps::SwapService& swapService, LssdSwapClientFactory& swapClientFactory, uint32_t port);
+    explicit SwapGRPCServer(swaps::SwapService& swapService,
+        LssdSwapClientFactory& swapClientFactory, uint32_t port, size_t serverThreads = 1);
 
     void run();
 
@@ -2,6 +2,13 @@
 #include <Orderbook/OrderbookClient.hpp>
 #include <Orderbook/TradingOrdersModel.hpp>
 #include <Swaps/Types.hpp>
+#include <Utils/Logging.hpp>
+
+#include <cstdlib>
+
+//==============================================================================
+
+static const std::chrono::milliseconds STREAMS_STATS_INTERVAL = std::chrono::seconds(60);
 
 //==============================================================================
 
@@ -14,11 +21,69 @@ template <class From, class Event> static void SendEventToStream(const From& fro
 
 //==============================================================================
 
-static std::unique_ptr<lssdrpc::BigInteger> ConvertToBigInt(int64_t value)
+static int64_t SignedOrderFunds(const lssdrpc::OrderUpdate& update)
 {
-    std::unique_ptr<lssdrpc::BigInteger> result(new lssdrpc::BigInteger);
-    result->set_value(std::to_string(value));
-    return result;
+    if (update.has_orderadded()) {
+        return ConvertBigInt(update.orderadded().funds());
+    } else if (update.has_orderremoval()) {
+        return -ConvertBigInt(update.orderremoval().funds());
+    }
+
+    return 0;
+}
+
+//==============================================================================
+
+static std::string OrderUpdatePriceLevel(const lssdrpc::OrderUpdate& update)
+{
+    const auto& summary = update.has_orderadded() ? update.orderadded() : update.orderremoval();
+    return summary.pairid() + ":" + summary.price().value();
+}
+
+//==============================================================================
+
+// updates are deltas of a price level, queued and incoming ones are merged into net change
+static bool MergeOrderUpdates(lssdrpc::OrderUpdate& queued, const lssdrpc::OrderUpdate& incoming)
+{
+    int64_t net = 0;
+    try {
+        net = SignedOrderFunds(queued) + SignedOrderFunds(incoming);
+    } catch (std::exception& ex) {
+        LogCCritical(Swaps) << "Failed to merge order updates:" << ex.what();
+        queued = incoming;
+        return true;
+    }
+
+    // level is back where it was, there is nothing to send
+    if (net == 0) {
+        return false;
+    }
+
+    auto summary = queued.has_orderadded() ? queued.orderadded() : queued.orderremoval();
+    summary.set_allocated_funds(ConvertToBigInt(std::abs(net)).release());
+    if (net > 0) {
+        *queued.mutable_orderadded() = summary;
+    } else {
+        *queued.mutable_orderremoval() = summary;
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+template <class T>
+static void LogStreamsStats(
+    const char* name, const std::vector<SwapsServiceNotifications::StreamingChanPtr<T>>& streams)
+{
+    for (auto&& stream : streams) {
+        auto stats = stream->stats();
+        if (stats.queueDepth > 0 || stats.dropped > 0 || stats.coalesced > 0) {
+            LogCDebug(Swaps) << name << "stream" << stream.get() << "depth:" << stats.queueDepth
+                             << "max depth:" << stats.maxQueueDepth
+                             << "dropped:" << stats.dropped << "coalesced:" << stats.coalesced;
+        }
+    }
 }
 
 //==============================================================================
@@ -38,14 +103,19 @@ void removeDisconnectedSubscriptions(
 SwapsServiceNotifications::SwapsServiceNotifications(
     swaps::SwapService& swapService, QObject* parent)
     : QObject(parent)
+    , _statsTimer(new QTimer(this))
 {
     init(swapService);
+    connect(_statsTimer, &QTimer::timeout, this, &SwapsServiceNotifications::onLogStreamsStats);
+    _statsTimer->start(STREAMS_STATS_INTERVAL.count());
 }
 
 //==============================================================================
 
 void SwapsServiceNotifications::addSubscription(StreamingChanPtr<lssdrpc::SwapResult> swapSuccess)
 {
+    // swap results can't be merged and client can't recover lost one, they are never dropped
+    swapSuccess->setPolicy({ qgrpc::StreamingChannelPolicy::Overflow::Unbounded });
     _swapsSubscriptions.emplace_back(swapSuccess);
 }
 
@@ -53,6 +123,10 @@ void SwapsServiceNotifications::addSubscription(StreamingChanPtr<lssdrpc::SwapRe
 
 void SwapsServiceNotifications::addSubscription(StreamingChanPtr<lssdrpc::OrderUpdate> orderUpdate)
 {
+    // updates are deltas which client applies to its book, dropping one would desync it. Queue
+    // is only coalesced, it can't grow beyond number of price levels with pending changes.
+    orderUpdate->setPolicy({ qgrpc::StreamingChannelPolicy::Overflow::Coalesce },
+        &OrderUpdatePriceLevel, &MergeOrderUpdates);
     _ordersSubscriptions.emplace_back(orderUpdate);
 }
 
@@ -61,6 +135,8 @@ void SwapsServiceNotifications::addSubscription(StreamingChanPtr<lssdrpc::OrderU
 void SwapsServiceNotifications::addSubscription(
     StreamingChanPtr<lssdrpc::OwnOrderUpdate> ownOrderUpdate)
 {
+    // own order state is applied incrementally by client, every update has to be delivered
+    ownOrderUpdate->setPolicy({ qgrpc::StreamingChannelPolicy::Overflow::Unbounded });
     _ownOrdersSubscriptions.emplace_back(ownOrderUpdate);
 }
 
@@ -69,11 +145,24 @@ void SwapsServiceNotifications::addSubscription(
 void SwapsServiceNotifications::addSubscription(
     StreamingChanPtr<lssdrpc::OrderbookState> orderbookStateUpdate)
 {
+    // only latest state matters
+    orderbookStateUpdate->setPolicy({ qgrpc::StreamingChannelPolicy::Overflow::Coalesce, 1 },
+        [](const lssdrpc::OrderbookState&) { return std::string("state"); });
     _orderbookStateSubscriptions.emplace_back(orderbookStateUpdate);
 }
 
 //==============================================================================
 
+void SwapsServiceNotifications::onLogStreamsStats()
+{
+    LogStreamsStats("Swaps", _swapsSubscriptions);
+    LogStreamsStats("Orders", _ordersSubscriptions);
+    LogStreamsStats("Own orders", _ownOrdersSubscriptions);
+    LogStreamsStats("Orderbook state", _orderbookStateSubscriptions);
+}
+
+//==============================================================================
+
 void SwapsServiceNotifications::onSwapSuccessReceived(swaps::SwapSuccess success)
 {
     removeDisconnectedSubscriptions(_swapsSubscriptions);
@@ -217,6 +306,22 @@ void SwapsServiceNotifications::connectOwnOrders(orderbook::OrderbookClient* ord
 
 //==============================================================================
 
+int64_t ConvertBigInt(const lssdrpc::BigInteger& bigInt)
+{
+    return std::stoll(bigInt.value());
+}
+
+//==============================================================================
+
+std::unique_ptr<lssdrpc::BigInteger> ConvertToBigInt(int64_t value)
+{
+    std::unique_ptr<lssdrpc::BigInteger> result(new lssdrpc::BigInteger);
+    result->set_value(std::to_string(value));
+    return result;
+}
+
+//==============================================================================
+
 void FillOrderHelper(lssdrpc::Order& orderToFill, const orderbook::OwnOrder& order)
 {
     orderToFill.set_pairid(order.pairId);
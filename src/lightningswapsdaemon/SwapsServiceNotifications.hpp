@@ -6,7 +6,12 @@
 #include <Protos/lssdrpc.grpc.pb.h>
 #include <SwapService.hpp>
 
+#include <QTimer>
+
 void FillOrderHelper(lssdrpc::Order& orderToFill, const orderbook::OwnOrder& order);
+// throws std::invalid_argument or std::out_of_range when value isn't 64 bit integer
+int64_t ConvertBigInt(const lssdrpc::BigInteger& bigInt);
+std::unique_ptr<lssdrpc::BigInteger> ConvertToBigInt(int64_t value);
 
 namespace orderbook {
 class OrderbookClient;
@@ -27,6 +32,7 @@ public:
 private slots:
     void onSwapSuccessReceived(swaps::SwapSuccess swap);
     void onSwapFailureReceived(swaps::SwapFailure swap);
+    void onLogStreamsStats();
 
 private:
     void init(swaps::SwapService& swapService);
@@ -39,6 +45,7 @@ private:
     std::vector<StreamingChanPtr<lssdrpc::OrderUpdate>> _ordersSubscriptions;
     std::vector<StreamingChanPtr<lssdrpc::OwnOrderUpdate>> _ownOrdersSubscriptions;
     std::vector<StreamingChanPtr<lssdrpc::OrderbookState>> _orderbookStateSubscriptions;
+    QTimer* _statsTimer{ nullptr };
 };
 
 #endif // SWAPSSERVICENOTIFICATIONS_HPP
@@ -35,6 +35,7 @@ public:
     static const QCommandLineOption versionOpt;
     static const QCommandLineOption dataDirPath;
     static const QCommandLineOption orderbookAPISecretOpt;
+    static const QCommandLineOption serverThreadsOpt;
 
     LssdApplication(int& argc, char** argv)
         : QCoreApplication(argc, argv)
@@ -133,7 +134,8 @@ public:
         }
 
         parser.addHelpOption();
-        parser.addOptions({ portOpt, orderbookUrlOpt, versionOpt, orderbookAPISecretOpt, dataDirPath });
+        parser.addOptions({ portOpt, orderbookUrlOpt, versionOpt, orderbookAPISecretOpt,
+            dataDirPath, serverThreadsOpt });
 
         parser.process(args);
     }
@@ -172,6 +174,8 @@ const QCommandLineOption LssdApplication::orderbookUrlOpt(
 const QCommandLineOption LssdApplication::versionOpt({ "v", "version" }, "Show version");
 const QCommandLineOption LssdApplication::orderbookAPISecretOpt(
     "orderbookAPISecret", "Api secret that is obtained from Stakenet DEX", "secret");
+const QCommandLineOption LssdApplication::serverThreadsOpt(
+    "serverThreads", "Number of threads serving grpc calls", "threads");
 const QCommandLineOption LssdApplication::dataDirPath (
     "dataDirPath", "path to store all data", "data dir path");
 
@@ -216,7 +220,10 @@ int main(int argc, char* argv[])
 
     swaps::SwapService service(cfg);
     service.moveToThread(&swapServiceWorker);
-    SwapGRPCServer swapServer(service, *lndClientFactory, port.toInt());
+    size_t serverThreads = LssdApplication::IsArgSet(LssdApplication::serverThreadsOpt)
+        ? LssdApplication::GetArg(LssdApplication::serverThreadsOpt).toUInt()
+        : 1;
+    SwapGRPCServer swapServer(service, *lndClientFactory, port.toInt(), serverThreads);
 
     QMetaObject::invokeMethod(&service, [&service] {
         LogDebug() << "Swap service starting";
@@ -12,3 +12,7 @@ AbstractBlockExplorerHttpClient::AbstractBlockExplorerHttpClient(QObject* parent
 AbstractBlockExplorerHttpClient::~AbstractBlockExplorerHttpClient() {}
 
 //==============================================================================
+
+void AbstractBlockExplorerHttpClient::subscribeTips() {}
+
+//==============================================================================
@@ -24,6 +24,8 @@ public:
         = 0;
     virtual Promise<QByteArray> getTransaction(QString transactionHash) = 0;
     virtual Promise<QByteArray> getRawTransaction(QString transactionHash) = 0;
+    // Raw transactions of whole block in one response: {"data": [{"id": ..., "hex": ...}]}.
+    virtual Promise<QByteArray> getBlockRawTransactions(QString blockHash) = 0;
     virtual Promise<QByteArray> getRawTxByIndex(int64_t blockNum, uint32_t txIndex) = 0;
     virtual Promise<QString> sendTransaction(QString hexEncodedTx) = 0;
     virtual Promise<double> estimateSmartFee(unsigned blocksTarget) = 0;
@@ -31,6 +33,13 @@ public:
     virtual Promise<QByteArray> getBlockFilter(QString blockHash) = 0;
     virtual Promise<QByteArray> getTxOut(QString txid, unsigned int outputIndex) = 0;
     virtual Promise<QByteArray> getSpendingTx(QString txHash, unsigned int outputIndex) = 0;
+
+    // Starts receiving pushed tips, clients which don't support it never emit tipReceived.
+    virtual void subscribeTips();
+
+signals:
+    void tipReceived(QString hash, unsigned height);
+    void tipStreamStateChanged(bool connected);
 };
 
 #endif // ABSTRACTBLOCKEXPLORERHTTPCLIENT_HPP
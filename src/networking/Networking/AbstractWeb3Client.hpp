@@ -32,6 +32,9 @@ public:
 
 signals:
     void connected();
+    void disconnected();
+    // delivered for "newHeads" subscription
+    void newBlockHeader(QVariantMap header);
 };
 
 #endif // ABSTRACTWEB3CLIENT_HPP
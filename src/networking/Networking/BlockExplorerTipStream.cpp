@@ -0,0 +1,153 @@
+#include "BlockExplorerTipStream.hpp"
+#include <Utils/Logging.hpp>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <algorithm>
+
+//==============================================================================
+
+static const int RECONNECT_INTERVAL_MS = 5000;
+static const int MAX_RECONNECT_INTERVAL_MS = 5 * 60 * 1000;
+
+//==============================================================================
+
+BlockExplorerTipStream::BlockExplorerTipStream(QUrl url, QObject* parent)
+    : QObject(parent)
+    , _url(url)
+    , _reconnectInterval(RECONNECT_INTERVAL_MS)
+{
+}
+
+//==============================================================================
+
+BlockExplorerTipStream::~BlockExplorerTipStream()
+{
+    close();
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::open()
+{
+    init();
+    _closed = false;
+    _autoConnectTimer->start(0);
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::close()
+{
+    _closed = true;
+    if (_socket) {
+        _autoConnectTimer->stop();
+        _socket->close();
+    }
+}
+
+//==============================================================================
+
+bool BlockExplorerTipStream::isConnected() const
+{
+    return _socket && _socket->state() == QAbstractSocket::ConnectedState;
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::onTryAutoConnect()
+{
+    _handshakeSent = false;
+    _socket->open(_url);
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::onConnected()
+{
+    LogCDebug(Api) << "Tip stream connected" << _url;
+    _autoConnectTimer->stop();
+    _reconnectInterval = RECONNECT_INTERVAL_MS;
+    connectedChanged(true);
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::onDisconnected()
+{
+    LogCDebug(Api) << "Tip stream disconnected" << _url << _socket->closeCode()
+                   << _socket->closeReason();
+    maybeStartReconnecting();
+    connectedChanged(false);
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::onMessageReceived(QString message)
+{
+    auto obj = QJsonDocument::fromJson(message.toUtf8()).object();
+    auto hash = obj.value("hash").toString();
+    if (hash.isEmpty() || !obj.contains("height")) {
+        LogCDebug(Api) << "Skipping malformed tip message" << message;
+        return;
+    }
+
+    tipReceived(hash, static_cast<unsigned>(obj.value("height").toInt()));
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::onError(QAbstractSocket::SocketError error)
+{
+    // handshake which got anything but upgrade response is reported as refused connection, same
+    // as refused tcp connection. Only explorer that answered the handshake is given up.
+    if (error == QAbstractSocket::ConnectionRefusedError && _handshakeSent) {
+        LogCWarning(Api) << "Tip stream is not served by explorer" << _url
+                         << _socket->errorString();
+        _closed = true;
+        _autoConnectTimer->stop();
+        return;
+    }
+
+    maybeStartReconnecting();
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::init()
+{
+    if (_socket) {
+        return;
+    }
+
+    _socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    connect(_socket, &QWebSocket::connected, this, &BlockExplorerTipStream::onConnected);
+    connect(_socket, &QWebSocket::disconnected, this, &BlockExplorerTipStream::onDisconnected);
+    connect(_socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), this,
+        &BlockExplorerTipStream::onError);
+    connect(
+        _socket, &QWebSocket::textMessageReceived, this, &BlockExplorerTipStream::onMessageReceived);
+    // handshake request is the only thing written before socket is connected
+    connect(_socket, &QWebSocket::bytesWritten, this, [this] {
+        if (!isConnected()) {
+            _handshakeSent = true;
+        }
+    });
+
+    _autoConnectTimer = new QTimer(this);
+    _autoConnectTimer->setSingleShot(true);
+    connect(_autoConnectTimer, &QTimer::timeout, this, &BlockExplorerTipStream::onTryAutoConnect);
+}
+
+//==============================================================================
+
+void BlockExplorerTipStream::maybeStartReconnecting()
+{
+    if (!_closed && !_autoConnectTimer->isActive()) {
+        _autoConnectTimer->start(_reconnectInterval);
+        _reconnectInterval = std::min(_reconnectInterval * 2, MAX_RECONNECT_INTERVAL_MS);
+    }
+}
+
+//==============================================================================
@@ -0,0 +1,53 @@
+#ifndef BLOCKEXPLORERTIPSTREAM_HPP
+#define BLOCKEXPLORERTIPSTREAM_HPP
+
+#include <QObject>
+#include <QPointer>
+#include <QUrl>
+#include <QWebSocket>
+
+class QTimer;
+
+/*!
+ * \brief The BlockExplorerTipStream class keeps web socket connection to block explorer which
+ * pushes every new best block as json text message {"hash": "...", "height": 123}.
+ * Connection is re-established automatically with growing interval until close() is called,
+ * explorer which answers web socket handshake without upgrade doesn't serve the stream and isn't
+ * retried.
+ */
+class BlockExplorerTipStream : public QObject {
+    Q_OBJECT
+public:
+    explicit BlockExplorerTipStream(QUrl url, QObject* parent = nullptr);
+    ~BlockExplorerTipStream();
+
+    void open();
+    void close();
+
+    bool isConnected() const;
+
+signals:
+    void tipReceived(QString hash, unsigned height);
+    void connectedChanged(bool connected);
+
+private slots:
+    void onTryAutoConnect();
+    void onConnected();
+    void onDisconnected();
+    void onMessageReceived(QString message);
+    void onError(QAbstractSocket::SocketError error);
+
+private:
+    void init();
+    void maybeStartReconnecting();
+
+private:
+    QPointer<QTimer> _autoConnectTimer;
+    QPointer<QWebSocket> _socket;
+    QUrl _url;
+    bool _closed{ false };
+    bool _handshakeSent{ false };
+    int _reconnectInterval{ 0 };
+};
+
+#endif // BLOCKEXPLORERTIPSTREAM_HPP
@@ -204,3 +204,13 @@ QNetworkAccessManager* RequestHandlerImpl::networkAccessManager() const
 }
 
 //==============================================================================
+
+QUrl RequestHandlerImpl::webSocketUrl(const QString& path) const
+{
+    auto useProxy = QNetworkProxy::applicationProxy() != QNetworkProxy::NoProxy;
+    QUrl url(QString("%1%2").arg(useProxy ? _domains.tor : _domains.normal).arg(path));
+    url.setScheme(url.scheme() == "http" ? "ws" : "wss");
+    return url;
+}
+
+//==============================================================================
@@ -41,6 +41,8 @@ public:
         override;
 
     QNetworkAccessManager* networkAccessManager() const;
+    // url of web socket endpoint on the same domain which requests currently go to
+    QUrl webSocketUrl(const QString& path) const;
 
 private slots:
     void processResponse(
@@ -1,21 +1,31 @@
 #include "Web3Client.hpp"
 
-#include <Utils/Logging.hpp>
+#include <QTimer>
 
-using namespace jcon;
+//==============================================================================
+
+static const int RECONNECT_INTERVAL_MS = 5000;
 
 //==============================================================================
 
 Web3Client::Web3Client(QUrl host, QObject* parent)
     : AbstractWeb3Client(parent)
     , _host(host)
-    , _client(new JsonRpcWebSocketClient(this, nullptr, 20000))
 {
     init();
 }
 
 //==============================================================================
 
+Web3Client::~Web3Client()
+{
+    // socket is destroyed after us as a child, it must not call back into half destroyed client
+    _closed = true;
+    _socket->disconnect(this);
+}
+
+//==============================================================================
+
 void Web3Client::open()
 {
     _autoConnectTimer->start(0);
@@ -25,74 +35,61 @@ void Web3Client::open()
 
 auto Web3Client::getBalance(QString address) -> Promise<eth::u256>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(
-            this, [=] { callAsync(resolve, reject, "eth_getBalance", address, "latest"); });
-    })
-        .then([](QVariant result) { return eth::u256{ result.toString().toStdString() }; });
+    return callAsync("eth_getBalance", { address, "latest" }).then([](QVariant result) {
+        return eth::u256{ result.toString().toStdString() };
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::getBlockNumber() -> Promise<eth::u64>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(this, [=] { callAsync(resolve, reject, "eth_blockNumber"); });
-    })
-        .then([](QVariant result) { return eth::u64{ result.toString().toStdString() }; });
+    return callAsync("eth_blockNumber").then([](QVariant result) {
+        return eth::u64{ result.toString().toStdString() };
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::getBlockByNumber(QString blockNumber) -> Promise<QVariantMap>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(
-            this, [=] { callAsync(resolve, reject, "eth_getBlockByNumber", blockNumber, false); });
-    })
-        .then([](QVariant result) { return result.toMap(); });
+    return callAsync("eth_getBlockByNumber", { blockNumber, false }).then([](QVariant result) {
+        return result.toMap();
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::call(QVariantMap params) -> Promise<QString>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(
-            this, [=] { callAsync(resolve, reject, "eth_call", params, "latest"); });
-    })
-        .then([](QVariant result) { return result.toString(); });
+    return callAsync("eth_call", { params, "latest" }).then([](QVariant result) {
+        return result.toString();
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::getChainId() -> Promise<eth::u256>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(this, [=] { callAsync(resolve, reject, "eth_chainId"); });
-    })
-        .then([](QVariant result) { return eth::u256{ result.toString().toStdString() }; });
+    return callAsync("eth_chainId").then([](QVariant result) {
+        return eth::u256{ result.toString().toStdString() };
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::estimateGas(QVariantMap params) -> Promise<eth::u64>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(
-            this, [=] { callAsync(resolve, reject, "eth_estimateGas", params); });
-    })
-        .then([](QVariant result) { return eth::u64{ result.toString().toStdString() }; });
+    return callAsync("eth_estimateGas", { params }).then([](QVariant result) {
+        return eth::u64{ result.toString().toStdString() };
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::getTransactionCount(QString addressTo) -> Promise<eth::u64>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(this,
-            [=] { callAsync(resolve, reject, "eth_getTransactionCount", addressTo, "latest"); });
-    })
+    return callAsync("eth_getTransactionCount", { addressTo, "latest" })
         .then([](QVariant result) { return eth::u64{ result.toString().toStdString() }; });
 }
 
@@ -100,51 +97,50 @@ auto Web3Client::getTransactionCount(QString addressTo) -> Promise<eth::u64>
 
 auto Web3Client::getTransactionByHash(QString txHash) -> Promise<QVariantMap>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(
-            this, [=] { callAsync(resolve, reject, "eth_getTransactionByHash", txHash); });
-    })
-        .then([](QVariant result) { return result.toMap(); });
+    return callAsync("eth_getTransactionByHash", { txHash }).then([](QVariant result) {
+        return result.toMap();
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::getTransactionReceipt(QString txHash) -> Promise<QVariantMap>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(
-            this, [=] { callAsync(resolve, reject, "eth_getTransactionReceipt", txHash); });
-    })
-        .then([](QVariant result) { return result.toMap(); });
+    return callAsync("eth_getTransactionReceipt", { txHash }).then([](QVariant result) {
+        return result.toMap();
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::sendRawTransaction(QString serializedTxHex) -> Promise<QString>
 {
-    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(
-            this, [=] { callAsync(resolve, reject, "eth_sendRawTransaction", serializedTxHex); });
-    })
-        .then([](QVariant result) {
-            qDebug() << "callAsync sendRawTransaction";
-            return result.toString();
-        });
+    return callAsync("eth_sendRawTransaction", { serializedTxHex }).then([](QVariant result) {
+        return result.toString();
+    });
 }
 
 //==============================================================================
 
 auto Web3Client::subscribe(QString eventType) -> Promise<void>
 {
-    //    _client->notification("eth_subscribe",
-    //    eventType);
     return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
-        QMetaObject::invokeMethod(
-            this, [=] { callAsync(resolve, reject, "eth_subscribe", eventType); });
+        QMetaObject::invokeMethod(this, [=] {
+            _eventTypes.insert(eventType);
+            requestSubscription(eventType, [resolve](QVariant id) { resolve(id); },
+                [reject](int code, QString message) {
+                    reject(NetworkUtils::ApiErrorException{ code, message });
+                });
+        });
     })
-        .then([](QVariant result) { qDebug() << "callAsync subscribe"; });
+        .then([](QVariant) {});
+}
 
-    //    QtPromise::resolve();
+//==============================================================================
+
+Web3RequestScheduler::Stats Web3Client::schedulerStats() const
+{
+    return _scheduler->stats();
 }
 
 //==============================================================================
@@ -152,7 +148,7 @@ auto Web3Client::subscribe(QString eventType) -> Promise<void>
 void Web3Client::onTryAutoConnect()
 {
     LogCDebug(Web3) << "Connecting to web3 host";
-    _client->connectToServer(_host);
+    _socket->open(_host);
 }
 
 //==============================================================================
@@ -161,6 +157,14 @@ void Web3Client::onConnected()
 {
     LogCDebug(Web3) << "Web3 client connected";
     _autoConnectTimer->stop();
+    _scheduler->setConnected(true);
+
+    // subscriptions don't survive reconnect, node assigns new ids
+    _subscriptions.clear();
+    for (auto&& eventType : _eventTypes) {
+        requestSubscription(eventType, [](QVariant) {}, [](int, QString) {});
+    }
+
     connected();
 }
 
@@ -169,7 +173,9 @@ void Web3Client::onConnected()
 void Web3Client::onDisconnected()
 {
     LogCDebug(Web3) << "Web3 client disconnected";
+    _scheduler->setConnected(false);
     maybeStartReconnecting();
+    disconnected();
 }
 
 //==============================================================================
@@ -182,28 +188,45 @@ void Web3Client::onConnectionError(QAbstractSocket::SocketError error)
 
 //==============================================================================
 
+void Web3Client::onNotificationReceived(QString method, QVariant params)
+{
+    if (method != "eth_subscription") {
+        LogCDebug(Web3) << "notificationReceived" << method << params;
+        return;
+    }
+
+    auto obj = params.toMap();
+    auto it = _subscriptions.find(obj.value("subscription").toString());
+    if (it != _subscriptions.end() && it->second == "newHeads") {
+        newBlockHeader(obj.value("result").toMap());
+    }
+}
+
+//==============================================================================
+
 void Web3Client::init()
 {
     qRegisterMetaType<QAbstractSocket::SocketState>("QAbstractSocket::SocketState");
     LogCDebug(Web3) << "Creating web3 "
                        "connection to host:"
                     << _host;
-    connect(_client, &JsonRpcWebSocketClient::socketConnected, this, &Web3Client::onConnected);
-    connect(
-        _client, &JsonRpcWebSocketClient::socketDisconnected, this, &Web3Client::onDisconnected);
-    connect(_client, &JsonRpcWebSocketClient::socketError, this,
-        std::bind(&Web3Client::onConnectionError, this, std::placeholders::_2));
+
+    _socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    connect(_socket, &QWebSocket::connected, this, &Web3Client::onConnected);
+    connect(_socket, &QWebSocket::disconnected, this, &Web3Client::onDisconnected);
+    connect(_socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), this,
+        &Web3Client::onConnectionError);
+
+    _scheduler = new Web3RequestScheduler(
+        [this](QString message) { _socket->sendTextMessage(message); }, this);
+    connect(_socket, &QWebSocket::textMessageReceived, _scheduler,
+        &Web3RequestScheduler::processMessage);
+    connect(_scheduler, &Web3RequestScheduler::notificationReceived, this,
+        &Web3Client::onNotificationReceived);
 
     _autoConnectTimer = new QTimer(this);
     _autoConnectTimer->setSingleShot(true);
     connect(_autoConnectTimer, &QTimer::timeout, this, &Web3Client::onTryAutoConnect);
-
-    _client->enableReceiveNotification(true);
-
-    connect(_client, &JsonRpcWebSocketClient::notificationReceived, this,
-        [](const QString key, const QVariant value) {
-            qDebug() << "notificationReceived" << key << value;
-        });
 }
 
 //==============================================================================
@@ -211,8 +234,35 @@ void Web3Client::init()
 void Web3Client::maybeStartReconnecting()
 {
     if (!_closed) {
-        _autoConnectTimer->start(5000);
+        _autoConnectTimer->start(RECONNECT_INTERVAL_MS);
     }
 }
 
 //==============================================================================
+
+auto Web3Client::callAsync(QString method, QVariantList params) -> Promise<QVariant>
+{
+    return Promise<QVariant>([=](const auto& resolve, const auto& reject) {
+        QMetaObject::invokeMethod(this, [=] {
+            _scheduler->call(method, params, [resolve](QVariant result) { resolve(result); },
+                [reject](int code, QString message) {
+                    reject(NetworkUtils::ApiErrorException{ code, message });
+                });
+        });
+    });
+}
+
+//==============================================================================
+
+void Web3Client::requestSubscription(QString eventType, Web3RequestScheduler::OnResult onResult,
+    Web3RequestScheduler::OnError onError)
+{
+    _scheduler->call("eth_subscribe", { eventType },
+        [this, eventType, onResult](QVariant id) {
+            _subscriptions[id.toString()] = eventType;
+            onResult(id);
+        },
+        onError);
+}
+
+//==============================================================================
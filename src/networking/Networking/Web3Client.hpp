@@ -3,11 +3,14 @@
 
 #include <Networking/AbstractWeb3Client.hpp>
 #include <Networking/NetworkingUtils.hpp>
+#include <Networking/Web3RequestScheduler.hpp>
 #include <QObject>
 #include <QPointer>
 #include <QUrl>
+#include <QWebSocket>
 #include <Utils/Logging.hpp>
-#include <json_rpc_websocket_client.h>
+#include <set>
+#include <unordered_map>
 
 class QTimer;
 
@@ -15,6 +18,7 @@ class Web3Client : public AbstractWeb3Client {
     Q_OBJECT
 public:
     explicit Web3Client(QUrl host, QObject* parent = nullptr);
+    ~Web3Client() override;
 
     void open() override;
 
@@ -30,37 +34,32 @@ public:
 
     Promise<QString> sendRawTransaction(QString serializedTxHex) override;
 
-    // TODO: subscribe is broken, need to make changes in lib for proper using
+    // subscription is renewed every time connection is re-established
     Promise<void> subscribe(QString eventType) override;
 
+    Web3RequestScheduler::Stats schedulerStats() const;
+
 private slots:
     void onTryAutoConnect();
     void onConnected();
     void onDisconnected();
     void onConnectionError(QAbstractSocket::SocketError error);
+    void onNotificationReceived(QString method, QVariant params);
 
 private:
     void init();
     void maybeStartReconnecting();
-
-    template <typename... T>
-    void callAsync(QtPromise::QPromiseResolve<QVariant> resolve,
-        QtPromise::QPromiseReject<QVariant> reject, const QString& method, T&&... args)
-    {
-        auto call = _client->callAsync(method, std::forward<T>(args)...);
-        connect(call.get(), &jcon::JsonRpcRequest::error, call.get(),
-            [reject](int code, const QString& message, const QVariant& data) {
-                LogCCritical(Web3) << "Web3 call failed: " << code << message << data;
-                reject(NetworkUtils::ApiErrorException{ code, message });
-            });
-        connect(call.get(), &jcon::JsonRpcRequest::result, call.get(),
-            [resolve](QVariant res) { resolve(res); });
-    }
+    Promise<QVariant> callAsync(QString method, QVariantList params = {});
+    void requestSubscription(QString eventType, Web3RequestScheduler::OnResult onResult,
+        Web3RequestScheduler::OnError onError);
 
 private:
     QUrl _host;
-    QPointer<jcon::JsonRpcWebSocketClient> _client;
+    QPointer<QWebSocket> _socket;
     QPointer<QTimer> _autoConnectTimer;
+    Web3RequestScheduler* _scheduler{ nullptr };
+    std::set<QString> _eventTypes;
+    std::unordered_map<QString, QString> _subscriptions; // subscription id -> event type
     bool _closed{ false };
 };
 
@@ -0,0 +1,237 @@
+#include "Web3RequestScheduler.hpp"
+#include <Utils/Logging.hpp>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <algorithm>
+
+//==============================================================================
+
+static const int REQUEST_TIMEOUT_MS = 20000;
+static const int MAX_BATCH_SIZE = 100;
+static const int TIMEOUT_ERROR_CODE = -32000;
+
+//==============================================================================
+
+static QJsonObject MakeRequest(int64_t id, const QString& method, const QVariantList& params)
+{
+    QJsonObject request;
+    request["jsonrpc"] = "2.0";
+    request["id"] = static_cast<qint64>(id);
+    request["method"] = method;
+    request["params"] = QJsonArray::fromVariantList(params);
+    return request;
+}
+
+//==============================================================================
+
+Web3RequestScheduler::Web3RequestScheduler(Sender sender, QObject* parent)
+    : QObject(parent)
+    , _sender(sender)
+{
+    _flushTimer = new QTimer(this);
+    _flushTimer->setSingleShot(true);
+    _flushTimer->setInterval(0);
+    connect(_flushTimer, &QTimer::timeout, this, &Web3RequestScheduler::flush);
+
+    _timeoutTimer = new QTimer(this);
+    _timeoutTimer->setSingleShot(true);
+    connect(_timeoutTimer, &QTimer::timeout, this, [this] {
+        failRequests([](const auto& request) { return request.deadline.hasExpired(); },
+            TIMEOUT_ERROR_CODE, "Request timed out");
+    });
+}
+
+//==============================================================================
+
+void Web3RequestScheduler::call(
+    QString method, QVariantList params, OnResult onResult, OnError onError)
+{
+    ++_stats.calls;
+    auto key = method
+        + QJsonDocument(QJsonArray::fromVariantList(params)).toJson(QJsonDocument::Compact);
+
+    auto it = _idsByKey.find(key);
+    if (it != _idsByKey.end()) {
+        ++_stats.merged;
+        _requests.at(it->second).waiters.push_back({ onResult, onError });
+        return;
+    }
+
+    auto id = _nextId++;
+    Request request;
+    request.key = key;
+    request.method = method;
+    request.params = params;
+    request.waiters.push_back({ onResult, onError });
+    request.deadline = QDeadlineTimer(REQUEST_TIMEOUT_MS);
+    _requests.emplace(id, std::move(request));
+    _idsByKey.emplace(key, id);
+    _queue.push_back(id);
+    scheduleFlush();
+    if (!_timeoutTimer->isActive()) {
+        scheduleTimeout();
+    }
+}
+
+//==============================================================================
+
+void Web3RequestScheduler::setConnected(bool connected)
+{
+    _connected = connected;
+    if (connected) {
+        scheduleFlush();
+    } else {
+        failRequests([](const auto& request) { return request.sent; }, TIMEOUT_ERROR_CODE,
+            "Connection lost");
+    }
+}
+
+//==============================================================================
+
+void Web3RequestScheduler::processMessage(const QString& message)
+{
+    auto document = QJsonDocument::fromJson(message.toUtf8());
+    if (document.isArray()) {
+        for (auto&& response : document.array()) {
+            processResponse(response.toObject());
+        }
+    } else if (document.isObject()) {
+        processResponse(document.object());
+    } else {
+        LogCDebug(Web3) << "Skipping malformed web3 message" << message;
+    }
+}
+
+//==============================================================================
+
+Web3RequestScheduler::Stats Web3RequestScheduler::stats() const
+{
+    return _stats;
+}
+
+//==============================================================================
+
+void Web3RequestScheduler::scheduleFlush()
+{
+    if (_connected && !_queue.empty() && !_flushTimer->isActive()) {
+        _flushTimer->start();
+    }
+}
+
+//==============================================================================
+
+void Web3RequestScheduler::flush()
+{
+    if (!_connected) {
+        return;
+    }
+
+    for (size_t first = 0; first < _queue.size(); first += MAX_BATCH_SIZE) {
+        auto last = std::min(_queue.size(), first + MAX_BATCH_SIZE);
+        QJsonArray batch;
+        for (auto i = first; i < last; ++i) {
+            auto& request = _requests.at(_queue[i]);
+            request.sent = true;
+            batch.append(MakeRequest(_queue[i], request.method, request.params));
+        }
+
+        _stats.requests += batch.size();
+        ++_stats.roundTrips;
+        // single call is sent as plain request object, batch of one is pointless
+        auto document = batch.size() == 1 ? QJsonDocument(batch.first().toObject())
+                                          : QJsonDocument(batch);
+        _sender(QString::fromUtf8(document.toJson(QJsonDocument::Compact)));
+    }
+
+    _queue.clear();
+}
+
+//==============================================================================
+
+void Web3RequestScheduler::processResponse(const QJsonObject& response)
+{
+    if (!response.contains("id") && response.contains("method")) {
+        notificationReceived(
+            response.value("method").toString(), response.value("params").toVariant());
+        return;
+    }
+
+    auto it = _requests.find(response.value("id").toVariant().toLongLong());
+    if (it == _requests.end() || !it->second.sent) {
+        LogCDebug(Web3) << "Skipping web3 response for unknown request" << response;
+        return;
+    }
+
+    auto request = std::move(it->second);
+    _requests.erase(it);
+    _idsByKey.erase(request.key);
+
+    if (response.contains("error")) {
+        auto error = response.value("error").toObject();
+        auto code = error.value("code").toInt();
+        auto message = error.value("message").toString();
+        LogCCritical(Web3) << "Web3 call failed: " << request.method << code << message
+                           << error.value("data").toVariant();
+        for (auto&& waiter : request.waiters) {
+            waiter.onError(code, message);
+        }
+    } else {
+        auto result = response.value("result").toVariant();
+        for (auto&& waiter : request.waiters) {
+            waiter.onResult(result);
+        }
+    }
+}
+
+//==============================================================================
+
+void Web3RequestScheduler::failRequests(
+    std::function<bool(const Request&)> predicate, int code, QString message)
+{
+    std::vector<Request> failed;
+    for (auto it = _requests.begin(); it != _requests.end();) {
+        if (predicate(it->second)) {
+            _idsByKey.erase(it->second.key);
+            failed.emplace_back(std::move(it->second));
+            it = _requests.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    _queue.erase(std::remove_if(std::begin(_queue), std::end(_queue),
+                     [this](auto id) { return _requests.count(id) == 0; }),
+        std::end(_queue));
+    scheduleTimeout();
+
+    // waiters can issue new calls, state has to be consistent before they are notified
+    for (auto&& request : failed) {
+        LogCCritical(Web3) << "Web3 call failed: " << request.method << code << message;
+        for (auto&& waiter : request.waiters) {
+            waiter.onError(code, message);
+        }
+    }
+}
+
+//==============================================================================
+
+void Web3RequestScheduler::scheduleTimeout()
+{
+    if (_requests.empty()) {
+        _timeoutTimer->stop();
+        return;
+    }
+
+    // every request has own deadline, other traffic (e.g. subscription pushes) doesn't extend it.
+    // Timer fires for the earliest one, requests answered meanwhile are skipped when it fires.
+    auto earliest = std::min_element(std::begin(_requests), std::end(_requests),
+        [](const auto& lhs, const auto& rhs) {
+            return lhs.second.deadline.deadline() < rhs.second.deadline.deadline();
+        });
+    _timeoutTimer->start(static_cast<int>(earliest->second.deadline.remainingTime()));
+}
+
+//==============================================================================
@@ -0,0 +1,79 @@
+#ifndef WEB3REQUESTSCHEDULER_HPP
+#define WEB3REQUESTSCHEDULER_HPP
+
+#include <QDeadlineTimer>
+#include <QObject>
+#include <QVariant>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class QJsonObject;
+class QTimer;
+
+/*!
+ * \brief The Web3RequestScheduler class multiplexes JSON-RPC 2.0 calls over one connection. Calls
+ * issued during one event loop iteration are sent together as one batch array, identical calls
+ * which are queued or still in flight share one request and its response.
+ */
+class Web3RequestScheduler : public QObject {
+    Q_OBJECT
+public:
+    using Sender = std::function<void(QString)>;
+    using OnResult = std::function<void(QVariant)>;
+    using OnError = std::function<void(int, QString)>;
+
+    struct Stats {
+        uint64_t calls{ 0 };
+        uint64_t merged{ 0 }; // calls served by identical queued or in flight request
+        uint64_t requests{ 0 };
+        uint64_t roundTrips{ 0 }; // messages sent, one per single request or batch
+    };
+
+    explicit Web3RequestScheduler(Sender sender, QObject* parent = nullptr);
+
+    void call(QString method, QVariantList params, OnResult onResult, OnError onError);
+    // queued calls are sent once connected, calls in flight fail when connection is lost. Every
+    // call which gets no response in time fails as well, whether it was sent or not.
+    void setConnected(bool connected);
+    void processMessage(const QString& message);
+
+    Stats stats() const;
+
+signals:
+    void notificationReceived(QString method, QVariant params);
+
+private:
+    struct Waiter {
+        OnResult onResult;
+        OnError onError;
+    };
+
+    struct Request {
+        QString key;
+        QString method;
+        QVariantList params;
+        std::vector<Waiter> waiters;
+        QDeadlineTimer deadline;
+        bool sent{ false };
+    };
+
+    void scheduleFlush();
+    void flush();
+    void processResponse(const QJsonObject& response);
+    void failRequests(std::function<bool(const Request&)> predicate, int code, QString message);
+    void scheduleTimeout();
+
+private:
+    Sender _sender;
+    QTimer* _flushTimer{ nullptr };
+    QTimer* _timeoutTimer{ nullptr };
+    bool _connected{ false };
+    int64_t _nextId{ 1 };
+    std::unordered_map<int64_t, Request> _requests; // queued and in flight
+    std::unordered_map<QString, int64_t> _idsByKey;
+    std::vector<int64_t> _queue;
+    Stats _stats;
+};
+
+#endif // WEB3REQUESTSCHEDULER_HPP
@@ -1,4 +1,5 @@
 #include "XSNBlockExplorerHttpClient.hpp"
+#include <Networking/BlockExplorerTipStream.hpp>
 #include <Networking/NetworkingUtils.hpp>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -27,8 +28,9 @@ void MakeRequest(
 //==============================================================================
 
 XSNBlockExplorerHttpClient::XSNBlockExplorerHttpClient(
-    std::unique_ptr<RequestHandlerImpl>&& requestHandler, QObject* parent)
+    std::unique_ptr<RequestHandlerImpl>&& requestHandler, bool withTipStream, QObject* parent)
     : AbstractBlockExplorerHttpClient(parent)
+    , _withTipStream(withTipStream)
 {
     requestHandler->setParent(this);
     _requestHandler = requestHandler.release();
@@ -36,6 +38,22 @@ XSNBlockExplorerHttpClient::XSNBlockExplorerHttpClient(
 
 //==============================================================================
 
+void XSNBlockExplorerHttpClient::subscribeTips()
+{
+    if (_tipStream || !_withTipStream) {
+        return;
+    }
+
+    _tipStream = new BlockExplorerTipStream(_requestHandler->webSocketUrl("/ws"), this);
+    connect(_tipStream, &BlockExplorerTipStream::tipReceived, this,
+        &XSNBlockExplorerHttpClient::tipReceived);
+    connect(_tipStream, &BlockExplorerTipStream::connectedChanged, this,
+        &XSNBlockExplorerHttpClient::tipStreamStateChanged);
+    _tipStream->open();
+}
+
+//==============================================================================
+
 auto XSNBlockExplorerHttpClient::getTransactionsForAddress(
     QString address, size_t limit, QString order, QString lastSeenTxid) -> Promise<QByteArray>
 {
@@ -287,6 +305,25 @@ auto XSNBlockExplorerHttpClient::getRawTransaction(QString transactionHash) -> P
 
 //==============================================================================
 
+auto XSNBlockExplorerHttpClient::getBlockRawTransactions(QString blockHash)
+    -> Promise<QByteArray>
+{
+    return Promise<QByteArray>([=](const auto& resolve, const auto& reject) {
+        QMetaObject::invokeMethod(this, [=] {
+            auto errorHandler = [=](int errorCode, const QString& errorResponse) {
+                reject(NetworkUtils::ApiErrorException{ errorCode, errorResponse });
+            };
+
+            auto responseHandler = [=](const QByteArray& response) { resolve(response); };
+
+            const QString url = QString("/v2/blocks/%1/raw-transactions").arg(blockHash);
+            _requestHandler->makeGetRequest(url, {}, errorHandler, responseHandler);
+        });
+    });
+}
+
+//==============================================================================
+
 auto XSNBlockExplorerHttpClient::getRawTxByIndex(int64_t blockNum, uint32_t txIndex)
     -> Promise<QByteArray>
 {
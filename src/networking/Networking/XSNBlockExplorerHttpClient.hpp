@@ -5,13 +5,19 @@
 #include "RequestHandlerImpl.hpp"
 #include <QObject>
 #include <QPointer>
+#include <QUrl>
 #include <memory>
 
+class BlockExplorerTipStream;
+
 class XSNBlockExplorerHttpClient : public AbstractBlockExplorerHttpClient {
     Q_OBJECT
 public:
-    XSNBlockExplorerHttpClient(
-        std::unique_ptr<RequestHandlerImpl>&& requestHandler, QObject* parent = nullptr);
+    // withTipStream enables pushed tips from <domain>/ws, only UTXO explorers serve it.
+    XSNBlockExplorerHttpClient(std::unique_ptr<RequestHandlerImpl>&& requestHandler,
+        bool withTipStream = false, QObject* parent = nullptr);
+
+    void subscribeTips() override;
 
 public slots:
     Promise<QByteArray> getTransactionsForAddress(
@@ -26,6 +32,7 @@ public slots:
     Promise<double> estimateSmartFee(unsigned blocksTarget) override;
     Promise<QByteArray> getBlockHashByHeight(unsigned blockHeight) override;
     Promise<QByteArray> getRawTransaction(QString transactionHash) override;
+    Promise<QByteArray> getBlockRawTransactions(QString blockHash) override;
     Promise<QByteArray> getRawTxByIndex(int64_t blockNum, uint32_t txIndex) override;
     Promise<QByteArray> getBlockFilter(QString blockHash) override;
     Promise<QByteArray> getTxOut(QString txid, unsigned int outputIndex) override;
@@ -33,6 +40,8 @@ public slots:
 
 private:
     RequestHandlerImpl* _requestHandler{ nullptr };
+    BlockExplorerTipStream* _tipStream{ nullptr };
+    bool _withTipStream{ false };
 };
 
 #endif // XSNBlockExplorerHttpClient_HPP
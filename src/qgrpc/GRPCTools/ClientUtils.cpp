@@ -4,6 +4,14 @@
 
 const grpc::Status BaseGrpcClient::notConnectedStatus(grpc::StatusCode::UNKNOWN, "Not connected");
 
+// layout of completion tag: | generation | slot index | step |
+static constexpr uintptr_t TAG_STEP_BITS = 2;
+static constexpr uintptr_t TAG_SLOT_BITS = sizeof(uintptr_t) >= 8 ? 24 : 14;
+static constexpr uintptr_t TAG_STEP_MASK = (uintptr_t(1) << TAG_STEP_BITS) - 1;
+static constexpr uintptr_t TAG_SLOT_MASK = (uintptr_t(1) << TAG_SLOT_BITS) - 1;
+static constexpr uintptr_t TAG_GENERATION_SHIFT = TAG_STEP_BITS + TAG_SLOT_BITS;
+static constexpr uintptr_t TAG_GENERATION_MASK = ~uintptr_t(0) >> TAG_GENERATION_SHIFT;
+
 struct MacaroonAuthPlugin : public grpc::MetadataCredentialsPlugin {
     explicit MacaroonAuthPlugin(std::string macaroon)
         : _macaroon(macaroon)
@@ -65,7 +73,17 @@ BaseGrpcClient::~BaseGrpcClient()
 {
 	LogCDebug(GRPC) << "Detroying grpc client" << this;
     _isShutdown = true;
+    // pending operations have to complete before drained queue lets pump thread exit
+    Utils::ExecuteJob(_worker, [this] {
+        for (auto&& slot : _callSlots) {
+            if (slot.call) {
+                slot.call->_context->TryCancel();
+            }
+        }
+    });
     _cq.Shutdown();
+    _cqPump->join();
+    Utils::ExecuteJob(_worker, [this] { completeAllCalls(); });
     _worker.quit();
     _worker.wait();
 }
@@ -119,88 +137,47 @@ void BaseGrpcClient::connect()
     }
 }
 
-uint64_t BaseGrpcClient::generateId()
-{
-    auto advanceId = [this](uint64_t& outId) { outId = ++_lastUsedId; };
-
-    uint64_t id;
-    do {
-        advanceId(id);
-    } while (_pendingCalls.count(id) > 0);
-
-    return id;
-}
-
-BaseGrpcClient::CallOps* BaseGrpcClient::generateCallOps(uint64_t id, std::string payload)
-{
-    CallOps* ops = new CallOps;
-    ops->id = id;
-    ops->payload = payload;
-    return ops;
-}
-
-void BaseGrpcClient::completeCall(uint64_t id)
-{
-    auto it = _pendingCalls.find(id);
-    if (it != std::end(_pendingCalls)) {
-        auto call = it->second.get();
-        if (call->_state == BaseAsyncClientCall::State::Finished) {
-            LogCDebug(GRPC) << "Call has finished, erasing" << reinterpret_cast<uintptr_t>(call);
-            _pendingCalls.erase(it);
-        }
-    }
-}
-
 void BaseGrpcClient::completeAllCalls()
 {
-    for (auto&& it : _pendingCalls) {
-        auto call = it.second.get();
-        call->_state = BaseAsyncClientCall::State::Shutdown;
-        call->process(it.first, {});
+    for (auto&& slot : _callSlots) {
+        if (auto call = slot.call.get()) {
+            call->_state = BaseAsyncClientCall::State::Shutdown;
+            call->process(false, BaseAsyncClientCall::Step::Default);
+        }
     }
 
-    _pendingCalls.clear();
-}
-
-BaseAsyncClientCall* BaseGrpcClient::pendingCall(uint64_t id)
-{
-    return _pendingCalls.count(id) > 0 ? _pendingCalls.at(id).get() : nullptr;
+    _callSlots.clear();
+    _freeSlots.clear();
 }
 
-void BaseGrpcClient::completeRpc()
+void BaseGrpcClient::onCompletion(void* tag, bool ok)
 {
-    QMetaObject::invokeMethod(
-        _worker.context(), [this] { _semaphore.release(); }, Qt::QueuedConnection);
+    if (_isShutdown) {
+        return;
+    }
 
-    // Block until the next result is available in the completion queue "cq".
-    while (true) {
-        bool ok = false;
-        void* got_tag = nullptr;
+    auto value = reinterpret_cast<uintptr_t>(tag);
+    auto step = static_cast<BaseAsyncClientCall::Step>(value & TAG_STEP_MASK);
+    auto index = (value >> TAG_STEP_BITS) & TAG_SLOT_MASK;
+    auto generation = value >> TAG_GENERATION_SHIFT;
 
-        std::chrono::system_clock::time_point deadline
-            = std::chrono::system_clock::now() + std::chrono::milliseconds(20);
-        auto status = _cq.DoThenAsyncNext(
-            [] { QCoreApplication::processEvents(); }, &got_tag, &ok, deadline);
+    if (index >= _callSlots.size()) {
+        return;
+    }
 
-        if (_isShutdown) {
-            status = CompletionQueue::SHUTDOWN;
-        }
+    auto call = _callSlots[index].call.get();
+    // completion of a call that has already finished or whose slot was reused
+    if (!call || _callSlots[index].generation != generation) {
+        return;
+    }
 
-        if (status == CompletionQueue::TIMEOUT) {
-            continue;
-        } else if (status == CompletionQueue::SHUTDOWN) {
-            break;
-        }
+    call->process(ok, step);
 
-        auto ops = reinterpret_cast<CallOps*>(got_tag);
-        if (auto call = pendingCall(ops->id)) {
-            call->process(ok, ops->payload);
-            completeCall(ops->id);
-            delete ops;
-        }
+    if (call->_state == BaseAsyncClientCall::State::Finished) {
+        LogCDebug(GRPC) << "Call has finished, erasing" << reinterpret_cast<uintptr_t>(call);
+        _callSlots[index].call.reset();
+        _freeSlots.push_back(index);
     }
-
-    completeAllCalls();
 }
 
 void BaseGrpcClient::startWorker()
@@ -209,17 +186,33 @@ void BaseGrpcClient::startWorker()
 
     if (!_worker.isRunning()) {
         _worker.start();
-        QMetaObject::invokeMethod(_worker.context(), [this] { completeRpc(); });
-
-        _semaphore.acquire();
+        _cqPump.reset(new qgrpc::CompletionQueuePump(&_cq, _worker.context(),
+            [this](void* tag, bool ok) { onCompletion(tag, ok); }));
+        _cqPump->start();
     }
 }
 
-void BaseGrpcClient::startPreparedCall(
-    uint64_t id, std::unique_ptr<BaseAsyncClientCall> preparedCall)
+void BaseGrpcClient::startPreparedCall(std::unique_ptr<BaseAsyncClientCall> preparedCall)
 {
-	LogCDebug(GRPC) << "Setting alarm for" << reinterpret_cast<uintptr_t>(preparedCall.get());
-	preparedCall->_alarm.Set(
-        &_cq, gpr_now(gpr_clock_type::GPR_CLOCK_REALTIME), preparedCall->_generateTag({}));
-    _pendingCalls[id] = std::move(preparedCall);
+    LogCDebug(GRPC) << "Starting call" << reinterpret_cast<uintptr_t>(preparedCall.get());
+
+    size_t index;
+    if (_freeSlots.empty()) {
+        index = _callSlots.size();
+        Q_ASSERT_X(index <= TAG_SLOT_MASK, __FUNCTION__, "Too many pending calls");
+        _callSlots.emplace_back();
+    } else {
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+
+    auto& slot = _callSlots[index];
+    slot.generation = (slot.generation + 1) & TAG_GENERATION_MASK;
+    preparedCall->_tagBase = (slot.generation << TAG_GENERATION_SHIFT)
+        | (static_cast<uintptr_t>(index) << TAG_STEP_BITS);
+    slot.call = std::move(preparedCall);
+
+    auto call = slot.call.get();
+    // we are already on worker thread, no need to round trip through completion queue
+    call->process(true, BaseAsyncClientCall::Step::Default);
 }
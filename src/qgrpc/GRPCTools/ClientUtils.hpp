@@ -1,14 +1,14 @@
 #ifndef CLIENTUTILS_HPP
 #define CLIENTUTILS_HPP
 
+#include <GRPCTools/CompletionQueuePump.hpp>
 #include <Utils/Logging.hpp>
 #include <Utils/Utils.hpp>
 
 #include <QDir>
-#include <QSemaphore>
 #include <boost/optional.hpp>
+#include <atomic>
 #include <cstdint>
-#include <grpcpp/alarm.h>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/impl/codegen/async_stream.h>
 #include <grpcpp/impl/codegen/async_unary_call.h>
@@ -16,6 +16,7 @@
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 //==============================================================================
 
@@ -179,15 +180,13 @@ public:
 struct BaseAsyncClientCall {
     enum class State { Initial, Connecting, MetadataRecv, Connected, Finishing, Finished, Shutdown };
 
-    using GenerateTag = std::function<void*(std::string)>;
+    // identifies which of concurrently pending operations has completed
+    enum class Step : uint8_t { Default, Read, Write };
 
-    BaseAsyncClientCall(
-        State state, std::unique_ptr<ClientContext> context, GenerateTag generateTag)
+    BaseAsyncClientCall(State state, std::unique_ptr<ClientContext> context)
         : _state(state)
         , _context(std::move(context))
-        , _generateTag(generateTag)
     {
-		
     }
 
     virtual ~BaseAsyncClientCall() {}
@@ -201,11 +200,15 @@ struct BaseAsyncClientCall {
     // Storage for the status of the RPC upon completion.
     Status _status;
 
-    GenerateTag _generateTag;
+    // assigned by BaseGrpcClient when call is started, low bits are left for step.
+    uintptr_t _tagBase{ 0 };
 
-    grpc::Alarm _alarm;
+    void* tag(Step step = Step::Default) const
+    {
+        return reinterpret_cast<void*>(_tagBase | static_cast<uintptr_t>(step));
+    }
 
-    virtual void process(bool ok, std::string payload) = 0;
+    virtual void process(bool ok, Step step) = 0;
 };
 
 //==============================================================================
@@ -213,8 +216,8 @@ struct BaseAsyncClientCall {
 // struct for keeping state and data information
 template <class T> struct UnaryAsyncCall : public BaseAsyncClientCall {
 public:
-    UnaryAsyncCall(std::unique_ptr<ClientContext> context, GenerateTag generateTag)
-        : BaseAsyncClientCall(State::Initial, std::move(context), generateTag)
+    UnaryAsyncCall(std::unique_ptr<ClientContext> context)
+        : BaseAsyncClientCall(State::Initial, std::move(context))
     {
     }
 
@@ -229,11 +232,11 @@ public:
     }
 
 protected:
-    void process(bool ok, std::string /*payload*/) override
+    void process(bool ok, Step /*step*/) override
     {
         if (_state == State::Initial) {
             _reader->StartCall();
-            _reader->Finish(&_reply, &_status, _generateTag({}));
+            _reader->Finish(&_reply, &_status, tag());
             _state = State::Connecting;
         } else if (ok && _status.ok()) {
             _resolve.get()(_reply);
@@ -263,8 +266,8 @@ template <class T> struct StreamingReadAsyncCall : public BaseAsyncClientCall {
 public:
     using Observer = StreamObserver<T>;
     using ObserverUniqueRef = std::unique_ptr<Observer>;
-    StreamingReadAsyncCall(std::unique_ptr<ClientContext> context, GenerateTag generateTag)
-        : BaseAsyncClientCall(State::Initial, std::move(context), generateTag)
+    StreamingReadAsyncCall(std::unique_ptr<ClientContext> context)
+        : BaseAsyncClientCall(State::Initial, std::move(context))
     {
 		LogCDebug(GRPC) << "Creating StreamingReadAsyncCall" << reinterpret_cast<uintptr_t>(this);
     }
@@ -281,7 +284,7 @@ public:
         _reader = func(_context.get(), request, cq);
     }
 
-    void process(bool ok, std::string /*payload*/) override
+    void process(bool ok, Step /*step*/) override
     {
 		LogCDebug(GRPC) << "Processing call:" << reinterpret_cast<uintptr_t>(this)
 			<< "state:" << static_cast<int>(_state) << "isOk:" << ok;
@@ -299,7 +302,7 @@ public:
 		if (ok) {
 			if (_state == State::Initial) {
 				_state = State::Connecting;
-				_reader->StartCall(_generateTag({}));
+				_reader->StartCall(tag());
 			}
 			else if (_state == State::Connected) {
 				// we can get here only if we are on read or write
@@ -307,7 +310,7 @@ public:
 			}
 			else if (_state == State::Connecting) {
 				_state = State::MetadataRecv;
-				_reader->ReadInitialMetadata(_generateTag({}));
+				_reader->ReadInitialMetadata(tag());
 			}
 			else if (_state == State::MetadataRecv) {
 				_state = State::Connected;
@@ -320,7 +323,7 @@ public:
 				_observer->onCompleted(grpc::Status::CANCELLED);
 			} else {
 				_state = State::Finishing;
-				_reader->Finish(&_status, _generateTag({}));
+				_reader->Finish(&_status, tag());
 			}
 		}
     }
@@ -329,7 +332,7 @@ private:
     void read()
     {
         Q_ASSERT(!_readPending);
-		_reader->Read(&_reply, _generateTag({}));
+		_reader->Read(&_reply, tag());
         _readPending = true;
     }
 
@@ -362,9 +365,8 @@ public:
     using Observer = StreamRequestObserver<Request, Response>;
     using ObserverUniqueRef = std::unique_ptr<Observer>;
 
-    StreamingReadWriteAsyncCall(
-        std::unique_ptr<ClientContext> context, GenerateTag generateTag, QObject* executionContext)
-        : BaseAsyncClientCall(State::Initial, std::move(context), generateTag)
+    StreamingReadWriteAsyncCall(std::unique_ptr<ClientContext> context, QObject* executionContext)
+        : BaseAsyncClientCall(State::Initial, std::move(context))
         , _executionContext(executionContext)
     {
     }
@@ -376,7 +378,7 @@ public:
         _readerWriter = func(_context.get(), cq);
     }
 
-    void process(bool ok, std::string payload) override
+    void process(bool ok, Step step) override
     {
         LogCDebug(GRPC) << "Processing call:" << reinterpret_cast<uintptr_t>(this)
                         << "state:" << static_cast<int>(_state) << "isOk:" << ok;
@@ -393,13 +395,13 @@ public:
 
         if (ok) {
             if (_state == State::Initial) {
-                _readerWriter->StartCall(_generateTag({}));
+                _readerWriter->StartCall(tag());
                 _state = State::Connecting;
             } else if (_state == State::Connected) {
-                if (payload == _readPayload) {
+                if (step == Step::Read) {
                     // we can get here only if we are on read
                     onReadDone();
-                } else if (payload == _writePayload) {
+                } else if (step == Step::Write) {
                     onWriteDone();
                 }
             } else if (_state == State::Connecting) {
@@ -409,7 +411,7 @@ public:
             }
         } else {
             _state = State::Finishing;
-            _readerWriter->Finish(&_status, _generateTag({}));
+            _readerWriter->Finish(&_status, tag());
         }
     }
 
@@ -429,7 +431,7 @@ private:
     void read()
     {
         Q_ASSERT(!_readPending);
-        _readerWriter->Read(&_reply, _generateTag(_readPayload));
+        _readerWriter->Read(&_reply, tag(Step::Read));
         _readPending = true;
     }
 
@@ -443,7 +445,7 @@ private:
         _writeQueue.pop();
         _writePending = true;
 
-        _readerWriter->Write(item, _generateTag(_writePayload));
+        _readerWriter->Write(item, tag(Step::Write));
     }
 
     void onReadDone()
@@ -474,8 +476,6 @@ private:
     ObserverUniqueRef _eventSubscription;
     bool _readPending{ false };
     bool _writePending{ false };
-    const std::string _readPayload{ "r" };
-    const std::string _writePayload{ "w" };
 };
 
 //==============================================================================
@@ -484,9 +484,11 @@ class BaseGrpcClient : public QObject {
 
     Q_OBJECT
 
-    struct CallOps {
-        uint64_t id;
-        std::string payload;
+    // calls are kept in reusable slots, completion tag packs slot index, slot generation and
+    // step, so tags don't need allocation and stale completions of reused slot are detected.
+    struct CallSlot {
+        std::unique_ptr<BaseAsyncClientCall> call;
+        uintptr_t generation{ 0 };
     };
 
 public:
@@ -511,17 +513,13 @@ public:
 		return Promise<T>([=](const auto &resolve, const auto &reject) {
 			QMetaObject::invokeMethod(_worker.context(), [=] {
 				using CallType = UnaryAsyncCall<T>;
-				auto id = this->generateId();
-				auto generateTag
-					= [this, id](std::string payload) -> void* { return this->generateCallOps(id, payload); };
-				std::unique_ptr<BaseAsyncClientCall> call(
-					new CallType(CreateContext(timeout), generateTag));
+				std::unique_ptr<BaseAsyncClientCall> call(new CallType(CreateContext(timeout)));
 				static_cast<CallType*>(call.get())
 					->makeRequest(std::bind(func, client, std::placeholders::_1,
 						std::placeholders::_2, std::placeholders::_3),
 						req, &_cq, resolve, reject);
 
-				this->startPreparedCall(id, std::move(call));
+				this->startPreparedCall(std::move(call));
 			});
 		});
     }
@@ -532,12 +530,8 @@ public:
     {
 		QMetaObject::invokeMethod(_worker.context(), [this, client, func, req, timeout, readContext = std::move(readContext)]() mutable {
 			using CallType = StreamingReadAsyncCall<T>;
-			auto id = this->generateId();
-			auto generateTag
-				= [this, id](std::string payload) -> void* { return this->generateCallOps(id, payload); };
 
-			std::unique_ptr<BaseAsyncClientCall> call(
-				new CallType(CreateContext(timeout), generateTag));
+			std::unique_ptr<BaseAsyncClientCall> call(new CallType(CreateContext(timeout)));
 
 			LogCDebug(GRPC) << "Created streaming call" << reinterpret_cast<uintptr_t>(call.get());
 
@@ -546,7 +540,7 @@ public:
 					std::placeholders::_3),
 					req, std::move(readContext), &_cq);
 
-			this->startPreparedCall(id, std::move(call));
+			this->startPreparedCall(std::move(call));
 		});
     }
 
@@ -556,11 +550,8 @@ public:
     {
 		QMetaObject::invokeMethod(_worker.context(), [this, client, func, timeout, readWriteContext = std::move(readWriteContext)]() mutable {
 			using CallType = StreamingReadWriteAsyncCall<Request, T>;
-			auto id = this->generateId();
-			auto generateTag
-				= [this, id](std::string payload) -> void* { return this->generateCallOps(id, payload); };
 			std::unique_ptr<BaseAsyncClientCall> call(
-				new CallType(CreateContext(timeout), generateTag, _worker.context()));
+				new CallType(CreateContext(timeout), _worker.context()));
 
 			LogCDebug(GRPC) << "Created streaming call" << reinterpret_cast<uintptr_t>(call.get());
 
@@ -568,7 +559,7 @@ public:
 				->makeRequest(std::bind(func, client, std::placeholders::_1, std::placeholders::_2),
 					std::move(readWriteContext), &_cq);
 
-			this->startPreparedCall(id, std::move(call));
+			this->startPreparedCall(std::move(call));
 		});
     }
 
@@ -579,33 +570,30 @@ public:
     void connect();
 
 private:
-    uint64_t generateId();
-    CallOps* generateCallOps(uint64_t id, std::string payload);
-    void completeCall(uint64_t id);
     void completeAllCalls();
-    BaseAsyncClientCall* pendingCall(uint64_t id);
-    void completeRpc();
+    void onCompletion(void* tag, bool ok);
     void startWorker();
-    void startPreparedCall(uint64_t id, std::unique_ptr<BaseAsyncClientCall> preparedCall);
+    void startPreparedCall(std::unique_ptr<BaseAsyncClientCall> preparedCall);
 
 protected:
     std::shared_ptr<grpc::Channel> _channel;
 
 private:
-    QSemaphore _semaphore;
     QString _rpcChannel;
     TlsCertProvider _tlsCertProvider;
     MacaroonProvider _macaroonProvider;
     Utils::WorkerThread _worker;
-    bool _isShutdown{ false };
-    uint64_t _lastUsedId{ 0 };
+    std::atomic_bool _isShutdown{ false };
     AuthType _authType{ AuthType::SSL };
 
     // The producer-consumer queue we use to communicate asynchronously with the
     // gRPC runtime.
     CompletionQueue _cq;
+    // delivers completions from _cq to _worker, has to be destroyed before _cq
+    std::unique_ptr<qgrpc::CompletionQueuePump> _cqPump;
 
-    std::unordered_map<uint64_t, std::unique_ptr<BaseAsyncClientCall>> _pendingCalls;
+    std::vector<CallSlot> _callSlots;
+    std::vector<size_t> _freeSlots;
 };
 
 #endif // CLIENTUTILS_HPP
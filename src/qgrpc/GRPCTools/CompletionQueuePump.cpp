@@ -0,0 +1,79 @@
+#include "CompletionQueuePump.hpp"
+
+#include <QThread>
+
+//==============================================================================
+
+qgrpc::CompletionQueuePump::CompletionQueuePump(
+    grpc::CompletionQueue* cq, QObject* context, Handler handler, Finished finished)
+    : _cq(cq)
+    , _context(context)
+    , _handler(handler)
+    , _finished(finished)
+{
+}
+
+//==============================================================================
+
+qgrpc::CompletionQueuePump::~CompletionQueuePump()
+{
+    join();
+}
+
+//==============================================================================
+
+void qgrpc::CompletionQueuePump::start()
+{
+    _thread = std::thread(&CompletionQueuePump::run, this);
+}
+
+//==============================================================================
+
+void qgrpc::CompletionQueuePump::join()
+{
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+//==============================================================================
+
+void qgrpc::CompletionQueuePump::dispatch()
+{
+    Q_ASSERT_X(QThread::currentThread() == _context->thread(), __FUNCTION__,
+        "Missmatched thread affinity");
+
+    // reset before draining, completion that is pushed meanwhile schedules one more dispatch
+    _dispatchScheduled = false;
+
+    Completion completion;
+    while (_completions.pop(completion)) {
+        _handler(completion.tag, completion.ok);
+    }
+}
+
+//==============================================================================
+
+void qgrpc::CompletionQueuePump::run()
+{
+    void* tag = nullptr;
+    bool ok = false;
+
+    // blocks until next event, returns false only when queue was shutdown and fully drained
+    while (_cq->Next(&tag, &ok)) {
+        _completions.push(Completion{ tag, ok });
+        if (!_dispatchScheduled.exchange(true)) {
+            QMetaObject::invokeMethod(_context, [this] { dispatch(); });
+        }
+    }
+
+    // queued after last dispatch, so it runs once everything was handled
+    QMetaObject::invokeMethod(_context, [this] {
+        dispatch();
+        if (_finished) {
+            _finished();
+        }
+    });
+}
+
+//==============================================================================
@@ -0,0 +1,58 @@
+#ifndef COMPLETIONQUEUEPUMP_HPP
+#define COMPLETIONQUEUEPUMP_HPP
+
+#include <QObject>
+#include <atomic>
+#include <boost/lockfree/queue.hpp>
+#include <functional>
+#include <grpcpp/completion_queue.h>
+#include <thread>
+
+namespace qgrpc {
+
+//==============================================================================
+
+/*!
+ * \brief The CompletionQueuePump class drains completion queue on a dedicated thread which is
+ * blocked in Next(), completions are handed over to execution context through lock-free queue.
+ * Execution context is woken up once per batch of completions, so handler is always called
+ * from context's thread. Drain thread stops once completion queue was shutdown and drained.
+ */
+class CompletionQueuePump {
+public:
+    using Handler = std::function<void(void* tag, bool ok)>;
+    using Finished = std::function<void()>;
+
+    // finished is called from context's thread after last completion was handled.
+    explicit CompletionQueuePump(grpc::CompletionQueue* cq, QObject* context, Handler handler,
+        Finished finished = {});
+    ~CompletionQueuePump();
+
+    void start();
+    void join();
+    // handles completions which were delivered but not dispatched yet, has to be called
+    // from context's thread.
+    void dispatch();
+
+private:
+    void run();
+
+private:
+    struct Completion {
+        void* tag;
+        bool ok;
+    };
+
+    grpc::CompletionQueue* _cq{ nullptr };
+    QObject* _context{ nullptr };
+    Handler _handler;
+    Finished _finished;
+    boost::lockfree::queue<Completion> _completions{ 128 };
+    std::atomic_bool _dispatchScheduled{ false };
+    std::thread _thread;
+};
+
+//==============================================================================
+}
+
+#endif // COMPLETIONQUEUEPUMP_HPP
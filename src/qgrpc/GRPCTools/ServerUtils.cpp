@@ -1,9 +1,12 @@
 #include "ServerUtils.hpp"
 
+#include <QEventLoop>
+
 //==============================================================================
 
-qgrpc::BaseGrpcServer::BaseGrpcServer(std::string serverAddress)
+qgrpc::BaseGrpcServer::BaseGrpcServer(std::string serverAddress, size_t completionQueues)
     : _serverAddress(serverAddress)
+    , _completionQueues(std::max<size_t>(completionQueues, 1))
 {
 }
 
@@ -24,7 +27,11 @@ void qgrpc::BaseGrpcServer::run(std::vector<grpc::Service*> services)
         builder.RegisterService(service);
     }
 
-    _cq = builder.AddCompletionQueue();
+    for (size_t i = 0; i < _completionQueues; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->cq = builder.AddCompletionQueue();
+        _shards.emplace_back(std::move(shard));
+    }
     _server = builder.BuildAndStart();
 
     exec();
@@ -34,79 +41,125 @@ void qgrpc::BaseGrpcServer::run(std::vector<grpc::Service*> services)
 
 void qgrpc::BaseGrpcServer::shutdown()
 {
-    if (!_cq) {
+    if (_shards.empty() || _isShutdown.exchange(true)) {
         return;
     }
 
-    QMetaObject::invokeMethod(_context, [this] {
-        for (auto& call : _calls) {
-            call.second->process(false);
+    for (auto&& shard : _shards) {
+        if (!shard->context) {
+            continue;
         }
-    });
+
+        auto calls = &shard->calls;
+        QMetaObject::invokeMethod(shard->context, [calls] {
+            for (auto& call : *calls) {
+                call.second->process(false);
+            }
+        });
+    }
+
     _server->Shutdown();
-    _cq->Shutdown();
+    for (auto&& shard : _shards) {
+        shard->cq->Shutdown();
+    }
 }
 
 //==============================================================================
 
 void qgrpc::BaseGrpcServer::exec()
 {
-    _context = new QObject;
-
-    registerService();
+    QEventLoop loop;
+
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        auto& shard = *_shards[i];
+        if (i == 0) {
+            // first queue is served from calling thread
+            shard.ownContext = std::make_unique<QObject>();
+            shard.context = shard.ownContext.get();
+        } else {
+            shard.thread = std::make_unique<Utils::WorkerThread>();
+            shard.thread->rename(QString("Stakenet-GrpcServer-%1").arg(i));
+            shard.thread->start();
+            shard.context = shard.thread->context();
+        }
 
-    void* tag; // uniquely identifies a request.
-    bool ok;
-    while (true) {
-        std::chrono::system_clock::time_point deadline
-            = std::chrono::system_clock::now() + std::chrono::milliseconds(20);
-        auto status
-            = _cq->DoThenAsyncNext([] { QCoreApplication::processEvents(); }, &tag, &ok, deadline);
+        auto registerShard = [this, &shard] {
+            _registeringShard = &shard;
+            registerService();
+            _registeringShard = nullptr;
+        };
 
-        if (status == grpc::CompletionQueue::NextStatus::TIMEOUT) {
-            continue;
-        } else if (status == grpc::CompletionQueue::NextStatus::SHUTDOWN) {
-            break;
+        if (shard.thread) {
+            Utils::ExecuteJob(*shard.thread, registerShard);
+        } else {
+            registerShard();
         }
 
-        size_t id = reinterpret_cast<uint64_t>(tag);
-        if (_calls.count(id) == 0) {
-            continue;
+        auto shardPtr = &shard;
+        CompletionQueuePump::Finished finished;
+        if (i == 0) {
+            finished = [&loop] { loop.quit(); };
         }
+        shard.pump = std::make_unique<CompletionQueuePump>(shard.cq.get(), shard.context,
+            [this, shardPtr](void* tag, bool ok) { processCompletion(*shardPtr, tag, ok); },
+            finished);
+    }
 
-        auto& call = _calls.at(id);
-        // means we got a connection
-        if (ok && call->_state == qgrpc::BaseServerAsyncCall::State::Connecting) {
-            // replicate this call to serve other clients, and process current one.
-            auto newId = generateId();
-            auto newCall = call->replicateAndProcess(newId);
-            newCall->process(true);
-            _calls.emplace(newId, std::move(newCall));
-        }
+    for (auto&& shard : _shards) {
+        shard->pump->start();
+    }
 
-        call->process(ok);
+    loop.exec();
 
-        if (call->_state == qgrpc::BaseServerAsyncCall::State::Finished) {
-            _calls.erase(id);
+    // first queue is drained at this point, wait for the rest
+    shutdown();
+    for (auto&& shard : _shards) {
+        shard->pump->join();
+        if (shard->thread) {
+            // flushes completions which were posted but not dispatched yet
+            Utils::ExecuteJob(*shard->thread, [] {});
+            shard->thread->quit();
+            shard->thread->wait();
         }
+        shard->calls.clear();
     }
-
-    _calls.clear();
 }
 
 //==============================================================================
 
-uint64_t qgrpc::BaseGrpcServer::generateId()
+void qgrpc::BaseGrpcServer::processCompletion(Shard& shard, void* tag, bool ok)
 {
-    auto advanceId = [](uint64_t& outId) {
-        static uint64_t id = 0;
-        outId = ++id;
-    };
+    auto id = reinterpret_cast<uint64_t>(tag);
+    auto it = shard.calls.find(id);
+    if (it == std::end(shard.calls)) {
+        return;
+    }
+
+    auto& call = it->second;
+    // means we got a connection
+    if (ok && call->_state == qgrpc::BaseServerAsyncCall::State::Connecting) {
+        // replicate this call to serve other clients, and process current one.
+        auto newId = generateId(shard);
+        auto newCall = call->replicateAndProcess(newId);
+        newCall->process(true);
+        shard.calls.emplace(newId, std::move(newCall));
+    }
+
+    call->process(ok);
 
+    if (call->_state == qgrpc::BaseServerAsyncCall::State::Finished) {
+        shard.calls.erase(id);
+    }
+}
+
+//==============================================================================
+
+uint64_t qgrpc::BaseGrpcServer::generateId(Shard& shard)
+{
     uint64_t id;
     do {
-        advanceId(id);
-    } while (_calls.count(id) > 0);
+        id = ++shard.lastUsedId;
+    } while (shard.calls.count(id) > 0);
 
     return id;
 }
@@ -1,19 +1,27 @@
 #ifndef SERVERUTILS_HPP
 #define SERVERUTILS_HPP
 
+#include <GRPCTools/CompletionQueuePump.hpp>
 #include <Utils/Logging.hpp>
+#include <Utils/Utils.hpp>
 
 #include <QCoreApplication>
 #include <QObject>
 #include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <string>
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/function_types/parameter_types.hpp>
 #include <boost/mpl/at.hpp>
@@ -81,20 +89,123 @@ namespace details {
 
 //==============================================================================
 
+struct StreamingChannelPolicy {
+    enum class Overflow {
+        // queue grows without limit
+        Unbounded,
+        // oldest queued message is dropped once capacity is reached
+        DropOldest,
+        // message is merged into queued one with same key, oldest message is dropped once
+        // capacity is reached
+        Coalesce
+    };
+
+    Overflow overflow{ Overflow::Unbounded };
+    // 0 means no limit, Coalesce then only merges messages
+    size_t capacity{ 0 };
+};
+
+//==============================================================================
+
+struct StreamingChannelStats {
+    size_t queueDepth{ 0 };
+    size_t maxQueueDepth{ 0 };
+    uint64_t dropped{ 0 };
+    uint64_t coalesced{ 0 };
+};
+
+//==============================================================================
+
 template <class T> struct StreamingChannel : std::enable_shared_from_this<StreamingChannel<T>> {
+    using CoalesceKey = std::function<std::string(const T&)>;
+    // merges incoming message into queued one, incoming replaces queued if not set. Returns false
+    // when messages cancel each other out, queued one is dropped then.
+    using Merge = std::function<bool(T& queued, const T& incoming)>;
+
     explicit StreamingChannel(QObject* context)
         : _context(context)
     {
     }
 
+    void setPolicy(StreamingChannelPolicy policy, CoalesceKey key = {}, Merge merge = {})
+    {
+        Q_ASSERT_X(policy.overflow != StreamingChannelPolicy::Overflow::Coalesce || key,
+            __FUNCTION__, "Coalesce policy requires key");
+        std::lock_guard<std::mutex> guard(_lock);
+        _policy = policy;
+        _coalesceKey = key;
+        _merge = merge;
+        _positions.clear();
+        if (_policy.overflow == StreamingChannelPolicy::Overflow::Coalesce) {
+            for (size_t i = 0; i < _queue.size(); ++i) {
+                if (!_queue[i].cancelled) {
+                    _queue[i].key = _coalesceKey(_queue[i].value);
+                    _positions[_queue[i].key] = _headSeq + i;
+                }
+            }
+        }
+    }
+
+    // can be called from any thread, wakes up context only if there is no pending wake up.
     void send(T value)
     {
-        QMetaObject::invokeMethod(_context,
-            [=] {
-                _writeQueue.push(value);
-                _notifyDataReady();
-            },
-            Qt::QueuedConnection);
+        using Overflow = StreamingChannelPolicy::Overflow;
+        bool notify = false;
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            if (_closed) {
+                return;
+            }
+
+            std::string key;
+            if (_policy.overflow == Overflow::Coalesce) {
+                key = _coalesceKey(value);
+                auto it = _positions.find(key);
+                if (it != std::end(_positions)) {
+                    auto& queued = _queue.at(it->second - _headSeq);
+                    if (!_merge) {
+                        queued.value = std::move(value);
+                    } else if (!_merge(queued.value, value)) {
+                        // entry stays in queue until it reaches front, sequences stay valid
+                        queued.cancelled = true;
+                        ++_cancelledCount;
+                        _positions.erase(it);
+                    }
+                    ++_stats.coalesced;
+                    return;
+                }
+            }
+
+            if (isFull()) {
+                while (_queue.front().cancelled) {
+                    popFront();
+                }
+                popFront();
+                ++_stats.dropped;
+            }
+
+            if (_policy.overflow == Overflow::Coalesce) {
+                _positions[key] = _headSeq + _queue.size();
+            }
+            _queue.push_back(Entry{ std::move(value), std::move(key) });
+            _stats.maxQueueDepth = std::max(_stats.maxQueueDepth, size());
+
+            notify = !_notifyScheduled;
+            _notifyScheduled = true;
+        }
+
+        if (notify) {
+            auto self = this->shared_from_this();
+            QMetaObject::invokeMethod(_context,
+                [self] {
+                    {
+                        std::lock_guard<std::mutex> guard(self->_lock);
+                        self->_notifyScheduled = false;
+                    }
+                    self->_notifyDataReady();
+                },
+                Qt::QueuedConnection);
+        }
     }
 
     void close(grpc::Status status)
@@ -102,10 +213,88 @@ template <class T> struct StreamingChannel : std::enable_shared_from_this<Stream
         QMetaObject::invokeMethod(_context, [=] { _notifyClose(status); });
     }
 
+    // takes next message to write, has to be called from context's thread.
+    bool pop(T& value, size_t& remaining)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        while (!_queue.empty() && _queue.front().cancelled) {
+            popFront();
+        }
+
+        if (_queue.empty()) {
+            return false;
+        }
+
+        value = std::move(_queue.front().value);
+        popFront();
+        remaining = size();
+        return true;
+    }
+
+    // rpc is done, pending and further messages are discarded.
+    void cancel()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _closed = true;
+        _queue.clear();
+        _positions.clear();
+        _cancelledCount = 0;
+    }
+
+    StreamingChannelStats stats() const
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        auto result = _stats;
+        result.queueDepth = size();
+        return result;
+    }
+
     QObject* _context;
-    std::queue<T> _writeQueue;
     std::function<void(void)> _notifyDataReady;
     std::function<void(grpc::Status)> _notifyClose;
+
+private:
+    struct Entry {
+        T value;
+        std::string key;
+        bool cancelled{ false };
+    };
+
+    // queued messages which are still going to be written
+    size_t size() const { return _queue.size() - _cancelledCount; }
+
+    bool isFull() const
+    {
+        return _policy.overflow != StreamingChannelPolicy::Overflow::Unbounded
+            && _policy.capacity > 0 && size() >= _policy.capacity;
+    }
+
+    void popFront()
+    {
+        if (_queue.front().cancelled) {
+            --_cancelledCount;
+        } else if (_policy.overflow == StreamingChannelPolicy::Overflow::Coalesce) {
+            auto it = _positions.find(_queue.front().key);
+            if (it != std::end(_positions) && it->second == _headSeq) {
+                _positions.erase(it);
+            }
+        }
+        _queue.pop_front();
+        ++_headSeq;
+    }
+
+    mutable std::mutex _lock;
+    StreamingChannelPolicy _policy;
+    CoalesceKey _coalesceKey;
+    Merge _merge;
+    std::deque<Entry> _queue;
+    // sequence number of queued message for coalesce key
+    std::unordered_map<std::string, uint64_t> _positions;
+    uint64_t _headSeq{ 0 };
+    size_t _cancelledCount{ 0 };
+    StreamingChannelStats _stats;
+    bool _notifyScheduled{ false };
+    bool _closed{ false };
 };
 
 //==============================================================================
@@ -132,6 +321,12 @@ template <class T> struct UnarySender : std::enable_shared_from_this<UnarySender
 
 //==============================================================================
 
+// client metadata of a call, copied out of grpc::ServerContext so that it stays valid when
+// receiver runs on other thread than the one which serves the call.
+using ClientMetadata = std::multimap<std::string, std::string>;
+
+//==============================================================================
+
 struct BaseServerAsyncCall {
     enum class State { Create, Connecting, Processing, Finishing, Finished };
 
@@ -149,6 +344,17 @@ struct BaseServerAsyncCall {
     virtual void process(bool ok) = 0;
     virtual std::unique_ptr<BaseServerAsyncCall> replicateAndProcess(uint64_t newId) = 0;
 
+    ClientMetadata clientMetadata() const
+    {
+        ClientMetadata result;
+        for (auto&& entry : _ctx.client_metadata()) {
+            result.emplace(std::string(entry.first.begin(), entry.first.end()),
+                std::string(entry.second.begin(), entry.second.end()));
+        }
+
+        return result;
+    }
+
     QObject* _executionContext{ nullptr };
     uint64_t _id;
     grpc::ServerCompletionQueue* _cq;
@@ -163,8 +369,8 @@ template <typename F, typename Service> struct UnaryServerAsyncCall : BaseServer
     typedef typename details::call_types<F>::Reply Reply;
     typedef typename details::call_types<F>::Responder Responder;
 
-    using Receiver
-        = std::function<void(grpc::ServerContext*, Request*, std::shared_ptr<UnarySender<Reply>>)>;
+    using Receiver = std::function<void(
+        const ClientMetadata*, Request*, std::shared_ptr<UnarySender<Reply>>)>;
 
     explicit UnaryServerAsyncCall(uint64_t id, Service* service, grpc::ServerCompletionQueue* cq,
         F func, Receiver receiver, QObject* context)
@@ -209,7 +415,8 @@ template <typename F, typename Service> struct UnaryServerAsyncCall : BaseServer
                           setState(State::Finishing);
                       };
 
-                _receiver(&_ctx, &_request, _sender);
+                auto metadata = clientMetadata();
+                _receiver(&metadata, &_request, _sender);
             } else if (_state == State::Finishing) {
                 setState(State::Finished);
             }
@@ -244,7 +451,7 @@ public:
     typedef typename details::call_types<F>::Responder Responder;
 
     using Receiver = std::function<void(
-        grpc::ServerContext*, Request*, std::shared_ptr<StreamingChannel<Reply>>)>;
+        const ClientMetadata*, Request*, std::shared_ptr<StreamingChannel<Reply>>)>;
 
     explicit StreamingServerAsyncCall(uint64_t id, Service* service,
         grpc::ServerCompletionQueue* cq, F func, Receiver receiver, QObject* context)
@@ -256,6 +463,13 @@ public:
     {
     }
 
+    ~StreamingServerAsyncCall() override
+    {
+        if (_channel) {
+            _channel->cancel();
+        }
+    }
+
     std::unique_ptr<BaseServerAsyncCall> replicateAndProcess(uint64_t newId) override
     {
         auto result = std::unique_ptr<BaseServerAsyncCall>(new StreamingServerAsyncCall(
@@ -296,7 +510,8 @@ public:
                             setState(State::Finishing);
                         }
                     };
-                    _receiver(&_ctx, &_request, _channel);
+                    auto metadata = clientMetadata();
+                    _receiver(&metadata, &_request, _channel);
                 } else if (_state == State::Finishing) {
                     setState(State::Finished);
                 } else {
@@ -313,6 +528,7 @@ public:
             if (_channel) {
                 _channel->_notifyDataReady = [] {};
                 _channel->_notifyClose = [](auto) {};
+                _channel->cancel();
             }
 
             if (_state == State::Processing) {
@@ -328,11 +544,10 @@ private:
     void sendScheduledData()
     {
         Q_ASSERT(_hasPendingWrite == false);
-        auto& queue = _channel->_writeQueue;
-        if (!queue.empty()) {
-            bool writeLast = queue.size() == 1 && _pendingClose;
-            auto value = queue.front();
-            queue.pop();
+        Reply value;
+        size_t remaining = 0;
+        if (_channel->pop(value, remaining)) {
+            bool writeLast = remaining == 0 && _pendingClose;
             _hasPendingWrite = true;
             auto tag = reinterpret_cast<void*>(_id);
             if (writeLast) {
@@ -359,7 +574,13 @@ private:
 
 class BaseGrpcServer {
 public:
-    explicit BaseGrpcServer(std::string serverAddress);
+    // completionQueues > 1 serves calls from that many threads, each completion queue gets own
+    // thread and own copy of registered calls. Receivers are still executed on thread of the
+    // first queue, other threads only take completion handling and (de)serialization off it.
+    // Receivers get copies of client metadata and request, pointers to them are valid only
+    // while receiver runs, grpc::ServerContext is never exposed since it belongs to thread of
+    // the queue which serves the call.
+    explicit BaseGrpcServer(std::string serverAddress, size_t completionQueues = 1);
     virtual ~BaseGrpcServer();
 
     void run(std::vector<grpc::Service*> services);
@@ -379,34 +600,70 @@ protected:
     typename std::enable_if<qgrpc::details::is_streaming<F>, void>::type registerCall(
         F func, Service* service, typename StreamingCall<F, Service>::Receiver receiver)
     {
-        auto newId = generateId();
-        auto call = std::unique_ptr<qgrpc::BaseServerAsyncCall>(
-            new StreamingCall<F, Service>(newId, service, _cq.get(), func, receiver, _context));
+        auto& shard = *_registeringShard;
+        auto newId = generateId(shard);
+        auto call = std::unique_ptr<qgrpc::BaseServerAsyncCall>(new StreamingCall<F, Service>(
+            newId, service, shard.cq.get(), func, serialized(receiver), shard.context));
         call->process(true);
-        _calls.emplace(newId, std::move(call));
+        shard.calls.emplace(newId, std::move(call));
     }
 
     template <class F, class Service>
     typename std::enable_if<qgrpc::details::is_unary<F>, void>::type registerCall(
         F func, Service* service, typename UnaryCall<F, Service>::Receiver receiver)
     {
-
-        auto newId = generateId();
-        auto call = std::unique_ptr<qgrpc::BaseServerAsyncCall>(
-            new UnaryCall<F, Service>(newId, service, _cq.get(), func, receiver, _context));
+        auto& shard = *_registeringShard;
+        auto newId = generateId(shard);
+        auto call = std::unique_ptr<qgrpc::BaseServerAsyncCall>(new UnaryCall<F, Service>(
+            newId, service, shard.cq.get(), func, serialized(receiver), shard.context));
         call->process(true);
-        _calls.emplace(newId, std::move(call));
+        shard.calls.emplace(newId, std::move(call));
     }
 
 private:
-    uint64_t generateId();
+    // receivers share state of the server, calls which came from other queues are handed over
+    // to first queue's thread. Metadata and request are copied for that since call can be gone
+    // by the time receiver runs.
+    template <class Request, class Sender>
+    std::function<void(const ClientMetadata*, Request*, Sender)> serialized(
+        std::function<void(const ClientMetadata*, Request*, Sender)> receiver)
+    {
+        auto receiverContext = _shards.front()->context;
+        if (_registeringShard->context == receiverContext) {
+            return receiver;
+        }
+
+        return [receiverContext, receiver](
+                   const ClientMetadata* metadata, Request* request, Sender sender) {
+            QMetaObject::invokeMethod(receiverContext,
+                [receiver, metadata = *metadata, request = *request, sender]() mutable {
+                    receiver(&metadata, &request, sender);
+                },
+                Qt::QueuedConnection);
+        };
+    }
+
+    // completion queue together with calls that are served from it, calls are accessed only
+    // from context's thread.
+    struct Shard {
+        std::unique_ptr<grpc::ServerCompletionQueue> cq;
+        std::unique_ptr<QObject> ownContext;
+        std::unique_ptr<Utils::WorkerThread> thread;
+        QObject* context{ nullptr };
+        std::unique_ptr<CompletionQueuePump> pump;
+        std::unordered_map<uint64_t, std::unique_ptr<qgrpc::BaseServerAsyncCall>> calls;
+        uint64_t lastUsedId{ 0 };
+    };
+
+    uint64_t generateId(Shard& shard);
+    void processCompletion(Shard& shard, void* tag, bool ok);
 
-    QObject* _context{ nullptr };
     std::string _serverAddress;
-    std::unique_ptr<grpc::ServerCompletionQueue> _cq;
+    size_t _completionQueues{ 1 };
+    std::vector<std::unique_ptr<Shard>> _shards;
+    Shard* _registeringShard{ nullptr };
     std::unique_ptr<grpc::Server> _server;
-    std::unordered_map<uint64_t, std::unique_ptr<qgrpc::BaseServerAsyncCall>> _calls;
-    bool _isShutdown{ false };
+    std::atomic_bool _isShutdown{ false };
 };
 }
 
@@ -27,6 +27,7 @@ include($$PWD/../../modules/boost/libboost.pri)
 
 HEADERS += \ \
     GRPCTools/ClientUtils.hpp \
+    GRPCTools/CompletionQueuePump.hpp \
     GRPCTools/ServerUtils.hpp
 
 unix {
@@ -39,4 +40,5 @@ DISTFILES += \
 
 SOURCES += \
     GRPCTools/ClientUtils.cpp \
+    GRPCTools/CompletionQueuePump.cpp \
     GRPCTools/ServerUtils.cpp
@@ -354,11 +354,6 @@ bool Filter::match(std::string str)
     return match(std::vector<unsigned char>{ str.begin(), str.end() });
 }
 
-bool Filter::matchAny(std::vector<std::string> data)
-{
-    return data.size() > (_modulusNP / _m / 2) ? hashMatchAny(data) : zipMatchAny(data);
-}
-
 void Filter::addEntry(std::vector<unsigned char> entry)
 {
     _data.emplace_back(entry);
@@ -399,111 +394,199 @@ Filter Filter::FromNMPBytes(
     return filter;
 }
 
-bool Filter::hashMatchAny(const std::vector<std::string>& data)
-{
-    if (data.empty()) {
-        return false;
-    }
+namespace {
 
-    // Create a filter bitstream.
-    const auto& filterData = _bytes;
+    // Gives uniform access to query items stored either as separate strings or in
+    // FilterQuerySet arena.
+    struct StringQueries {
+        const std::vector<std::string>& data;
 
-    BitReader reader(filterData);
+        size_t size() const { return data.size(); }
+        const unsigned char* entry(size_t index) const
+        {
+            return reinterpret_cast<const unsigned char*>(data[index].data());
+        }
+        size_t entrySize(size_t index) const { return data[index].size(); }
+    };
 
-    uint64_t lastValue = 0;
-    std::vector<uint64_t> values;
-    values.reserve(10000);
-    uint64_t value;
-    while (ReadFullUint64(reader, _p, value)) {
-        lastValue += value;
-        values.push_back(lastValue);
+    struct ArenaQueries {
+        const FilterQuerySet& data;
+
+        size_t size() const { return data.size(); }
+        const unsigned char* entry(size_t index) const { return data.entry(index); }
+        size_t entrySize(size_t index) const { return data.entrySize(index); }
+    };
+
+    struct FilterParams {
+        const std::vector<uint8_t>& bytes;
+        const Filter::key_t& key;
+        uint64_t m;
+        uint64_t modulusNP;
+        uint8_t p;
+
+        uint64_t n() const { return m > 0 ? modulusNP / m : 0; }
+    };
+
+    std::vector<uint64_t> DecodeValues(const FilterParams& params)
+    {
+        BitReader reader(params.bytes);
+
+        // Values are stored as sorted deltas, so decoded set is sorted too.
+        std::vector<uint64_t> values;
+        values.reserve(params.n());
+        uint64_t lastValue = 0;
+        uint64_t value;
+        while (ReadFullUint64(reader, params.p, value)) {
+            lastValue += value;
+            values.push_back(lastValue);
+        }
+
+        return values;
     }
 
-    // We take the high and low bits of modulusNP for the multiplication
-    // of 2 64-bit integers into a 128-bit integer.
-    auto nphi = _modulusNP >> 32;
-    auto nplo = uint64_t(uint32_t(_modulusNP));
+    template <class Queries> std::vector<uint64_t> ReduceQueries(
+        const FilterParams& params, const Queries& queries)
+    {
+        // We take the high and low bits of modulusNP for the multiplication
+        // of 2 64-bit integers into a 128-bit integer.
+        auto nphi = params.modulusNP >> 32;
+        auto nplo = uint64_t(uint32_t(params.modulusNP));
+
+        // Then we hash our search term with the same parameters as the filter.
+        uint64_t k0, k1;
+        memcpy(&k0, &params.key[0], sizeof(k0));
+        memcpy(&k1, &params.key[Filter::KeySize / 2], sizeof(k1));
+
+        std::vector<uint64_t> values(queries.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            auto term = bitcoin::CSipHasher(k0, k1)
+                            .Write(queries.entry(i), queries.entrySize(i))
+                            .Finalize();
+            values[i] = fastReduction(term, nphi, nplo);
+        }
 
-    // Then we hash our search term with the same parameters as the filter.
-    uint64_t k0 = *(reinterpret_cast<uint64_t*>(&_key[0]));
-    uint64_t k1 = *(reinterpret_cast<uint64_t*>(&_key[KeySize / 2]));
+        return values;
+    }
+
+    template <class Queries>
+    bool HashMatchAny(const FilterParams& params, const Queries& queries)
+    {
+        const auto values = DecodeValues(params);
+        if (values.empty()) {
+            return false;
+        }
+
+        // Every query is hashed and reduced exactly once and probed in decoded set.
+        const auto terms = ReduceQueries(params, queries);
+        return std::any_of(std::begin(terms), std::end(terms), [&values](uint64_t term) {
+            return std::binary_search(std::begin(values), std::end(values), term);
+        });
+    }
 
-    // Finally, run through the provided data items, querying the index to
-    // determine if the filter contains any elements of interest.
-    for (auto&& entry : data) {
-        // For each datum, we assign the initial hash to
-        // a uint64.
-        auto term = bitcoin::CSipHasher(k0, k1)
-                        .Write(reinterpret_cast<const unsigned char*>(&entry[0]), entry.size())
-                        .Finalize();
-
-        // We'll then reduce the value down to the range
-        // of our modulus.
-        for (size_t i = 0; i < values.size(); ++i) {
-            if (values[i] == fastReduction(term, nphi, nplo)) {
-                return true;
+    template <class Queries>
+    bool ZipMatchAny(const FilterParams& params, const Queries& queries)
+    {
+        // Create a filter bitstream.
+        BitReader reader(params.bytes);
+
+        auto values = ReduceQueries(params, queries);
+        std::sort(std::begin(values), std::end(values));
+
+        // Go through the search filter and look for the desired value.
+        uint64_t lastValue1 = 0;
+        uint64_t lastValue2 = values[0];
+        size_t i = 1;
+        while (lastValue1 != lastValue2) {
+            // Check which filter to advance to make sure we're comparing
+            // the right values.
+            if (lastValue1 > lastValue2) {
+                // Advance filter created from search terms or return
+                // false if we're at the end because nothing matched.
+                if (i < values.size()) {
+                    lastValue2 = values[i++];
+                } else {
+                    return false;
+                }
+            } else if (lastValue1 < lastValue2) {
+                // Advance filter we're searching or return false if
+                // we're at the end because nothing matched.
+                uint64_t value;
+                if (!ReadFullUint64(reader, params.p, value)) {
+                    return false;
+                }
+
+                lastValue1 += value;
             }
         }
+
+        return true;
     }
 
-    return false;
+    template <class Queries>
+    bool MatchAnyQuery(const FilterParams& params, const Queries& queries)
+    {
+        if (queries.size() == 0 || params.m == 0) {
+            return false;
+        }
+
+        // When query set is bigger than filter it's cheaper to decode filter once and probe it
+        // with every query, otherwise we sort queries and merge them with decoded stream.
+        return queries.size() > (params.n() / 2) ? HashMatchAny(params, queries)
+                                                 : ZipMatchAny(params, queries);
+    }
 }
 
-bool Filter::zipMatchAny(const std::vector<std::string>& data)
+bool Filter::matchAny(const std::vector<std::string>& data)
 {
-    // Create a filter bitstream.
-    const auto& filterData = _bytes;
+    return MatchAnyQuery(FilterParams{ _bytes, _key, _m, _modulusNP, _p }, StringQueries{ data });
+}
 
-    BitReader reader(filterData);
+bool Filter::matchAny(const FilterQuerySet& data)
+{
+    return MatchAnyQuery(FilterParams{ _bytes, _key, _m, _modulusNP, _p }, ArenaQueries{ data });
+}
 
-    // We take the high and low bits of modulusNP for the multiplication
-    // of 2 64-bit integers into a 128-bit integer.
-    auto nphi = _modulusNP >> 32;
-    auto nplo = uint64_t(uint32_t(_modulusNP));
+bool Filter::MatchAny(key_t key, uint64_t n, uint64_t m, unsigned short p,
+    const std::vector<uint8_t>& bytes, const FilterQuerySet& data)
+{
+    return MatchAnyQuery(FilterParams{ bytes, key, m, n * m, static_cast<uint8_t>(p) },
+        ArenaQueries{ data });
+}
 
-    std::vector<uint64_t> values(data.size());
+void FilterQuerySet::reserve(size_t entries, size_t bytes)
+{
+    _offsets.reserve(entries + 1);
+    _arena.reserve(bytes);
+}
 
-    // Then we hash our search term with the same parameters as the filter.
-    uint64_t k0 = *(reinterpret_cast<uint64_t*>(&_key[0]));
-    uint64_t k1 = *(reinterpret_cast<uint64_t*>(&_key[KeySize / 2]));
+void FilterQuerySet::clear()
+{
+    _arena.clear();
+    _offsets.assign(1, 0);
+}
 
-    std::transform(std::begin(data), std::end(data), std::begin(values),
-        [k0, k1, nphi, nplo](const auto& entry) {
-            auto term = bitcoin::CSipHasher(k0, k1)
-                            .Write(reinterpret_cast<const unsigned char*>(&entry[0]), entry.size())
-                            .Finalize();
-            return fastReduction(term, nphi, nplo);
-        });
+size_t FilterQuerySet::size() const
+{
+    return _offsets.size() - 1;
+}
 
-    std::sort(std::begin(values), std::end(values));
+bool FilterQuerySet::empty() const
+{
+    return size() == 0;
+}
 
-    // Go through the search filter and look for the desired value.
-    uint64_t lastValue1 = 0;
-    uint64_t lastValue2 = values[0];
-    size_t i = 1;
-    while (lastValue1 != lastValue2) {
-        // Check which filter to advance to make sure we're comparing
-        // the right values.
-        if (lastValue1 > lastValue2) {
-            // Advance filter created from search terms or return
-            // false if we're at the end because nothing matched.
-            if (i < values.size()) {
-                lastValue2 = values[i++];
-            } else {
-                return false;
-            }
-        } else if (lastValue1 < lastValue2) {
-            // Advance filter we're searching or return false if
-            // we're at the end because nothing matched.
-            uint64_t value;
-            if (!ReadFullUint64(reader, _p, value)) {
-                return false;
-            }
+const unsigned char* FilterQuerySet::entry(size_t index) const
+{
+    return _arena.data() + _offsets[index];
+}
 
-            lastValue1 += value;
-        }
-    }
+size_t FilterQuerySet::entrySize(size_t index) const
+{
+    return _offsets[index + 1] - _offsets[index];
+}
 
-    return true;
+void FilterQuerySet::commitEntry()
+{
+    _offsets.push_back(static_cast<uint32_t>(_arena.size()));
 }
 }
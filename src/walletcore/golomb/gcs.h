@@ -34,6 +34,31 @@
 
 namespace bitcoin {
 
+// Query items stored back to back in one contiguous arena, can be grown
+// incrementally and reused for matching many filters.
+class FilterQuerySet {
+public:
+    template <class It> void add(It first, It last)
+    {
+        _arena.insert(_arena.end(), first, last);
+        commitEntry();
+    }
+
+    void reserve(size_t entries, size_t bytes);
+    void clear();
+    size_t size() const;
+    bool empty() const;
+    const unsigned char* entry(size_t index) const;
+    size_t entrySize(size_t index) const;
+
+private:
+    void commitEntry();
+
+private:
+    std::vector<unsigned char> _arena;
+    std::vector<uint32_t> _offsets{ 0 };
+};
+
 class Filter {
 public:
     static constexpr size_t KeySize = 16;
@@ -42,17 +67,17 @@ public:
     size_t build(); // returns N
     bool match(std::vector<unsigned char> data);
     bool match(std::string str);
-    bool matchAny(std::vector<std::string> entries);
+    bool matchAny(const std::vector<std::string>& entries);
+    bool matchAny(const FilterQuerySet& entries);
     void addEntry(std::vector<unsigned char> entry);
     void addEntries(std::vector<std::string> entries);
     std::vector<uint8_t> bytes() const;
 
     static Filter WithKeyMP(key_t key, uint64_t m, unsigned short p);
     static Filter FromNMPBytes(key_t key, uint64_t n, uint64_t m, unsigned short p, std::vector<uint8_t> bytes);
-
-private:
-    bool hashMatchAny(const std::vector<std::string>& data);
-    bool zipMatchAny(const std::vector<std::string>& data);
+    // Same as FromNMPBytes(...).matchAny(entries), without copying filter bytes.
+    static bool MatchAny(key_t key, uint64_t n, uint64_t m, unsigned short p,
+        const std::vector<uint8_t>& bytes, const FilterQuerySet& entries);
 
 private:
     key_t _key;
@@ -182,33 +182,32 @@ bool CBlockTreeDB::LoadBestBlockGuts(
 bool CBlockTreeDB::EraseByAsset(unsigned assetID)
 {
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    CDBBatch batch(*this);
+    batch.Erase(std::make_pair(DB_TIP_HASH, AssetID(assetID)));
 
-    pcursor->Seek(std::make_pair(DB_TX_INDEX, uint256()));
-
+    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, std::make_pair(AssetID(assetID), 0u)));
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
-        std::pair<char, std::pair<AssetID, uint256>> key;
-        if (pcursor->GetKey(key) && key.first == DB_TX_INDEX && key.second.first == assetID) {
-            Erase(key);
+        std::pair<char, std::pair<AssetID, uint32_t>> key;
+        if (!pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX || key.second.first != assetID) {
+            break;
         }
+
+        batch.Erase(key);
+        pcursor->Next();
     }
 
-    return true;
+    return WriteBatch(batch, true);
 }
 
 bool CBlockTreeDB::Exists(unsigned assetID)
 {
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
 
-    pcursor->Seek(std::make_pair(DB_TX_INDEX, uint256()));
-    while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
-        std::pair<char, std::pair<AssetID, uint256>> key;
-        if (pcursor->GetKey(key) && key.first == DB_TX_INDEX && key.second.first == assetID) {
-            return true;
-        }
-    }
-    return false;
+    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, std::make_pair(AssetID(assetID), 0u)));
+    std::pair<char, std::pair<AssetID, uint32_t>> key;
+    return pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX
+        && key.second.first == assetID;
 }
 
 CTxDB::CTxDB(std::string dataDir, size_t nCacheSize, bool fMemory, bool fWipe)